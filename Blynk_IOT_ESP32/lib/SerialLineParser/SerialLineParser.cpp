@@ -0,0 +1,70 @@
+#include "SerialLineParser.h"
+
+void SerialLineParser::poll(Stream& stream, size_t maxBytes) {
+    while (maxBytes-- > 0 && stream.available() > 0) {
+        feed((char)stream.read());
+    }
+}
+
+void SerialLineParser::feed(char c) {
+    if (c == '\r') {
+        return;
+    }
+
+    if (c == '\n') {
+        if (_discarding) {
+            // End of an over-long line that was already counted
+            _discarding = false;
+        } else if (_len > 0) {
+            _buf[_len] = '\0';
+            _lines++;
+            dispatch();
+        }
+        _len = 0;
+        return;
+    }
+
+    if (_discarding) {
+        return;
+    }
+    if (_len >= MAX_LINE) {
+        _overflowed++;
+        _discarding = true;
+        _len = 0;
+        return;
+    }
+    _buf[_len++] = c;
+}
+
+void SerialLineParser::dispatch() {
+    const LineRoute* match = nullptr;
+    size_t matchLen = 0;
+
+    for (size_t i = 0; i < _routeCount; i++) {
+        size_t n = strlen(_routes[i].prefix);
+        if (n > matchLen && strncmp(_buf, _routes[i].prefix, n) == 0) {
+            match = &_routes[i];
+            matchLen = n;
+        }
+    }
+    if (!match) {
+        _malformed++;
+        return;
+    }
+
+    const char* start = _buf + matchLen;
+    char* end;
+    long value = strtol(start, &end, 10);
+    bool converted = end != start;
+    // Require a number, optionally followed by trailing whitespace only
+    while (*end == ' ' || *end == '\t') {
+        end++;
+    }
+    if (!converted || *end != '\0') {
+        _malformed++;
+        return;
+    }
+
+    _dispatched++;
+    _handler(match->vpin, value);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Maps a line prefix (e.g. "Sensor2 Value1") to a virtual pin
+struct LineRoute {
+    const char* prefix;
+    uint8_t vpin;
+};
+
+// Incremental, allocation-free "<prefix> <integer>" line parser.
+//
+// Bytes are consumed as they arrive, so poll() never waits for a full line
+// and never blocks; a complete line is matched against the route table
+// (longest prefix wins) and handed to the handler with its virtual pin.
+class SerialLineParser {
+public:
+    using Handler = void (*)(uint8_t vpin, long value);
+
+    static const size_t MAX_LINE = 64;
+
+    SerialLineParser(const LineRoute* routes, size_t routeCount, Handler handler)
+        : _routes(routes), _routeCount(routeCount), _handler(handler) {}
+
+    // Consume at most maxBytes of what is already buffered in the stream
+    void poll(Stream& stream, size_t maxBytes = 128);
+    void feed(char c);
+
+    uint32_t lines() const { return _lines; }
+    uint32_t dispatched() const { return _dispatched; }
+    uint32_t malformed() const { return _malformed; }
+    uint32_t overflowed() const { return _overflowed; }
+
+private:
+    void dispatch();
+
+    const LineRoute* _routes;
+    size_t _routeCount;
+    Handler _handler;
+
+    char _buf[MAX_LINE + 1];
+    size_t _len = 0;
+    bool _discarding = false;
+
+    uint32_t _lines = 0;
+    uint32_t _dispatched = 0;
+    uint32_t _malformed = 0;
+    uint32_t _overflowed = 0;
+};
@@ -0,0 +1,78 @@
+#include "VirtualPinPublisher.h"
+
+VirtualPinPublisher::Pin* VirtualPinPublisher::pin(uint8_t vpin) {
+    for (size_t i = 0; i < _pinCount; i++) {
+        if (_pins[i].vpin == vpin) {
+            return &_pins[i];
+        }
+    }
+    if (_pinCount >= MAX_PINS) {
+        return nullptr;
+    }
+
+    Pin& p = _pins[_pinCount++];
+    p.vpin = vpin;
+    p.deadband = 0;
+    p.latest = 0;
+    p.lastSent = 0;
+    p.lastSentAt = 0;
+    p.pending = false;
+    p.everSent = false;
+    return &p;
+}
+
+bool VirtualPinPublisher::configurePin(uint8_t vpin, long deadband) {
+    Pin* p = pin(vpin);
+    if (!p) {
+        return false;
+    }
+    p->deadband = deadband;
+    return true;
+}
+
+void VirtualPinPublisher::update(uint8_t vpin, long value) {
+    _received++;
+    Pin* p = pin(vpin);
+    if (!p) {
+        return;
+    }
+    if (p->pending) {
+        // Overwritten before it was sent
+        _suppressed++;
+    }
+    p->latest = value;
+    p->pending = true;
+}
+
+size_t VirtualPinPublisher::flush() {
+    unsigned long now = millis();
+    size_t writes = 0;
+
+    for (size_t i = 0; i < _pinCount; i++) {
+        Pin& p = _pins[i];
+        if (!p.pending) {
+            continue;
+        }
+        if (p.everSent && now - p.lastSentAt < _minInterval) {
+            continue;
+        }
+
+        p.pending = false;
+        if (p.everSent && labs(p.latest - p.lastSent) <= p.deadband) {
+            _suppressed++;
+            continue;
+        }
+
+        _writer(p.vpin, p.latest);
+        p.lastSent = p.latest;
+        p.lastSentAt = now;
+        p.everSent = true;
+        writes++;
+    }
+
+    if (writes > 0) {
+        _sent += writes;
+        _flushes++;
+    }
+    return writes;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Rate-limited, deduplicating publish stage for virtual pin values.
+//
+// update() only records the latest value per pin. flush(), run from a
+// timer, sends every pin that is due in one pass: at most one write per pin
+// per interval, and only when the value moved by more than the pin's deadband
+// since the last value actually sent.
+class VirtualPinPublisher {
+public:
+    using Writer = void (*)(uint8_t vpin, long value);
+
+    static const size_t MAX_PINS = 8;
+
+    VirtualPinPublisher(Writer writer, unsigned long minIntervalMs)
+        : _writer(writer), _minInterval(minIntervalMs) {}
+
+    // Optional per-pin deadband; pins are registered on first use otherwise
+    bool configurePin(uint8_t vpin, long deadband);
+    void update(uint8_t vpin, long value);
+    // Returns the number of writes made
+    size_t flush();
+
+    void setMinInterval(unsigned long ms) { _minInterval = ms; }
+
+    uint32_t valuesReceived() const { return _received; }
+    uint32_t messagesSent() const { return _sent; }
+    uint32_t flushes() const { return _flushes; }
+    uint32_t suppressed() const { return _suppressed; }
+
+private:
+    struct Pin {
+        uint8_t vpin;
+        long deadband;
+        long latest;
+        long lastSent;
+        unsigned long lastSentAt;
+        bool pending;
+        bool everSent;
+    };
+
+    Pin* pin(uint8_t vpin);
+
+    Writer _writer;
+    unsigned long _minInterval;
+    Pin _pins[MAX_PINS];
+    size_t _pinCount = 0;
+
+    uint32_t _received = 0;
+    uint32_t _sent = 0;
+    uint32_t _flushes = 0;
+    uint32_t _suppressed = 0;
+};
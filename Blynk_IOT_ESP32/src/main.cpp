@@ -1,5 +1,16 @@
 #include <WiFi.h>
 #include "BlynkSimpleEsp32.h"
+#include <SerialLineParser.h>
+#include <VirtualPinPublisher.h>
+
+// 1 = run the on-device benchmark suite at boot and print JSON results
+#ifndef BENCH_SUITE
+#define BENCH_SUITE 0
+#endif
+
+#if BENCH_SUITE
+#include <BenchSuite.h>
+#endif
 
 #define BLYNK_TEMPLATE_ID ""
 #define BLYNK_TEMPLATE_NAME " "
@@ -13,43 +24,94 @@ const char *password = "";
 // Blynk authentication token
 char auth[] = BLYNK_AUTH_TOKEN;
 
-// put function definitions here:
-void sendDataSensor1() {
-  if (Serial.available()) {
-    String command = Serial.readStringUntil('\n');
-    if (command.startsWith("Sensor1")) {
-      int value = command.substring(7).toInt();
-      // Send data to Blynk server
-      Serial.print("Sensor1 value: ");
-      Serial.println(value);
-      Blynk.virtualWrite(V1, value); // Assuming V1 is the virtual pin to send the data to
-    }
-  }
+// At most one update per virtual pin per interval
+#define PUBLISH_INTERVAL_MS 1000
+// How often due pins are flushed to Blynk
+#define PUBLISH_FLUSH_MS 100
+// Changes of up to this much are not sent
+#define SENSOR1_DEADBAND 0
+#define SENSOR2_DEADBAND 0
+
+// Serial lines forwarded to Blynk, by prefix
+const LineRoute sensorRoutes[] = {
+  {"Sensor1", V1},
+  {"Sensor2 Value1", V2},
+  {"Sensor2 Value2", V3},
+};
+
+void writeVirtualPin(uint8_t vpin, long value) {
+  Serial.printf("V%u value: %ld\n", vpin, value);
+  Blynk.virtualWrite(vpin, value);
 }
 
-void sendDataSensor2() {
-  if (Serial.available()) {
-    String command = Serial.readStringUntil('\n');
-    if (command.startsWith("Sensor2 Value1")) {
-      int value1 = command.substring(14).toInt();
-      // Send data to Blynk server
-      Serial.print("Sensor2 value1: ");
-      Serial.println(value1);
-      Blynk.virtualWrite(V2, value1); // Assuming V2 is the virtual pin to send the data to
-    }
-    if (command.startsWith("Sensor2 Value2")) {
-      int value2 = command.substring(14).toInt();
-      // Send data to Blynk server
-      Serial.print("Sensor2 value2: ");
-      Serial.println(value2);
-      Blynk.virtualWrite(V3, value2); // Assuming V3 is the virtual pin to send the data to
+// Keeps the latest value per pin; a fast producer can't flood the connection
+VirtualPinPublisher publisher(writeVirtualPin, PUBLISH_INTERVAL_MS);
+
+void sendSensorValue(uint8_t vpin, long value) {
+  publisher.update(vpin, value);
+}
+
+void flushPublisher() {
+  publisher.flush();
+}
+
+// One parser for all sensors, so no handler can steal another's line
+SerialLineParser sensorParser(sensorRoutes, sizeof(sensorRoutes) / sizeof(sensorRoutes[0]),
+                              sendSensorValue);
+
+void printStats() {
+  Serial.printf("Serial: %u lines, %u forwarded, %u malformed, %u too long\n",
+                sensorParser.lines(), sensorParser.dispatched(),
+                sensorParser.malformed(), sensorParser.overflowed());
+  Serial.printf("Blynk: %u values received, %u messages sent in %u flushes, %u suppressed\n",
+                publisher.valuesReceived(), publisher.messagesSent(),
+                publisher.flushes(), publisher.suppressed());
+}
+
+#if BENCH_SUITE
+// Parser and publisher throughput on a recorded burst of sensor output
+void runBenchmarks() {
+  static const char fixture[] =
+    "Sensor1 23\r\n"
+    "Sensor2 Value1 1024\r\n"
+    "Sensor2 Value2 -17\r\n"
+    "Sensor1 24\r\n"
+    "garbage line\r\n"
+    "Sensor2 Value1 1031\r\n"
+    "Sensor2 Value2 -16\r\n"
+    "Sensor1 24\r\n";
+  static uint32_t values = 0;
+  static SerialLineParser parser(sensorRoutes, sizeof(sensorRoutes) / sizeof(sensorRoutes[0]),
+                                 [](uint8_t, long) { values++; });
+  static VirtualPinPublisher benchPublisher([](uint8_t, long) { values++; }, 0);
+
+  BenchSuite suite("blynk");
+  suite.add("parse_lines/8", [] {
+    for (const char* p = fixture; *p; p++) {
+      parser.feed(*p);
     }
-  }
+    BenchSuite::doNotOptimize(values);
+  });
+  suite.add("publish_update_flush/3", [] {
+    benchPublisher.update(V1, values);
+    benchPublisher.update(V2, values + 1);
+    benchPublisher.update(V3, values + 2);
+    benchPublisher.flush();
+    values++;
+  });
+
+  suite.run();
 }
+#endif
 
 void setup() {
   // WiFi connectivity check code
+  // Room for bursts of sensor lines while Blynk.run() is busy
+  Serial.setRxBufferSize(1024);
   Serial.begin(115200);
+#if BENCH_SUITE
+  runBenchmarks();
+#endif
   Serial.println("Connecting to Blynk...");
   Blynk.begin(auth, ssid, password,IPAddress(128,199,144,129), 8080);
   while (Blynk.connected() == false) {
@@ -59,13 +121,19 @@ void setup() {
   Serial.println("\nBlynk connected!");
   // Rest of your setup code
 
-  timer.setInterval(2000L, sendDataSensor1);
-  timer.setInterval(1000L, sendDataSensor2);
+  publisher.configurePin(V1, SENSOR1_DEADBAND);
+  publisher.configurePin(V2, SENSOR2_DEADBAND);
+  publisher.configurePin(V3, SENSOR2_DEADBAND);
+
+  timer.setInterval(PUBLISH_FLUSH_MS, flushPublisher);
+  timer.setInterval(60000L, printStats);
 }
 
 void loop() {
   // put your main code here, to run repeatedly:
   Blynk.run();
   timer.run();
+  // Only takes what is already buffered; never waits for a full line
+  sensorParser.poll(Serial);
 }
 
@@ -0,0 +1,314 @@
+// Host benchmark: VirtualPinPublisher against a local Blynk protocol
+// stand-in, through HostHAL's Blynk client (BLYNK_SERVER points it at the
+// stand-in, which answers the login and heartbeats and decodes every
+// HARDWARE "vw" message).
+//
+// The loop gets sensor values at the rate the 115200-baud serial stream
+// delivers them (600 values/s over V1-V3) and either writes each one straight
+// to Blynk, as the sketch did before, or hands them to the publisher flushed
+// by a BlynkTimer every 100 ms, as the sketch does now. For each run it
+// prints values received, messages and bytes the server read per second,
+// messages over the server's default quota of 100 per second (the legacy
+// server's user-message-quota-limit; those are dropped) and the loop's CPU
+// time. Checked: the server got every message the publisher counted, the
+// publisher stays under the quota, and after a final flush the server holds
+// each pin's latest value (within the pin's deadband).
+//
+//   g++ -O2 -std=gnu++17 -pthread -I../../lib/HostHAL -I../lib/VirtualPinPublisher
+//       -o blynk_publish_bench blynk_publish_bench.cpp ../lib/VirtualPinPublisher/VirtualPinPublisher.cpp
+//       ../../lib/HostHAL/*.cpp -lssl -lcrypto
+//
+//   ./blynk_publish_bench
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <Arduino.h>
+#include <BlynkSimpleEsp32.h>
+#include <HostTest.h>
+
+#include "VirtualPinPublisher.h"
+
+using HostTest::check;
+
+namespace {
+
+const unsigned long RUN_MS = 3000;
+const uint32_t VALUES_PER_SECOND = 600;
+const uint8_t PINS[] = {V1, V2, V3};
+const size_t PIN_COUNT = sizeof(PINS) / sizeof(PINS[0]);
+const unsigned long FLUSH_MS = 100;
+const uint32_t QUOTA_PER_SECOND = 100;
+
+class StandInServer {
+public:
+    bool start() {
+        _fd = socket(AF_INET, SOCK_STREAM, 0);
+        int on = 1;
+        setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(_fd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(_fd, 4) != 0) {
+            return false;
+        }
+        socklen_t len = sizeof(addr);
+        getsockname(_fd, (sockaddr*)&addr, &len);
+        _port = ntohs(addr.sin_port);
+        std::thread(&StandInServer::acceptLoop, this).detach();
+        return true;
+    }
+
+    uint16_t port() const { return _port; }
+    uint32_t writes() const { return _writes; }
+    uint32_t overQuota() const { return _overQuota; }
+    uint64_t bytesIn() const { return _bytesIn; }
+
+    // Last value written to a virtual pin, or -1 when none was
+    long value(uint8_t vpin) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _values.find(vpin);
+        return it == _values.end() ? -1 : it->second;
+    }
+
+private:
+    void acceptLoop() {
+        while (true) {
+            int client = accept(_fd, nullptr, nullptr);
+            if (client < 0) {
+                continue;
+            }
+            std::thread(&StandInServer::serve, this, client).detach();
+        }
+    }
+
+    void serve(int fd) {
+        uint8_t header[5];
+        char body[256];
+        while (readFully(fd, header, 5)) {
+            uint8_t cmd = header[0];
+            uint16_t len = (uint16_t)(header[3] << 8 | header[4]);
+            // A response carries a status where the length would be
+            if (cmd != BLYNK_CMD_RESPONSE && (len > sizeof(body) || !readFully(fd, body, len))) {
+                break;
+            }
+            if (cmd == BLYNK_CMD_HW_LOGIN || cmd == BLYNK_CMD_PING) {
+                uint8_t ok[5] = {BLYNK_CMD_RESPONSE, header[1], header[2], 0, BLYNK_SUCCESS};
+                write(fd, ok, sizeof(ok));
+            } else if (cmd == BLYNK_CMD_HARDWARE) {
+                hardware(body, len);
+            }
+        }
+        close(fd);
+    }
+
+    // "vw\0<pin>\0<value>"
+    void hardware(const char* body, uint16_t len) {
+        if (len < 5 || memcmp(body, "vw", 3) != 0) {
+            return;
+        }
+        std::string pin(body + 3, strnlen(body + 3, len - 3));
+        size_t valueAt = 3 + pin.size() + 1;
+        if (valueAt > len) {
+            return;
+        }
+        std::string value(body + valueAt, len - valueAt);
+        _writes++;
+
+        unsigned long now = millis();
+        while (!_recent.empty() && now - _recent.front() >= 1000) {
+            _recent.pop_front();
+        }
+        if (_recent.size() >= QUOTA_PER_SECOND) {
+            // The server drops it and warns the user
+            _overQuota++;
+            return;
+        }
+        _recent.push_back(now);
+        std::lock_guard<std::mutex> lock(_mutex);
+        _values[(uint8_t)atoi(pin.c_str())] = atol(value.c_str());
+    }
+
+    bool readFully(int fd, void* buf, size_t len) {
+        size_t got = 0;
+        while (got < len) {
+            ssize_t n = read(fd, (char*)buf + got, len - got);
+            if (n <= 0) {
+                return false;
+            }
+            got += n;
+            _bytesIn += n;
+        }
+        return true;
+    }
+
+    int _fd = -1;
+    uint16_t _port = 0;
+    std::mutex _mutex;
+    std::map<uint8_t, long> _values;
+    std::deque<unsigned long> _recent;
+    std::atomic<uint32_t> _writes{0};
+    std::atomic<uint32_t> _overQuota{0};
+    std::atomic<uint64_t> _bytesIn{0};
+};
+
+// Sensor values in the shape of the sketch's inputs: V1 a slow temperature,
+// V2 a noisy ADC reading, V3 a rarely changing level
+long sensorValue(uint8_t vpin, uint32_t n) {
+    static uint32_t seed = 1;
+    seed = seed * 1103515245u + 12345u;
+    int noise = (int)((seed >> 16) % 7) - 3;
+    switch (vpin) {
+        case V1:
+            return 23 + (long)(n / 2000);
+        case V2:
+            return 1024 + noise;
+        default:
+            return -17 - (long)(n / 1500);
+    }
+}
+
+double threadMicros() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+void writeVirtualPin(uint8_t vpin, long value) {
+    Blynk.virtualWrite(vpin, value);
+}
+
+VirtualPinPublisher* activePublisher = nullptr;
+
+void flushPublisher() {
+    activePublisher->flush();
+}
+
+struct Run {
+    uint32_t values = 0;
+    uint32_t writes = 0;
+    uint32_t overQuota = 0;
+    uint64_t bytes = 0;
+    double cpuMicros = 0;
+    long latest[PIN_COUNT] = {};
+};
+
+// Drives the sketch's loop for RUN_MS; publisher null writes every value
+Run runLoop(StandInServer& server, VirtualPinPublisher* publisher) {
+    Run run;
+    BlynkTimer timer;
+    activePublisher = publisher;
+    if (publisher) {
+        timer.setInterval(FLUSH_MS, flushPublisher);
+    }
+    uint32_t writesBefore = server.writes();
+    uint32_t overBefore = server.overQuota();
+    uint64_t bytesBefore = server.bytesIn();
+
+    double cpuStart = threadMicros();
+    unsigned long start = millis();
+    unsigned long elapsed;
+    while ((elapsed = millis() - start) < RUN_MS) {
+        // Values the serial stream has delivered by now
+        uint32_t due = (uint32_t)((uint64_t)elapsed * VALUES_PER_SECOND / 1000);
+        for (; run.values < due; run.values++) {
+            size_t i = run.values % PIN_COUNT;
+            run.latest[i] = sensorValue(PINS[i], run.values);
+            if (publisher) {
+                publisher->update(PINS[i], run.latest[i]);
+            } else {
+                writeVirtualPin(PINS[i], run.latest[i]);
+            }
+        }
+        Blynk.run();
+        timer.run();
+        delay(1);
+    }
+    run.cpuMicros = threadMicros() - cpuStart;
+
+    // Let the quota window pass, then send whatever is still pending
+    if (publisher) {
+        delay(1000);
+        publisher->flush();
+    }
+    delay(100);
+    run.writes = server.writes() - writesBefore;
+    run.overQuota = server.overQuota() - overBefore;
+    run.bytes = server.bytesIn() - bytesBefore;
+    return run;
+}
+
+void report(const char* label, const Run& run) {
+    double seconds = RUN_MS / 1000.0;
+    printf("%-34s %5.0f values/s  %6.1f messages/s  %7.0f B/s  %5u over quota  loop CPU %4.1f%%\n", label,
+           run.values / seconds, run.writes / seconds, run.bytes / seconds, run.overQuota,
+           run.cpuMicros / (RUN_MS * 10.0));
+}
+
+void benchDirect(StandInServer& server) {
+    Run run = runLoop(server, nullptr);
+    report("virtualWrite per value (old)", run);
+    check(run.writes == run.values, "direct: every value is a message");
+    check(run.overQuota > 0, "direct: the server drops messages over its quota");
+}
+
+void benchPublisher(StandInServer& server, unsigned long intervalMs, long v2Deadband, const char* label) {
+    VirtualPinPublisher publisher(writeVirtualPin, intervalMs);
+    publisher.configurePin(V1, 0);
+    publisher.configurePin(V2, v2Deadband);
+    publisher.configurePin(V3, 0);
+    Run run = runLoop(server, &publisher);
+    report(label, run);
+
+    char what[112];
+    snprintf(what, sizeof(what), "%s: server got every message sent", label);
+    check(run.writes == publisher.messagesSent() && run.overQuota == 0, what);
+    uint32_t perPinLimit = RUN_MS / intervalMs + 2;
+    snprintf(what, sizeof(what), "%s: at most one message per pin per interval", label);
+    check(run.writes <= perPinLimit * PIN_COUNT, what);
+    bool fresh = true;
+    for (size_t i = 0; i < PIN_COUNT; i++) {
+        long deadband = PINS[i] == V2 ? v2Deadband : 0;
+        fresh &= labs(server.value(PINS[i]) - run.latest[i]) <= deadband;
+    }
+    snprintf(what, sizeof(what), "%s: server holds the latest values", label);
+    check(fresh, what);
+}
+
+}  // namespace
+
+int main() {
+    hostAdoptTask("loopTask");
+    StandInServer server;
+    if (!server.start()) {
+        fprintf(stderr, "cannot start the Blynk stand-in\n");
+        return 1;
+    }
+    std::string address = "127.0.0.1:" + std::to_string(server.port());
+    setenv("BLYNK_SERVER", address.c_str(), 1);
+    Blynk.config("stand-in-token");
+    if (!Blynk.connect()) {
+        fprintf(stderr, "cannot log in to the Blynk stand-in\n");
+        return 1;
+    }
+
+    printf("%u values/s over %u pins for %lu ms per run, flush every %lu ms\n", VALUES_PER_SECOND,
+           (unsigned)PIN_COUNT, RUN_MS, FLUSH_MS);
+    benchDirect(server);
+    benchPublisher(server, 1000, 0, "publisher 1000 ms (sketch)");
+    benchPublisher(server, 1000, 4, "publisher 1000 ms, V2 deadband 4");
+    benchPublisher(server, 250, 0, "publisher 250 ms");
+
+    return HostTest::finish();
+}
@@ -0,0 +1,183 @@
+// Host test: SerialLineParser fed by a 115200-baud sensor stream through the
+// HostHAL UART (1 KB RX buffer, as set in setup()), with the loop stalled the
+// way Blynk.run() can stall it.
+//
+// A writer thread paces generated sensor lines into the UART at 11520 bytes/s
+// (115200 8N1), with a garbage line every 50. The loop polls like the sketch.
+// Checked:
+//   - steady loop and 60 ms stalls: no RX overflow, every line parsed, every
+//     value reaches the right pin, garbage counted as malformed
+//   - poll() time stays bounded (128 bytes per call at most)
+//   - a 150 ms stall overflows the 1 KB buffer (~89 ms of data); the overflow
+//     is counted and parsing resumes on the next whole line
+//
+//   g++ -O2 -std=gnu++17 -pthread -I../../lib/HostHAL -I../lib/SerialLineParser
+//       -o serial_stream_test serial_stream_test.cpp ../lib/SerialLineParser/SerialLineParser.cpp
+//       ../../lib/HostHAL/*.cpp -lssl -lcrypto
+//
+//   ./serial_stream_test
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Arduino.h>
+#include <BlynkSimpleEsp32.h>
+#include <HostTest.h>
+
+#include "SerialLineParser.h"
+
+using HostTest::check;
+
+namespace {
+
+const uint32_t BYTES_PER_SECOND = 11520;
+const size_t RX_BUFFER = 1024;
+
+// Same routes as the sketch
+const LineRoute routes[] = {
+    {"Sensor1", V1},
+    {"Sensor2 Value1", V2},
+    {"Sensor2 Value2", V3},
+};
+
+struct PinTotals {
+    uint32_t count = 0;
+    int64_t sum = 0;
+};
+
+PinTotals sent[4];
+PinTotals received[4];
+uint32_t garbageSent = 0;
+uint32_t linesSent = 0;
+
+void onValue(uint8_t vpin, long value) {
+    received[vpin].count++;
+    received[vpin].sum += value;
+}
+
+SerialLineParser parser(routes, sizeof(routes) / sizeof(routes[0]), onValue);
+
+std::string makeLine(uint32_t i) {
+    char line[48];
+    if (i % 50 == 49) {
+        garbageSent++;
+        snprintf(line, sizeof(line), "garbage line %u\r\n", (unsigned)i);
+        return line;
+    }
+    long value = (long)(i * 37 % 2048) - 512;
+    const LineRoute& route = routes[i % 3];
+    sent[route.vpin].count++;
+    sent[route.vpin].sum += value;
+    snprintf(line, sizeof(line), "%s %ld\r\n", route.prefix, value);
+    return line;
+}
+
+// Writes lines into fd at line rate for `seconds`
+void writeStream(int fd, double seconds, uint32_t& next) {
+    unsigned long start = millis();
+    uint64_t written = 0;
+    while (millis() - start < seconds * 1000) {
+        uint64_t due = (uint64_t)(millis() - start) * BYTES_PER_SECOND / 1000;
+        while (written < due) {
+            std::string line = makeLine(next++);
+            linesSent++;
+            if (write(fd, line.data(), line.size()) != (ssize_t)line.size()) {
+                return;
+            }
+            written += line.size();
+        }
+        delay(1);
+    }
+}
+
+struct PollTiming {
+    std::vector<uint32_t> us;
+    uint32_t max() const { return us.empty() ? 0 : *std::max_element(us.begin(), us.end()); }
+    uint32_t percentile(double p) {
+        if (us.empty()) {
+            return 0;
+        }
+        std::vector<uint32_t> sorted = us;
+        std::sort(sorted.begin(), sorted.end());
+        return sorted[(size_t)(p * (sorted.size() - 1))];
+    }
+};
+
+// The sketch's loop(): poll, then whatever else runs (stallMs every second)
+void runLoop(unsigned long durationMs, unsigned long stallMs, PollTiming& timing) {
+    unsigned long start = millis();
+    unsigned long lastStall = start;
+    while (millis() - start < durationMs) {
+        if (stallMs && millis() - lastStall >= 1000) {
+            lastStall = millis();
+            delay(stallMs);
+        }
+        unsigned long t = micros();
+        bool hadBytes = Serial.available() > 0;
+        parser.poll(Serial);
+        if (hadBytes) {
+            timing.us.push_back(micros() - t);
+        }
+        delay(1);
+    }
+}
+
+}  // namespace
+
+int main() {
+    int fds[2];
+    if (pipe(fds) != 0 || dup2(fds[0], 0) < 0) {
+        perror("pipe");
+        return 1;
+    }
+    Serial.setRxBufferSize(RX_BUFFER);
+    Serial.begin(115200);
+
+    // Steady loop, then a 60 ms stall every second
+    uint32_t next = 0;
+    std::thread writer([&] { writeStream(fds[1], 6, next); });
+    PollTiming steady, stalled;
+    runLoop(2000, 0, steady);
+    runLoop(4000, 60, stalled);
+    writer.join();
+    runLoop(200, 0, stalled);
+
+    printf("%u lines (%u garbage) in 6 s; parsed %u, forwarded %u, malformed %u, too long %u; "
+           "RX overflow %u bytes\n",
+           linesSent, garbageSent, parser.lines(), parser.dispatched(), parser.malformed(), parser.overflowed(),
+           Serial.rxOverflowBytes());
+    printf("poll(): steady p50 %u us, p99 %u us, max %u us; with 60 ms stalls p99 %u us, max %u us\n",
+           steady.percentile(0.5), steady.percentile(0.99), steady.max(), stalled.percentile(0.99), stalled.max());
+
+    check(Serial.rxOverflowBytes() == 0, "no RX overflow at 115200 baud with 60 ms stalls");
+    check(parser.lines() == linesSent, "every line parsed");
+    bool pinsMatch = true;
+    for (const LineRoute& route : routes) {
+        pinsMatch = pinsMatch && received[route.vpin].count == sent[route.vpin].count &&
+                    received[route.vpin].sum == sent[route.vpin].sum;
+    }
+    check(pinsMatch, "every value reached its pin");
+    check(parser.malformed() == garbageSent && parser.overflowed() == 0, "only garbage lines counted as malformed");
+    // 128 bytes of parsing is a few microseconds; the rest is scheduling noise
+    check(steady.percentile(0.99) < 500 && stalled.percentile(0.99) < 500, "poll() p99 under 500 us");
+
+    // A stall longer than the buffer holds
+    uint32_t forwarded = parser.dispatched();
+    writer = std::thread([&] { writeStream(fds[1], 1, next); });
+    delay(150);
+    PollTiming after;
+    runLoop(1100, 0, after);
+    writer.join();
+    runLoop(200, 0, after);
+    printf("150 ms stall: RX overflow %u bytes, %u lines forwarded after it\n", Serial.rxOverflowBytes(),
+           parser.dispatched() - forwarded);
+    check(Serial.rxOverflowBytes() > 0, "a 150 ms stall overflows the 1 KB buffer and is counted");
+    check(parser.dispatched() - forwarded > 0 && parser.overflowed() == 0, "parsing resumes after the overflow");
+
+    return HostTest::finish();
+}
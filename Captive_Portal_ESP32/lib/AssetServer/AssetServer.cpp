@@ -0,0 +1,338 @@
+#include "AssetServer.h"
+
+#include <esp_timer.h>
+
+// Leave this much contiguous heap to WiFi and lwIP when filling the cache
+static const size_t CACHE_HEAP_RESERVE = 24 * 1024;
+
+enum RangeResult { RANGE_NONE, RANGE_OK, RANGE_UNSATISFIABLE };
+
+// Single "bytes=" range; anything we don't handle is ignored (full response),
+// which RFC 9110 allows
+static RangeResult parseRange(const String& header, uint32_t size, uint32_t& first, uint32_t& length) {
+    if (!header.startsWith("bytes=") || header.indexOf(',') >= 0) {
+        return RANGE_NONE;
+    }
+    const char* p = header.c_str() + 6;
+    char* end;
+
+    if (*p == '-') {
+        // Suffix range: the last n bytes
+        unsigned long n = strtoul(p + 1, &end, 10);
+        if (end == p + 1 || *end) {
+            return RANGE_NONE;
+        }
+        if (n == 0 || size == 0) {
+            return RANGE_UNSATISFIABLE;
+        }
+        if (n > size) {
+            n = size;
+        }
+        first = size - n;
+        length = n;
+        return RANGE_OK;
+    }
+
+    unsigned long a = strtoul(p, &end, 10);
+    if (end == p || *end != '-') {
+        return RANGE_NONE;
+    }
+    p = end + 1;
+    unsigned long b = size ? size - 1 : 0;
+    if (*p) {
+        b = strtoul(p, &end, 10);
+        if (end == p || *end || b < a) {
+            return RANGE_NONE;
+        }
+        if (b >= size) {
+            b = size - 1;
+        }
+    }
+    if (a >= size) {
+        return RANGE_UNSATISFIABLE;
+    }
+    first = a;
+    length = b - a + 1;
+    return RANGE_OK;
+}
+
+static bool etagMatches(const String& ifNoneMatch, const String& etag) {
+    // Weak comparison: W/"x" matches "x"
+    return ifNoneMatch == "*" || ifNoneMatch.indexOf(etag) >= 0;
+}
+
+const char* AssetServer::contentTypeFor(const String& path) {
+    static const struct {
+        const char* ext;
+        const char* type;
+    } TYPES[] = {
+        {".html", "text/html"},        {".css", "text/css"},         {".js", "application/javascript"},
+        {".json", "application/json"}, {".svg", "image/svg+xml"},    {".png", "image/png"},
+        {".jpg", "image/jpeg"},        {".jpeg", "image/jpeg"},      {".gif", "image/gif"},
+        {".ico", "image/x-icon"},      {".woff2", "font/woff2"},     {".txt", "text/plain"},
+    };
+    for (const auto& t : TYPES) {
+        if (path.endsWith(t.ext)) {
+            return t.type;
+        }
+    }
+    return "application/octet-stream";
+}
+
+bool AssetServer::begin(fs::FS& fs, const char* root, size_t cacheBytes, size_t cacheMaxFileBytes) {
+    _fs = &fs;
+    _root = root;
+    // "/" indexes the whole filesystem
+    while (_root.endsWith("/")) {
+        _root.remove(_root.length() - 1);
+    }
+    _cacheBytes = cacheBytes;
+    _cacheMaxFileBytes = cacheMaxFileBytes;
+
+    indexDir(_root.length() ? _root : String("/"));
+    Serial.printf("Assets: %u files under %s\n", (unsigned)_assets.size(), root);
+    return !_assets.empty();
+}
+
+void AssetServer::attach(WebServer& server) {
+    static const char* HEADERS[] = {"If-None-Match", "Range", "If-Range"};
+    server.collectHeaders(HEADERS, sizeof(HEADERS) / sizeof(HEADERS[0]));
+}
+
+void AssetServer::indexDir(const String& dir) {
+    File d = _fs->open(dir);
+    if (!d || !d.isDirectory()) {
+        return;
+    }
+
+    for (File f = d.openNextFile(); f; f = d.openNextFile()) {
+        String path = f.path();
+        if (f.isDirectory()) {
+            f.close();
+            indexDir(path);
+            continue;
+        }
+
+        Asset a;
+        a.path = path;
+        a.size = f.size();
+        a.gzip = path.endsWith(".gz");
+        a.uri = path.substring(_root.length(), a.gzip ? path.length() - 3 : path.length());
+        a.contentType = contentTypeFor(a.uri);
+        a.cached = nullptr;
+        a.lastUsed = 0;
+
+        // Content hash (FNV-1a), so a rebuilt file never matches a stale
+        // browser copy even when its size and name are unchanged
+        uint32_t hash = 2166136261u;
+        size_t n;
+        while ((n = f.read(_chunk, CHUNK_SIZE)) > 0) {
+            for (size_t i = 0; i < n; i++) {
+                hash = (hash ^ _chunk[i]) * 16777619u;
+            }
+        }
+        f.close();
+        char etag[24];
+        snprintf(etag, sizeof(etag), "\"%08x-%x\"", (unsigned)hash, (unsigned)a.size);
+        a.etag = etag;
+
+        // "name.gz" wins over a plain "name"
+        Asset* existing = find(a.uri);
+        if (existing) {
+            if (a.gzip) {
+                *existing = a;
+            }
+            continue;
+        }
+        _assets.push_back(a);
+    }
+}
+
+AssetServer::Asset* AssetServer::find(const String& uri) {
+    // A few dozen files at most; a linear scan beats a map here
+    for (Asset& a : _assets) {
+        if (a.uri == uri) {
+            return &a;
+        }
+    }
+    return nullptr;
+}
+
+bool AssetServer::loadIntoCache(Asset& asset) {
+    if (asset.size == 0 || asset.size > _cacheMaxFileBytes || asset.size > _cacheBytes) {
+        return false;
+    }
+
+    // Evict least recently used files until this one fits
+    while (_cacheUsed + asset.size > _cacheBytes) {
+        Asset* oldest = nullptr;
+        for (Asset& a : _assets) {
+            if (a.cached && &a != &asset && (!oldest || a.lastUsed < oldest->lastUsed)) {
+                oldest = &a;
+            }
+        }
+        if (!oldest) {
+            return false;
+        }
+        free(oldest->cached);
+        oldest->cached = nullptr;
+        _cacheUsed -= oldest->size;
+    }
+
+    if (ESP.getMaxAllocHeap() < asset.size + CACHE_HEAP_RESERVE) {
+        return false;
+    }
+    uint8_t* buf = (uint8_t*)malloc(asset.size);
+    if (!buf) {
+        return false;
+    }
+    File f = _fs->open(asset.path, "r");
+    size_t n = f ? f.read(buf, asset.size) : 0;
+    if (n != asset.size) {
+        free(buf);
+        return false;
+    }
+    _stats.flashBytesRead += n;
+    asset.cached = buf;
+    _cacheUsed += asset.size;
+    return true;
+}
+
+void AssetServer::sampleHeap() {
+    uint32_t free = ESP.getFreeHeap();
+    if (free < _stats.heapLow) {
+        _stats.heapLow = free;
+    }
+}
+
+void AssetServer::send(WebServer& server, Asset& asset, uint32_t first, uint32_t length) {
+    WiFiClient client = server.client();
+    int64_t start = esp_timer_get_time();
+    size_t sent = 0;
+
+    if (asset.size <= _cacheMaxFileBytes) {
+        if (asset.cached) {
+            _stats.cacheHits++;
+        } else {
+            _stats.cacheMisses++;
+            loadIntoCache(asset);
+        }
+    }
+
+    if (asset.cached) {
+        sent = client.write(asset.cached + first, length);
+        sampleHeap();
+    } else {
+        // Flash -> chunk -> socket; the file is never held in RAM as a whole
+        File f = _fs->open(asset.path, "r");
+        if (f && f.seek(first)) {
+            while (sent < length) {
+                size_t want = length - sent;
+                if (want > CHUNK_SIZE) {
+                    want = CHUNK_SIZE;
+                }
+                size_t n = f.read(_chunk, want);
+                if (n == 0) {
+                    break;
+                }
+                _stats.flashBytesRead += n;
+                size_t w = client.write(_chunk, n);
+                // lwIP holds the unacknowledged chunks now; this is where
+                // concurrent transfers push the heap lowest
+                sampleHeap();
+                sent += w;
+                if (w != n) {
+                    break;
+                }
+            }
+        }
+    }
+
+    if (sent < length) {
+        _stats.aborted++;
+    }
+    _stats.bytesSent += sent;
+    _stats.sendUs += esp_timer_get_time() - start;
+}
+
+bool AssetServer::handle(WebServer& server) {
+    if (server.method() != HTTP_GET && server.method() != HTTP_HEAD) {
+        return false;
+    }
+    String uri = server.uri();
+    if (uri.endsWith("/")) {
+        uri += "index.html";
+    }
+    Asset* asset = find(uri);
+    if (!asset) {
+        return false;
+    }
+    _stats.requests++;
+    asset->lastUsed = ++_useCounter;
+
+    server.sendHeader("ETag", asset->etag);
+    // Always revalidate; with the ETag that is a bodyless 304
+    server.sendHeader("Cache-Control", "no-cache");
+
+    if (etagMatches(server.header("If-None-Match"), asset->etag)) {
+        _stats.notModified++;
+        server.send(304);
+        return true;
+    }
+
+    server.sendHeader("Accept-Ranges", "bytes");
+    uint32_t first = 0;
+    uint32_t length = asset->size;
+    int code = 200;
+    String range = server.header("Range");
+    String ifRange = server.header("If-Range");
+    // A range only applies to the version the client already has
+    if (range.length() && (!ifRange.length() || ifRange == asset->etag)) {
+        char contentRange[48];
+        switch (parseRange(range, asset->size, first, length)) {
+        case RANGE_UNSATISFIABLE:
+            _stats.badRange++;
+            snprintf(contentRange, sizeof(contentRange), "bytes */%u", (unsigned)asset->size);
+            server.sendHeader("Content-Range", contentRange);
+            server.send(416);
+            return true;
+        case RANGE_OK:
+            code = 206;
+            snprintf(contentRange, sizeof(contentRange), "bytes %u-%u/%u", (unsigned)first,
+                     (unsigned)(first + length - 1), (unsigned)asset->size);
+            server.sendHeader("Content-Range", contentRange);
+            break;
+        case RANGE_NONE:
+            break;
+        }
+    }
+
+    if (asset->gzip) {
+        // Every browser accepts gzip; the device cannot inflate for the rest
+        server.sendHeader("Content-Encoding", "gzip");
+    }
+    server.setContentLength(length);
+    server.send(code, asset->contentType, "");
+    if (code == 206) {
+        _stats.partial++;
+    } else {
+        _stats.full++;
+    }
+
+    if (server.method() != HTTP_HEAD) {
+        send(server, *asset, first, length);
+    }
+    return true;
+}
+
+void AssetServer::printStats() const {
+    Serial.printf("Assets: %u requests (%u full, %u partial, %u not modified, %u bad range, %u aborted); "
+                  "cache %u hits / %u misses, %u bytes used; %.1f KB sent at %.1f KB/s, "
+                  "%.1f KB read from flash; heap free %u, lowest while serving %u\n",
+                  _stats.requests, _stats.full, _stats.partial, _stats.notModified, _stats.badRange,
+                  _stats.aborted, _stats.cacheHits, _stats.cacheMisses, (unsigned)_cacheUsed,
+                  _stats.bytesSent / 1024.0,
+                  _stats.sendUs ? _stats.bytesSent * 1e6 / 1024.0 / _stats.sendUs : 0.0,
+                  _stats.flashBytesRead / 1024.0, ESP.getFreeHeap(),
+                  _stats.heapLow == UINT32_MAX ? ESP.getFreeHeap() : _stats.heapLow);
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FS.h>
+#include <WebServer.h>
+#include <vector>
+
+// Static files from flash for the synchronous WebServer.
+//
+// Files under the asset root are indexed once at boot. A file stored as
+// "name.gz" is served as "name" with Content-Encoding: gzip, so pages are
+// kept pre-compressed on flash and never inflated on the device. Bodies are
+// streamed through one fixed chunk buffer, never loaded whole, except for
+// small files that the LRU cache keeps in RAM.
+//
+// Every response carries a content-hash ETag, so browsers revalidate with
+// If-None-Match and get a bodyless 304. Single byte ranges ("Range:
+// bytes=a-b", "a-", "-n") get a 206; multi-range requests get the whole file.
+class AssetServer {
+public:
+    struct Stats {
+        uint32_t requests = 0;
+        uint32_t full = 0;          // 200
+        uint32_t partial = 0;       // 206
+        uint32_t notModified = 0;   // 304
+        uint32_t badRange = 0;      // 416
+        uint32_t cacheHits = 0;
+        uint32_t cacheMisses = 0;
+        uint32_t aborted = 0;       // client went away mid-body
+        uint64_t bytesSent = 0;
+        uint64_t flashBytesRead = 0;
+        uint64_t sendUs = 0;
+        // Lowest free heap sampled while serving since resetHeapLow()
+        uint32_t heapLow = UINT32_MAX;
+    };
+
+    // Indexes the files under root; false when there is none
+    bool begin(fs::FS& fs, const char* root = "/www", size_t cacheBytes = 48 * 1024,
+               size_t cacheMaxFileBytes = 8 * 1024);
+    // Asks the server to keep the request headers this class needs; call
+    // before server.begin(). Replaces any previously collected headers.
+    void attach(WebServer& server);
+
+    // Answers the current request if its URI is an asset, false otherwise
+    bool handle(WebServer& server);
+
+    size_t assetCount() const { return _assets.size(); }
+    size_t cacheUsed() const { return _cacheUsed; }
+    const Stats& stats() const { return _stats; }
+    // Starts a new heap low-water measurement, e.g. before a load test
+    void resetHeapLow() { _stats.heapLow = ESP.getFreeHeap(); }
+    void printStats() const;
+
+private:
+    static const size_t CHUNK_SIZE = 4096;
+
+    struct Asset {
+        String uri;
+        String path;
+        String etag;
+        const char* contentType;
+        uint32_t size;
+        bool gzip;
+        uint8_t* cached;
+        uint32_t lastUsed;
+    };
+
+    void indexDir(const String& dir);
+    Asset* find(const String& uri);
+    bool loadIntoCache(Asset& asset);
+    void send(WebServer& server, Asset& asset, uint32_t first, uint32_t length);
+    static const char* contentTypeFor(const String& path);
+    void sampleHeap();
+
+    fs::FS* _fs = nullptr;
+    String _root;
+    std::vector<Asset> _assets;
+
+    size_t _cacheBytes = 0;
+    size_t _cacheMaxFileBytes = 0;
+    size_t _cacheUsed = 0;
+    uint32_t _useCounter = 0;
+
+    // One request is served at a time, so one chunk buffer is enough
+    uint8_t _chunk[CHUNK_SIZE];
+
+    Stats _stats;
+};
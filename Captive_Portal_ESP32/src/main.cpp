@@ -1,16 +1,43 @@
 #include <WiFi.h>
 #include <DNSServer.h>
 #include <WebServer.h>
+#include <LittleFS.h>
+#include <AssetServer.h>
+
+// 1 = run the on-device benchmark suite at boot and print JSON results
+#ifndef BENCH_SUITE
+#define BENCH_SUITE 0
+#endif
+
+#if BENCH_SUITE
+#include <BenchSuite.h>
+#endif
+
+// 1 = record spans/counters for /trace (Chrome trace JSON); send 't' on
+// Serial for the same dump there
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 0
+#endif
+#include <Trace.h>
+// Idle polls of the DNS and web server are only recorded above this
+#define TRACE_SLOW_POLL_US 500
 
 // Constants and global variables
 const byte DNS_PORT = 53;
 const int WEBSERVER_PORT = 80;
+// Branded pages live here on LittleFS (see tools/build_assets.py)
+const char* ASSET_ROOT = "/www";
+// Small, hot files are kept in RAM; everything else streams from flash
+const size_t ASSET_CACHE_BYTES = 48 * 1024;
+const size_t ASSET_CACHE_MAX_FILE = 8 * 1024;
+const uint32_t ASSET_STATS_INTERVAL_MS = 10000;
 
 IPAddress apIP(192, 168, 4, 1);
 IPAddress netMsk(255, 255, 255, 0);
 
 DNSServer dnsServer;
 WebServer server(WEBSERVER_PORT);
+AssetServer assets;
 
 char ap_ssid[32];
 String ap_password = "password123";
@@ -52,6 +79,7 @@ String toStringIp(IPAddress ip) {
 
 boolean captivePortal() {
   if (!isIp(server.hostHeader())) {
+    TRACE_INSTANT("captiveRedirect");
     server.sendHeader("Location", String("http://") + 
                      toStringIp(server.client().localIP()), true);
     server.send(302, "text/plain", "");
@@ -63,9 +91,13 @@ boolean captivePortal() {
 
 
 void handleNotFound() {
+  TRACE_SCOPE("handleNotFound");
   if (captivePortal()) {
     return;
   }
+  if (assets.handle(server)) {
+    return;
+  }
   
   String message = F("File Not Found\n\n");
   message += F("URI: ");
@@ -73,39 +105,155 @@ void handleNotFound() {
   server.send(404, "text/plain", message);
 }
 
+String buildHomePage() {
+  String html = "<!DOCTYPE html><html lang=\"en\"><head><meta charset=\"UTF-8\">";
+  html += "<meta name=\"viewport\" content=\"width=device-width, initial-scale=1.0\">";
+  html += "<title>ESP32 Captive Portal</title></head><body>";
+  html += "<h1>Welcome to the ESP32 Captive Portal</h1>";
+  html += "<p>Please connect to the WiFi network.</p>";
+  html += "</body></html>";
+  return html;
+}
+
 void handleHomePage() {
+  TRACE_SCOPE("handleHomePage");
   if (captivePortal()) {
     return;
   }
+  // The built-in page is only the fallback when no index.html was uploaded
+  if (assets.handle(server)) {
+    return;
+  }
   server.sendHeader("Cache-Control", "no-cache, no-store, must-revalidate");
   server.sendHeader("Pragma", "no-cache");
   server.sendHeader("Expires", "-1");
-  String html = "<!DOCTYPE html><html lang=\"en\"><head><meta charset=\"UTF-8\">";
-  html += "<meta name=\"viewport\" content=\"width=device-width, initial-scale=1.0\">";
-  html += "<title>ESP32 Captive Portal</title></head><body>";
-  html += "<h1>Welcome to the ESP32 Captive Portal</h1>";
-  html += "<p>Please connect to the WiFi network.</p>";
-  html += "</body></html>";
-  server.send(200, "text/html", html);
+  server.send(200, "text/html", buildHomePage());
 }
 
+// Asset server counters for the load generator (tools/asset_load.py).
+// "?reset=1" restarts the heap low-water mark, so heapLow covers one run
+// rather than everything since boot.
+void handleAssetStats() {
+  if (server.hasArg("reset")) {
+    assets.resetHeapLow();
+  }
+  const AssetServer::Stats& st = assets.stats();
+  uint32_t freeHeap = ESP.getFreeHeap();
+  char json[400];
+  snprintf(json, sizeof(json),
+           "{\"requests\":%u,\"full\":%u,\"partial\":%u,\"notModified\":%u,\"badRange\":%u,"
+           "\"aborted\":%u,\"cacheHits\":%u,\"cacheMisses\":%u,\"cacheBytes\":%u,"
+           "\"bytesSent\":%llu,\"flashBytesRead\":%llu,\"sendUs\":%llu,"
+           "\"freeHeap\":%u,\"heapLow\":%u,\"minFreeHeap\":%u}",
+           st.requests, st.full, st.partial, st.notModified, st.badRange, st.aborted,
+           st.cacheHits, st.cacheMisses, (unsigned)assets.cacheUsed(),
+           (unsigned long long)st.bytesSent, (unsigned long long)st.flashBytesRead,
+           (unsigned long long)st.sendUs,
+           freeHeap, st.heapLow < freeHeap ? st.heapLow : freeHeap, ESP.getMinFreeHeap());
+  server.sendHeader("Cache-Control", "no-store");
+  server.send(200, "application/json", json);
+}
+
+#if TRACE_ENABLED
+void handleTrace() {
+  // Streamed straight to the socket; the dump is too large for a String
+  WiFiClient client = server.client();
+  client.print("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n"
+               "Content-Disposition: attachment; filename=\"captive.trace.json\"\r\n"
+               "Connection: close\r\n\r\n");
+  Trace::dump(client);
+  client.stop();
+}
+
+// Runs in the WiFi event task, which gets its own track
+void onWiFiEvent(arduino_event_id_t event) {
+  TRACE_INSTANT(WiFi.eventName(event));
+  if (event == ARDUINO_EVENT_WIFI_AP_STACONNECTED || event == ARDUINO_EVENT_WIFI_AP_STADISCONNECTED) {
+    TRACE_COUNTER("apStations", WiFi.softAPgetStationNum());
+  }
+}
+#endif
+
 void setupWebServer() {
+  if (LittleFS.begin()) {
+    assets.begin(LittleFS, ASSET_ROOT, ASSET_CACHE_BYTES, ASSET_CACHE_MAX_FILE);
+  } else {
+    Serial.println("LittleFS not mounted, serving the built-in page only");
+  }
+  assets.attach(server);
+
   server.on("/", handleHomePage);
+  server.on("/asset-stats", handleAssetStats);
+#if TRACE_ENABLED
+  server.on("/trace", handleTrace);
+#endif
   server.onNotFound(handleNotFound);
   server.begin();
 }
 
+#if BENCH_SUITE
+// The per-request work of the handlers, without the sockets
+void runBenchmarks() {
+  BenchSuite suite("captive");
+
+  // Typical probe hosts sent by phones, plus a direct IP hit
+  static const String hosts[] = {
+    "connectivitycheck.gstatic.com", "captive.apple.com", "www.msftconnecttest.com", "192.168.4.1"
+  };
+  suite.add("host_check/4", [] {
+    for (const String& host : hosts) {
+      BenchSuite::doNotOptimize(isIp(host));
+    }
+  });
+  suite.add("redirect_location", [] {
+    String location = String("http://") + toStringIp(apIP);
+    BenchSuite::doNotOptimize(location);
+  });
+  suite.add("home_page", [] {
+    String html = buildHomePage();
+    BenchSuite::doNotOptimize(html);
+  });
+
+  suite.run();
+}
+#endif
+
 void webServerTask(void* pvParameters) {
   setupWebServer();
+  uint32_t lastStats = millis();
+  uint32_t lastRequests = 0;
   while (true) {
-    dnsServer.processNextRequest();
-    server.handleClient();
-    vTaskDelay(pdMS_TO_TICKS(50));
+    {
+      TRACE_SLOW_SCOPE("dns", TRACE_SLOW_POLL_US);
+      dnsServer.processNextRequest();
+    }
+    {
+      TRACE_SLOW_SCOPE("handleClient", TRACE_SLOW_POLL_US);
+      server.handleClient();
+    }
+    // handleClient() serves at most one request per call; a long pause here
+    // would cap a page with many assets at a few requests per second
+    vTaskDelay(pdMS_TO_TICKS(2));
+
+    if (millis() - lastStats >= ASSET_STATS_INTERVAL_MS) {
+      if (assets.stats().requests != lastRequests) {
+        assets.printStats();
+        lastRequests = assets.stats().requests;
+      }
+      lastStats = millis();
+    }
   }
 }
 
 void setup() {
   Serial.begin(115200);
+#if BENCH_SUITE
+  runBenchmarks();
+#endif
+#if TRACE_ENABLED
+  Trace::printOverhead();
+  WiFi.onEvent(onWiFiEvent);
+#endif
   
   setupAP();
   
@@ -121,5 +269,10 @@ void setup() {
 }
 
 void loop() {
-  
+#if TRACE_ENABLED
+  if (Serial.available() && Serial.read() == 't') {
+    Trace::dump(Serial);
+  }
+  delay(10);
+#endif
 }
\ No newline at end of file
@@ -0,0 +1,151 @@
+"""HTTP load generator for the captive portal's asset server.
+
+Starts N clients at once, each fetching the given paths in a loop, and
+reports client-side throughput and latency. The device's /asset-stats
+counters are read before and after, which gives the server-side send rate;
+the heap low-water mark is reset at the start, so it is the lowest free heap
+seen while serving this run.
+
+    python tools/build_assets.py --bench-kb 200   # then: pio run -t uploadfs
+    python tools/asset_load.py                    # 20 clients, /bench/page.bin, 20 s
+    python tools/asset_load.py -c 20 -p / -p /style.css --revalidate
+    python tools/asset_load.py --range 65536      # 64 KB ranges at random offsets
+
+Run it from a machine joined to the portal's access point, or against the
+native build (pio run -e native -t exec, from a data/ made by build_assets.py):
+
+    python tools/asset_load.py --host 127.0.0.1 --port 8080 --vhost 192.168.4.1
+"""
+import argparse
+import http.client
+import json
+import random
+import threading
+import time
+
+
+def get_stats(host, port, timeout, reset=False):
+    conn = http.client.HTTPConnection(host, port, timeout=timeout)
+    try:
+        conn.request('GET', '/asset-stats?reset=1' if reset else '/asset-stats')
+        return json.loads(conn.getresponse().read())
+    finally:
+        conn.close()
+
+
+def percentile(values, p):
+    if not values:
+        return 0.0
+    values = sorted(values)
+    return values[min(len(values) - 1, int(p / 100 * len(values)))]
+
+
+class Client(threading.Thread):
+    def __init__(self, args, start_at, stop_at):
+        super().__init__(daemon=True)
+        self.args = args
+        self.start_at = start_at
+        self.stop_at = stop_at
+        self.etags = {}
+        self.sizes = {}
+        self.latencies = []
+        self.bytes = 0
+        self.codes = {}
+        self.errors = 0
+
+    def fetch(self, path):
+        headers = {'Accept-Encoding': 'gzip'}
+        if self.args.vhost:
+            headers['Host'] = self.args.vhost
+        if self.args.revalidate and path in self.etags:
+            headers['If-None-Match'] = self.etags[path]
+        if self.args.range and path in self.sizes:
+            size = self.sizes[path]
+            first = random.randrange(max(1, size - self.args.range))
+            headers['Range'] = f'bytes={first}-{first + self.args.range - 1}'
+
+        conn = http.client.HTTPConnection(self.args.host, self.args.port, timeout=self.args.timeout)
+        t0 = time.perf_counter()
+        try:
+            conn.request('GET', path, headers=headers)
+            resp = conn.getresponse()
+            body = resp.read()
+        finally:
+            conn.close()
+        self.latencies.append(time.perf_counter() - t0)
+        self.bytes += len(body)
+        self.codes[resp.status] = self.codes.get(resp.status, 0) + 1
+
+        etag = resp.getheader('ETag')
+        if etag:
+            self.etags[path] = etag
+        if resp.status == 200:
+            self.sizes[path] = len(body)
+
+    def run(self):
+        # All clients hit the server at the same moment
+        time.sleep(max(0.0, self.start_at - time.time()))
+        while time.time() < self.stop_at:
+            for path in self.args.paths:
+                try:
+                    self.fetch(path)
+                except (OSError, http.client.HTTPException):
+                    self.errors += 1
+                    time.sleep(0.05)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--host', default='192.168.4.1')
+    parser.add_argument('--port', type=int, default=80)
+    parser.add_argument('-c', '--clients', type=int, default=20)
+    parser.add_argument('-d', '--duration', type=float, default=20.0)
+    parser.add_argument('-p', '--path', dest='paths', action='append',
+                        help='path to fetch, repeatable (default /bench/page.bin)')
+    parser.add_argument('--revalidate', action='store_true',
+                        help='send If-None-Match with the ETag seen last time')
+    parser.add_argument('--range', type=int, default=0,
+                        help='after the first full fetch, request ranges of this many bytes')
+    parser.add_argument('--vhost',
+                        help='Host header to send; the portal redirects names that are not its IP')
+    parser.add_argument('--timeout', type=float, default=30.0)
+    args = parser.parse_args()
+    args.paths = args.paths or ['/bench/page.bin']
+
+    before = get_stats(args.host, args.port, args.timeout, reset=True)
+    start_at = time.time() + 0.5
+    clients = [Client(args, start_at, start_at + args.duration) for _ in range(args.clients)]
+    for c in clients:
+        c.start()
+    for c in clients:
+        c.join()
+    wall = time.time() - start_at
+    after = get_stats(args.host, args.port, args.timeout)
+
+    latencies = [t for c in clients for t in c.latencies]
+    total = sum(c.bytes for c in clients)
+    codes = {}
+    for c in clients:
+        for code, n in c.codes.items():
+            codes[code] = codes.get(code, 0) + n
+    errors = sum(c.errors for c in clients)
+    sent = after['bytesSent'] - before['bytesSent']
+    send_us = after['sendUs'] - before['sendUs']
+
+    print(f'{args.clients} clients, {", ".join(args.paths)}, {wall:.1f} s')
+    print(f'  client: {len(latencies)} responses {dict(sorted(codes.items()))}, {errors} errors, '
+          f'{total / 1024 / wall:.1f} KB/s')
+    print(f'  latency p50 {percentile(latencies, 50) * 1000:.0f} ms, '
+          f'p95 {percentile(latencies, 95) * 1000:.0f} ms, max {max(latencies, default=0) * 1000:.0f} ms')
+    print(f'  device: {sent / 1024:.0f} KB sent, {sent / 1024 / wall:.1f} KB/s overall, '
+          f'{sent * 1e6 / 1024 / send_us if send_us else 0:.1f} KB/s while sending, '
+          f'{after["aborted"] - before["aborted"]} aborted')
+    print(f'  device heap: free {after["freeHeap"]}, lowest during the run {after["heapLow"]} '
+          f'({before["freeHeap"] - after["heapLow"]} bytes below the start), '
+          f'min free since boot {after["minFreeHeap"]}; '
+          f'cache {after["cacheHits"] - before["cacheHits"]} hits / '
+          f'{after["cacheMisses"] - before["cacheMisses"]} misses')
+
+
+if __name__ == '__main__':
+    main()
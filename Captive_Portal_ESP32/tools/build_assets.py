@@ -0,0 +1,69 @@
+"""Pre-compresses the portal's web assets for LittleFS.
+
+Text assets from web/ are gzipped into data/www/ as name.gz, which the
+AssetServer serves as name with Content-Encoding: gzip. Formats that are
+already compressed (images, fonts) are copied as they are. Upload the result
+with `pio run -t uploadfs`.
+
+    python tools/build_assets.py
+    python tools/build_assets.py --bench-kb 200    # plus a 200 KB load-test file
+"""
+import argparse
+import gzip
+import os
+import shutil
+
+COMPRESS = ('.html', '.css', '.js', '.json', '.svg', '.txt')
+
+
+def build(src, dst, bench_kb):
+    if os.path.isdir(dst):
+        shutil.rmtree(dst)
+    total_in = total_out = 0
+
+    for root, _, files in os.walk(src):
+        for name in sorted(files):
+            path = os.path.join(root, name)
+            rel = os.path.relpath(path, src)
+            with open(path, 'rb') as f:
+                data = f.read()
+
+            out = os.path.join(dst, rel)
+            if name.endswith(COMPRESS):
+                out += '.gz'
+                # mtime=0 keeps the output, and so the ETag, reproducible
+                data_out = gzip.compress(data, compresslevel=9, mtime=0)
+            else:
+                data_out = data
+            os.makedirs(os.path.dirname(out), exist_ok=True)
+            with open(out, 'wb') as f:
+                f.write(data_out)
+            total_in += len(data)
+            total_out += len(data_out)
+            print(f'{rel:32} {len(data):8} -> {len(data_out):8} bytes')
+
+    if bench_kb:
+        # Incompressible, so the transfer really is bench_kb per request
+        out = os.path.join(dst, 'bench', 'page.bin')
+        os.makedirs(os.path.dirname(out), exist_ok=True)
+        with open(out, 'wb') as f:
+            f.write(os.urandom(bench_kb * 1024))
+        print(f'{"bench/page.bin":32} {bench_kb * 1024:8} bytes')
+
+    print(f'total {total_in} -> {total_out} bytes')
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    project = os.path.dirname(here)
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--src', default=os.path.join(project, 'web'))
+    parser.add_argument('--dst', default=os.path.join(project, 'data', 'www'))
+    parser.add_argument('--bench-kb', type=int, default=0,
+                        help='also write bench/page.bin of this size for tools/asset_load.py')
+    args = parser.parse_args()
+    build(args.src, args.dst, args.bench_kb)
+
+
+if __name__ == '__main__':
+    main()
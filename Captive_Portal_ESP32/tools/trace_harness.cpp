@@ -0,0 +1,294 @@
+// Host harness for lib/Trace on lib/HostHAL (FreeRTOS tasks are threads).
+//
+// Measures what an event costs with one and with several tasks recording,
+// and how long a dump takes, then checks the dumps taken while tasks keep
+// recording: every dump must be valid JSON, every event name one that was
+// recorded (a torn slot would show up as a stray pointer), spans in order
+// per task, and at most RING_EVENTS events per task.
+//
+//   g++ -O2 -std=gnu++17 -pthread -I../../lib/HostHAL -I../../lib/Trace -DTRACE_ENABLED=1
+//       -o trace_harness trace_harness.cpp ../../lib/Trace/Trace.cpp ../../lib/HostHAL/*.cpp
+//       -lssl -lcrypto
+//
+//   ./trace_harness
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <time.h>
+
+#include <Arduino.h>
+#include <WiFi.h>
+
+#include "Trace.h"
+
+namespace {
+
+const uint32_t ITERATIONS = 200000;
+const int WRITER_TASKS = 3;
+const int DUMPS = 200;
+
+const char* const NAMES[] = {"work", "work.inner", "queueDepth", "tick"};
+
+// Collects a dump in memory
+class StringPrint : public Print {
+public:
+    size_t write(uint8_t c) override {
+        text += (char)c;
+        return 1;
+    }
+    size_t write(const uint8_t* buffer, size_t size) override {
+        text.append((const char*)buffer, size);
+        return size;
+    }
+    std::string text;
+};
+
+// Minimal JSON syntax check; enough to catch a broken dump
+class JsonCheck {
+public:
+    explicit JsonCheck(const std::string& s) : _s(s) {}
+    bool valid() {
+        skip();
+        if (!value()) {
+            return false;
+        }
+        skip();
+        return _i == _s.size();
+    }
+
+private:
+    void skip() {
+        while (_i < _s.size() && isspace((unsigned char)_s[_i])) {
+            _i++;
+        }
+    }
+    bool literal(const char* word) {
+        size_t n = strlen(word);
+        if (_s.compare(_i, n, word) != 0) {
+            return false;
+        }
+        _i += n;
+        return true;
+    }
+    bool string() {
+        if (_s[_i] != '"') {
+            return false;
+        }
+        for (_i++; _i < _s.size(); _i++) {
+            if (_s[_i] == '\\') {
+                _i++;
+            } else if (_s[_i] == '"') {
+                _i++;
+                return true;
+            } else if ((unsigned char)_s[_i] < 0x20) {
+                return false;
+            }
+        }
+        return false;
+    }
+    bool number() {
+        size_t start = _i;
+        if (_s[_i] == '-') {
+            _i++;
+        }
+        while (_i < _s.size() && (isdigit((unsigned char)_s[_i]) || strchr(".eE+-", _s[_i]))) {
+            _i++;
+        }
+        return _i > start;
+    }
+    bool value() {
+        skip();
+        if (_i >= _s.size()) {
+            return false;
+        }
+        char c = _s[_i];
+        if (c == '{' || c == '[') {
+            char close = c == '{' ? '}' : ']';
+            _i++;
+            skip();
+            if (_s[_i] == close) {
+                _i++;
+                return true;
+            }
+            while (true) {
+                skip();
+                if (c == '{') {
+                    if (!string()) {
+                        return false;
+                    }
+                    skip();
+                    if (_s[_i++] != ':') {
+                        return false;
+                    }
+                }
+                if (!value()) {
+                    return false;
+                }
+                skip();
+                if (_s[_i] == ',') {
+                    _i++;
+                    continue;
+                }
+                if (_s[_i] == close) {
+                    _i++;
+                    return true;
+                }
+                return false;
+            }
+        }
+        if (c == '"') {
+            return string();
+        }
+        return literal("true") || literal("false") || literal("null") || number();
+    }
+
+    const std::string& _s;
+    size_t _i = 0;
+};
+
+// Event names, ordering and per-task counts in one dump
+bool checkEvents(const std::string& dump, uint32_t& events) {
+    events = 0;
+    long long lastTs[Trace::MAX_TASKS] = {};
+    uint32_t perTask[Trace::MAX_TASKS] = {};
+    size_t at = 0;
+    while ((at = dump.find("{\"name\":\"", at)) != std::string::npos) {
+        // Not the thread name inside a metadata event's args
+        bool event = at > 0 && (dump[at - 1] == ',' || dump[at - 1] == '[');
+        at += 9;
+        if (!event) {
+            continue;
+        }
+        size_t end = dump.find('"', at);
+        std::string name = dump.substr(at, end - at);
+        size_t ph = dump.find("\"ph\":\"", end);
+        char phase = dump[ph + 6];
+        if (phase == 'M') {
+            continue;
+        }
+        bool known = name == "trace_overhead" || name == "WIFI_READY";
+        for (const char* n : NAMES) {
+            known = known || name == n;
+        }
+        if (!known) {
+            printf("unexpected event name \"%s\"\n", name.c_str());
+            return false;
+        }
+        long long ts = atoll(dump.c_str() + dump.find("\"ts\":", end) + 5);
+        unsigned tid = (unsigned)atoi(dump.c_str() + dump.find("\"tid\":", end) + 6);
+        if (tid >= Trace::MAX_TASKS || ++perTask[tid] > Trace::RING_EVENTS) {
+            printf("task %u: more than %u events\n", tid, (unsigned)Trace::RING_EVENTS);
+            return false;
+        }
+        // Spans are recorded when they close, so only counters and instants
+        // are strictly in order
+        if (phase != 'X') {
+            if (ts < lastTs[tid]) {
+                printf("task %u: %s at %lld before %lld\n", tid, name.c_str(), ts, lastTs[tid]);
+                return false;
+            }
+            lastTs[tid] = ts;
+        }
+        events++;
+    }
+    return true;
+}
+
+std::atomic<bool> stopWriters{false};
+std::atomic<int> writersDone{0};
+std::atomic<uint64_t> writerEvents{0};
+
+void writerTask(void*) {
+    uint64_t n = 0;
+    while (!stopWriters.load(std::memory_order_relaxed)) {
+        TRACE_SCOPE("work");
+        {
+            TRACE_SCOPE("work.inner");
+        }
+        TRACE_COUNTER("queueDepth", (int32_t)(n & 15));
+        TRACE_INSTANT("tick");
+        n += 4;
+    }
+    writerEvents += n;
+    writersDone++;
+    vTaskDelete(NULL);
+}
+
+// CPU time of this thread, so other tasks being scheduled in between
+// doesn't count as tracing cost
+double threadNs() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+double nsPerEvent(void (*body)()) {
+    double start = threadNs();
+    for (uint32_t i = 0; i < ITERATIONS; i++) {
+        body();
+    }
+    return (threadNs() - start) / ITERATIONS;
+}
+
+}  // namespace
+
+int main() {
+    hostAdoptTask("loopTask");
+    int failures = 0;
+
+    // Alone
+    Trace::printOverhead(Serial);
+    double span = nsPerEvent([] { TRACE_SCOPE("work"); });
+    double counter = nsPerEvent([] { TRACE_COUNTER("queueDepth", 1); });
+    double instant = nsPerEvent([] { TRACE_INSTANT("tick"); });
+    // WiFi.eventName() returns static strings, so it is a valid event name
+    TRACE_INSTANT(WiFi.eventName(ARDUINO_EVENT_WIFI_READY));
+
+    // With other tasks recording and the loop dumping
+    for (int i = 0; i < WRITER_TASKS; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "writer%d", i);
+        xTaskCreate(writerTask, name, 4096, NULL, 1, NULL);
+    }
+    delay(50);
+    double contendedSpan = nsPerEvent([] { TRACE_SCOPE("work"); });
+
+    uint32_t maxEvents = 0;
+    size_t maxBytes = 0;
+    int64_t dumpUsTotal = 0;
+    int64_t dumpUsMax = 0;
+    for (int i = 0; i < DUMPS; i++) {
+        StringPrint out;
+        int64_t start = esp_timer_get_time();
+        Trace::dump(out);
+        int64_t us = esp_timer_get_time() - start;
+        dumpUsTotal += us;
+        dumpUsMax = us > dumpUsMax ? us : dumpUsMax;
+
+        uint32_t events;
+        if (!JsonCheck(out.text).valid()) {
+            printf("dump %d is not valid JSON\n", i);
+            failures++;
+        } else if (!checkEvents(out.text, events)) {
+            failures++;
+        } else {
+            maxEvents = events > maxEvents ? events : maxEvents;
+            maxBytes = out.text.size() > maxBytes ? out.text.size() : maxBytes;
+        }
+    }
+    stopWriters = true;
+    while (writersDone < WRITER_TASKS) {
+        delay(1);
+    }
+
+    printf("Host: %.0f ns per span, %.0f ns per counter, %.0f ns per instant; "
+           "%.0f ns per span with %d other tasks recording\n",
+           span, counter, instant, contendedSpan, WRITER_TASKS);
+    printf("Dump while %d tasks record (%llu events): %d dumps, up to %u events / %zu bytes, "
+           "avg %.0f us, max %lld us\n",
+           WRITER_TASKS, (unsigned long long)writerEvents.load(), DUMPS, maxEvents, maxBytes,
+           (double)dumpUsTotal / DUMPS, (long long)dumpUsMax);
+    printf("%s\n", failures ? "FAILED" : "all dumps valid");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,190 @@
+#include "InfluxRetryQueue.h"
+#include <LittleFS.h>
+
+static const char* ACTIVE_PATH = "/influx_q.lp";
+static const char* ROTATED_PATH = "/influx_q.old.lp";
+
+static size_t fileSize(const char* path) {
+    if (!LittleFS.exists(path)) {
+        return 0;
+    }
+    File f = LittleFS.open(path, FILE_READ);
+    size_t size = f ? f.size() : 0;
+    f.close();
+    return size;
+}
+
+static uint32_t countLines(const char* path, size_t fromOffset) {
+    File f = LittleFS.open(path, FILE_READ);
+    if (!f) {
+        return 0;
+    }
+    uint32_t lines = 0;
+    uint8_t buf[128];
+    f.seek(fromOffset);
+    while (f.available()) {
+        size_t n = f.read(buf, sizeof(buf));
+        for (size_t i = 0; i < n; i++) {
+            if (buf[i] == '\n') {
+                lines++;
+            }
+        }
+    }
+    f.close();
+    return lines;
+}
+
+static bool endsWithNewline(const char* path) {
+    size_t size = fileSize(path);
+    if (size == 0) {
+        return true;
+    }
+    File f = LittleFS.open(path, FILE_READ);
+    bool ok = f && f.seek(size - 1) && f.read() == '\n';
+    f.close();
+    return ok;
+}
+
+bool InfluxRetryQueue::begin(size_t maxBytes) {
+    _maxBytes = maxBytes;
+    // Format on first use so a blank partition just works
+    _ready = LittleFS.begin(true);
+    if (!_ready) {
+        Serial.println("Retry queue: LittleFS mount failed");
+        return false;
+    }
+    // A push cut short before a reboot left a fragment without its newline
+    _unterminated = !endsWithNewline(ACTIVE_PATH);
+    return true;
+}
+
+void InfluxRetryQueue::rotate() {
+    if (LittleFS.exists(ROTATED_PATH)) {
+        size_t from = (_readPath == ROTATED_PATH) ? _readOffset : 0;
+        _dropped += countLines(ROTATED_PATH, from);
+        LittleFS.remove(ROTATED_PATH);
+        if (_readPath == ROTATED_PATH) {
+            _readPath = nullptr;
+            _readOffset = 0;
+        }
+    }
+    LittleFS.rename(ACTIVE_PATH, ROTATED_PATH);
+    if (_readPath == ACTIVE_PATH) {
+        _readPath = ROTATED_PATH;
+    }
+}
+
+bool InfluxRetryQueue::push(const char* line, size_t len) {
+    if (!_ready) {
+        _dropped++;
+        return false;
+    }
+
+    if (fileSize(ACTIVE_PATH) + len + 1 > _maxBytes / 2) {
+        rotate();
+    }
+
+    File f = LittleFS.open(ACTIVE_PATH, FILE_APPEND);
+    if (!f) {
+        _dropped++;
+        return false;
+    }
+    // Offsets come from the write results; size() can lag buffered writes
+    size_t start = f.size();
+    if (_unterminated) {
+        // End the fragment an earlier failed push left behind
+        if (f.write('\n') != 1) {
+            f.close();
+            _dropped++;
+            return false;
+        }
+        start++;
+        _unterminated = false;
+    }
+    size_t written = f.write((const uint8_t*)line, len);
+    bool ok = written == len && f.write('\n') == 1;
+    f.close();
+
+    if (!ok) {
+        // Flash full: comment out whatever part of the record made it, so it
+        // is never sent as a truncated point
+        if (written > 0) {
+            commentOut(start);
+            _unterminated = true;
+        }
+        _dropped++;
+        return false;
+    }
+    return true;
+}
+
+void InfluxRetryQueue::commentOut(size_t offset) {
+    // Overwrites one byte in place, which needs no free space
+    File f = LittleFS.open(ACTIVE_PATH, "r+");
+    if (f && f.seek(offset)) {
+        f.write('#');
+    }
+    f.close();
+}
+
+size_t InfluxRetryQueue::drainFile(const char* path, const Writer& write, size_t maxLines, bool& blocked) {
+    if (!LittleFS.exists(path)) {
+        return 0;
+    }
+    if (_readPath != path) {
+        _readPath = path;
+        _readOffset = 0;
+    }
+
+    File f = LittleFS.open(path, FILE_READ);
+    if (!f) {
+        return 0;
+    }
+    f.seek(_readOffset);
+
+    size_t sent = 0;
+    while (sent < maxLines && f.available()) {
+        String line = f.readStringUntil('\n');
+        // '#' marks a record cut short by a full partition
+        if (line.length() > 0 && line[0] != '#' && !write(line)) {
+            blocked = true;
+            break;
+        }
+        _readOffset = f.position();
+        sent++;
+    }
+    bool finished = !blocked && !f.available();
+    f.close();
+
+    if (finished) {
+        LittleFS.remove(path);
+        _readPath = nullptr;
+        _readOffset = 0;
+    }
+    return sent;
+}
+
+size_t InfluxRetryQueue::drain(const Writer& write, size_t maxLines) {
+    if (!_ready) {
+        return 0;
+    }
+
+    bool blocked = false;
+    size_t sent = drainFile(ROTATED_PATH, write, maxLines, blocked);
+    if (!blocked && sent < maxLines && !LittleFS.exists(ROTATED_PATH)) {
+        sent += drainFile(ACTIVE_PATH, write, maxLines - sent, blocked);
+    }
+    return sent;
+}
+
+bool InfluxRetryQueue::empty() {
+    return queuedBytes() == 0;
+}
+
+size_t InfluxRetryQueue::queuedBytes() {
+    if (!_ready) {
+        return 0;
+    }
+    size_t total = fileSize(ROTATED_PATH) + fileSize(ACTIVE_PATH);
+    return total - _readOffset;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <Arduino.h>
+#include <functional>
+
+// Bounded on-flash queue of InfluxDB line-protocol records.
+//
+// Records that cannot be sent (no WiFi, write failures) are appended to a
+// file on LittleFS so they survive outages and reboots. When the active file
+// reaches half the budget it is rotated, and the previous rotated file is
+// dropped, so the oldest data goes first once the budget is exhausted.
+// The read position lives in RAM only: after a reboot, records already
+// drained from a file that was not finished are sent again. InfluxDB
+// overwrites points with the same series and timestamp, so that costs
+// bandwidth, not data.
+class InfluxRetryQueue {
+public:
+    using Writer = std::function<bool(const String& line)>;
+
+    bool begin(size_t maxBytes = 64 * 1024);
+
+    // Append one record (without trailing newline); false, and counted as
+    // dropped, when it could not be written in full
+    bool push(const char* line, size_t len);
+    bool push(const String& line) { return push(line.c_str(), line.length()); }
+
+    // Hand up to maxLines queued records to write(), oldest first. Stops at
+    // the first record write() refuses; that record stays queued.
+    size_t drain(const Writer& write, size_t maxLines);
+
+    bool empty();
+    size_t queuedBytes();
+    uint32_t droppedRecords() const { return _dropped; }
+
+private:
+    size_t drainFile(const char* path, const Writer& write, size_t maxLines, bool& blocked);
+    void rotate();
+    void commentOut(size_t offset);
+
+    size_t _maxBytes = 0;
+    size_t _readOffset = 0;     // offset into the file currently being drained
+    const char* _readPath = nullptr;
+    uint32_t _dropped = 0;
+    bool _ready = false;
+    // The active file ends in a partial record without its newline
+    bool _unterminated = false;
+};
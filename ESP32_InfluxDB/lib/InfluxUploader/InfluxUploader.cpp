@@ -0,0 +1,172 @@
+#include "InfluxUploader.h"
+
+static const uint16_t HTTP_TIMEOUT_MS = 10000;
+
+InfluxUploader::InfluxUploader(const char* serverUrl, const char* org, const char* bucket,
+                               const char* token, const char* caCert) {
+    String url = serverUrl;
+    while (url.endsWith("/")) {
+        url.remove(url.length() - 1);
+    }
+
+    // https://host[:port]
+    int hostStart = url.indexOf("://");
+    hostStart = hostStart < 0 ? 0 : hostStart + 3;
+    int hostEnd = url.indexOf('/', hostStart);
+    String authority = hostEnd < 0 ? url.substring(hostStart) : url.substring(hostStart, hostEnd);
+    int colon = authority.indexOf(':');
+    if (colon >= 0) {
+        _host = authority.substring(0, colon);
+        _port = authority.substring(colon + 1).toInt();
+    } else {
+        _host = authority;
+    }
+
+    _writeUrl = url + "/api/v2/write?org=" + org + "&bucket=" + bucket + "&precision=s";
+    _authHeader = String("Token ") + token;
+
+    _tls.setCACert(caCert);
+    _tls.setTimeout(HTTP_TIMEOUT_MS / 1000);
+    _http.setReuse(true);
+    _http.setTimeout(HTTP_TIMEOUT_MS);
+}
+
+InfluxUploader::~InfluxUploader() {
+    free(_body);
+}
+
+void InfluxUploader::setBatching(size_t batchSize, size_t bufferSize, uint32_t flushIntervalMs,
+                                 size_t maxLineBytes) {
+    _batchSize = batchSize;
+    _bufferSize = bufferSize < batchSize ? batchSize : bufferSize;
+    _flushIntervalMs = flushIntervalMs;
+
+    // Sized once; drops whatever was pending, so call this before adding
+    free(_body);
+    _capacity = _bufferSize * (maxLineBytes + 1);
+    _body = (char*)malloc(_capacity);
+    if (!_body) {
+        _capacity = 0;
+    }
+    _length = 0;
+    _pending = 0;
+}
+
+bool InfluxUploader::add(const char* line, size_t len) {
+    if (isFull() || len + 1 > _capacity - _length) {
+        return false;
+    }
+    if (_pending == 0) {
+        _lastFlush = millis();
+    }
+    memcpy(_body + _length, line, len);
+    _body[_length + len] = '\n';
+    _length += len + 1;
+    _pending++;
+    return true;
+}
+
+bool InfluxUploader::flushDue() const {
+    if (_pending == 0) {
+        return false;
+    }
+    return _pending >= _batchSize || millis() - _lastFlush >= _flushIntervalMs;
+}
+
+bool InfluxUploader::ensureConnected() {
+    if (_tls.connected()) {
+        return true;
+    }
+
+    // Full TCP + TLS handshake; keep-alive makes this the exception
+    _tls.stop();
+    unsigned long start = millis();
+    if (!_tls.connect(_host.c_str(), _port)) {
+        Serial.printf("InfluxDB: TLS connect to %s:%u failed\n", _host.c_str(), _port);
+        return false;
+    }
+    // Header and body go out as separate writes; without this the body
+    // waits for the server's delayed ACK (~40 ms per request)
+    _tls.setNoDelay(true);
+    _stats.lastHandshakeMs = millis() - start;
+    _stats.handshakeMsTotal += _stats.lastHandshakeMs;
+    _stats.handshakes++;
+    return true;
+}
+
+bool InfluxUploader::flush() {
+    if (_pending == 0) {
+        return true;
+    }
+
+    unsigned long start = millis();
+    int code = -1;
+    if (ensureConnected() && _http.begin(_tls, _writeUrl)) {
+        _http.addHeader("Authorization", _authHeader);
+        _http.addHeader("Content-Type", "text/plain; charset=utf-8");
+        code = _http.POST((uint8_t*)_body, _length);
+        // Leaves the socket open when the server agreed to keep-alive
+        _http.end();
+    }
+
+    _stats.lastWriteMs = millis() - start;
+    _stats.writeMsTotal += _stats.lastWriteMs;
+    if (_stats.lastWriteMs > _stats.maxWriteMs) {
+        _stats.maxWriteMs = _stats.lastWriteMs;
+    }
+    _stats.writes++;
+
+    if (code == 204) {
+        _stats.pointsWritten += _pending;
+        _stats.bytesWritten += _length;
+        clear();
+        return true;
+    }
+
+    _stats.failedWrites++;
+    if (code < 0) {
+        // Transport error: don't try to reuse this socket
+        _tls.stop();
+    }
+    if (retryable(code)) {
+        Serial.printf("InfluxDB write failed: HTTP %d, retrying %u points later\n", code,
+                      (unsigned)_pending);
+        _lastFlush = millis();
+        return false;
+    }
+    // The server refused the data itself; resending it cannot succeed
+    _stats.rejectedWrites++;
+    _stats.pointsDropped += _pending;
+    Serial.printf("InfluxDB write rejected: HTTP %d, dropping %u points\n", code,
+                  (unsigned)_pending);
+    clear();
+    return false;
+}
+
+bool InfluxUploader::retryable(int code) {
+    return code < 0 || code == HTTP_CODE_REQUEST_TIMEOUT || code == HTTP_CODE_TOO_MANY_REQUESTS ||
+           code >= 500;
+}
+
+void InfluxUploader::clear() {
+    _length = 0;
+    _pending = 0;
+    _lastFlush = millis();
+}
+
+void InfluxUploader::disconnect() {
+    _tls.stop();
+}
+
+void InfluxUploader::printStats() const {
+    Serial.printf("InfluxDB: %u writes (%u failed, %u rejected), last %u ms, avg %.1f ms, max %u ms; "
+                  "%u handshakes, last %u ms, avg %.1f ms; %u points, %.1f bytes/point, %u dropped\n",
+                  _stats.writes, _stats.failedWrites, _stats.rejectedWrites, _stats.lastWriteMs,
+                  _stats.writes ? (float)_stats.writeMsTotal / _stats.writes : 0.0f,
+                  _stats.maxWriteMs,
+                  _stats.handshakes, _stats.lastHandshakeMs,
+                  _stats.handshakes ? (float)_stats.handshakeMsTotal / _stats.handshakes : 0.0f,
+                  _stats.pointsWritten,
+                  _stats.pointsWritten ? (float)_stats.bytesWritten / _stats.pointsWritten : 0.0f,
+                  _stats.pointsDropped);
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <Arduino.h>
+#include <WiFiClientSecure.h>
+#include <HTTPClient.h>
+
+// Batched line-protocol writer for the InfluxDB v2 write API.
+//
+// Keeps one TLS connection open across writes (HTTP/1.1 keep-alive), so the
+// handshake is paid once per connection instead of once per request, and
+// reports how often and how long handshakes and writes take. Pending lines
+// are copied into one request body allocated up front, so queueing a point
+// never touches the heap.
+class InfluxUploader {
+public:
+    struct Stats {
+        uint32_t handshakes = 0;
+        uint32_t lastHandshakeMs = 0;
+        uint64_t handshakeMsTotal = 0;
+        uint32_t writes = 0;
+        uint32_t failedWrites = 0;
+        uint32_t rejectedWrites = 0;  // non-retryable 4xx, batch dropped
+        uint32_t lastWriteMs = 0;
+        uint32_t maxWriteMs = 0;
+        uint64_t writeMsTotal = 0;
+        uint32_t pointsWritten = 0;
+        uint64_t bytesWritten = 0;
+        uint32_t pointsDropped = 0;
+    };
+
+    InfluxUploader(const char* serverUrl, const char* org, const char* bucket,
+                   const char* token, const char* caCert);
+
+    ~InfluxUploader();
+
+    // Flush when batchSize points are pending or flushIntervalMs has passed;
+    // hold at most bufferSize points of up to maxLineBytes each while the
+    // server is unreachable
+    void setBatching(size_t batchSize, size_t bufferSize, uint32_t flushIntervalMs,
+                     size_t maxLineBytes = 128);
+
+    // Queue one line-protocol record (without newline); false when the
+    // buffer is full
+    bool add(const char* line, size_t len);
+    bool add(const String& line) { return add(line.c_str(), line.length()); }
+    bool isFull() const { return _pending >= _bufferSize || _length >= _capacity; }
+    bool flushDue() const;
+    // POST everything pending in one request. On transport errors, 408,
+    // 429 and 5xx the batch is kept for the next flush; any other error
+    // (400, 401, 413, 422, ...) would fail the same way again, so the batch
+    // is dropped and counted
+    bool flush();
+    // Close the connection (e.g. when WiFi drops)
+    void disconnect();
+
+    const Stats& stats() const { return _stats; }
+    void printStats() const;
+
+private:
+    bool ensureConnected();
+    static bool retryable(int code);
+    void clear();
+
+    WiFiClientSecure _tls;
+    HTTPClient _http;
+    String _host;
+    uint16_t _port = 443;
+    String _writeUrl;
+    String _authHeader;
+
+    char* _body = nullptr;
+    size_t _capacity = 0;
+    size_t _length = 0;
+    size_t _pending = 0;
+    size_t _batchSize = 1;
+    size_t _bufferSize = 1;
+    uint32_t _flushIntervalMs = 0;
+    unsigned long _lastFlush = 0;
+
+    Stats _stats;
+};
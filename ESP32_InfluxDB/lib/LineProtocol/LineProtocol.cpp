@@ -0,0 +1,146 @@
+#include "LineProtocol.h"
+
+#include <math.h>
+#include <string.h>
+
+// Appends s with commas and spaces (and equals signs in keys and tag values)
+// backslash-escaped; false if it does not fit in size bytes
+static bool appendEscaped(char* buf, size_t& len, size_t size, const char* s, bool escapeEquals) {
+    for (; *s; s++) {
+        if ((*s == ',' || *s == ' ' || (*s == '=' && escapeEquals))) {
+            if (len >= size) {
+                return false;
+            }
+            buf[len++] = '\\';
+        }
+        if (len >= size) {
+            return false;
+        }
+        buf[len++] = *s;
+    }
+    return true;
+}
+
+bool LinePrefix::setMeasurement(const char* measurement) {
+    _len = 0;
+    return appendEscaped(_buf, _len, CAPACITY, measurement, false);
+}
+
+bool LinePrefix::addTag(const char* key, const char* value) {
+    // Empty tag values are not allowed by the protocol
+    if (!*value) {
+        return true;
+    }
+    size_t len = _len;
+    if (len >= CAPACITY) {
+        return false;
+    }
+    _buf[len++] = ',';
+    if (!appendEscaped(_buf, len, CAPACITY, key, true) || len >= CAPACITY) {
+        return false;
+    }
+    _buf[len++] = '=';
+    if (!appendEscaped(_buf, len, CAPACITY, value, true)) {
+        return false;
+    }
+    _len = len;
+    return true;
+}
+
+void LineEncoder::put(char c) {
+    if (_len < _size) {
+        _buf[_len++] = c;
+    } else {
+        _overflow = true;
+    }
+}
+
+void LineEncoder::put(const char* s, size_t n) {
+    if (n > _size - _len) {
+        _overflow = true;
+        return;
+    }
+    memcpy(_buf + _len, s, n);
+    _len += n;
+}
+
+void LineEncoder::putUnsigned(uint64_t value) {
+    char digits[20];
+    size_t n = 0;
+    // 64-bit division is a library call on the ESP32; timestamps and field
+    // values almost always fit in 32 bits
+    while (value > UINT32_MAX) {
+        digits[n++] = '0' + value % 10;
+        value /= 10;
+    }
+    uint32_t v = (uint32_t)value;
+    do {
+        digits[n++] = '0' + v % 10;
+        v /= 10;
+    } while (v);
+    while (n) {
+        put(digits[--n]);
+    }
+}
+
+void LineEncoder::putKey(const char* key) {
+    put(_hasFields ? ',' : ' ');
+    _hasFields = true;
+    if (!appendEscaped(_buf, _len, _size, key, true)) {
+        _overflow = true;
+    }
+    put('=');
+}
+
+void LineEncoder::begin(const LinePrefix& prefix) {
+    _len = 0;
+    _hasFields = false;
+    _overflow = false;
+    put(prefix.data(), prefix.length());
+}
+
+void LineEncoder::addIntField(const char* key, int64_t value) {
+    putKey(key);
+    if (value < 0) {
+        put('-');
+        putUnsigned(0 - (uint64_t)value);
+    } else {
+        putUnsigned(value);
+    }
+    put('i');
+}
+
+void LineEncoder::addFloatField(const char* key, float value, uint8_t decimals) {
+    static const uint32_t POW10[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+    if (decimals > 8) {
+        decimals = 8;
+    }
+    // Beyond 1e18 the fixed-point value below would not fit in 64 bits
+    if (isnan(value) || fabs((double)value) * POW10[decimals] >= 1e18) {
+        return;
+    }
+    putKey(key);
+
+    double v = value;
+    if (v < 0) {
+        put('-');
+        v = -v;
+    }
+    // Rounded once in fixed point, so the carry of 9.999 reaches the integer
+    // part. The product is exact for a float, and rint() breaks ties to even
+    // like printf, so the output matches String(value, decimals) byte for byte.
+    uint64_t scaled = (uint64_t)rint(v * POW10[decimals]);
+    putUnsigned(scaled / POW10[decimals]);
+    if (decimals) {
+        put('.');
+        uint32_t frac = scaled % POW10[decimals];
+        for (uint32_t p = POW10[decimals] / 10; p; p /= 10) {
+            put('0' + frac / p % 10);
+        }
+    }
+}
+
+void LineEncoder::setTime(uint64_t timestamp) {
+    put(' ');
+    putUnsigned(timestamp);
+}
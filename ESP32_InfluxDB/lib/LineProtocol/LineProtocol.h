@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Allocation-free InfluxDB line-protocol encoding.
+//
+// The measurement and tags never change between points, so they are escaped
+// once into a LinePrefix; each point then only appends its fields and
+// timestamp into a caller-owned buffer. Numbers are formatted like the
+// InfluxDB client's Point (integers with an "i" suffix, floats with a fixed
+// number of decimals) so existing series keep their field types.
+// Plain C++, shared with the host benchmark in tools/.
+class LinePrefix {
+public:
+    static const size_t CAPACITY = 128;
+
+    // Starts over with a new measurement; false when it does not fit
+    bool setMeasurement(const char* measurement);
+    // Tags should be added sorted by key, which is what the server expects
+    bool addTag(const char* key, const char* value);
+
+    const char* data() const { return _buf; }
+    size_t length() const { return _len; }
+
+private:
+    char _buf[CAPACITY];
+    size_t _len = 0;
+};
+
+class LineEncoder {
+public:
+    LineEncoder(char* buf, size_t size) : _buf(buf), _size(size) {}
+
+    // Starts a new point; the buffer is reused
+    void begin(const LinePrefix& prefix);
+    void addIntField(const char* key, int64_t value);
+    // NaN is skipped, like Point::addField does, and so are values too large
+    // for fixed-point formatting (> 1e18)
+    void addFloatField(const char* key, float value, uint8_t decimals = 2);
+    void setTime(uint64_t timestamp);
+
+    // Length of the encoded line (no trailing newline), 0 if it overflowed
+    size_t length() const { return _overflow ? 0 : _len; }
+    const char* data() const { return _buf; }
+
+private:
+    void put(char c);
+    void put(const char* s, size_t n);
+    void putUnsigned(uint64_t value);
+    void putKey(const char* key);
+
+    char* _buf;
+    size_t _size;
+    size_t _len = 0;
+    bool _hasFields = false;
+    bool _overflow = false;
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+// Per-interval RSSI statistics.
+// RSSI is an integer in [-127, 0] dBm, so a 128-bin histogram gives exact
+// percentiles in constant memory no matter how many samples arrive.
+class RssiAggregator {
+public:
+    RssiAggregator() { reset(); }
+
+    void reset() {
+        memset(_hist, 0, sizeof(_hist));
+        _count = 0;
+        _sum = 0;
+        _min = 0;
+        _max = -127;
+    }
+
+    void add(int rssi) {
+        if (rssi > 0) rssi = 0;
+        if (rssi < -127) rssi = -127;
+        _hist[-rssi]++;
+        _sum += rssi;
+        if (_count == 0 || rssi < _min) _min = rssi;
+        if (_count == 0 || rssi > _max) _max = rssi;
+        _count++;
+    }
+
+    uint32_t count() const { return _count; }
+    int min() const { return _min; }
+    int max() const { return _max; }
+    float mean() const { return _count ? (float)_sum / _count : 0.0f; }
+
+    // Smallest value v such that at least p percent of samples are <= v
+    int percentile(float p) const {
+        if (_count == 0) {
+            return 0;
+        }
+        uint32_t rank = (uint32_t)((p / 100.0f) * _count + 0.999f);
+        if (rank == 0) rank = 1;
+        uint32_t seen = 0;
+        // Walk from the weakest signal (-127) up to the strongest (0)
+        for (int i = 127; i >= 0; i--) {
+            seen += _hist[i];
+            if (seen >= rank) {
+                return -i;
+            }
+        }
+        return _max;
+    }
+
+private:
+    uint32_t _hist[128];
+    uint32_t _count;
+    int32_t _sum;
+    int _min;
+    int _max;
+};
@@ -10,6 +10,20 @@
   
 #include <InfluxDbClient.h>
 #include <InfluxDbCloud.h>
+#include <InfluxRetryQueue.h>
+#include <InfluxUploader.h>
+#include <LineProtocol.h>
+#include <SampleRing.h>
+#include <RssiAggregator.h>
+
+// 1 = benchmark line-protocol encoding at boot and print JSON results
+#ifndef BENCH_SUITE
+#define BENCH_SUITE 0
+#endif
+
+#if BENCH_SUITE
+#include <BenchSuite.h>
+#endif
 
 // WiFi AP SSID
 #define WIFI_SSID ""
@@ -24,14 +38,303 @@
 // Time zone info
 #define TZ_INFO "UTC5"
 
+// RSSI sampling rate, independent of the upload cadence; profile at 1, 10
+// and 100 with -DSAMPLE_RATE_HZ=... in build_flags
+#ifndef SAMPLE_RATE_HZ
+#define SAMPLE_RATE_HZ 10
+#endif
+// One aggregated point (min/max/mean/p95) is produced per interval
+#define AGGREGATE_INTERVAL_MS 10000
+// How often the aggregator empties the sample ring
+#define AGGREGATOR_POLL_MS 100
+
+// Points are sent in batches instead of one HTTP request per point
+#define WRITE_BATCH_SIZE 6
+// Points held in RAM while the server is unreachable
+#define WRITE_BUFFER_SIZE 30
+// Flush a partial batch after this long
+#define WRITE_FLUSH_INTERVAL_MS 60000
+// Longest encoded point; also sizes the uploader's batch buffer
+#define LINE_MAX_BYTES 192
+// On-flash budget for points collected while offline
+#define RETRY_QUEUE_BYTES (64 * 1024)
+// Queued points replayed per loop iteration once back online
+#define RETRY_DRAIN_PER_LOOP 30
+
 // Declare InfluxDB client instance with preconfigured InfluxCloud certificate
 InfluxDBClient client(INFLUXDB_URL, INFLUXDB_ORG, INFLUXDB_BUCKET, INFLUXDB_TOKEN, InfluxDbCloud2CACert);
+// Writes go through a persistent keep-alive connection instead of the client
+InfluxUploader uploader(INFLUXDB_URL, INFLUXDB_ORG, INFLUXDB_BUCKET, INFLUXDB_TOKEN, InfluxDbCloud2CACert);
+
+// Escaped measurement and tags, shared by every point
+LinePrefix linePrefix;
+
+// Points that could not be handed to the client survive here across outages
+InfluxRetryQueue retryQueue;
+
+struct IntervalStats {
+  time_t timestamp;
+  uint32_t count;
+  int min;
+  int max;
+  int p95;
+  float mean;
+};
+
+// Sampler -> aggregator: raw samples, lock-free
+SampleRing<int8_t, 256> sampleRing;
+// Aggregator -> uploader: one entry per interval
+QueueHandle_t statsQueue;
+
+TaskHandle_t samplerTaskHandle = NULL;
+TaskHandle_t aggregatorTaskHandle = NULL;
+TaskHandle_t uploaderTaskHandle = NULL;
+hw_timer_t* sampleTimer = NULL;
+
+// Time spent doing work in each stage, for profiling
+volatile uint64_t samplerBusyUs = 0;
+volatile uint64_t aggregatorBusyUs = 0;
+volatile uint64_t uploaderBusyUs = 0;
+volatile uint32_t samplesSkipped = 0;
+// Intervals lost because the uploader fell 8 intervals behind
+volatile uint32_t statsDropped = 0;
+
+// Accept a record into the uploader's batch unless it is already full
+bool bufferRecord(const String& line) {
+  return uploader.add(line);
+}
+
+void IRAM_ATTR onSampleTimer() {
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(samplerTaskHandle, &woken);
+  if (woken) {
+    portYIELD_FROM_ISR();
+  }
+}
+
+void samplerTask(void* pvParameters) {
+  while (true) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    int64_t start = esp_timer_get_time();
+
+    // RSSI reads 0 while disconnected; don't let that skew the statistics
+    if (WiFi.status() == WL_CONNECTED) {
+      sampleRing.push((int8_t)WiFi.RSSI());
+    } else {
+      samplesSkipped++;
+    }
+
+    samplerBusyUs += esp_timer_get_time() - start;
+  }
+}
+
+void aggregatorTask(void* pvParameters) {
+  RssiAggregator aggregator;
+  TickType_t lastWake = xTaskGetTickCount();
+  unsigned long intervalStart = millis();
+
+  while (true) {
+    vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(AGGREGATOR_POLL_MS));
+    int64_t start = esp_timer_get_time();
+
+    int8_t rssi;
+    while (sampleRing.pop(rssi)) {
+      aggregator.add(rssi);
+    }
+
+    if (millis() - intervalStart >= AGGREGATE_INTERVAL_MS) {
+      intervalStart += AGGREGATE_INTERVAL_MS;
+      if (aggregator.count() > 0) {
+        IntervalStats stats;
+        stats.timestamp = time(nullptr);
+        stats.count = aggregator.count();
+        stats.min = aggregator.min();
+        stats.max = aggregator.max();
+        stats.mean = aggregator.mean();
+        stats.p95 = aggregator.percentile(95);
+        // Never block sampling on a slow uploader; when it is a full queue
+        // behind, the interval is dropped and counted
+        if (xQueueSend(statsQueue, &stats, 0) != pdTRUE) {
+          statsDropped++;
+        }
+      }
+      aggregator.reset();
+    }
+
+    aggregatorBusyUs += esp_timer_get_time() - start;
+  }
+}
+
+// Same fields and formatting as the client's Point, without any String
+size_t encodeStats(const IntervalStats& stats, char* buf, size_t size) {
+  LineEncoder point(buf, size);
+  point.begin(linePrefix);
+  // "rssi" stays an integer as it always was; the exact mean is separate
+  point.addIntField("rssi", lroundf(stats.mean));
+  point.addFloatField("rssi_mean", stats.mean);
+  point.addIntField("rssi_min", stats.min);
+  point.addIntField("rssi_max", stats.max);
+  point.addIntField("rssi_p95", stats.p95);
+  point.addIntField("samples", stats.count);
+  point.setTime((uint64_t)stats.timestamp);
+  return point.length();
+}
+
+void writeStats(const IntervalStats& stats) {
+  char line[LINE_MAX_BYTES];
+  size_t len = encodeStats(stats, line, sizeof(line));
+  if (len == 0) {
+    Serial.println("Point longer than LINE_MAX_BYTES, dropped");
+    return;
+  }
+  // Print what are we exactly writing
+  Serial.print("Writing: ");
+  Serial.write(line, len);
+  Serial.println();
+  // If no Wifi signal, try to reconnect it
+  if (wifiMulti.run() != WL_CONNECTED) {
+    Serial.println("Wifi connection lost, queueing point");
+    uploader.disconnect();
+    retryQueue.push(line, len);
+  } else {
+    // Replay points collected during an outage, then the fresh one
+    retryQueue.drain(bufferRecord, RETRY_DRAIN_PER_LOOP);
+    if (!uploader.add(line, len)) {
+      retryQueue.push(line, len);
+    }
+    if (uploader.flushDue()) {
+      uploader.flush();
+      uploader.printStats();
+    }
+  }
+
+  if (!retryQueue.empty() || retryQueue.droppedRecords()) {
+    Serial.printf("Retry queue: %u bytes queued, %u points dropped\n",
+                  (unsigned)retryQueue.queuedBytes(), (unsigned)retryQueue.droppedRecords());
+  }
+}
+
+#if configGENERATE_RUN_TIME_STATS
+// Scheduler run time of each pipeline task: CPU time only, unlike the busy
+// counters, which include the uploader's waits on the network. Needs
+// CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS with the esp_timer clock (counters
+// in microseconds); the stock Arduino core leaves it off, and then only the
+// wall line is printed
+void readTaskCpu(uint32_t cpuUs[3]) {
+  const TaskHandle_t handles[3] = {samplerTaskHandle, aggregatorTaskHandle, uploaderTaskHandle};
+  UBaseType_t count = uxTaskGetNumberOfTasks() + 2;
+  TaskStatus_t* status = (TaskStatus_t*)malloc(count * sizeof(TaskStatus_t));
+  memset(cpuUs, 0, 3 * sizeof(uint32_t));
+  if (!status) {
+    return;
+  }
+  count = uxTaskGetSystemState(status, count, NULL);
+  for (UBaseType_t i = 0; i < count; i++) {
+    for (int t = 0; t < 3; t++) {
+      if (status[i].xHandle == handles[t]) {
+        cpuUs[t] = status[i].ulRunTimeCounter;
+      }
+    }
+  }
+  free(status);
+}
+#endif
+
+void printProfile() {
+  static uint64_t lastSampler = 0, lastAggregator = 0, lastUploader = 0;
+  static int64_t lastReport = 0;
+
+  int64_t now = esp_timer_get_time();
+  float elapsed = lastReport ? (float)(now - lastReport) : (float)now;
+  uint64_t samplerUs = samplerBusyUs, aggregatorUs = aggregatorBusyUs, uploaderUs = uploaderBusyUs;
+
+#if configGENERATE_RUN_TIME_STATS
+  static uint32_t lastCpu[3] = {0, 0, 0};
+  uint32_t cpu[3];
+  readTaskCpu(cpu);
+  Serial.printf("Pipeline @ %d Hz CPU: sampler %.3f%%, aggregator %.3f%%, uploader %.3f%%\n",
+                SAMPLE_RATE_HZ,
+                100.0f * (uint32_t)(cpu[0] - lastCpu[0]) / elapsed,
+                100.0f * (uint32_t)(cpu[1] - lastCpu[1]) / elapsed,
+                100.0f * (uint32_t)(cpu[2] - lastCpu[2]) / elapsed);
+  memcpy(lastCpu, cpu, sizeof(lastCpu));
+#endif
+  // Wall time inside each stage's work; the uploader's includes network waits
+  Serial.printf("Pipeline @ %d Hz wall: sampler %.3f%%, aggregator %.3f%%, uploader %.2f%% in calls; "
+                "ring overruns %u, skipped %u, intervals dropped %u\n",
+                SAMPLE_RATE_HZ,
+                100.0f * (samplerUs - lastSampler) / elapsed,
+                100.0f * (aggregatorUs - lastAggregator) / elapsed,
+                100.0f * (uploaderUs - lastUploader) / elapsed,
+                sampleRing.overruns(), samplesSkipped, statsDropped);
+  Serial.printf("Heap: free %u, min free %u; stack headroom: sampler %u, aggregator %u, uploader %u\n",
+                ESP.getFreeHeap(), ESP.getMinFreeHeap(),
+                uxTaskGetStackHighWaterMark(samplerTaskHandle),
+                uxTaskGetStackHighWaterMark(aggregatorTaskHandle),
+                uxTaskGetStackHighWaterMark(uploaderTaskHandle));
+
+  lastSampler = samplerUs;
+  lastAggregator = aggregatorUs;
+  lastUploader = uploaderUs;
+  lastReport = now;
+}
+
+void uploaderTask(void* pvParameters) {
+  IntervalStats stats;
+  while (true) {
+    if (xQueueReceive(statsQueue, &stats, portMAX_DELAY) != pdTRUE) {
+      continue;
+    }
+    int64_t start = esp_timer_get_time();
+    writeStats(stats);
+    // Includes time blocked on the network, not just CPU time
+    uploaderBusyUs += esp_timer_get_time() - start;
+
+    printProfile();
+  }
+}
 
-// Declare Data point
-Point sensor("wifi_status");
+#if BENCH_SUITE
+// Encoding one interval's point: the client library path against LineEncoder
+void runBenchmarks() {
+  BenchSuite suite("influx");
+
+  static const IntervalStats stats = {1700000000, 100, -71, -48, -52, -57.25f};
+  static Point point("wifi_status");
+  point.addTag("device", DEVICE);
+  point.addTag("SSID", "bench-network");
+  linePrefix.setMeasurement("wifi_status");
+  linePrefix.addTag("device", DEVICE);
+  linePrefix.addTag("SSID", "bench-network");
+
+  suite.add("point_to_line_protocol", [] {
+    point.clearFields();
+    point.addField("rssi", (int)lroundf(stats.mean));
+    point.addField("rssi_mean", stats.mean);
+    point.addField("rssi_min", stats.min);
+    point.addField("rssi_max", stats.max);
+    point.addField("rssi_p95", stats.p95);
+    point.addField("samples", stats.count);
+    point.setTime((unsigned long long)stats.timestamp);
+    String line = client.pointToLineProtocol(point);
+    BenchSuite::doNotOptimize(line);
+  });
+  suite.add("line_encoder", [] {
+    char line[LINE_MAX_BYTES];
+    size_t len = encodeStats(stats, line, sizeof(line));
+    BenchSuite::doNotOptimize(len);
+  });
+
+  client.setWriteOptions(WriteOptions().writePrecision(WritePrecision::S));
+  suite.run();
+}
+#endif
 
 void setup() {
   Serial.begin(115200);
+#if BENCH_SUITE
+  runBenchmarks();
+#endif
 
   // Setup wifi
   WiFi.mode(WIFI_STA);
@@ -59,29 +362,30 @@ void setup() {
     Serial.println(client.getLastErrorMessage());
   }
 
-  // Add tags to the data point
-  sensor.addTag("device", DEVICE);
-  sensor.addTag("SSID", WiFi.SSID());
+  // Timestamps are set on the device so queued points keep their sample time
+  client.setWriteOptions(WriteOptions().writePrecision(WritePrecision::S));
+  uploader.setBatching(WRITE_BATCH_SIZE, WRITE_BUFFER_SIZE, WRITE_FLUSH_INTERVAL_MS, LINE_MAX_BYTES);
+
+  retryQueue.begin(RETRY_QUEUE_BYTES);
+
+  // Tags never change, so they are escaped once
+  linePrefix.setMeasurement("wifi_status");
+  linePrefix.addTag("device", DEVICE);
+  linePrefix.addTag("SSID", WiFi.SSID().c_str());
+
+  statsQueue = xQueueCreate(8, sizeof(IntervalStats));
+  xTaskCreatePinnedToCore(samplerTask, "Sampler", 3072, NULL, 3, &samplerTaskHandle, 1);
+  xTaskCreatePinnedToCore(aggregatorTask, "Aggregator", 3072, NULL, 2, &aggregatorTaskHandle, 1);
+  xTaskCreatePinnedToCore(uploaderTask, "Uploader", 12288, NULL, 1, &uploaderTaskHandle, 1);
+
+  // The hardware timer only wakes the sampler; WiFi.RSSI() is not ISR safe
+  sampleTimer = timerBegin(0, 80, true);  // 1 MHz tick
+  timerAttachInterrupt(sampleTimer, &onSampleTimer, true);
+  timerAlarmWrite(sampleTimer, 1000000 / SAMPLE_RATE_HZ, true);
+  timerAlarmEnable(sampleTimer);
 }
-void loop() {
-  // Store measured value into point
-  sensor.clearFields();
-  // Report RSSI of currently connected network
-  sensor.addField("rssi", WiFi.RSSI());
-  // Print what are we exactly writing
-  Serial.print("Writing: ");
-  Serial.println(client.pointToLineProtocol(sensor));
-  // If no Wifi signal, try to reconnect it
-  if (wifiMulti.run() != WL_CONNECTED) {
-    Serial.println("Wifi connection lost");
-  }
-  // Write point
-  if (!client.writePoint(sensor)) {
-    Serial.print("InfluxDB write failed: ");
-    Serial.println(client.getLastErrorMessage());
-  }
 
-  //Wait 10s
-  Serial.println("Wait 10s");
-  delay(10000);
+void loop() {
+  // All work happens in the pipeline tasks
+  vTaskDelay(portMAX_DELAY);
 }
@@ -0,0 +1,522 @@
+// Host test: InfluxUploader against a local TLS stand-in for the InfluxDB
+// write API, built on lib/HostHAL (WiFiClientSecure is OpenSSL there).
+//
+// The stand-in generates a throwaway self-signed certificate for localhost,
+// which the uploader gets as its CA, so the handshake is verified exactly as
+// on the device. Each write is answered from a script: a status code, or a
+// dropped connection. Checked:
+//   - keep-alive: several flushes share one handshake
+//   - 400/401/413/422 drop the batch, transport errors, 429 and 5xx keep it
+//   - a dropped connection is re-established on the next flush
+//
+// With --bench it instead writes the same points per point and in batches,
+// and reports points/s and bytes on the wire per point: TLS records in both
+// directions, handshakes included, as counted on the server's socket (TCP/IP
+// headers not included).
+//
+// With --pipeline it runs the sketch's sampler, aggregator and uploader tasks
+// against the stand-in at 1, 10 and 100 Hz and reports each task's CPU time,
+// read through uxTaskGetSystemState() as printProfile() does on the device,
+// next to the uploader's wall time in calls (which includes the TLS round
+// trips). Intervals are 1 s instead of 10 s so a run sees several flushes;
+// the uploader's share at the sketch's cadence is a tenth of what it prints.
+//
+//   g++ -O2 -std=gnu++17 -pthread -I../../lib/HostHAL -I../lib/InfluxUploader
+//       -I../lib/LineProtocol -I../lib/SamplePipeline
+//       -o influx_tls_standin influx_tls_standin.cpp ../lib/InfluxUploader/InfluxUploader.cpp
+//       ../lib/LineProtocol/LineProtocol.cpp ../../lib/HostHAL/*.cpp -lssl -lcrypto
+//
+//   ./influx_tls_standin
+//   ./influx_tls_standin --bench
+//   ./influx_tls_standin --pipeline
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <HostTest.h>
+#include <WiFi.h>
+#include <esp_timer.h>
+
+#include "InfluxUploader.h"
+#include "LineProtocol.h"
+#include "RssiAggregator.h"
+#include "SampleRing.h"
+
+using HostTest::check;
+
+namespace {
+
+// Answer that closes the connection instead of sending a status
+const int DROP_CONNECTION = 0;
+
+class StandInServer {
+public:
+    bool start() {
+        if (!makeCertificate()) {
+            return false;
+        }
+        _fd = socket(AF_INET, SOCK_STREAM, 0);
+        int on = 1;
+        setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(_fd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(_fd, 4) != 0) {
+            return false;
+        }
+        socklen_t len = sizeof(addr);
+        getsockname(_fd, (sockaddr*)&addr, &len);
+        _port = ntohs(addr.sin_port);
+        std::thread(&StandInServer::acceptLoop, this).detach();
+        return true;
+    }
+
+    uint16_t port() const { return _port; }
+    const std::string& certificatePem() const { return _certPem; }
+
+    // Status for the next writes, in order; 204 once the script runs out
+    void script(std::initializer_list<int> codes) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _script.insert(_script.end(), codes.begin(), codes.end());
+    }
+
+    uint32_t connections() const { return _connections; }
+    uint32_t requests() const { return _requests; }
+    uint32_t linesAccepted() const { return _linesAccepted; }
+    uint64_t wireBytes() const { return _wireBytes; }
+
+private:
+    bool makeCertificate() {
+        EVP_PKEY* key = EVP_EC_gen("P-256");
+        X509* cert = X509_new();
+        if (!key || !cert) {
+            return false;
+        }
+        ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+        X509_gmtime_adj(X509_getm_notBefore(cert), -60);
+        X509_gmtime_adj(X509_getm_notAfter(cert), 3600);
+        X509_set_pubkey(cert, key);
+        X509_NAME* name = X509_get_subject_name(cert);
+        X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char*)"localhost", -1, -1, 0);
+        X509_set_issuer_name(cert, name);
+        X509_sign(cert, key, EVP_sha256());
+
+        BIO* bio = BIO_new(BIO_s_mem());
+        PEM_write_bio_X509(bio, cert);
+        char* data;
+        long len = BIO_get_mem_data(bio, &data);
+        _certPem.assign(data, len);
+        BIO_free(bio);
+
+        _ctx = SSL_CTX_new(TLS_server_method());
+        bool ok = SSL_CTX_use_certificate(_ctx, cert) == 1 && SSL_CTX_use_PrivateKey(_ctx, key) == 1;
+        X509_free(cert);
+        EVP_PKEY_free(key);
+        return ok;
+    }
+
+    void acceptLoop() {
+        while (true) {
+            int client = accept(_fd, nullptr, nullptr);
+            if (client < 0) {
+                continue;
+            }
+            _connections++;
+            std::thread(&StandInServer::serve, this, client).detach();
+        }
+    }
+
+    int nextCode() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_script.empty()) {
+            return 204;
+        }
+        int code = _script.front();
+        _script.pop_front();
+        return code;
+    }
+
+    void serve(int fd) {
+        SSL* ssl = SSL_new(_ctx);
+        SSL_set_fd(ssl, fd);
+        uint64_t counted = 0;
+        if (SSL_accept(ssl) == 1) {
+            std::string buffer;
+            while (handleRequest(ssl, buffer)) {
+                countWire(ssl, counted);
+            }
+        }
+        countWire(ssl, counted);
+        SSL_free(ssl);
+        close(fd);
+    }
+
+    // Raw socket bytes both ways since the last call on this connection
+    void countWire(SSL* ssl, uint64_t& counted) {
+        uint64_t total = BIO_number_read(SSL_get_rbio(ssl)) + BIO_number_written(SSL_get_wbio(ssl));
+        _wireBytes += total - counted;
+        counted = total;
+    }
+
+    // One keep-alive request; false when the connection is done
+    bool handleRequest(SSL* ssl, std::string& buffer) {
+        size_t headerEnd;
+        while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+            if (!readMore(ssl, buffer)) {
+                return false;
+            }
+        }
+        size_t bodyLength = 0;
+        size_t at = buffer.find("Content-Length: ");
+        if (at != std::string::npos && at < headerEnd) {
+            bodyLength = strtoul(buffer.c_str() + at + 16, nullptr, 10);
+        }
+        while (buffer.size() < headerEnd + 4 + bodyLength) {
+            if (!readMore(ssl, buffer)) {
+                return false;
+            }
+        }
+        std::string body = buffer.substr(headerEnd + 4, bodyLength);
+        buffer.erase(0, headerEnd + 4 + bodyLength);
+        _requests++;
+
+        int code = nextCode();
+        if (code == DROP_CONNECTION) {
+            return false;
+        }
+        if (code == 204) {
+            for (char c : body) {
+                _linesAccepted += c == '\n';
+            }
+        }
+        std::string error = code == 204 ? "" : "{\"code\":\"invalid\",\"message\":\"stand-in\"}";
+        char head[160];
+        snprintf(head, sizeof(head), "HTTP/1.1 %d Stand-in\r\nContent-Length: %u\r\n%s\r\n", code,
+                 (unsigned)error.size(), error.empty() ? "" : "Content-Type: application/json\r\n");
+        std::string response = head + error;
+        return SSL_write(ssl, response.data(), (int)response.size()) > 0;
+    }
+
+    static bool readMore(SSL* ssl, std::string& buffer) {
+        char chunk[4096];
+        int n = SSL_read(ssl, chunk, sizeof(chunk));
+        if (n <= 0) {
+            return false;
+        }
+        buffer.append(chunk, n);
+        return true;
+    }
+
+    SSL_CTX* _ctx = nullptr;
+    std::string _certPem;
+    int _fd = -1;
+    uint16_t _port = 0;
+    std::mutex _mutex;
+    std::deque<int> _script;
+    std::atomic<uint32_t> _connections{0};
+    std::atomic<uint32_t> _requests{0};
+    std::atomic<uint32_t> _linesAccepted{0};
+    std::atomic<uint64_t> _wireBytes{0};
+};
+
+// Queues a batch of points and flushes it
+bool writeBatch(InfluxUploader& uploader, int points) {
+    for (int i = 0; i < points; i++) {
+        char line[96];
+        int len = snprintf(line, sizeof(line), "wifi_status,device=ESP32 rssi=-%di,samples=100i %d", 50 + i,
+                           1700000000 + i);
+        uploader.add(line, len);
+    }
+    return uploader.flush();
+}
+
+// Writes `points` points in batches of batchSize; reconnect closes the
+// connection after every write, as without keep-alive
+void benchWrites(StandInServer& server, const std::string& url, const char* label, int points,
+                 size_t batchSize, bool reconnect) {
+    InfluxUploader uploader(url.c_str(), "org", "bucket", "token", server.certificatePem().c_str());
+    uploader.setBatching(batchSize, batchSize, 60000, 192);
+    uint32_t requestsBefore = server.requests();
+    uint64_t wireBefore = server.wireBytes();
+
+    unsigned long start = millis();
+    for (int i = 0; i < points; i += batchSize) {
+        writeBatch(uploader, std::min((int)batchSize, points - i));
+        if (reconnect) {
+            uploader.disconnect();
+        }
+    }
+    uploader.disconnect();
+    delay(50);  // let the server count the closing records
+    unsigned long ms = millis() - start;
+
+    const InfluxUploader::Stats& st = uploader.stats();
+    printf("%-30s %7.1f points/s  %7.1f wire bytes/point  %7.1f body bytes/point  %4u requests  "
+           "%3u handshakes\n",
+           label, points * 1000.0 / ms, (double)(server.wireBytes() - wireBefore) / points,
+           st.pointsWritten ? (double)st.bytesWritten / st.pointsWritten : 0.0,
+           server.requests() - requestsBefore, st.handshakes);
+}
+
+int runBench(StandInServer& server, const std::string& url) {
+    const int POINTS = 120;
+    printf("%d points each, TLS on loopback\n", POINTS);
+    benchWrites(server, url, "per point, new connection", POINTS, 1, true);
+    benchWrites(server, url, "per point, keep-alive", POINTS, 1, false);
+    benchWrites(server, url, "batch 6 (sketch default)", POINTS, 6, false);
+    benchWrites(server, url, "batch 30", POINTS, 30, false);
+    return 0;
+}
+
+// --- Pipeline profile (--pipeline) ------------------------------------------
+
+const unsigned long PIPELINE_RUN_MS = 12000;
+const unsigned long PIPELINE_INTERVAL_MS = 1000;
+const unsigned long PIPELINE_POLL_MS = 100;
+
+struct IntervalStats {
+    time_t timestamp;
+    uint32_t count;
+    int min;
+    int max;
+    int p95;
+    float mean;
+};
+
+struct Pipeline {
+    int rateHz = 10;
+    std::atomic<bool> stop{false};
+    SampleRing<int8_t, 256> ring;
+    QueueHandle_t statsQueue = nullptr;
+    LinePrefix prefix;
+    InfluxUploader* uploader = nullptr;
+    TaskHandle_t timer = nullptr;
+    TaskHandle_t sampler = nullptr;
+    TaskHandle_t aggregator = nullptr;
+    TaskHandle_t uploaderTask = nullptr;
+    std::atomic<uint32_t> intervals{0};
+    std::atomic<uint64_t> uploaderWallUs{0};
+};
+
+// Stands in for the hardware timer ISR, which only notifies the sampler
+void timerTask(void* arg) {
+    Pipeline& p = *(Pipeline*)arg;
+    TickType_t lastWake = xTaskGetTickCount();
+    while (!p.stop) {
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(1000 / p.rateHz));
+        xTaskNotifyGive(p.sampler);
+    }
+    xTaskNotifyGive(p.sampler);
+    vTaskDelete(NULL);
+}
+
+void samplerTask(void* arg) {
+    Pipeline& p = *(Pipeline*)arg;
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (p.stop) {
+            vTaskDelete(NULL);
+        }
+        p.ring.push((int8_t)WiFi.RSSI());
+    }
+}
+
+void aggregatorTask(void* arg) {
+    Pipeline& p = *(Pipeline*)arg;
+    RssiAggregator aggregator;
+    TickType_t lastWake = xTaskGetTickCount();
+    unsigned long intervalStart = millis();
+    while (!p.stop) {
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(PIPELINE_POLL_MS));
+        int8_t rssi;
+        while (p.ring.pop(rssi)) {
+            aggregator.add(rssi);
+        }
+        if (millis() - intervalStart >= PIPELINE_INTERVAL_MS) {
+            intervalStart += PIPELINE_INTERVAL_MS;
+            if (aggregator.count() > 0) {
+                IntervalStats stats = {time(nullptr), aggregator.count(), aggregator.min(), aggregator.max(),
+                                       aggregator.percentile(95), aggregator.mean()};
+                xQueueSend(p.statsQueue, &stats, 0);
+            }
+            aggregator.reset();
+        }
+    }
+    vTaskDelete(NULL);
+}
+
+void pipelineUploaderTask(void* arg) {
+    Pipeline& p = *(Pipeline*)arg;
+    IntervalStats stats;
+    while (true) {
+        if (xQueueReceive(p.statsQueue, &stats, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        // An empty interval is the stop signal
+        if (stats.count == 0) {
+            break;
+        }
+        int64_t start = esp_timer_get_time();
+        char line[192];
+        LineEncoder point(line, sizeof(line));
+        point.begin(p.prefix);
+        point.addIntField("rssi", lroundf(stats.mean));
+        point.addFloatField("rssi_mean", stats.mean);
+        point.addIntField("rssi_min", stats.min);
+        point.addIntField("rssi_max", stats.max);
+        point.addIntField("rssi_p95", stats.p95);
+        point.addIntField("samples", stats.count);
+        point.setTime((uint64_t)stats.timestamp);
+        p.uploader->add(line, point.length());
+        if (p.uploader->flushDue()) {
+            p.uploader->flush();
+        }
+        p.uploaderWallUs += esp_timer_get_time() - start;
+        p.intervals++;
+    }
+    vTaskDelete(NULL);
+}
+
+// Run time counters of the three pipeline tasks, as readTaskCpu() in the sketch
+void readTaskCpu(const Pipeline& p, uint32_t cpuUs[3]) {
+    const TaskHandle_t handles[3] = {p.sampler, p.aggregator, p.uploaderTask};
+    TaskStatus_t status[16];
+    UBaseType_t count = uxTaskGetSystemState(status, 16, nullptr);
+    memset(cpuUs, 0, 3 * sizeof(uint32_t));
+    for (UBaseType_t i = 0; i < count; i++) {
+        for (int t = 0; t < 3; t++) {
+            if (status[i].xHandle == handles[t]) {
+                cpuUs[t] = status[i].ulRunTimeCounter;
+            }
+        }
+    }
+}
+
+void profilePipeline(StandInServer& server, const std::string& url, int rateHz) {
+    Pipeline p;
+    p.rateHz = rateHz;
+    p.statsQueue = xQueueCreate(8, sizeof(IntervalStats));
+    p.prefix.setMeasurement("wifi_status");
+    p.prefix.addTag("device", "ESP32");
+    p.prefix.addTag("SSID", "standin");
+    InfluxUploader uploader(url.c_str(), "org", "bucket", "token", server.certificatePem().c_str());
+    uploader.setBatching(6, 30, 60000, 192);
+    p.uploader = &uploader;
+    uint32_t linesBefore = server.linesAccepted();
+
+    xTaskCreatePinnedToCore(samplerTask, "Sampler", 3072, &p, 3, &p.sampler, 1);
+    xTaskCreatePinnedToCore(aggregatorTask, "Aggregator", 3072, &p, 2, &p.aggregator, 1);
+    xTaskCreatePinnedToCore(pipelineUploaderTask, "Uploader", 12288, &p, 1, &p.uploaderTask, 1);
+    xTaskCreatePinnedToCore(timerTask, "SampleTimer", 2048, &p, 4, &p.timer, 1);
+    delay(20);
+    uint32_t before[3], after[3];
+    readTaskCpu(p, before);
+    unsigned long start = millis();
+    delay(PIPELINE_RUN_MS);
+    readTaskCpu(p, after);
+    float elapsedUs = (millis() - start) * 1000.0f;
+    p.stop = true;
+    IntervalStats last = {};
+    xQueueSend(p.statsQueue, &last, portMAX_DELAY);
+    delay(300);
+
+    uint32_t uploaderCpu = after[2] - before[2];
+    printf("%3d Hz  CPU: sampler %6.3f%%  aggregator %6.3f%%  uploader %6.3f%%   uploader wall in calls "
+           "%6.3f%%   %2u intervals, %2u points accepted, uploader CPU %5.0f us/interval\n",
+           rateHz, 100.0f * (after[0] - before[0]) / elapsedUs, 100.0f * (after[1] - before[1]) / elapsedUs,
+           100.0f * uploaderCpu / elapsedUs, 100.0f * p.uploaderWallUs / elapsedUs, (unsigned)p.intervals,
+           server.linesAccepted() - linesBefore, p.intervals ? (double)uploaderCpu / p.intervals : 0.0);
+    char what[64];
+    snprintf(what, sizeof(what), "%d Hz: every full batch reached the server", rateHz);
+    check(server.linesAccepted() - linesBefore == p.intervals / 6 * 6, what);
+    snprintf(what, sizeof(what), "%d Hz: run time counters cover all three tasks", rateHz);
+    check(after[0] > before[0] && after[1] > before[1] && uploaderCpu > 0, what);
+}
+
+int runPipeline(StandInServer& server, const std::string& url) {
+    hostAdoptTask("loopTask");
+    WiFi.mode(WIFI_STA);
+    WiFi.begin("standin");
+    while (WiFi.status() != WL_CONNECTED) {
+        delay(10);
+    }
+    printf("%lu ms per rate, %lu ms intervals, batches of 6\n", PIPELINE_RUN_MS, PIPELINE_INTERVAL_MS);
+    for (int rate : {1, 10, 100}) {
+        profilePipeline(server, url, rate);
+    }
+    return HostTest::finish();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    StandInServer server;
+    if (!server.start()) {
+        fprintf(stderr, "cannot start the TLS stand-in\n");
+        return 1;
+    }
+    std::string url = "https://localhost:" + std::to_string(server.port());
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        return runBench(server, url);
+    }
+    if (argc > 1 && strcmp(argv[1], "--pipeline") == 0) {
+        return runPipeline(server, url);
+    }
+    InfluxUploader uploader(url.c_str(), "org", "bucket", "token", server.certificatePem().c_str());
+    uploader.setBatching(6, 30, 60000, 192);
+    const InfluxUploader::Stats& st = uploader.stats();
+
+    // Keep-alive: one handshake for several writes
+    bool ok = writeBatch(uploader, 6) && writeBatch(uploader, 6) && writeBatch(uploader, 6);
+    check(ok && server.linesAccepted() == 18, "three batches written");
+    check(st.handshakes == 1 && server.connections() == 1, "one TLS handshake for three writes");
+
+    // Non-retryable: the batch is dropped, the connection stays up
+    for (int code : {400, 401, 413, 422}) {
+        server.script({code});
+        uint32_t dropped = st.pointsDropped;
+        writeBatch(uploader, 6);
+        char what[64];
+        snprintf(what, sizeof(what), "HTTP %d drops the batch", code);
+        check(st.pointsDropped == dropped + 6 && !uploader.flushDue(), what);
+    }
+    check(st.rejectedWrites == 4 && st.handshakes == 1, "rejections keep the connection");
+
+    // Retryable: the batch is kept and goes out on the next flush
+    for (int code : {429, 500, 503}) {
+        server.script({code});
+        uint32_t accepted = server.linesAccepted();
+        bool first = writeBatch(uploader, 6);
+        bool second = uploader.flush();
+        char what[64];
+        snprintf(what, sizeof(what), "HTTP %d keeps the batch for the retry", code);
+        check(!first && second && server.linesAccepted() == accepted + 6, what);
+    }
+
+    // Transport error: the server hangs up instead of answering
+    server.script({DROP_CONNECTION});
+    uint32_t accepted = server.linesAccepted();
+    uint32_t handshakes = st.handshakes;
+    bool first = writeBatch(uploader, 6);
+    bool second = uploader.flush();
+    check(!first && second && server.linesAccepted() == accepted + 6, "dropped connection keeps the batch");
+    check(st.handshakes == handshakes + 1, "the retry opens a new connection");
+
+    check(st.pointsDropped == 24, "only rejected points were dropped");
+    uploader.printStats();
+    return HostTest::finish();
+}
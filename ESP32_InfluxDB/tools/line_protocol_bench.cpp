@@ -0,0 +1,213 @@
+// Host micro-benchmark: encoding one interval point with LineEncoder versus
+// the way the InfluxDB client builds it (Point::addField/setTime and
+// pointToLineProtocol, one String per number, key and concatenation).
+//
+// The client library is Arduino-only, so its path is reproduced here with
+// std::string, which has a small-string buffer much like the ESP32 core's
+// String. Allocations are counted through operator new. The on-device
+// numbers for the real library come from BENCH_SUITE in src/main.cpp.
+//
+//   g++ -O2 -std=c++17 -I../lib/LineProtocol -o line_protocol_bench
+//       line_protocol_bench.cpp ../lib/LineProtocol/LineProtocol.cpp
+//
+//   ./line_protocol_bench [POINTS]
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+
+#include "LineProtocol.h"
+
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    if (void* p = malloc(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+namespace {
+
+struct IntervalStats {
+    uint64_t timestamp;
+    uint32_t count;
+    int min;
+    int max;
+    int p95;
+    float mean;
+};
+
+// --- Client library path ---------------------------------------------------
+
+std::string escapeKey(const std::string& key) {
+    std::string out;
+    out.reserve(key.length() + 5);
+    for (char c : key) {
+        if (c == ',' || c == '=' || c == ' ') {
+            out += '\\';
+        }
+        out += c;
+    }
+    return out;
+}
+
+std::string floatToString(float value, int decimals) {
+    char buf[33];
+    snprintf(buf, sizeof(buf), "%.*f", decimals, value);
+    return buf;
+}
+
+class LibraryPoint {
+public:
+    explicit LibraryPoint(const std::string& measurement) : _measurement(escapeKey(measurement)) {}
+
+    void addTag(const std::string& key, const std::string& value) {
+        if (!_tags.empty()) {
+            _tags += ',';
+        }
+        _tags += escapeKey(key) + '=' + escapeKey(value);
+    }
+    void addField(const std::string& name, int value) { putField(name, std::to_string(value) + "i"); }
+    void addField(const std::string& name, unsigned value) { putField(name, std::to_string(value) + "i"); }
+    void addField(const std::string& name, float value) {
+        if (!std::isnan(value)) {
+            putField(name, floatToString(value, 2));
+        }
+    }
+    void setTime(unsigned long long timestamp) { _timestamp = std::to_string(timestamp); }
+    // Frees the fields, so the next point grows them again
+    void clearFields() { std::string().swap(_fields); }
+
+    std::string toLineProtocol() const {
+        std::string line;
+        line.reserve(_measurement.length() + 1 + _tags.length() + 1 + _fields.length() + 1 + _timestamp.length());
+        line += _measurement;
+        line += ',';
+        line += _tags;
+        line += ' ';
+        line += _fields;
+        line += ' ';
+        line += _timestamp;
+        return line;
+    }
+
+private:
+    void putField(const std::string& name, const std::string& value) {
+        if (!_fields.empty()) {
+            _fields += ',';
+        }
+        _fields += escapeKey(name);
+        _fields += '=';
+        _fields += value;
+    }
+
+    std::string _measurement;
+    std::string _tags;
+    std::string _fields;
+    std::string _timestamp;
+};
+
+size_t encodeLibrary(LibraryPoint& point, const IntervalStats& stats, char* out) {
+    point.clearFields();
+    point.addField("rssi", (int)lroundf(stats.mean));
+    point.addField("rssi_mean", stats.mean);
+    point.addField("rssi_min", stats.min);
+    point.addField("rssi_max", stats.max);
+    point.addField("rssi_p95", stats.p95);
+    point.addField("samples", (unsigned)stats.count);
+    point.setTime(stats.timestamp);
+    std::string line = point.toLineProtocol();
+    memcpy(out, line.data(), line.length());
+    return line.length();
+}
+
+// --- LineEncoder path ------------------------------------------------------
+
+size_t encodeLine(const LinePrefix& prefix, const IntervalStats& stats, char* out, size_t size) {
+    LineEncoder point(out, size);
+    point.begin(prefix);
+    point.addIntField("rssi", lroundf(stats.mean));
+    point.addFloatField("rssi_mean", stats.mean);
+    point.addIntField("rssi_min", stats.min);
+    point.addIntField("rssi_max", stats.max);
+    point.addIntField("rssi_p95", stats.p95);
+    point.addIntField("samples", stats.count);
+    point.setTime(stats.timestamp);
+    return point.length();
+}
+
+IntervalStats sample(uint32_t i) {
+    // Varies every field so nothing is constant-folded
+    IntervalStats s;
+    s.timestamp = 1700000000ULL + i * 10;
+    s.count = 100 + i % 7;
+    s.min = -90 + (int)(i % 20);
+    s.max = -40 - (int)(i % 9);
+    s.p95 = -45 - (int)(i % 11);
+    s.mean = -65.0f + (i % 1000) * 0.013f;
+    return s;
+}
+
+template <typename Encode>
+void run(const char* name, uint32_t points, Encode encode) {
+    char line[256];
+    uint64_t bytes = 0;
+    size_t before = allocations;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < points; i++) {
+        bytes += encode(sample(i), line);
+        // Keep the compiler from dropping the encoded bytes
+        asm volatile("" : : "r"(line) : "memory");
+    }
+    double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("%-12s %10.0f points/s  %6.1f ns/point  %5.2f allocations/point  %5.1f bytes/point\n",
+           name, points / s, s * 1e9 / points, (double)(allocations - before) / points,
+           (double)bytes / points);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    uint32_t points = argc > 1 ? (uint32_t)atol(argv[1]) : 2000000;
+
+    LibraryPoint libraryPoint("wifi_status");
+    libraryPoint.addTag("device", "ESP32");
+    libraryPoint.addTag("SSID", "Office Wi-Fi");
+
+    LinePrefix prefix;
+    prefix.setMeasurement("wifi_status");
+    prefix.addTag("device", "ESP32");
+    prefix.addTag("SSID", "Office Wi-Fi");
+
+    // Both paths must produce the same bytes for the server
+    for (uint32_t i = 0; i < 100000; i++) {
+        char a[256], b[256];
+        size_t na = encodeLibrary(libraryPoint, sample(i), a);
+        size_t nb = encodeLine(prefix, sample(i), b, sizeof(b));
+        if (na != nb || memcmp(a, b, na) != 0) {
+            fprintf(stderr, "mismatch at %u:\n  %.*s\n  %.*s\n", i, (int)na, a, (int)nb, b);
+            return 1;
+        }
+    }
+
+    run("library", points, [&](const IntervalStats& s, char* out) {
+        return encodeLibrary(libraryPoint, s, out);
+    });
+    run("LineEncoder", points, [&](const IntervalStats& s, char* out) {
+        return encodeLine(prefix, s, out, 256);
+    });
+    return 0;
+}
@@ -1,6 +1,8 @@
 #include <WiFiClientSecure.h>
 #include <ArduinoJson.h>
 #include <UniversalTelegramBot.h>
+#include <WiFiConnectionManager.h>
+#include <NotificationQueue.h>
 
 const char *ssid = "";
 const char *password = "";
@@ -8,50 +10,143 @@ const char *password = "";
 #define botToken ""
 #define chatID ""
 
+// Long-poll wait for getUpdates; the server answers as soon as a message arrives
+#ifndef LONG_POLL_TIMEOUT_S
+#define LONG_POLL_TIMEOUT_S 30
+#endif
+#define STATS_INTERVAL_MS 600000
+
+// Outgoing rate limit, well under Telegram's per-chat limits
+#define NOTIFY_MESSAGES_PER_MINUTE 20
+#define NOTIFY_BURST 5
+
+// Outgoing messages typed on Serial
 WiFiClientSecure client;
 UniversalTelegramBot bot(botToken, client);
 
-void setup() {
-  Serial.begin(115200);
-  client.setInsecure();
-  WiFi.mode(WIFI_STA);
-  WiFi.begin(ssid, password);
-  while (WiFi.status() != WL_CONNECTED) {
-    delay(1000);
-    Serial.println("Connecting to WiFi...");
+// Rate-limited, coalescing queue in front of bot.sendMessage
+NotificationQueue notifications([](const String& text) {
+  return bot.sendMessage(chatID, text, "") ? 200 : -1;
+});
+
+// Incoming messages: long-polled from their own task on their own connection,
+// so a pending poll never holds up the loop
+WiFiClientSecure pollClient;
+UniversalTelegramBot pollBot(botToken, pollClient);
+TaskHandle_t pollTaskHandle = NULL;
+
+bool botStarted = false;
+volatile bool pollLinkDropped = false;
+unsigned long statsPrevMillis = 0;
+
+// Polling statistics
+volatile uint32_t pollRequests = 0;
+volatile uint32_t messagesHandled = 0;
+volatile uint32_t lastReplyLatencyS = 0;
+volatile uint32_t maxReplyLatencyS = 0;
+
+void handleMessage(const telegramMessage& msg) {
+  Serial.println("New message received");
+  pollBot.sendMessage(msg.chat_id, "Received your message: " + msg.text);
+  messagesHandled++;
+
+  // Message date is in Unix seconds; needs SNTP time to be meaningful
+  time_t now = time(nullptr);
+  long sent = msg.date.toInt();
+  if (now > 1600000000 && sent > 0 && now >= sent) {
+    lastReplyLatencyS = now - sent;
+    if (lastReplyLatencyS > maxReplyLatencyS) {
+      maxReplyLatencyS = lastReplyLatencyS;
+    }
   }
-  Serial.println("Connected to WiFi");
-  Serial.println("IP Address");
-  Serial.println(WiFi.localIP());
-  bot.sendMessage(chatID, "Code Started", "");
-  Serial.println("Bot connected");
 }
 
-void loop() {
-  if (WiFi.status() == WL_CONNECTED) {
-    int numNewMessages = bot.getUpdates(bot.last_message_received + 1);
+void pollTask(void* pvParameters) {
+  while (true) {
+    if (pollLinkDropped) {
+      pollLinkDropped = false;
+      pollClient.stop();
+    }
+    if (!Connectivity.connected()) {
+      vTaskDelay(pdMS_TO_TICKS(500));
+      continue;
+    }
 
-    while (numNewMessages) {
-      Serial.println("New message received");
-      String chat_id = bot.messages[0].chat_id;
-      String text = bot.messages[0].text;
+    // Blocks until messages arrive or the long-poll timeout expires
+    unsigned long start = millis();
+    int numNewMessages = pollBot.getUpdates(pollBot.last_message_received + 1);
+    pollRequests++;
 
-      bot.sendMessage(chat_id, "Received your message: " + text);
+    if (numNewMessages == 0 && millis() - start < 1000) {
+      // Returned early without a long poll: the request failed, don't spin
+      vTaskDelay(pdMS_TO_TICKS(1000));
+      continue;
+    }
 
-      bot.getUpdates(bot.last_message_received + 1);
-      numNewMessages--;
+    // Handle every message in the batch, not just the first one
+    for (int i = 0; i < numNewMessages; i++) {
+      handleMessage(pollBot.messages[i]);
     }
+  }
+}
 
-    if (Serial.available()) {
-      String input = Serial.readStringUntil('\n');
-      if (bot.sendMessage(chatID, input)) {
-        Serial.println("Message sent to Telegram");
-      } else {
-        Serial.println("Failed to send message to Telegram");
-      }
+void printPollStats() {
+  float hours = millis() / 3600000.0f;
+  Serial.printf("Telegram: %u getUpdates (%.1f/hour), %u messages, reply latency %u s (max %u s)\n",
+                pollRequests, hours > 0 ? pollRequests / hours : 0.0f, messagesHandled,
+                lastReplyLatencyS, maxReplyLatencyS);
+}
+
+void setup() {
+  Serial.begin(115200);
+  client.setInsecure();
+  pollClient.setInsecure();
+  pollBot.longPoll = LONG_POLL_TIMEOUT_S;
+
+  notifications.setRateLimit(NOTIFY_MESSAGES_PER_MINUTE, NOTIFY_BURST);
+  notifications.begin();
+
+  Connectivity.onConnected([]() {
+    Serial.println("Connected to WiFi");
+    Serial.println("IP Address");
+    Serial.println(WiFi.localIP());
+    // Wall-clock time for reply latency
+    configTime(0, 0, "pool.ntp.org");
+    if (!botStarted) {
+      botStarted = true;
+      notifications.push("Code Started");
+      Serial.println("Bot connected");
+      xTaskCreatePinnedToCore(pollTask, "TelegramPoll", 10240, NULL, 1, &pollTaskHandle, 1);
+    }
+  });
+  // The TLS socket does not survive a link drop; reopen it on the next request
+  Connectivity.onDisconnected([]() {
+    client.stop();
+    pollLinkDropped = true;
+  });
+  Serial.println("Connecting to WiFi...");
+  Connectivity.begin(ssid, password);
+}
+
+void loop() {
+  Connectivity.loop();
+
+  // Typed messages are queued even while offline and sent when possible
+  if (Serial.available()) {
+    String input = Serial.readStringUntil('\n');
+    if (notifications.push(input)) {
+      Serial.println("Message queued for Telegram");
+    } else {
+      Serial.println("Notification queue full, message dropped");
     }
-  } else {
-    Serial.println("WiFi Disconnected");
   }
-  delay(1000);
-}
\ No newline at end of file
+
+  // Runs offline too, so queued messages still reach flash
+  notifications.loop(Connectivity.connected());
+
+  if (millis() - statsPrevMillis > STATS_INTERVAL_MS) {
+    statsPrevMillis = millis();
+    printPollStats();
+    notifications.printStats();
+  }
+}
@@ -0,0 +1,4 @@
+#pragma once
+
+// The sketch includes ArduinoJson for UniversalTelegramBot; the host
+// stand-in bot next to this file parses its replies itself.
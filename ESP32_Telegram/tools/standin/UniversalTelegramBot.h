@@ -0,0 +1,181 @@
+#pragma once
+
+// Host stand-in for the calls of UniversalTelegramBot 1.3 that src/main.cpp
+// uses, over HostHAL's clients. Requests go out the way the library sends
+// them to the Bot API: one keep-alive connection per bot, getUpdates as a GET
+// with offset, limit=HANDLE_MESSAGES (1 in the library) and the long-poll
+// timeout in the query string, sendMessage as a POST with a JSON body. The
+// connection is closed after an empty reply, as the library does.
+//
+// TELEGRAM_SERVER=host:port points it at a stand-in server instead of
+// api.telegram.org:443.
+#include <Arduino.h>
+#include <Client.h>
+
+#define TELEGRAM_HOST "api.telegram.org"
+#define TELEGRAM_SSL_PORT 443
+#define HANDLE_MESSAGES 1
+
+struct telegramMessage {
+    String text;
+    String chat_id;
+    String chat_title;
+    String from_id;
+    String from_name;
+    String date;
+    String type;
+    int update_id = 0;
+    int message_id = 0;
+};
+
+class UniversalTelegramBot {
+public:
+    UniversalTelegramBot(const String& token, Client& client) : _token(token), _client(&client) {}
+
+    int getUpdates(long offset) {
+        String path = "/bot" + _token + "/getUpdates?offset=" + String(offset) + "&limit=" +
+                      String(HANDLE_MESSAGES);
+        if (longPoll > 0) {
+            path += "&timeout=" + String(longPoll);
+        }
+        String body = request("GET " + path + " HTTP/1.1\r\nHost: " TELEGRAM_HOST
+                              "\r\nAccept: application/json\r\nCache-Control: no-cache\r\n\r\n",
+                              "");
+        if (body.length() == 0) {
+            // Nothing to parse; the library drops the connection
+            _client->stop();
+            return 0;
+        }
+
+        int count = 0;
+        int at = body.indexOf("\"update_id\":");
+        while (at >= 0 && count < HANDLE_MESSAGES) {
+            telegramMessage& m = messages[count++];
+            m.update_id = value(body, "update_id", at).toInt();
+            m.message_id = value(body, "message_id", at).toInt();
+            m.from_id = value(body, "id", body.indexOf("\"from\":", at));
+            m.from_name = value(body, "first_name", at);
+            m.chat_id = value(body, "id", body.indexOf("\"chat\":", at));
+            m.type = "message";
+            m.date = value(body, "date", at);
+            m.text = value(body, "text", at);
+            last_message_received = m.update_id;
+            at = body.indexOf("\"update_id\":", at + 1);
+        }
+        return count;
+    }
+
+    bool sendMessage(const String& chat_id, const String& text, const String& parse_mode = "") {
+        String payload = "{\"chat_id\":" + quote(chat_id) + ",\"text\":" + quote(text) +
+                         ",\"parse_mode\":" + quote(parse_mode) + "}";
+        String body = request("POST /bot" + _token + "/sendMessage HTTP/1.1\r\nHost: " TELEGRAM_HOST
+                              "\r\nContent-Type: application/json\r\nContent-Length: " +
+                                  String((unsigned)payload.length()) + "\r\n\r\n",
+                              payload);
+        return body.indexOf("\"ok\":true") >= 0;
+    }
+
+    telegramMessage messages[HANDLE_MESSAGES];
+    long last_message_received = 0;
+    int longPoll = 0;
+    unsigned int waitForResponse = 1500;
+
+private:
+    bool connect() {
+        String host = TELEGRAM_HOST;
+        uint16_t port = TELEGRAM_SSL_PORT;
+        if (const char* server = getenv("TELEGRAM_SERVER")) {
+            String s = server;
+            int colon = s.indexOf(':');
+            host = colon > 0 ? s.substring(0, colon) : s;
+            port = colon > 0 ? (uint16_t)s.substring(colon + 1).toInt() : port;
+        }
+        return _client->connect(host.c_str(), port);
+    }
+
+    // Sends one request and returns the response body, or "" on failure
+    String request(const String& head, const String& body) {
+        if (!_client->connected() && !connect()) {
+            return "";
+        }
+        String message = head + body;
+        if (_client->write((const uint8_t*)message.c_str(), message.length()) != message.length()) {
+            _client->stop();
+            return "";
+        }
+
+        _client->setTimeout(waitForResponse + longPoll * 1000UL);
+        String status = _client->readStringUntil('\n');
+        long contentLength = 0;
+        while (true) {
+            String line = _client->readStringUntil('\n');
+            if (line.length() <= 1) {
+                break;
+            }
+            if (line.startsWith("Content-Length: ")) {
+                contentLength = line.substring(16).toInt();
+            }
+        }
+        String response;
+        for (long i = 0; i < contentLength; i++) {
+            char c;
+            if (_client->readBytes(&c, 1) != 1) {
+                break;
+            }
+            response += c;
+        }
+        if (status.length() < 12 || status.substring(9, 12) != "200") {
+            _client->stop();
+            return "";
+        }
+        return response;
+    }
+
+    // Value of the first "key": after from, unquoted; strings are unescaped
+    static String value(const String& json, const char* key, int from) {
+        if (from < 0) {
+            return "";
+        }
+        String pattern = String("\"") + key + "\":";
+        int at = json.indexOf(pattern, from);
+        if (at < 0) {
+            return "";
+        }
+        at += pattern.length();
+        String out;
+        if (json[at] != '"') {
+            while (at < (int)json.length() && json[at] != ',' && json[at] != '}') {
+                out += json[at++];
+            }
+            return out;
+        }
+        for (at++; at < (int)json.length() && json[at] != '"'; at++) {
+            char c = json[at];
+            if (c == '\\' && at + 1 < (int)json.length()) {
+                c = json[++at];
+                c = c == 'n' ? '\n' : c == 't' ? '\t' : c;
+            }
+            out += c;
+        }
+        return out;
+    }
+
+    static String quote(const String& s) {
+        String out = "\"";
+        for (size_t i = 0; i < s.length(); i++) {
+            char c = s[i];
+            if (c == '"' || c == '\\') {
+                out += '\\';
+                out += c;
+            } else if (c == '\n') {
+                out += "\\n";
+            } else {
+                out += c;
+            }
+        }
+        return out + "\"";
+    }
+
+    String _token;
+    Client* _client;
+};
@@ -0,0 +1,371 @@
+// Host test: the Telegram sketch (src/main.cpp, unchanged) against a local
+// TLS stand-in for the Bot API, on lib/HostHAL with the stand-in
+// UniversalTelegramBot from standin/.
+//
+// The stand-in holds getUpdates open for the requested timeout and answers
+// as soon as an update is queued, like the real long poll, and records every
+// sendMessage. The sketch is built with a 2 s long-poll timeout instead of
+// 30 s so the idle phase sees enough requests to count. Measured:
+//   - idle: getUpdates per hour with nothing to deliver, against 3600/timeout
+//   - burst: 20 messages queued at once, the time from queueing to the
+//     sketch's reply for each, and the requests that took
+// Checked: the idle rate follows the timeout, every burst message is
+// answered once and in order, and the boot notification goes out.
+//
+//   g++ -O2 -std=gnu++17 -pthread -DLONG_POLL_TIMEOUT_S=2 -Istandin -I../../lib/HostHAL
+//       -I../../lib/NotificationQueue -I../../lib/WiFiConnectionManager
+//       -o telegram_standin_test telegram_standin_test.cpp ../src/main.cpp
+//       ../../lib/NotificationQueue/NotificationQueue.cpp
+//       ../../lib/WiFiConnectionManager/WiFiConnectionManager.cpp ../../lib/HostHAL/*.cpp -lssl -lcrypto
+//
+//   ./telegram_standin_test
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Arduino.h>
+#include <HostTest.h>
+
+using HostTest::check;
+
+// Sketch statistics
+extern volatile uint32_t pollRequests;
+extern volatile uint32_t messagesHandled;
+extern volatile uint32_t maxReplyLatencyS;
+
+namespace {
+
+const unsigned long IDLE_MS = 30000;
+const int BURST = 20;
+const char* REPLY_PREFIX = "Received your message: ";
+
+class StandInServer {
+public:
+    bool start() {
+        if (!makeContext()) {
+            return false;
+        }
+        _fd = socket(AF_INET, SOCK_STREAM, 0);
+        int on = 1;
+        setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(_fd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(_fd, 4) != 0) {
+            return false;
+        }
+        socklen_t len = sizeof(addr);
+        getsockname(_fd, (sockaddr*)&addr, &len);
+        _port = ntohs(addr.sin_port);
+        std::thread(&StandInServer::acceptLoop, this).detach();
+        return true;
+    }
+
+    uint16_t port() const { return _port; }
+    uint32_t getUpdates() const { return _getUpdates; }
+    uint32_t connections() const { return _connections; }
+
+    // Queues a user message; a held getUpdates returns it right away
+    void queueMessage(const std::string& text) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _updates.push_back({_nextUpdateId++, text, (long)time(nullptr)});
+        _queued.notify_all();
+    }
+
+    struct Sent {
+        std::chrono::steady_clock::time_point at;
+        std::string text;
+    };
+
+    std::vector<Sent> sent() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _sent;
+    }
+
+private:
+    struct Update {
+        long id;
+        std::string text;
+        long date;
+    };
+
+    bool makeContext() {
+        EVP_PKEY* key = EVP_EC_gen("P-256");
+        X509* cert = X509_new();
+        if (!key || !cert) {
+            return false;
+        }
+        ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+        X509_gmtime_adj(X509_getm_notBefore(cert), -60);
+        X509_gmtime_adj(X509_getm_notAfter(cert), 3600);
+        X509_set_pubkey(cert, key);
+        X509_NAME* name = X509_get_subject_name(cert);
+        X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char*)"localhost", -1, -1, 0);
+        X509_set_issuer_name(cert, name);
+        X509_sign(cert, key, EVP_sha256());
+        _ctx = SSL_CTX_new(TLS_server_method());
+        bool ok = SSL_CTX_use_certificate(_ctx, cert) == 1 && SSL_CTX_use_PrivateKey(_ctx, key) == 1;
+        X509_free(cert);
+        EVP_PKEY_free(key);
+        return ok;
+    }
+
+    void acceptLoop() {
+        while (true) {
+            int client = accept(_fd, nullptr, nullptr);
+            if (client < 0) {
+                continue;
+            }
+            _connections++;
+            std::thread(&StandInServer::serve, this, client).detach();
+        }
+    }
+
+    void serve(int fd) {
+        SSL* ssl = SSL_new(_ctx);
+        SSL_set_fd(ssl, fd);
+        if (SSL_accept(ssl) == 1) {
+            std::string buffer;
+            while (handleRequest(ssl, buffer)) {
+            }
+        }
+        SSL_free(ssl);
+        close(fd);
+    }
+
+    static long queryLong(const std::string& target, const char* key) {
+        size_t at = target.find(key);
+        return at == std::string::npos ? 0 : atol(target.c_str() + at + strlen(key));
+    }
+
+    static std::string quote(const std::string& s) {
+        std::string out = "\"";
+        for (char c : s) {
+            if (c == '"' || c == '\\') {
+                out += '\\';
+            }
+            out += c;
+        }
+        return out + "\"";
+    }
+
+    static std::string unquote(const std::string& json, const char* key) {
+        std::string pattern = std::string("\"") + key + "\":\"";
+        size_t at = json.find(pattern);
+        std::string out;
+        if (at == std::string::npos) {
+            return out;
+        }
+        for (at += pattern.size(); at < json.size() && json[at] != '"'; at++) {
+            if (json[at] == '\\' && at + 1 < json.size()) {
+                at++;
+                out += json[at] == 'n' ? '\n' : json[at];
+            } else {
+                out += json[at];
+            }
+        }
+        return out;
+    }
+
+    // Long poll: drop confirmed updates, then wait up to timeout for one
+    std::string getUpdatesBody(const std::string& target) {
+        long offset = queryLong(target, "offset=");
+        long limit = std::max(1L, queryLong(target, "limit="));
+        long timeout = queryLong(target, "timeout=");
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (!_updates.empty() && _updates.front().id < offset) {
+            _updates.pop_front();
+        }
+        _queued.wait_for(lock, std::chrono::seconds(timeout), [this] { return !_updates.empty(); });
+        std::string body = "{\"ok\":true,\"result\":[";
+        for (long i = 0; i < limit && i < (long)_updates.size(); i++) {
+            const Update& u = _updates[i];
+            char head[256];
+            snprintf(head, sizeof(head),
+                     "%s{\"update_id\":%ld,\"message\":{\"message_id\":%ld,\"from\":{\"id\":7,\"is_bot\":false,"
+                     "\"first_name\":\"Tester\"},\"chat\":{\"id\":42,\"type\":\"private\"},\"date\":%ld,\"text\":",
+                     i ? "," : "", u.id, u.id, u.date);
+            body += head + quote(u.text) + "}}";
+        }
+        return body + "]}";
+    }
+
+    bool handleRequest(SSL* ssl, std::string& buffer) {
+        size_t headerEnd;
+        while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+            if (!readMore(ssl, buffer)) {
+                return false;
+            }
+        }
+        size_t bodyLength = 0;
+        size_t at = buffer.find("Content-Length: ");
+        if (at != std::string::npos && at < headerEnd) {
+            bodyLength = strtoul(buffer.c_str() + at + 16, nullptr, 10);
+        }
+        while (buffer.size() < headerEnd + 4 + bodyLength) {
+            if (!readMore(ssl, buffer)) {
+                return false;
+            }
+        }
+        std::string target = buffer.substr(0, buffer.find("\r\n"));
+        std::string body = buffer.substr(headerEnd + 4, bodyLength);
+        buffer.erase(0, headerEnd + 4 + bodyLength);
+
+        std::string reply;
+        if (target.find("/getUpdates") != std::string::npos) {
+            _getUpdates++;
+            reply = getUpdatesBody(target);
+        } else if (target.find("/sendMessage") != std::string::npos) {
+            std::string text = unquote(body, "text");
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _sent.push_back({std::chrono::steady_clock::now(), text});
+            }
+            reply = "{\"ok\":true,\"result\":{\"message_id\":1,\"chat\":{\"id\":42},\"text\":" + quote(text) + "}}";
+        } else {
+            reply = "{\"ok\":false,\"error_code\":404,\"description\":\"Not Found\"}";
+        }
+        char head[128];
+        snprintf(head, sizeof(head), "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: %u\r\n\r\n",
+                 (unsigned)reply.size());
+        std::string response = head + reply;
+        return SSL_write(ssl, response.data(), (int)response.size()) > 0;
+    }
+
+    static bool readMore(SSL* ssl, std::string& buffer) {
+        char chunk[4096];
+        int n = SSL_read(ssl, chunk, sizeof(chunk));
+        if (n <= 0) {
+            return false;
+        }
+        buffer.append(chunk, n);
+        return true;
+    }
+
+    SSL_CTX* _ctx = nullptr;
+    int _fd = -1;
+    uint16_t _port = 0;
+    std::mutex _mutex;
+    std::condition_variable _queued;
+    std::deque<Update> _updates;
+    long _nextUpdateId = 1;
+    std::vector<Sent> _sent;
+    std::atomic<uint32_t> _getUpdates{0};
+    std::atomic<uint32_t> _connections{0};
+};
+
+// The core runs loop() back to back; the pause keeps a 1-CPU host usable
+void loopTask(void*) {
+    while (true) {
+        loop();
+        delay(1);
+    }
+}
+
+bool waitFor(unsigned long timeoutMs, const std::function<bool()>& done) {
+    unsigned long start = millis();
+    while (millis() - start < timeoutMs) {
+        if (done()) {
+            return true;
+        }
+        delay(10);
+    }
+    return done();
+}
+
+size_t countSent(StandInServer& server, const std::string& prefix) {
+    size_t n = 0;
+    for (const auto& s : server.sent()) {
+        n += s.text.compare(0, prefix.size(), prefix) == 0;
+    }
+    return n;
+}
+
+}  // namespace
+
+int main() {
+    char fsDir[] = "/tmp/telegram_fs_XXXXXX";
+    char nvsDir[] = "/tmp/telegram_nvs_XXXXXX";
+    setenv("HOST_FS_DIR", mkdtemp(fsDir), 1);
+    setenv("HOST_NVS_DIR", mkdtemp(nvsDir), 1);
+
+    StandInServer server;
+    if (!server.start()) {
+        fprintf(stderr, "cannot start the Bot API stand-in\n");
+        return 1;
+    }
+    std::string address = "127.0.0.1:" + std::to_string(server.port());
+    setenv("TELEGRAM_SERVER", address.c_str(), 1);
+
+    hostAdoptTask("loopTask");
+    setup();
+    xTaskCreate(loopTask, "SketchLoop", 8192, nullptr, 1, nullptr);
+
+    check(waitFor(10000, [&] { return countSent(server, "Code Started") == 1; }), "boot notification sent");
+    check(waitFor(10000, [] { return pollRequests > 0; }), "poll task running");
+
+    // Idle: nothing queued, every getUpdates runs into the long-poll timeout
+    uint32_t before = server.getUpdates();
+    unsigned long start = millis();
+    delay(IDLE_MS);
+    uint32_t idleRequests = server.getUpdates() - before;
+    double perHour = idleRequests * 3600000.0 / (millis() - start);
+    double expected = 3600.0 / LONG_POLL_TIMEOUT_S;
+    printf("idle: %u getUpdates in %lu ms = %.0f/hour at a %d s timeout (%.0f/hour expected; 120/hour at 30 s, "
+           "3600/hour for a 1 s poll)\n",
+           idleRequests, IDLE_MS, perHour, LONG_POLL_TIMEOUT_S, expected);
+    check(perHour <= expected * 1.1 && perHour >= expected * 0.8, "idle: one request per long-poll timeout");
+
+    // Burst: 20 messages queued at once
+    before = server.getUpdates();
+    uint32_t connectionsBefore = server.connections();
+    auto queued = std::chrono::steady_clock::now();
+    for (int i = 0; i < BURST; i++) {
+        server.queueMessage("burst " + std::to_string(i));
+    }
+    bool answered = waitFor(30000, [&] { return countSent(server, REPLY_PREFIX) >= (size_t)BURST; });
+    std::vector<double> latencies;
+    std::vector<std::string> order;
+    for (const auto& s : server.sent()) {
+        if (s.text.compare(0, strlen(REPLY_PREFIX), REPLY_PREFIX) == 0) {
+            latencies.push_back(std::chrono::duration<double, std::milli>(s.at - queued).count());
+            order.push_back(s.text.substr(strlen(REPLY_PREFIX)));
+        }
+    }
+    uint32_t burstRequests = server.getUpdates() - before;
+    if (!latencies.empty()) {
+        printf("burst: %d messages, reply latency first %.1f ms, median %.1f ms, last %.1f ms; %u getUpdates, "
+               "%u new connections; sketch max latency %u s\n",
+               BURST, latencies.front(), latencies[latencies.size() / 2], latencies.back(), burstRequests,
+               server.connections() - connectionsBefore, maxReplyLatencyS);
+    }
+    bool inOrder = order.size() == (size_t)BURST;
+    for (size_t i = 0; inOrder && i < order.size(); i++) {
+        inOrder = order[i] == "burst " + std::to_string(i);
+    }
+    check(answered && messagesHandled == (uint32_t)BURST, "burst: every message handled");
+    check(inOrder, "burst: replies once each, in order");
+
+    // The sketch's tasks still hold the clients; leave without destructors
+    int result = HostTest::finish();
+    fflush(stdout);
+    _exit(result);
+}
@@ -1,6 +1,9 @@
 #include <HTTPClient.h>
-#include <UrlEncode.h>
+#include <WiFiClientSecure.h>
 #include <WiFi.h>
+#include <WiFiConnectionManager.h>
+#include <NotificationQueue.h>
+#include <esp_heap_caps.h>
 
 const char *ssid = "";
 const char *password = "";
@@ -10,46 +13,194 @@ const char *password = "";
 String phoneNumber = "";
 String apiKey = "";
 
-void sendMessage(String message) {
+// CallMeBot throttles aggressively; keep well below its limits
+#define NOTIFY_MESSAGES_PER_MINUTE 4
+#define NOTIFY_BURST 2
 
-  // Data to send with HTTP POST
-  String url = "https://api.callmebot.com/whatsapp.php?phone=" + phoneNumber +
-               "&apikey=" + apiKey + "&text=" + urlEncode(message);
-  HTTPClient http;
-  http.begin(url);
+bool greetingSent = false;
 
-  // Specify content-type header
-  http.addHeader("Content-Type", "application/x-www-form-urlencoded");
+// Fixed buffer for the request URL; no String temporaries per message
+#define URL_BUFFER_SIZE 1024
+// Keeps the percent-encoded text comfortably inside the URL buffer
+#define MAX_MESSAGE_LENGTH 250
+// Send this many messages straight after connecting and print latency/heap
+// figures (0 disables; CallMeBot will throttle a real number)
+#define BENCH_MESSAGES 0
 
-  // Send HTTP POST request
-  int httpResponseCode = http.POST(url);
+// One TLS connection reused for every message (HTTP keep-alive)
+WiFiClientSecure tlsClient;
+HTTPClient http;
+
+// Per-message instrumentation
+uint32_t messagesSent = 0;
+uint32_t connectionsOpened = 0;
+uint32_t lastLatencyMs = 0;
+uint32_t maxLatencyMs = 0;
+uint64_t totalLatencyMs = 0;
+
+// Lowest free heap seen while the benchmark runs. ESP.getMinFreeHeap() is
+// the low point since boot (WiFi bring-up included), and the TLS handshake
+// allocates and frees inside http.GET(), so a task samples it instead.
+#define HEAP_SAMPLE_MS 1
+volatile bool heapSampling = false;
+volatile uint32_t heapLowDuringRun = UINT32_MAX;
+TaskHandle_t heapSamplerHandle = NULL;
+
+// Append src to dst[len..cap), percent-encoding everything outside the
+// RFC 3986 unreserved set. Stops early if the buffer is full.
+static bool appendEncoded(char* dst, size_t cap, size_t& len, const char* src) {
+  static const char hex[] = "0123456789ABCDEF";
+  for (; *src; src++) {
+    uint8_t c = (uint8_t)*src;
+    bool plain = isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~';
+    size_t need = plain ? 1 : 3;
+    if (len + need >= cap) {
+      dst[len] = '\0';
+      return false;
+    }
+    if (plain) {
+      dst[len++] = c;
+    } else {
+      dst[len++] = '%';
+      dst[len++] = hex[c >> 4];
+      dst[len++] = hex[c & 0x0F];
+    }
+  }
+  dst[len] = '\0';
+  return true;
+}
+
+static bool appendRaw(char* dst, size_t cap, size_t& len, const char* src) {
+  size_t n = strlen(src);
+  if (len + n >= cap) {
+    return false;
+  }
+  memcpy(dst + len, src, n + 1);
+  len += n;
+  return true;
+}
+
+int sendMessage(const String& message) {
+  char url[URL_BUFFER_SIZE];
+  size_t len = 0;
+
+  appendRaw(url, sizeof(url), len, "https://api.callmebot.com/whatsapp.php?phone=");
+  appendEncoded(url, sizeof(url), len, phoneNumber.c_str());
+  appendRaw(url, sizeof(url), len, "&apikey=");
+  appendEncoded(url, sizeof(url), len, apiKey.c_str());
+  appendRaw(url, sizeof(url), len, "&text=");
+  if (!appendEncoded(url, sizeof(url), len, message.c_str())) {
+    Serial.println("Message truncated to fit the request URL");
+  }
+
+  unsigned long start = millis();
+  if (!tlsClient.connected()) {
+    connectionsOpened++;
+  }
+
+  // CallMeBot takes everything from the query string, so a plain GET does
+  http.begin(tlsClient, url);
+  int httpResponseCode = http.GET();
   if (httpResponseCode == 200) {
-    Serial.print("Message sent successfully");
+    Serial.println("Message sent successfully");
   } else {
     Serial.println("Error sending the message");
     Serial.print("HTTP response code: ");
     Serial.println(httpResponseCode);
   }
-
-  // Free resources
+  // Keeps the connection open when the server allows keep-alive
   http.end();
+
+  lastLatencyMs = millis() - start;
+  totalLatencyMs += lastLatencyMs;
+  if (lastLatencyMs > maxLatencyMs) {
+    maxLatencyMs = lastLatencyMs;
+  }
+  messagesSent++;
+  return httpResponseCode;
 }
 
+void heapSamplerTask(void* pvParameters) {
+  while (heapSampling) {
+    uint32_t freeNow = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    if (freeNow < heapLowDuringRun) {
+      heapLowDuringRun = freeNow;
+    }
+    vTaskDelay(pdMS_TO_TICKS(HEAP_SAMPLE_MS));
+  }
+  heapSamplerHandle = NULL;
+  vTaskDelete(NULL);
+}
+
+void startHeapSampling() {
+  heapLowDuringRun = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  heapSampling = true;
+  // Above loop() and on the other core, so it keeps sampling mid-handshake
+  xTaskCreatePinnedToCore(heapSamplerTask, "HeapSampler", 2048, NULL, 2, &heapSamplerHandle, 0);
+}
+
+void stopHeapSampling() {
+  heapSampling = false;
+  while (heapSamplerHandle != NULL) {
+    delay(HEAP_SAMPLE_MS);
+  }
+}
+
+void printSendStats(uint32_t heapBefore) {
+  Serial.printf("WhatsApp: %u messages, latency last %u ms, avg %.1f ms, max %u ms, "
+                "%u TLS connections opened\n",
+                messagesSent, lastLatencyMs,
+                messagesSent ? (float)totalLatencyMs / messagesSent : 0.0f, maxLatencyMs,
+                connectionsOpened);
+  Serial.printf("Heap: free %u before, %u after, low %u during sends (peak use %u bytes, "
+                "sampled every %u ms); min free since boot %u\n",
+                heapBefore, ESP.getFreeHeap(), heapLowDuringRun,
+                heapBefore > heapLowDuringRun ? heapBefore - heapLowDuringRun : 0, HEAP_SAMPLE_MS,
+                ESP.getMinFreeHeap());
+}
+
+void runBenchmark() {
+  uint32_t heapBefore = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  startHeapSampling();
+  for (int i = 0; i < BENCH_MESSAGES; i++) {
+    sendMessage("Benchmark message " + String(i + 1) + "/" + String(BENCH_MESSAGES));
+  }
+  stopHeapSampling();
+  printSendStats(heapBefore);
+}
+
+// Rate-limited, coalescing queue in front of sendMessage()
+NotificationQueue notifications(sendMessage);
+
 void setup() {
   Serial.begin(115200);
 
-  WiFi.begin(ssid, password);
-  Serial.println("Connecting");
-  while (WiFi.status() != WL_CONNECTED) {
-    delay(500);
-    Serial.print(".");
-  }
-  Serial.println("");
-  Serial.print("Connected to WiFi network with IP Address: ");
-  Serial.println(WiFi.localIP());
+  tlsClient.setInsecure();
+  http.setReuse(true);
 
-  // Send Message to WhatsAPP
-  sendMessage("Hello from ESP32!");
+  notifications.setRateLimit(NOTIFY_MESSAGES_PER_MINUTE, NOTIFY_BURST);
+  notifications.setMaxMessageLength(MAX_MESSAGE_LENGTH);
+  notifications.begin();
+
+  Connectivity.onConnected([]() {
+    Serial.print("Connected to WiFi network with IP Address: ");
+    Serial.println(WiFi.localIP());
+
+    // Send Message to WhatsAPP once the first connection is up
+    if (!greetingSent) {
+      greetingSent = true;
+      notifications.push("Hello from ESP32!");
+      if (BENCH_MESSAGES > 0) {
+        runBenchmark();
+      }
+    }
+  });
+  Serial.println("Connecting");
+  Connectivity.begin(ssid, password);
 }
 
-void loop() {}
\ No newline at end of file
+void loop() {
+  Connectivity.loop();
+  // Runs offline too, so queued messages still reach flash
+  notifications.loop(Connectivity.connected());
+}
@@ -0,0 +1,399 @@
+// Host test for lib/NotificationQueue on lib/HostHAL, against a local HTTP
+// stand-in for the messaging API that answers each request from a script:
+// 200 by default, or 429, 400 or 403.
+//
+// The transport is an HTTPClient GET with the text in the query string, as
+// the sketch sends it to CallMeBot. The rate limit is 120 messages a minute
+// with a burst of 5 instead of the sketch's 4 and 2, so the runs take
+// seconds. Checked and measured:
+//   - a burst of 1000 events from 40 sources: push cost, requests and time
+//     to drain, every event delivered or counted as dropped
+//   - dequeue rate against a backlog of distinct messages, and no 1 s window
+//     with more requests than the token bucket allows
+//   - 429 keeps the message and retries after the backoff; 400/403 drop it,
+//     count it as rejected and do not hold up the next one
+//   - messages queued offline survive a restart (LittleFS in HOST_FS_DIR)
+//   - truncation keeps multi-byte characters whole and the "(xN)" note
+//
+//   g++ -O2 -std=gnu++17 -pthread -I../../lib/HostHAL -I../../lib/NotificationQueue
+//       -o notification_queue_test notification_queue_test.cpp
+//       ../../lib/NotificationQueue/NotificationQueue.cpp ../../lib/HostHAL/*.cpp -lssl -lcrypto
+//
+//   ./notification_queue_test
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Arduino.h>
+#include <HTTPClient.h>
+#include <HostTest.h>
+
+#include "NotificationQueue.h"
+
+using HostTest::check;
+
+namespace {
+
+const float MESSAGES_PER_MINUTE = 120;
+const uint8_t BURST = 5;
+
+class StandInServer {
+public:
+    bool start() {
+        _fd = socket(AF_INET, SOCK_STREAM, 0);
+        int on = 1;
+        setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(_fd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(_fd, 8) != 0) {
+            return false;
+        }
+        socklen_t len = sizeof(addr);
+        getsockname(_fd, (sockaddr*)&addr, &len);
+        _port = ntohs(addr.sin_port);
+        std::thread(&StandInServer::acceptLoop, this).detach();
+        return true;
+    }
+
+    uint16_t port() const { return _port; }
+
+    // Status codes for the next requests; 200 once the script runs out
+    void script(std::initializer_list<int> codes) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _script.assign(codes.begin(), codes.end());
+    }
+
+    struct Request {
+        unsigned long at;
+        int code;
+        std::string text;
+    };
+
+    std::vector<Request> requests() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _requests;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _requests.clear();
+        _script.clear();
+    }
+
+private:
+    void acceptLoop() {
+        while (true) {
+            int client = accept(_fd, nullptr, nullptr);
+            if (client >= 0) {
+                serve(client);
+                close(client);
+            }
+        }
+    }
+
+    // One request per connection; HTTPClient reconnects after Connection: close
+    void serve(int fd) {
+        std::string head;
+        char c;
+        while (head.find("\r\n\r\n") == std::string::npos && read(fd, &c, 1) == 1) {
+            head += c;
+        }
+        size_t at = head.find("text=");
+        size_t end = head.find(' ', at);
+        if (at == std::string::npos || end == std::string::npos) {
+            return;
+        }
+        std::string text = decode(head.substr(at + 5, end - at - 5));
+
+        int code = 200;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_script.empty()) {
+                code = _script.front();
+                _script.pop_front();
+            }
+            _requests.push_back({millis(), code, text});
+        }
+        char response[128];
+        int n = snprintf(response, sizeof(response),
+                         "HTTP/1.1 %d Status\r\nContent-Length: 2\r\nConnection: close\r\n\r\nok", code);
+        write(fd, response, n);
+    }
+
+    static std::string decode(const std::string& s) {
+        std::string out;
+        for (size_t i = 0; i < s.size(); i++) {
+            if (s[i] == '%' && i + 2 < s.size()) {
+                out += (char)strtol(s.substr(i + 1, 2).c_str(), nullptr, 16);
+                i += 2;
+            } else {
+                out += s[i] == '+' ? ' ' : s[i];
+            }
+        }
+        return out;
+    }
+
+    int _fd = -1;
+    uint16_t _port = 0;
+    std::mutex _mutex;
+    std::deque<int> _script;
+    std::vector<Request> _requests;
+};
+
+String baseUrl;
+
+String encode(const String& text) {
+    static const char* hex = "0123456789ABCDEF";
+    String out;
+    for (size_t i = 0; i < text.length(); i++) {
+        uint8_t c = (uint8_t)text[i];
+        if (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
+            out += (char)c;
+        } else {
+            out += '%';
+            out += hex[c >> 4];
+            out += hex[c & 0x0F];
+        }
+    }
+    return out;
+}
+
+int sendToStandIn(const String& text) {
+    HTTPClient http;
+    http.begin(baseUrl + "/send?text=" + encode(text));
+    int code = http.GET();
+    http.end();
+    return code;
+}
+
+double threadMicros() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+// Runs loop() every 5 ms until nothing is pending; returns the milliseconds
+// it took, or -1 on timeout
+long drain(NotificationQueue& queue, unsigned long timeoutMs) {
+    unsigned long start = millis();
+    while (millis() - start < timeoutMs) {
+        queue.loop(true);
+        if (queue.pending() == 0) {
+            return (long)(millis() - start);
+        }
+        delay(5);
+    }
+    return -1;
+}
+
+// Most requests the server saw in any window of windowMs
+size_t busiestWindow(const std::vector<StandInServer::Request>& requests, unsigned long windowMs) {
+    size_t most = 0;
+    for (size_t i = 0; i < requests.size(); i++) {
+        size_t n = 0;
+        for (size_t j = i; j < requests.size() && requests[j].at - requests[i].at < windowMs; j++) {
+            n++;
+        }
+        most = n > most ? n : most;
+    }
+    return most;
+}
+
+void testBurst(StandInServer& server) {
+    server.clear();
+    NotificationQueue queue(sendToStandIn);
+    queue.setRateLimit(MESSAGES_PER_MINUTE, BURST);
+    queue.begin("/nq_burst.txt");
+
+    // 1000 events from 40 sources over about 2 s, the loop running between them
+    const int EVENTS = 1000, SOURCES = 40;
+    double pushUs = 0;
+    for (int i = 0; i < EVENTS; i++) {
+        char text[48];
+        snprintf(text, sizeof(text), "sensor %02d over limit", i % SOURCES);
+        double start = threadMicros();
+        queue.push(text);
+        pushUs += threadMicros() - start;
+        if (i % 5 == 0) {
+            queue.loop(true);
+            delay(10);
+        }
+    }
+    long drainMs = drain(queue, 30000);
+    const NotificationQueue::Stats& st = queue.stats();
+    printf("burst: %d events, %.2f us per push, %u coalesced, %u dropped, %u requests (%u digests), "
+           "drained %ld ms after the last event\n",
+           EVENTS, pushUs / EVENTS, st.coalesced, st.dropped, st.sends, st.digests, drainMs);
+    check(drainMs >= 0, "burst: queue drains");
+    check(st.delivered + st.dropped == (uint32_t)EVENTS, "burst: every event delivered or counted as dropped");
+    check(st.sends <= BURST + 3 * MESSAGES_PER_MINUTE / 60 + 2, "burst: a handful of requests, not one per event");
+}
+
+void testDequeueRate(StandInServer& server) {
+    server.clear();
+    NotificationQueue queue(sendToStandIn);
+    queue.setRateLimit(MESSAGES_PER_MINUTE, BURST);
+    queue.begin("/nq_rate.txt");
+
+    // One distinct message per loop, so every request carries a single one
+    const int MESSAGES = 20;
+    int pushed = 0;
+    unsigned long start = millis();
+    while (queue.stats().delivered < (uint32_t)MESSAGES && millis() - start < 30000) {
+        if (pushed < MESSAGES && queue.pending() == 0) {
+            queue.push("event " + String(pushed++));
+        }
+        queue.loop(true);
+        delay(5);
+    }
+    unsigned long ms = millis() - start;
+    std::vector<StandInServer::Request> requests = server.requests();
+    size_t busiest = busiestWindow(requests, 1000);
+    printf("dequeue: %d messages in %lu ms, %.2f messages/s (limit %.1f/s after a burst of %u), busiest 1 s: "
+           "%u requests\n",
+           MESSAGES, ms, MESSAGES * 1000.0 / ms, MESSAGES_PER_MINUTE / 60, BURST, (unsigned)busiest);
+    check(queue.stats().delivered == (uint32_t)MESSAGES, "rate: all messages delivered");
+    check(busiest <= BURST + (size_t)(MESSAGES_PER_MINUTE / 60), "rate: no 1 s window over the token bucket");
+    check(ms >= (MESSAGES - BURST - 1) * 60000.0 / MESSAGES_PER_MINUTE, "rate: sustained rate held to the limit");
+}
+
+void testStatusCodes(StandInServer& server) {
+    server.clear();
+    NotificationQueue queue(sendToStandIn);
+    queue.setRateLimit(MESSAGES_PER_MINUTE, BURST);
+    queue.begin("/nq_codes.txt");
+    const NotificationQueue::Stats& st = queue.stats();
+
+    server.script({429});
+    queue.push("throttled");
+    queue.loop(true);
+    check(queue.pending() == 1 && st.failedSends == 1 && st.rejected == 0, "429: message kept");
+    long retryMs = drain(queue, 10000);
+    printf("429: retried and delivered after %ld ms\n", retryMs);
+    check(retryMs >= 1900 && st.delivered == 1, "429: delivered after the backoff");
+
+    for (int code : {400, 403}) {
+        server.script({code});
+        uint32_t rejected = st.rejected;
+        queue.push("refused " + String(code));
+        queue.loop(true);
+        queue.push("next after " + String(code));
+        queue.loop(true);
+        char what[64];
+        snprintf(what, sizeof(what), "HTTP %d: message dropped and counted", code);
+        check(st.rejected == rejected + 1 && queue.pending() == 0, what);
+        std::vector<StandInServer::Request> requests = server.requests();
+        snprintf(what, sizeof(what), "HTTP %d: next message goes out without a backoff", code);
+        check(!requests.empty() && requests.back().code == 200 &&
+                  requests.back().text == ("next after " + std::to_string(code)),
+              what);
+    }
+}
+
+void testPersistence(StandInServer& server) {
+    server.clear();
+    const char* path = "/nq_persist.txt";
+    const char* texts[] = {"door open", "line one\nline two", "back\\slash"};
+    {
+        NotificationQueue queue(sendToStandIn);
+        queue.begin(path);
+        for (const char* t : texts) {
+            queue.push(t);
+        }
+        queue.push("door open");
+        // Saves are debounced by 5 s
+        unsigned long start = millis();
+        while (millis() - start < 5500) {
+            queue.loop(false);
+            delay(50);
+        }
+    }
+    check(server.requests().empty(), "offline: nothing sent");
+
+    NotificationQueue restarted(sendToStandIn);
+    restarted.setRateLimit(MESSAGES_PER_MINUTE, BURST);
+    restarted.begin(path);
+    check(restarted.pending() == 3, "restart: three messages restored");
+    drain(restarted, 5000);
+    std::vector<StandInServer::Request> requests = server.requests();
+    std::string digest = requests.empty() ? "" : requests.back().text;
+    check(digest.find("door open (x2)") != std::string::npos &&
+              digest.find("line one\nline two") != std::string::npos &&
+              digest.find("back\\slash") != std::string::npos,
+          "restart: texts and counts survive");
+}
+
+bool validUtf8(const std::string& s) {
+    for (size_t i = 0; i < s.size();) {
+        uint8_t c = (uint8_t)s[i];
+        size_t n = c < 0x80 ? 1 : (c & 0xE0) == 0xC0 ? 2 : (c & 0xF0) == 0xE0 ? 3 : (c & 0xF8) == 0xF0 ? 4 : 0;
+        if (n == 0 || i + n > s.size()) {
+            return false;
+        }
+        for (size_t k = 1; k < n; k++) {
+            if (((uint8_t)s[i + k] & 0xC0) != 0x80) {
+                return false;
+            }
+        }
+        i += n;
+    }
+    return true;
+}
+
+void testTruncation(StandInServer& server) {
+    server.clear();
+    NotificationQueue queue(sendToStandIn);
+    queue.setRateLimit(MESSAGES_PER_MINUTE, BURST);
+    queue.setMaxMessageLength(40);
+    queue.begin("/nq_utf8.txt");
+
+    // 2-, 3- and 4-byte characters, so some cut lands mid-character
+    String text = "Temp ";
+    for (int i = 0; i < 8; i++) {
+        text += "é€😀";
+    }
+    for (int i = 0; i < 3; i++) {
+        queue.push(text);
+    }
+    drain(queue, 5000);
+    std::vector<StandInServer::Request> requests = server.requests();
+    std::string sent = requests.empty() ? "" : requests.back().text;
+    printf("truncated to %u of 40 bytes: %s\n", (unsigned)sent.size(), sent.c_str());
+    check(sent.size() <= 40 && validUtf8(sent), "long message: cut on a character boundary");
+    check(sent.size() >= 5 && sent.compare(sent.size() - 5, 5, " (x3)") == 0, "long message: keeps its count");
+}
+
+}  // namespace
+
+int main() {
+    hostAdoptTask("loopTask");
+    char fsDir[] = "/tmp/notification_queue_XXXXXX";
+    setenv("HOST_FS_DIR", mkdtemp(fsDir), 1);
+
+    StandInServer server;
+    if (!server.start()) {
+        fprintf(stderr, "cannot start the API stand-in\n");
+        return 1;
+    }
+    baseUrl = "http://127.0.0.1:" + String(server.port());
+
+    testBurst(server);
+    testDequeueRate(server);
+    testStatusCodes(server);
+    testPersistence(server);
+    testTruncation(server);
+    return HostTest::finish();
+}
@@ -0,0 +1,107 @@
+#include "RtdbWriteCoalescer.h"
+
+RtdbWriteCoalescer::Field* RtdbWriteCoalescer::field(const char* key, bool isInt) {
+    for (auto& f : _fields) {
+        if (f.key == key) {
+            return &f;
+        }
+    }
+
+    Field f;
+    f.key = key;
+    f.isInt = isInt;
+    f.intValue = 0;
+    f.sentInt = 0;
+    f.deadband = 0;
+    f.sent = false;
+    f.dirty = false;
+    _fields.push_back(f);
+    return &_fields.back();
+}
+
+void RtdbWriteCoalescer::setInt(const char* key, int value, int deadband) {
+    Field* f = field(key, true);
+    f->intValue = value;
+    f->deadband = deadband;
+
+    bool changed = !f->sent || abs(value - f->sentInt) > deadband;
+    if (!changed) {
+        _stats.suppressed++;
+    }
+    // Once dirty, a field stays dirty until written, even if it drifts back
+    f->dirty = f->dirty || changed;
+}
+
+void RtdbWriteCoalescer::setString(const char* key, const String& value) {
+    Field* f = field(key, false);
+    f->strValue = value;
+
+    bool changed = !f->sent || value != f->sentStr;
+    if (!changed) {
+        _stats.suppressed++;
+    }
+    f->dirty = f->dirty || changed;
+}
+
+bool RtdbWriteCoalescer::dirty() const {
+    for (const auto& f : _fields) {
+        if (f.dirty) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool RtdbWriteCoalescer::flush(FirebaseData* fbdo) {
+    FirebaseJson json;
+    uint32_t fields = 0;
+
+    for (const auto& f : _fields) {
+        if (!f.dirty) {
+            continue;
+        }
+        if (f.isInt) {
+            json.set(f.key, f.intValue);
+        } else {
+            json.set(f.key, f.strValue);
+        }
+        fields++;
+    }
+    if (fields == 0) {
+        return true;
+    }
+
+    String payload;
+    json.toString(payload);
+    _stats.requests++;
+    _stats.payloadBytes += payload.length() + strlen(_basePath);
+
+    // Silent update: the server replies with an empty body
+    if (!Firebase.RTDB.updateNodeSilent(fbdo, _basePath, &json)) {
+        _stats.failedRequests++;
+        return false;
+    }
+
+    for (auto& f : _fields) {
+        if (!f.dirty) {
+            continue;
+        }
+        f.sentInt = f.intValue;
+        f.sentStr = f.strValue;
+        f.sent = true;
+        f.dirty = false;
+    }
+    _stats.fieldsWritten += fields;
+    return true;
+}
+
+void RtdbWriteCoalescer::printStats() const {
+    float minutes = millis() / 60000.0f;
+    if (minutes <= 0) {
+        return;
+    }
+    Serial.printf("RTDB writes: %.1f requests/min, %.0f payload bytes/min, %u fields written, "
+                  "%u unchanged values suppressed, %u failed\n",
+                  _stats.requests / minutes, _stats.payloadBytes / minutes,
+                  _stats.fieldsWritten, _stats.suppressed, _stats.failedRequests);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Firebase_ESP_Client.h>
+#include <vector>
+
+// Collects field updates under one RTDB node and writes all changed fields
+// with a single multi-path update (PATCH) per flush.
+// Values equal to the last one written are suppressed; numeric fields can
+// have a deadband so small jitter (e.g. RSSI) doesn't cause a write.
+class RtdbWriteCoalescer {
+public:
+    struct Stats {
+        uint32_t requests = 0;
+        uint32_t failedRequests = 0;
+        // JSON body and node path only; HTTP headers, the auth token and TLS
+        // framing come on top (see tools/rtdb_standin_bench.cpp)
+        uint64_t payloadBytes = 0;
+        uint32_t fieldsWritten = 0;
+        uint32_t suppressed = 0;
+    };
+
+    explicit RtdbWriteCoalescer(const char* basePath) : _basePath(basePath) {}
+
+    void setInt(const char* key, int value, int deadband = 0);
+    void setString(const char* key, const String& value);
+
+    bool dirty() const;
+    // One updateNode request carrying every dirty field
+    bool flush(FirebaseData* fbdo);
+
+    const Stats& stats() const { return _stats; }
+    // Request and payload byte rates since boot
+    void printStats() const;
+
+private:
+    struct Field {
+        String key;
+        bool isInt;
+        int intValue;
+        int sentInt;
+        int deadband;
+        String strValue;
+        String sentStr;
+        bool sent;
+        bool dirty;
+    };
+
+    Field* field(const char* key, bool isInt);
+
+    const char* _basePath;
+    std::vector<Field> _fields;
+    Stats _stats;
+};
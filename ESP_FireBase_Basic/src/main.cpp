@@ -5,6 +5,9 @@
   #include <ESP8266WiFi.h>
 #endif
 #include <Firebase_ESP_Client.h>
+#include <WiFiConnectionManager.h>
+#include <RtdbWriteCoalescer.h>
+#include <sys/time.h>
 
 //Provide the token generation process info.
 #include "addons/TokenHelper.h"
@@ -22,29 +25,269 @@
 
 #define LED_PIN 2 // Built-in LED pin for ESP32
 
+// RSSI changes of up to this many dBm are not written
+#ifndef RSSI_DEADBAND
+#define RSSI_DEADBAND 2
+#endif
+#define STATS_INTERVAL_MS 60000
+
+#define LED_CONTROL_PATH "esp32/led_control"
+// Resubscribe backoff after the stream drops
+#define STREAM_BACKOFF_MIN_MS 1000
+#define STREAM_BACKOFF_MAX_MS 60000
+// Command latency needs wall-clock time on both ends
+#define NTP_SERVER "pool.ntp.org"
+
+#define SAMPLE_INTERVAL_MS 1000
+// Pending RTDB commands; the loop drops samples rather than block when full
+#define COMMAND_QUEUE_LENGTH 8
+// Longest the worker waits for a command before reading the stream again
+#define STREAM_READ_INTERVAL_MS 20
+// 0 runs the Firebase calls in loop() as the sketch used to, to compare the
+// sample jitter (tools/sketch_standin_test.cpp)
+#ifndef RTDB_WORKER
+#define RTDB_WORKER 1
+#endif
+// Extra delay added to every write, to check that a slow server no longer
+// disturbs sampling (0 in normal builds)
+#define SIMULATED_SLOW_WRITE_MS 0
+
+// Every Firebase.* call runs on one task, the RTDB worker: the library keeps
+// its token and session state in the shared Firebase object and does not lock it
+// Writes
 FirebaseData fbdo;
+// Dedicated connection for the led_control event stream
+FirebaseData stream;
 FirebaseAuth auth;
 FirebaseConfig config;
 
 unsigned long sendDataPrevMillis = 0;
-unsigned long readDataPrevMillis = 0;
 bool signupOK = false;
+bool firebaseStarted = false;
+unsigned long statsPrevMillis = 0;
 
-void setup() {
-  Serial.begin(115200);
-  pinMode(LED_PIN, OUTPUT);
+// Work the loop hands to the RTDB worker
+struct RtdbCommand {
+  int rssi;
+  char mac[18];
+};
+
+QueueHandle_t commandQueue;
+TaskHandle_t rtdbWorkerHandle = NULL;
+
+// Set by the worker once Firebase has a valid token
+volatile bool firebaseReady = false;
+// Set on WiFi loss; the worker closes both connections
+volatile bool linkDropped = false;
+
+// Sample-interval jitter, measured in loop()
+uint32_t samplesTaken = 0;
+uint32_t samplesDropped = 0;
+unsigned long lastSampleUs = 0;
+long minIntervalUs = 0;
+long maxIntervalUs = 0;
+uint64_t jitterUsTotal = 0;
+
+// Changed fields under esp32/ go out in one multi-path update
+RtdbWriteCoalescer deviceNode("esp32");
+
+bool streamActive = false;
+unsigned long streamRetryAt = 0;
+unsigned long streamBackoff = 0;
+// Stream statistics
+uint32_t streamSubscriptions = 0;
+uint32_t streamDrops = 0;
+uint32_t streamTimeouts = 0;
+uint32_t ledCommands = 0;
+// Event handed over by the library -> pin set
+uint32_t lastApplyUs = 0;
+uint32_t maxApplyUs = 0;
+// Command written ("ts", server time) -> pin set, against NTP time
+uint32_t timedCommands = 0;
+long lastCommandLatencyMs = 0;
+long maxCommandLatencyMs = 0;
+int64_t commandLatencyMsTotal = 0;
+
+void subscribeLedControl() {
+  streamSubscriptions++;
+  if (Firebase.RTDB.beginStream(&stream, LED_CONTROL_PATH)) {
+    Serial.println("Subscribed to " LED_CONTROL_PATH);
+    streamActive = true;
+    streamBackoff = 0;
+    return;
+  }
+
+  Serial.println("Failed to subscribe to LED control");
+  Serial.println("Reason: " + stream.errorReason());
+  streamBackoff = streamBackoff ? min(streamBackoff * 2, (unsigned long)STREAM_BACKOFF_MAX_MS)
+                                : STREAM_BACKOFF_MIN_MS;
+  streamRetryAt = millis() + streamBackoff;
+}
+
+void dropStream() {
+  if (streamActive) {
+    streamDrops++;
+  }
+  Firebase.RTDB.endStream(&stream);
+  streamActive = false;
+  streamBackoff = streamBackoff ? min(streamBackoff * 2, (unsigned long)STREAM_BACKOFF_MAX_MS)
+                                : STREAM_BACKOFF_MIN_MS;
+  streamRetryAt = millis() + streamBackoff;
+}
+
+// Apply led_control changes as the server pushes them
+void serviceLedStream() {
+  if (!streamActive) {
+    if ((long)(millis() - streamRetryAt) >= 0) {
+      subscribeLedControl();
+    }
+    return;
+  }
+
+  if (!Firebase.RTDB.readStream(&stream)) {
+    Serial.println("LED control stream error, resubscribing");
+    Serial.println("Reason: " + stream.errorReason());
+    dropStream();
+    return;
+  }
+
+  if (stream.streamTimeout()) {
+    // No keep-alive from the server; the library reconnects on the next read
+    streamTimeouts++;
+    Serial.println("LED control stream timed out, resuming");
+  }
+
+  if (!stream.streamAvailable()) {
+    return;
+  }
+
+  // Either a plain boolean, or {"state": bool, "ts": {".sv": "timestamp"}}
+  // so the server stamps the time of the write
+  bool ledState;
+  double writtenMs = 0;
+  if (stream.dataType() == "boolean") {
+    ledState = stream.boolData();
+  } else if (stream.dataType() == "json" && stream.dataPath() == "/") {
+    FirebaseJson& json = stream.jsonObject();
+    FirebaseJsonData field;
+    if (!json.get(field, "state") || field.type != "boolean") {
+      return;
+    }
+    ledState = field.to<bool>();
+    if (json.get(field, "ts")) {
+      writtenMs = field.to<double>();
+    }
+  } else {
+    return;
+  }
+
+  unsigned long received = micros();
+  digitalWrite(LED_PIN, ledState);
+  lastApplyUs = micros() - received;
+  if (lastApplyUs > maxApplyUs) {
+    maxApplyUs = lastApplyUs;
+  }
+  ledCommands++;
+
+  // Only meaningful once NTP has set the clock
+  timeval now;
+  gettimeofday(&now, nullptr);
+  if (writtenMs > 0 && now.tv_sec > 1600000000) {
+    double nowMs = now.tv_sec * 1000.0 + now.tv_usec / 1000;
+    lastCommandLatencyMs = (long)(nowMs - writtenMs);
+    if (lastCommandLatencyMs > maxCommandLatencyMs) {
+      maxCommandLatencyMs = lastCommandLatencyMs;
+    }
+    commandLatencyMsTotal += lastCommandLatencyMs;
+    timedCommands++;
+  }
+  Serial.printf("LED state updated: %s\n", ledState ? "ON" : "OFF");
+}
 
-  WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
-  Serial.print("Connecting to Wi-Fi");
-  while (WiFi.status() != WL_CONNECTED) {
-    Serial.print(".");
-    delay(300);
+void printStreamStats() {
+  float hours = millis() / 3600000.0f;
+  Serial.printf("LED stream: %u commands, %u subscriptions (%.1f requests/hour vs 720 when polling), "
+                "%u drops, %u timeouts, event-to-pin %u us (max %u us)\n",
+                ledCommands, streamSubscriptions, hours > 0 ? streamSubscriptions / hours : 0.0f,
+                streamDrops, streamTimeouts, lastApplyUs, maxApplyUs);
+  if (timedCommands > 0) {
+    // Includes the NTP offset between the server and this clock
+    Serial.printf("LED command latency (write to pin): last %ld ms, avg %.1f ms, max %ld ms over %u commands\n",
+                  lastCommandLatencyMs, (double)commandLatencyMsTotal / timedCommands,
+                  maxCommandLatencyMs, timedCommands);
   }
-  Serial.println();
-  Serial.print("Connected with IP: ");
-  Serial.println(WiFi.localIP());
-  Serial.println();
+}
+
+// Token upkeep, dropped links and the LED stream
+void serviceFirebase() {
+  // Keeps the auth token fresh even when there is nothing to write
+  firebaseReady = Firebase.ready();
+
+  if (linkDropped) {
+    linkDropped = false;
+    fbdo.stopWiFiClient();
+    if (streamActive) {
+      dropStream();
+    }
+  }
+
+  if (firebaseReady && Connectivity.connected()) {
+    serviceLedStream();
+  }
+}
+
+void writeSample(const RtdbCommand& cmd) {
+  deviceNode.setInt("rssi", cmd.rssi, RSSI_DEADBAND);
+  deviceNode.setString("mac", cmd.mac);
+
+  if (deviceNode.dirty() && firebaseReady) {
+    if (SIMULATED_SLOW_WRITE_MS > 0) {
+      vTaskDelay(pdMS_TO_TICKS(SIMULATED_SLOW_WRITE_MS));
+    }
+    if (deviceNode.flush(&fbdo)) {
+      Serial.println("Device data sent successfully");
+    } else {
+      Serial.println("Failed to send device data");
+      Serial.println("Reason: " + fbdo.errorReason());
+    }
+  }
+}
+
+void rtdbWorkerTask(void* pvParameters) {
+  RtdbCommand cmd;
+  while (true) {
+    serviceFirebase();
+
+    // A write in progress holds up the stream by at most its own duration
+    if (xQueueReceive(commandQueue, &cmd, pdMS_TO_TICKS(STREAM_READ_INTERVAL_MS)) == pdTRUE) {
+      writeSample(cmd);
+    }
+  }
+}
+
+void recordSampleTiming() {
+  unsigned long now = micros();
+  if (lastSampleUs != 0) {
+    long interval = (long)(now - lastSampleUs);
+    if (minIntervalUs == 0 || interval < minIntervalUs) minIntervalUs = interval;
+    if (interval > maxIntervalUs) maxIntervalUs = interval;
+    jitterUsTotal += abs(interval - (long)SAMPLE_INTERVAL_MS * 1000);
+  }
+  lastSampleUs = now;
+  samplesTaken++;
+}
+
+void printSamplingStats() {
+  if (samplesTaken < 2) {
+    return;
+  }
+  Serial.printf("Sampling: %u samples, interval min %.1f ms, max %.1f ms, mean jitter %.2f ms, "
+                "%u dropped (queue full)\n",
+                samplesTaken, minIntervalUs / 1000.0f, maxIntervalUs / 1000.0f,
+                jitterUsTotal / 1000.0f / (samplesTaken - 1), samplesDropped);
+}
 
+void setupFirebase() {
   config.api_key = API_KEY;
   config.database_url = DATABASE_URL;
 
@@ -58,49 +301,73 @@ void setup() {
   config.token_status_callback = tokenStatusCallback;
   
   Firebase.begin(&config, &auth);
-  Firebase.reconnectWiFi(true);
+  // Reconnection is handled by the connectivity manager
+  Firebase.reconnectWiFi(false);
+
+#if RTDB_WORKER
+  // Network I/O happens off the loop so a slow request can't delay sampling
+  commandQueue = xQueueCreate(COMMAND_QUEUE_LENGTH, sizeof(RtdbCommand));
+  xTaskCreatePinnedToCore(rtdbWorkerTask, "RtdbWorker", 10240, NULL, 1, &rtdbWorkerHandle, 1);
+#endif
+}
+
+void setup() {
+  Serial.begin(115200);
+  pinMode(LED_PIN, OUTPUT);
+
+  Connectivity.onConnected([]() {
+    Serial.print("Connected with IP: ");
+    Serial.println(WiFi.localIP());
+    Serial.println();
+
+    // Sign-up needs the network, so it runs on the first connect
+    if (!firebaseStarted) {
+      firebaseStarted = true;
+      configTime(0, 0, NTP_SERVER);
+      setupFirebase();
+    }
+  });
+  // Drop the stale TLS socket so the next request opens a fresh one
+  Connectivity.onDisconnected([]() {
+    linkDropped = true;
+  });
+  Serial.println("Connecting to Wi-Fi");
+  Connectivity.begin(WIFI_SSID, WIFI_PASSWORD);
 }
 
 void loop() {
-  if (Firebase.ready() && signupOK) {
+  Connectivity.loop();
+
+  if (Connectivity.connected() && signupOK) {
+#if !RTDB_WORKER
+    serviceFirebase();
+#endif
     unsigned long currentMillis = millis();
 
-    // Send WiFi RSSI and MAC address every 1 second
-    if (currentMillis - sendDataPrevMillis > 1000 || sendDataPrevMillis == 0) {
+    // Sample WiFi RSSI and MAC address every second; the worker sends them
+    if (currentMillis - sendDataPrevMillis >= SAMPLE_INTERVAL_MS || sendDataPrevMillis == 0) {
       sendDataPrevMillis = currentMillis;
-      
-      int rssi = WiFi.RSSI();
-      String macAddress = WiFi.macAddress();
-
-      if (Firebase.RTDB.setInt(&fbdo, "esp32/rssi", rssi)) {
-        Serial.println("RSSI sent successfully");
-      } else {
-        Serial.println("Failed to send RSSI");
-        Serial.println("Reason: " + fbdo.errorReason());
-      }
+      recordSampleTiming();
 
-      if (Firebase.RTDB.setString(&fbdo, "esp32/mac", macAddress)) {
-        Serial.println("MAC address sent successfully");
-      } else {
-        Serial.println("Failed to send MAC address");
-        Serial.println("Reason: " + fbdo.errorReason());
+      RtdbCommand cmd;
+      cmd.rssi = WiFi.RSSI();
+      strlcpy(cmd.mac, WiFi.macAddress().c_str(), sizeof(cmd.mac));
+#if RTDB_WORKER
+      if (xQueueSend(commandQueue, &cmd, 0) != pdTRUE) {
+        samplesDropped++;
       }
+#else
+      writeSample(cmd);
+#endif
 
-      Serial.printf("RSSI: %d dBm, MAC: %s\n", rssi, macAddress.c_str());
+      Serial.printf("RSSI: %d dBm, MAC: %s\n", cmd.rssi, cmd.mac);
     }
 
-    // Read LED control input every 5 seconds
-    if (currentMillis - readDataPrevMillis > 5000 || readDataPrevMillis == 0) {
-      readDataPrevMillis = currentMillis;
-
-      if (Firebase.RTDB.getBool(&fbdo, "esp32/led_control")) {
-        bool ledState = fbdo.boolData();
-        digitalWrite(LED_PIN, ledState);
-        Serial.printf("LED state updated: %s\n", ledState ? "ON" : "OFF");
-      } else {
-        Serial.println("Failed to read LED control state");
-        Serial.println("Reason: " + fbdo.errorReason());
-      }
+    if (currentMillis - statsPrevMillis > STATS_INTERVAL_MS) {
+      statsPrevMillis = currentMillis;
+      printSamplingStats();
+      deviceNode.printStats();
+      printStreamStats();
     }
   }
 }
@@ -0,0 +1,534 @@
+// Host test: the sketch (src/main.cpp, unchanged) on lib/HostHAL against a
+// local TLS stand-in for the Firebase RTDB REST API, with
+// tools/standin/Firebase_ESP_Client.h in place of the library.
+//
+// The stand-in stores what is written and serves event streams the way RTDB
+// does: a GET with Accept: text/event-stream gets the current value as a
+// "put" event, then one "put" per change and a keep-alive every 30 s.
+// Values written with {".sv": "timestamp"} get the server's time.
+//
+// LED control is measured both ways, from the harness writing
+// esp32/led_control to the LED pin changing:
+//   - polling: the loop the sketch had before streaming, getBool every 5 s,
+//     run on its own before the sketch starts
+//   - streaming: the sketch itself, commands written as
+//     {"state": bool, "ts": {".sv": "timestamp"}} so its own write-to-pin
+//     figure can be compared
+// For each: command latency (min/median/max) and LED control requests per
+// hour once running: reads at the polling rate, stream subscriptions after
+// the first (keep-alives are pushed by the server, not requested).
+// Checked: every command reaches the pin, polling makes one request per 5 s,
+// streaming subscribes once and is faster.
+//
+// Then the sample interval of loop() against a slow backend: the stand-in
+// holds each write for 0, 300 and 1500 ms in turn. The sketch is built with
+// RSSI_DEADBAND=-1 so every 1 s sample is written. With RTDB_WORKER=0 it
+// writes from loop() as it used to; build it both ways to compare. Printed
+// per delay: interval min/max (seen by the harness), the sketch's own mean
+// jitter and samples dropped on a full queue. Checked with the worker: the
+// interval stays within 50 ms of 1 s whatever the delay.
+//
+//   g++ -O2 -std=gnu++17 -pthread -DRSSI_DEADBAND=-1 -Istandin -I../../lib/HostHAL
+//       -I../../lib/WiFiConnectionManager -I../lib/RtdbWriteCoalescer -o sketch_standin_test
+//       sketch_standin_test.cpp ../src/main.cpp ../lib/RtdbWriteCoalescer/RtdbWriteCoalescer.cpp
+//       ../../lib/WiFiConnectionManager/WiFiConnectionManager.cpp ../../lib/HostHAL/*.cpp -lssl -lcrypto
+//
+//   ./sketch_standin_test
+//
+// and again with -DRTDB_WORKER=0 for the loop()-only figures.
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Firebase_ESP_Client.h>
+#include <HostTest.h>
+
+using HostTest::check;
+
+// The sketch's default, unless the build line says otherwise
+#ifndef RTDB_WORKER
+#define RTDB_WORKER 1
+#endif
+
+// Sketch state and statistics
+extern bool streamActive;
+extern uint32_t samplesTaken;
+extern uint32_t samplesDropped;
+extern uint64_t jitterUsTotal;
+extern uint32_t streamSubscriptions;
+extern uint32_t ledCommands;
+extern uint32_t timedCommands;
+extern long maxCommandLatencyMs;
+extern int64_t commandLatencyMsTotal;
+
+namespace {
+
+const char* DATABASE_HOST = "example-project-default-rtdb.firebaseio.com";
+const char* LED_PATH = "esp32/led_control";
+const uint8_t LED = 2;
+const unsigned long POLL_INTERVAL_MS = 5000;
+const int POLL_COMMANDS = 8;
+const int STREAM_COMMANDS = 20;
+const unsigned long KEEP_ALIVE_MS = 30000;
+const unsigned long SAMPLE_INTERVAL_MS = 1000;
+const uint32_t JITTER_SAMPLES = 20;
+
+uint64_t epochMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+class StandInServer {
+public:
+    bool start() {
+        if (!makeCertificate()) {
+            return false;
+        }
+        _fd = socket(AF_INET, SOCK_STREAM, 0);
+        int on = 1;
+        setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(_fd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(_fd, 4) != 0) {
+            return false;
+        }
+        socklen_t len = sizeof(addr);
+        getsockname(_fd, (sockaddr*)&addr, &len);
+        _port = ntohs(addr.sin_port);
+        std::thread(&StandInServer::acceptLoop, this).detach();
+        return true;
+    }
+
+    uint16_t port() const { return _port; }
+    const std::string& certificatePem() const { return _certPem; }
+
+    // Requests for LED_PATH: plain reads and stream subscriptions
+    uint32_t ledReads() const { return _ledReads; }
+    uint32_t ledSubscriptions() const { return _ledSubscriptions; }
+
+    // Seconds between the first and the last read
+    double readSpan() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return std::chrono::duration<double>(_lastRead - _firstRead).count();
+    }
+
+    // How long each PATCH is held before the reply, like a slow backend
+    void setWriteDelay(unsigned long ms) { _writeDelayMs = ms; }
+
+    // A write from another client, e.g. the app; streams get the change
+    void write(const std::string& path, std::string json) {
+        size_t sv = json.find("{\".sv\": \"timestamp\"}");
+        if (sv != std::string::npos) {
+            json.replace(sv, strlen("{\".sv\": \"timestamp\"}"), std::to_string(epochMs()));
+        }
+        std::lock_guard<std::mutex> lock(_mutex);
+        _data[path] = json;
+        _versions[path]++;
+        _changed.notify_all();
+    }
+
+private:
+    bool makeCertificate() {
+        EVP_PKEY* key = EVP_EC_gen("P-256");
+        X509* cert = X509_new();
+        if (!key || !cert) {
+            return false;
+        }
+        ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+        X509_gmtime_adj(X509_getm_notBefore(cert), -60);
+        X509_gmtime_adj(X509_getm_notAfter(cert), 3600);
+        X509_set_pubkey(cert, key);
+        X509_NAME* name = X509_get_subject_name(cert);
+        X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char*)"localhost", -1, -1, 0);
+        X509_set_issuer_name(cert, name);
+        X509_sign(cert, key, EVP_sha256());
+
+        BIO* bio = BIO_new(BIO_s_mem());
+        PEM_write_bio_X509(bio, cert);
+        char* data;
+        long len = BIO_get_mem_data(bio, &data);
+        _certPem.assign(data, len);
+        BIO_free(bio);
+
+        _ctx = SSL_CTX_new(TLS_server_method());
+        bool ok = SSL_CTX_use_certificate(_ctx, cert) == 1 && SSL_CTX_use_PrivateKey(_ctx, key) == 1;
+        X509_free(cert);
+        EVP_PKEY_free(key);
+        return ok;
+    }
+
+    void acceptLoop() {
+        while (true) {
+            int client = accept(_fd, nullptr, nullptr);
+            if (client < 0) {
+                continue;
+            }
+            std::thread(&StandInServer::serve, this, client).detach();
+        }
+    }
+
+    void serve(int fd) {
+        SSL* ssl = SSL_new(_ctx);
+        SSL_set_fd(ssl, fd);
+        if (SSL_accept(ssl) == 1) {
+            std::string buffer;
+            while (handleRequest(ssl, buffer)) {
+            }
+        }
+        SSL_free(ssl);
+        close(fd);
+    }
+
+    std::string value(const std::string& path) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _data.find(path);
+        return it == _data.end() ? "null" : it->second;
+    }
+
+    // One keep-alive request; false when the connection is done
+    bool handleRequest(SSL* ssl, std::string& buffer) {
+        size_t headerEnd;
+        while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+            if (!readMore(ssl, buffer)) {
+                return false;
+            }
+        }
+        size_t bodyLength = 0;
+        size_t at = buffer.find("Content-Length: ");
+        if (at != std::string::npos && at < headerEnd) {
+            bodyLength = strtoul(buffer.c_str() + at + 16, nullptr, 10);
+        }
+        while (buffer.size() < headerEnd + 4 + bodyLength) {
+            if (!readMore(ssl, buffer)) {
+                return false;
+            }
+        }
+        std::string header = buffer.substr(0, headerEnd);
+        std::string body = buffer.substr(headerEnd + 4, bodyLength);
+        buffer.erase(0, headerEnd + 4 + bodyLength);
+
+        // "GET /esp32/led_control.json?auth=... HTTP/1.1"
+        size_t space = header.find(' ');
+        std::string method = header.substr(0, space);
+        std::string path = header.substr(space + 2, header.find(".json") - space - 2);
+        bool silent = header.find("print=silent") != std::string::npos;
+
+        if (method == "GET" && header.find("Accept: text/event-stream") != std::string::npos) {
+            if (path == LED_PATH) {
+                _ledSubscriptions++;
+            }
+            stream(ssl, path);
+            return false;
+        }
+
+        std::string reply;
+        if (method == "GET") {
+            if (path == LED_PATH) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _lastRead = std::chrono::steady_clock::now();
+                _firstRead = _ledReads++ ? _firstRead : _lastRead;
+            }
+            reply = value(path);
+        } else if (method == "PATCH") {
+            std::this_thread::sleep_for(std::chrono::milliseconds(_writeDelayMs.load()));
+            patch(path, body);
+        } else {
+            write(path, body);
+        }
+        if (silent) {
+            reply.clear();
+        }
+        char head[256];
+        snprintf(head, sizeof(head),
+                 "HTTP/1.1 %s\r\nContent-Type: application/json; charset=utf-8\r\nContent-Length: %u\r\n"
+                 "Connection: keep-alive\r\nCache-Control: no-cache\r\n\r\n",
+                 silent ? "204 No Content" : "200 OK", (unsigned)reply.size());
+        std::string response = head + reply;
+        return SSL_write(ssl, response.data(), (int)response.size()) > 0;
+    }
+
+    // Held open until the client goes away: the value now, then every change
+    // to it; writes elsewhere are not sent
+    void stream(SSL* ssl, const std::string& path) {
+        std::string head = "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nCache-Control: no-cache\r\n\r\n";
+        if (SSL_write(ssl, head.data(), (int)head.size()) <= 0) {
+            return;
+        }
+        uint64_t seen = ~0ull;
+        while (true) {
+            std::string event;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _changed.wait_for(lock, std::chrono::milliseconds(KEEP_ALIVE_MS),
+                                  [&] { return _versions[path] != seen; });
+                if (_versions[path] != seen) {
+                    seen = _versions[path];
+                    auto it = _data.find(path);
+                    event = "event: put\ndata: {\"path\":\"/\",\"data\":" +
+                            (it == _data.end() ? std::string("null") : it->second) + "}\n\n";
+                } else {
+                    event = "event: keep-alive\ndata: null\n\n";
+                }
+            }
+            if (SSL_write(ssl, event.data(), (int)event.size()) <= 0) {
+                return;
+            }
+        }
+    }
+
+    // Multi-path update of a flat object: {"rssi":-61,"mac":"..."}
+    void patch(const std::string& path, const std::string& body) {
+        size_t i = 1;
+        while (i < body.size()) {
+            size_t keyEnd = body.find('"', i + 1);
+            size_t valueEnd = body.find_first_of(",}", keyEnd + 2);
+            if (keyEnd == std::string::npos || valueEnd == std::string::npos) {
+                return;
+            }
+            write(path + "/" + body.substr(i + 1, keyEnd - i - 1), body.substr(keyEnd + 2, valueEnd - keyEnd - 2));
+            i = valueEnd + 1;
+        }
+    }
+
+    static bool readMore(SSL* ssl, std::string& buffer) {
+        char chunk[4096];
+        int n = SSL_read(ssl, chunk, sizeof(chunk));
+        if (n <= 0) {
+            return false;
+        }
+        buffer.append(chunk, n);
+        return true;
+    }
+
+    SSL_CTX* _ctx = nullptr;
+    std::string _certPem;
+    int _fd = -1;
+    uint16_t _port = 0;
+    std::mutex _mutex;
+    std::condition_variable _changed;
+    std::map<std::string, std::string> _data;
+    std::map<std::string, uint64_t> _versions;
+    std::atomic<unsigned long> _writeDelayMs{0};
+    std::atomic<uint32_t> _ledReads{0};
+    std::atomic<uint32_t> _ledSubscriptions{0};
+    std::chrono::steady_clock::time_point _firstRead;
+    std::chrono::steady_clock::time_point _lastRead;
+};
+
+struct Latencies {
+    std::vector<double> ms;
+    int missed = 0;
+
+    double median() const {
+        std::vector<double> sorted = ms;
+        std::sort(sorted.begin(), sorted.end());
+        return sorted.empty() ? 0 : sorted[sorted.size() / 2];
+    }
+};
+
+// Irregular gaps between commands, so they land at any point of a poll cycle
+unsigned long nextGapMs(uint32_t& seed, unsigned long minMs, unsigned long maxMs) {
+    seed = seed * 1103515245u + 12345u;
+    return minMs + (seed >> 16) % (maxMs - minMs);
+}
+
+// Writes commands and times each one until the pin follows
+Latencies sendCommands(StandInServer& server, int count, bool timestamped, unsigned long minGapMs,
+                       unsigned long maxGapMs) {
+    Latencies result;
+    uint32_t seed = 4242;
+    for (int i = 0; i < count; i++) {
+        delay(nextGapMs(seed, minGapMs, maxGapMs));
+        bool state = digitalRead(LED) == LOW;
+        std::string value = state ? "true" : "false";
+        if (timestamped) {
+            value = "{\"state\": " + value + ", \"ts\": {\".sv\": \"timestamp\"}}";
+        }
+        auto written = std::chrono::steady_clock::now();
+        server.write(LED_PATH, value);
+        while (digitalRead(LED) != (state ? HIGH : LOW) &&
+               std::chrono::steady_clock::now() - written < std::chrono::milliseconds(2 * POLL_INTERVAL_MS)) {
+            delay(1);
+        }
+        if (digitalRead(LED) != (state ? HIGH : LOW)) {
+            result.missed++;
+            continue;
+        }
+        result.ms.push_back(
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - written).count());
+    }
+    return result;
+}
+
+void report(const char* label, const Latencies& l, const char* requests, double perHour) {
+    printf("%-10s %2u commands, latency min %7.1f ms, median %7.1f ms, max %7.1f ms; %s = %.0f requests/hour\n",
+           label, (unsigned)l.ms.size(), l.ms.empty() ? 0 : *std::min_element(l.ms.begin(), l.ms.end()), l.median(),
+           l.ms.empty() ? 0 : *std::max_element(l.ms.begin(), l.ms.end()), requests, perHour);
+}
+
+struct Jitter {
+    double minMs = 1e9;
+    double maxMs = 0;
+    double meanJitterMs = 0;
+    uint32_t dropped = 0;
+};
+
+// Watches the sketch's sample counter; the interval is between increments
+Jitter measureSampling(StandInServer& server, unsigned long writeDelayMs) {
+    server.setWriteDelay(writeDelayMs);
+    Jitter j;
+    uint32_t taken = samplesTaken;
+    uint32_t dropped = samplesDropped;
+    uint64_t jitterUs = jitterUsTotal;
+    auto last = std::chrono::steady_clock::time_point();
+    uint32_t seen = taken;
+    while (seen - taken < JITTER_SAMPLES) {
+        delay(1);
+        if (samplesTaken == seen) {
+            continue;
+        }
+        seen = samplesTaken;
+        auto now = std::chrono::steady_clock::now();
+        if (last != std::chrono::steady_clock::time_point()) {
+            double ms = std::chrono::duration<double, std::milli>(now - last).count();
+            j.minMs = std::min(j.minMs, ms);
+            j.maxMs = std::max(j.maxMs, ms);
+        }
+        last = now;
+    }
+    j.meanJitterMs = (jitterUsTotal - jitterUs) / 1000.0 / (samplesTaken - taken);
+    j.dropped = samplesDropped - dropped;
+    return j;
+}
+
+// The sketch's LED handling before streaming
+std::atomic<bool> pollingDone{false};
+
+void oldPollTask(void*) {
+    FirebaseData fbdo;
+    unsigned long readDataPrevMillis = 0;
+    while (!pollingDone) {
+        unsigned long currentMillis = millis();
+        if (currentMillis - readDataPrevMillis > POLL_INTERVAL_MS || readDataPrevMillis == 0) {
+            readDataPrevMillis = currentMillis;
+            if (Firebase.RTDB.getBool(&fbdo, LED_PATH)) {
+                digitalWrite(LED, fbdo.boolData());
+            }
+        }
+        delay(1);
+    }
+    fbdo.stopWiFiClient();
+    vTaskDelete(NULL);
+}
+
+// The core runs loop() back to back; the pause keeps a 1-CPU host usable
+void loopTask(void*) {
+    while (true) {
+        loop();
+        delay(1);
+    }
+}
+
+}  // namespace
+
+int main() {
+    char fsDir[] = "/tmp/firebase_fs_XXXXXX";
+    char nvsDir[] = "/tmp/firebase_nvs_XXXXXX";
+    setenv("HOST_FS_DIR", mkdtemp(fsDir), 1);
+    setenv("HOST_NVS_DIR", mkdtemp(nvsDir), 1);
+    hostAdoptTask("loopTask");
+
+    StandInServer server;
+    if (!server.start()) {
+        fprintf(stderr, "cannot start the TLS stand-in\n");
+        return 1;
+    }
+    Firebase.begin(DATABASE_HOST, server.port(), server.certificatePem().c_str(), "host-id-token");
+    server.write(LED_PATH, "false");
+
+    // Polling, before the sketch starts. A device has been up for a while by
+    // then; the old loop takes millis() == 0 as "never read"
+    delay(100);
+    xTaskCreate(oldPollTask, "OldPoll", 8192, nullptr, 1, nullptr);
+    Latencies polled = sendCommands(server, POLL_COMMANDS, false, 2000, 8000);
+    pollingDone = true;
+    uint32_t pollReads = server.ledReads();
+    double pollSpan = server.readSpan();
+    double pollsPerHour = (pollReads - 1) * 3600.0 / pollSpan;
+    delay(50);
+
+    // Streaming, by the sketch
+    setup();
+    xTaskCreate(loopTask, "SketchLoop", 8192, nullptr, 1, nullptr);
+    unsigned long subscribeBy = millis() + 10000;
+    while (!streamActive && (long)(millis() - subscribeBy) < 0) {
+        delay(10);
+    }
+    check(streamActive, "sketch subscribes to " "esp32/led_control");
+    unsigned long start = millis();
+    Latencies streamed = sendCommands(server, STREAM_COMMANDS, true, 500, 1500);
+    double streamSeconds = (millis() - start) / 1000.0;
+    uint32_t resubscriptions = server.ledSubscriptions() - 1;
+    delay(100);
+
+    printf("LED control, %d and %d commands at irregular gaps, TLS on loopback:\n", POLL_COMMANDS,
+           STREAM_COMMANDS);
+    char requests[96];
+    snprintf(requests, sizeof(requests), "%u reads over %.1f s", pollReads, pollSpan);
+    report("polling", polled, requests, pollsPerHour);
+    snprintf(requests, sizeof(requests), "1 subscription, %u more over %.1f s", resubscriptions, streamSeconds);
+    report("streaming", streamed, requests, resubscriptions * 3600.0 / streamSeconds);
+    if (timedCommands > 0) {
+        printf("sketch's own write-to-pin figure: avg %.1f ms, max %ld ms over %u commands (1 ms resolution)\n",
+               (double)commandLatencyMsTotal / timedCommands, maxCommandLatencyMs, timedCommands);
+    }
+
+    check(polled.missed == 0, "polling: every command reaches the pin");
+    check(pollsPerHour > 700 && pollsPerHour <= 720, "polling: one read per 5 s (720/hour)");
+    check(streamed.missed == 0 && ledCommands >= (uint32_t)STREAM_COMMANDS,
+          "streaming: every command reaches the pin");
+    check(server.ledSubscriptions() == 1 && streamSubscriptions == 1, "streaming: one subscription, no reads");
+    check(timedCommands == (uint32_t)STREAM_COMMANDS, "streaming: the sketch timed every command");
+    check(streamed.median() < polled.median(), "streaming: lower latency than polling");
+
+    // Sampling against a slow backend
+    printf("sampling every %lu ms, %s, every sample written:\n", SAMPLE_INTERVAL_MS,
+           RTDB_WORKER ? "writes on the RTDB worker" : "writes from loop() (RTDB_WORKER=0)");
+    bool steady = true;
+    for (unsigned long writeDelayMs : {0ul, 300ul, 1500ul}) {
+        Jitter j = measureSampling(server, writeDelayMs);
+        printf("  write held %4lu ms: interval min %7.1f ms, max %7.1f ms, mean jitter %6.1f ms, %u dropped\n",
+               writeDelayMs, j.minMs, j.maxMs, j.meanJitterMs, j.dropped);
+        steady &= j.minMs > SAMPLE_INTERVAL_MS - 50 && j.maxMs < SAMPLE_INTERVAL_MS + 50;
+    }
+    server.setWriteDelay(0);
+#if RTDB_WORKER
+    check(steady, "worker: sample interval within 50 ms of 1 s at every write delay");
+#else
+    (void)steady;
+#endif
+
+    // The sketch's tasks still hold their connections; leave without destructors
+    int result = HostTest::finish();
+    fflush(stdout);
+    _exit(result);
+}
@@ -0,0 +1,465 @@
+#pragma once
+
+// Host stand-in for the calls of the Firebase ESP Client library that
+// src/main.cpp, lib/RtdbWriteCoalescer and the old per-field path use, over
+// HostHAL's WiFiClientSecure. Requests go out the way the library sends them
+// to the RTDB REST API: one keep-alive TLS connection per FirebaseData, the ID
+// token in the query string and print=silent on the *Silent calls, so the
+// bytes a stand-in server counts are the bytes the device would send.
+//
+// Streams are a GET with Accept: text/event-stream that stays open; the
+// server pushes "put"/"patch" events and a keep-alive every 30 s. As in the
+// library, readStream() handles at most one event per call, and a stream
+// silent for longer than the keep-alive timeout reports streamTimeout() and
+// is reopened.
+//
+// Sign-up and tokens are not modelled: the host-only begin() supplies the
+// server and the ID token, and ready() is true once the sketch has called
+// Firebase.begin(&config, &auth).
+#include <Arduino.h>
+#include <WiFiClientSecure.h>
+
+#include <type_traits>
+#include <vector>
+
+// One member looked up with FirebaseJson::get()
+struct FirebaseJsonData {
+    bool success = false;
+    String type;  // "string", "int", "double", "boolean", "object", "array" or "null"
+    String stringValue;
+
+    template <typename T>
+    T to() const {
+        if constexpr (std::is_same<T, bool>::value) {
+            return stringValue == "true";
+        } else if constexpr (std::is_same<T, String>::value) {
+            return stringValue;
+        } else {
+            return (T)atof(stringValue.c_str());
+        }
+    }
+};
+
+// JSON helpers shared by the classes below
+namespace FirebaseStandInJson {
+
+inline String typeOf(const String& value) {
+    if (value.length() == 0 || value == "null") {
+        return "null";
+    }
+    char c = value[0];
+    if (c == '"') {
+        return "string";
+    }
+    if (c == '{') {
+        return "object";
+    }
+    if (c == '[') {
+        return "array";
+    }
+    if (value == "true" || value == "false") {
+        return "boolean";
+    }
+    return value.indexOf('.') >= 0 || value.indexOf('e') >= 0 ? "double" : "int";
+}
+
+inline String unquote(const String& value) {
+    String out;
+    for (size_t i = 1; i + 1 < value.length(); i++) {
+        if (value[i] == '\\') {
+            i++;
+        }
+        out += value[i];
+    }
+    return out;
+}
+
+// Raw JSON of a top-level member of object, or false if there is none
+inline bool member(const String& object, const String& key, String& value) {
+    int depth = 0;
+    for (size_t i = 0; i < object.length(); i++) {
+        char c = object[i];
+        if (c == '{' || c == '[') {
+            depth++;
+        } else if (c == '}' || c == ']') {
+            depth--;
+        } else if (c == '"') {
+            size_t start = i;
+            for (i++; i < object.length() && object[i] != '"'; i++) {
+                i += object[i] == '\\';
+            }
+            String name = object.substring(start + 1, i);
+            size_t colon = i + 1;
+            while (colon < object.length() && object[colon] == ' ') {
+                colon++;
+            }
+            if (depth != 1 || colon >= object.length() || object[colon] != ':') {
+                continue;
+            }
+            size_t from = colon + 1;
+            while (from < object.length() && object[from] == ' ') {
+                from++;
+            }
+            size_t to = from;
+            int nesting = 0;
+            bool inString = false;
+            for (; to < object.length(); to++) {
+                char v = object[to];
+                if (inString) {
+                    to += v == '\\';
+                    inString = v != '"';
+                } else if (v == '"') {
+                    inString = true;
+                } else if (v == '{' || v == '[') {
+                    nesting++;
+                } else if (v == '}' || v == ']') {
+                    if (nesting-- == 0) {
+                        break;
+                    }
+                } else if (v == ',' && nesting == 0) {
+                    break;
+                }
+            }
+            if (name == key) {
+                value = object.substring(from, to);
+                value.trim();
+                return true;
+            }
+            i = to - 1;
+        }
+    }
+    return false;
+}
+
+}  // namespace FirebaseStandInJson
+
+class FirebaseJson {
+public:
+    // Parsed objects handed over by a stream or a get
+    void setJsonData(const String& json) {
+        _members.clear();
+        _raw = json;
+    }
+
+    bool get(FirebaseJsonData& result, const String& path) const {
+        String value;
+        result.success = FirebaseStandInJson::member(_raw, path, value);
+        result.type = result.success ? FirebaseStandInJson::typeOf(value) : "";
+        result.stringValue = result.type == "string" ? FirebaseStandInJson::unquote(value) : value;
+        return result.success;
+    }
+
+    void set(const String& path, int value) { _members.push_back({path, String(value)}); }
+    void set(const String& path, const String& value) { _members.push_back({path, quote(value)}); }
+
+    void toString(String& out, bool prettify = false) const {
+        (void)prettify;
+        out = "{";
+        for (size_t i = 0; i < _members.size(); i++) {
+            if (i > 0) {
+                out += ",";
+            }
+            out += quote(_members[i].key) + ":" + _members[i].value;
+        }
+        out += "}";
+    }
+
+private:
+    struct Member {
+        String key;
+        String value;  // already JSON
+    };
+
+    static String quote(const String& s) {
+        String out = "\"";
+        for (size_t i = 0; i < s.length(); i++) {
+            if (s[i] == '"' || s[i] == '\\') {
+                out += '\\';
+            }
+            out += s[i];
+        }
+        return out + "\"";
+    }
+
+    std::vector<Member> _members;
+    String _raw;
+};
+
+class FirebaseData {
+public:
+    String errorReason() const { return _error; }
+    void stopWiFiClient() { _client.stop(); }
+
+    // Last value received, from a stream event or a get
+    String dataType() const { return _type; }
+    String dataPath() const { return _path; }
+    bool boolData() const { return _data == "true"; }
+    FirebaseJson& jsonObject() { return _json; }
+
+    bool streamAvailable() const { return _available; }
+    bool streamTimeout() const { return _timedOut; }
+
+    // Host only: TLS handshakes made on this object's connection
+    uint32_t handshakes = 0;
+
+private:
+    friend class FB_RTDB;
+
+    void setData(const String& path, const String& value) {
+        _path = path;
+        _data = value;
+        _type = FirebaseStandInJson::typeOf(value);
+        if (_type == "object") {
+            _type = "json";
+            _json.setJsonData(value);
+        }
+    }
+
+    WiFiClientSecure _client;
+    String _error;
+    String _type;
+    String _path;
+    String _data;
+    FirebaseJson _json;
+    String _streamPath;
+    bool _available = false;
+    bool _timedOut = false;
+    unsigned long _lastEventMs = 0;
+};
+
+class FB_RTDB {
+public:
+    bool beginStream(FirebaseData* fbdo, const String& path) {
+        fbdo->_streamPath = path;
+        fbdo->_client.stop();
+        fbdo->_available = false;
+        if (!connect(fbdo)) {
+            return false;
+        }
+        String head = "GET /" + path + ".json?auth=" + _idToken + " HTTP/1.1\r\nHost: " + _databaseHost +
+                      "\r\nUser-Agent: ESP\r\nX-Firebase-Decoding: 1\r\nAccept: text/event-stream"
+                      "\r\nConnection: keep-alive\r\n\r\n";
+        WiFiClientSecure& client = fbdo->_client;
+        client.setTimeout(5000);
+        if (client.write((const uint8_t*)head.c_str(), head.length()) != head.length()) {
+            fbdo->_error = "send request failed";
+            client.stop();
+            return false;
+        }
+        String status = client.readStringUntil('\n');
+        while (client.readStringUntil('\n').length() > 1) {
+        }
+        if (status.length() < 12 || status.substring(9, 12) != "200") {
+            fbdo->_error = status.length() ? "bad request" : "response read timed out";
+            client.stop();
+            return false;
+        }
+        fbdo->_lastEventMs = millis();
+        return true;
+    }
+
+    // At most one event per call; false when the stream connection is gone
+    bool readStream(FirebaseData* fbdo) {
+        WiFiClientSecure& client = fbdo->_client;
+        fbdo->_available = false;
+        fbdo->_timedOut = false;
+        if (client.available() == 0) {
+            if (!client.connected()) {
+                fbdo->_error = "connection lost";
+                return false;
+            }
+            if (millis() - fbdo->_lastEventMs > STREAM_KEEP_ALIVE_TIMEOUT_MS) {
+                fbdo->_timedOut = true;
+                return beginStream(fbdo, fbdo->_streamPath);
+            }
+            return true;
+        }
+
+        String event;
+        String data;
+        while (true) {
+            String line = client.readStringUntil('\n');
+            line.trim();
+            if (line.length() == 0) {
+                break;
+            }
+            if (line.startsWith("event:")) {
+                event = line.substring(6);
+                event.trim();
+            } else if (line.startsWith("data:")) {
+                data = line.substring(5);
+                data.trim();
+            }
+        }
+        fbdo->_lastEventMs = millis();
+        if (event == "put" || event == "patch") {
+            String path;
+            String value;
+            FirebaseStandInJson::member(data, "path", path);
+            FirebaseStandInJson::member(data, "data", value);
+            fbdo->setData(FirebaseStandInJson::unquote(path), value);
+            fbdo->_available = true;
+        } else if (event == "cancel" || event == "auth_revoked") {
+            fbdo->_error = event;
+            client.stop();
+            return false;
+        }
+        return true;
+    }
+
+    void endStream(FirebaseData* fbdo) { fbdo->_client.stop(); }
+
+    bool setInt(FirebaseData* fbdo, const char* path, int value) {
+        return request(fbdo, "PUT", path, String(value), false);
+    }
+    bool setString(FirebaseData* fbdo, const char* path, const String& value) {
+        return request(fbdo, "PUT", path, "\"" + value + "\"", false);
+    }
+    bool updateNodeSilent(FirebaseData* fbdo, const char* path, FirebaseJson* json) {
+        String body;
+        json->toString(body);
+        return request(fbdo, "PATCH", path, body, true);
+    }
+    bool getBool(FirebaseData* fbdo, const char* path) {
+        return request(fbdo, "GET", path, "", false) && expect(fbdo, "boolean");
+    }
+    bool getJSON(FirebaseData* fbdo, const char* path) {
+        return request(fbdo, "GET", path, "", false) && expect(fbdo, "json");
+    }
+
+private:
+    friend class FirebaseStandIn;
+
+    // The library's default config.timeout.rtdbKeepAlive
+    static const unsigned long STREAM_KEEP_ALIVE_TIMEOUT_MS = 45000;
+
+    bool connect(FirebaseData* fbdo) {
+        WiFiClientSecure& client = fbdo->_client;
+        client.setCACert(_caPem.c_str());
+        if (!client.connect("localhost", _port)) {
+            fbdo->_error = "connection refused";
+            return false;
+        }
+        fbdo->handshakes++;
+        return true;
+    }
+
+    bool request(FirebaseData* fbdo, const char* method, const char* path, const String& body, bool silent) {
+        WiFiClientSecure& client = fbdo->_client;
+        if (!client.connected() && !connect(fbdo)) {
+            return false;
+        }
+        String head = String(method) + " /" + path + ".json?auth=" + _idToken + (silent ? "&print=silent" : "") +
+                      " HTTP/1.1\r\nHost: " + _databaseHost +
+                      "\r\nUser-Agent: ESP\r\nX-Firebase-Decoding: 1\r\nKeep-Alive: timeout=30, max=100"
+                      "\r\nConnection: keep-alive\r\nContent-Length: " +
+                      String((unsigned)body.length()) + "\r\n\r\n";
+        String message = head + body;
+        if (client.write((const uint8_t*)message.c_str(), message.length()) != message.length()) {
+            fbdo->_error = "send request failed";
+            client.stop();
+            return false;
+        }
+
+        client.setTimeout(5000);
+        String status = client.readStringUntil('\n');
+        long contentLength = 0;
+        while (true) {
+            String line = client.readStringUntil('\n');
+            if (line.length() <= 1) {
+                break;
+            }
+            if (line.startsWith("Content-Length: ")) {
+                contentLength = line.substring(16).toInt();
+            }
+        }
+        String response;
+        for (long i = 0; i < contentLength; i++) {
+            char c;
+            if (client.readBytes(&c, 1) != 1) {
+                break;
+            }
+            response += c;
+        }
+        int code = status.length() > 12 ? status.substring(9, 12).toInt() : 0;
+        if (code != 200 && code != 204) {
+            fbdo->_error = code ? "bad request" : "response read timed out";
+            client.stop();
+            return false;
+        }
+        if (strcmp(method, "GET") == 0) {
+            fbdo->setData(path, response);
+        }
+        return true;
+    }
+
+    static bool expect(FirebaseData* fbdo, const char* type) {
+        if (fbdo->_type != type) {
+            fbdo->_error = "data type mismatch";
+            return false;
+        }
+        return true;
+    }
+
+    String _databaseHost;
+    uint16_t _port = 0;
+    String _caPem;
+    String _idToken;
+};
+
+struct TokenInfo {
+    String error;
+};
+typedef void (*TokenStatusCallback)(TokenInfo);
+
+struct FirebaseAuth {};
+
+struct FirebaseConfig {
+    String api_key;
+    String database_url;
+    struct {
+        struct {
+            String message;
+        } signupError;
+    } signer;
+    TokenStatusCallback token_status_callback = nullptr;
+};
+
+class FirebaseStandIn {
+public:
+    // Host only: where the library's config would point, plus the token the
+    // sign-up flow would have fetched
+    void begin(const char* databaseHost, uint16_t port, const char* caPem, const String& idToken) {
+        RTDB._databaseHost = databaseHost;
+        RTDB._port = port;
+        RTDB._caPem = caPem;
+        RTDB._idToken = idToken;
+    }
+
+    // Anonymous sign-up always succeeds; the host-only begin() set the token
+    bool signUp(FirebaseConfig* config, FirebaseAuth* auth, const String& email, const String& password) {
+        (void)config;
+        (void)auth;
+        (void)email;
+        (void)password;
+        return true;
+    }
+
+    void begin(FirebaseConfig* config, FirebaseAuth* auth) {
+        (void)config;
+        (void)auth;
+        _started = true;
+    }
+
+    void reconnectWiFi(bool reconnect) { (void)reconnect; }
+
+    // The token never expires here
+    bool ready() const { return _started; }
+
+    FB_RTDB RTDB;
+
+private:
+    bool _started = false;
+};
+
+inline FirebaseStandIn Firebase;
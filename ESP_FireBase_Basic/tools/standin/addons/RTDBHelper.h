@@ -0,0 +1,4 @@
+#pragma once
+
+// The sketch includes the library's RTDB payload printers but does not call
+// them; nothing is needed on the host.
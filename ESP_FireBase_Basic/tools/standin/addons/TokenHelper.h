@@ -0,0 +1,9 @@
+#pragma once
+
+// Host stand-in for the library's addons/TokenHelper.h. Tokens are not
+// modelled (see ../Firebase_ESP_Client.h), so there is no status to print.
+#include <Firebase_ESP_Client.h>
+
+inline void tokenStatusCallback(TokenInfo info) {
+    (void)info;
+}
@@ -0,0 +1,48 @@
+#include "EdgeBatch.h"
+
+namespace {
+
+uint8_t* putU16(uint8_t* p, uint16_t v) {
+    *p++ = v & 0xFF;
+    *p++ = v >> 8;
+    return p;
+}
+
+uint8_t* putU32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        *p++ = (v >> (8 * i)) & 0xFF;
+    }
+    return p;
+}
+
+uint8_t* putVarint(uint8_t* p, uint32_t v) {
+    while (v >= 0x80) {
+        *p++ = (v & 0x7F) | 0x80;
+        v >>= 7;
+    }
+    *p++ = v;
+    return p;
+}
+
+}  // namespace
+
+size_t EdgeBatch::encode(const EdgeEvent* events, size_t count, uint32_t dropped, uint8_t cpuMhz, uint8_t* out) {
+    if (count > 0xFFFF) {
+        count = 0xFFFF;
+    }
+
+    uint8_t* p = out;
+    *p++ = VERSION;
+    *p++ = cpuMhz;
+    p = putU16(p, count);
+    p = putU32(p, count ? events[0].cycles : 0);
+    p = putU32(p, dropped);
+
+    uint32_t prev = count ? events[0].cycles : 0;
+    for (size_t i = 0; i < count; i++) {
+        *p++ = (events[i].pin << 1) | (events[i].level & 1);
+        p = putVarint(p, events[i].cycles - prev);
+        prev = events[i].cycles;
+    }
+    return p - out;
+}
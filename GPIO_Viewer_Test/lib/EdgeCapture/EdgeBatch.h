@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "EdgeEvent.h"
+
+// Binary batch sent to the browser, little endian:
+//
+//   u8   version (1)
+//   u8   cpu clock in MHz, to turn cycles into time
+//   u16  event count
+//   u32  cycle count of the first event
+//   u32  total events dropped so far
+//   then per event:
+//     u8      pin << 1 | level
+//     varint  cycles since the previous event (0 for the first)
+//
+// Edges are usually close together, so most deltas fit in 2-3 bytes instead
+// of a full 4-byte timestamp.
+namespace EdgeBatch {
+
+constexpr uint8_t VERSION = 1;
+constexpr size_t HEADER_SIZE = 12;
+// 1 byte pin/level + up to 5 bytes of varint
+constexpr size_t MAX_EVENT_SIZE = 6;
+
+constexpr size_t maxSize(size_t events) { return HEADER_SIZE + events * MAX_EVENT_SIZE; }
+
+// out must hold maxSize(count) bytes; returns the encoded length
+size_t encode(const EdgeEvent* events, size_t count, uint32_t dropped, uint8_t cpuMhz, uint8_t* out);
+
+}  // namespace EdgeBatch
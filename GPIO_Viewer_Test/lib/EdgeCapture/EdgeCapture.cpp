@@ -0,0 +1,47 @@
+#include "EdgeCapture.h"
+
+#include <hal/cpu_hal.h>
+#include <hal/gpio_ll.h>
+
+void IRAM_ATTR EdgeCapture::onEdge(void* arg) {
+    Watch* w = static_cast<Watch*>(arg);
+    EdgeEvent ev;
+    ev.cycles = cpu_hal_get_cycle_count();
+    ev.pin = w->pin;
+    // Read the pad directly; the level may already have moved on if the
+    // pulse was shorter than the interrupt latency
+    ev.level = gpio_ll_get_level(&GPIO, (gpio_num_t)w->pin);
+    w->owner->_ring.push(ev);
+}
+
+bool EdgeCapture::watch(uint8_t pin) {
+    if (_pinCount >= MAX_PINS) {
+        return false;
+    }
+    Watch& w = _watches[_pinCount++];
+    w.owner = this;
+    w.pin = pin;
+    attachInterruptArg(pin, onEdge, &w, CHANGE);
+    return true;
+}
+
+void EdgeCapture::stop() {
+    for (size_t i = 0; i < _pinCount; i++) {
+        detachInterrupt(_watches[i].pin);
+    }
+    _pinCount = 0;
+}
+
+size_t EdgeCapture::drain(EdgeEvent* out, size_t max) {
+    size_t backlog = _ring.size();
+    if (backlog > _maxBacklog) {
+        _maxBacklog = backlog;
+    }
+
+    size_t n = 0;
+    while (n < max && _ring.pop(out[n])) {
+        n++;
+    }
+    _captured += n;
+    return n;
+}
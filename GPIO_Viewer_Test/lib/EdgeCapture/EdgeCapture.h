@@ -0,0 +1,49 @@
+#pragma once
+
+#include <Arduino.h>
+#include "EdgeEvent.h"
+#include "EdgeRing.h"
+
+// Interrupt-driven edge capture for a handful of GPIOs.
+//
+// Each watched pin gets a CHANGE interrupt whose handler stamps the edge with
+// the cycle counter and pushes it into one ring. GPIO interrupts are all
+// serviced by the shared GPIO ISR on the core that attached the first one,
+// so there is a single producer and a single cycle counter: the two cores'
+// counters are not synchronised, so edges stamped on different cores could
+// not be put in order. A single consumer task calls drain().
+//
+// Pins configured as OUTPUT can be watched too (the input path stays enabled),
+// which makes it easy to capture what the sketch itself is driving.
+class EdgeCapture {
+public:
+    static constexpr size_t MAX_PINS = 8;
+    static constexpr size_t RING_SIZE = 2048;
+
+    bool watch(uint8_t pin);
+    void stop();
+
+    // Move up to max events into out, oldest first. Consumer task only.
+    // watch() must always be called from the same core.
+    size_t drain(EdgeEvent* out, size_t max);
+
+    uint32_t captured() const { return _captured; }
+    uint32_t dropped() const { return _ring.overruns(); }
+    // Highest ring fill level seen by drain(), to size RING_SIZE
+    size_t maxBacklog() const { return _maxBacklog; }
+    size_t pinCount() const { return _pinCount; }
+
+private:
+    struct Watch {
+        EdgeCapture* owner;
+        uint8_t pin;
+    };
+
+    static void onEdge(void* arg);
+
+    EdgeRing<EdgeEvent, RING_SIZE> _ring;
+    Watch _watches[MAX_PINS];
+    size_t _pinCount = 0;
+    uint32_t _captured = 0;
+    size_t _maxBacklog = 0;
+};
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Plain C++ (no Arduino headers), so the ring and batch encoder build on the
+// host as well.
+
+struct EdgeEvent {
+    uint32_t cycles;  // CPU cycle counter when the ISR ran
+    uint8_t pin;
+    uint8_t level;
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+// Lock-free single-producer/single-consumer ring buffer, safe to push from an
+// ISR: push() is forced inline so it lands in the caller's IRAM section.
+// N must be a power of two.
+template <typename T, size_t N>
+class EdgeRing {
+    static_assert((N & (N - 1)) == 0, "EdgeRing size must be a power of two");
+
+public:
+    // Producer side. Returns false (and counts an overrun) when full.
+    inline __attribute__((always_inline)) bool push(const T& item) {
+        size_t head = _head.load(std::memory_order_relaxed);
+        size_t tail = _tail.load(std::memory_order_acquire);
+        if (head - tail >= N) {
+            _overruns.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        _items[head & (N - 1)] = item;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Look at the oldest item without removing it.
+    bool peek(T& item) const {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = _items[tail & (N - 1)];
+        return true;
+    }
+
+    // Consumer side. Returns false when empty.
+    bool pop(T& item) {
+        if (!peek(item)) {
+            return false;
+        }
+        _tail.store(_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t size() const {
+        return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+    }
+
+    uint32_t overruns() const { return _overruns.load(std::memory_order_relaxed); }
+
+private:
+    T _items[N];
+    std::atomic<size_t> _head{0};
+    std::atomic<size_t> _tail{0};
+    std::atomic<uint32_t> _overruns{0};
+};
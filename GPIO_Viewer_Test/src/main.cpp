@@ -1,4 +1,7 @@
 #include <gpio_viewer.h> // Must me the first include in your project
+#include <ESPAsyncWebServer.h>
+#include <EdgeCapture.h>
+#include <EdgeBatch.h>
 GPIOViewer gpio_viewer;
 
 const char *ssid = "KytherTek";
@@ -6,23 +9,194 @@ const char *password = "x11y22z33";
 
 #define DEMO_PIN  18
 
+// 1 = interrupt-driven edge capture streamed over a WebSocket,
+// 0 = GPIOViewer's fixed-interval polling. Capture mode replaces the
+// GPIOViewer UI: gpioViewer.begin() is not called, so its polling doesn't
+// compete with the capture task and only the capture page is served.
+#define CAPTURE_MODE 1
+// Pins to capture edges on (outputs are fine)
+const uint8_t WATCH_PINS[] = {DEMO_PIN};
+// Port for the capture page and WebSocket
+#define CAPTURE_PORT 80
+// How often the streaming task drains the capture ring
+#define STREAM_INTERVAL_MS 20
+// Events per WebSocket message
+#define MAX_BATCH_EVENTS 512
+#define STATS_INTERVAL_MS 5000
+// 1 = sweep a PWM signal on DEMO_PIN to find the highest edge rate that is
+// captured without drops (no jumper needed, the pin watches itself)
+#define BENCH_EDGE_RATE 0
+#define BENCH_SECONDS 2
+// A rate counts as sustained only if the captured edges are within this
+// fraction of 2 * freq * BENCH_SECONDS (PWM start/stop is not exact)
+#define BENCH_TOLERANCE 0.02f
+
 GPIOViewer gpioViewer;
 bool pinState = false;
 
+#if CAPTURE_MODE
+EdgeCapture capture;
+AsyncWebServer captureServer(CAPTURE_PORT);
+AsyncWebSocket edgeSocket("/edges");
+
+EdgeEvent batchEvents[MAX_BATCH_EVENTS];
+uint8_t batchBuffer[EdgeBatch::maxSize(MAX_BATCH_EVENTS)];
+
+uint32_t batchesSent = 0;
+uint32_t batchesSkipped = 0;
+uint64_t bytesSent = 0;
+uint32_t eventsSent = 0;
+
+const char CAPTURE_PAGE[] PROGMEM = R"rawliteral(
+<!DOCTYPE html><html><head><title>Edge capture</title></head>
+<body style="font-family:monospace">
+<h3>Edge capture</h3>
+<div id="stats"></div>
+<pre id="log"></pre>
+<script>
+const lines = [], maxLines = 40;
+let edges = 0, last = performance.now();
+const ws = new WebSocket(`ws://${location.host}/edges`);
+ws.binaryType = 'arraybuffer';
+ws.onmessage = (msg) => {
+  const d = new DataView(msg.data);
+  const mhz = d.getUint8(1), count = d.getUint16(2, true), dropped = d.getUint32(8, true);
+  let p = 12;
+  for (let i = 0; i < count; i++) {
+    const pl = d.getUint8(p++);
+    let delta = 0, shift = 0, b;
+    do { b = d.getUint8(p++); delta += (b & 0x7f) * 2 ** shift; shift += 7; } while (b & 0x80);
+    lines.push(`GPIO${pl >> 1} -> ${pl & 1}  +${(delta / mhz).toFixed(2)} us`);
+  }
+  lines.splice(0, Math.max(0, lines.length - maxLines));
+  edges += count;
+  const now = performance.now();
+  if (now - last >= 1000) {
+    document.getElementById('stats').textContent =
+      `${Math.round(edges * 1000 / (now - last))} edges/s, dropped ${dropped}`;
+    edges = 0;
+    last = now;
+  }
+  document.getElementById('log').textContent = lines.join('\n');
+};
+</script></body></html>
+)rawliteral";
+
+// Drains the capture ring and ships delta-encoded batches to the browser
+void streamTask(void* parameter) {
+  const uint8_t cpuMhz = getCpuFrequencyMhz();
+
+  while (true) {
+    size_t n;
+    while ((n = capture.drain(batchEvents, MAX_BATCH_EVENTS)) > 0) {
+      // Skip rather than queue when the socket can't keep up; the
+      // capture ring must keep draining either way
+      if (edgeSocket.count() == 0 || !edgeSocket.availableForWriteAll()) {
+        batchesSkipped++;
+        continue;
+      }
+      size_t len = EdgeBatch::encode(batchEvents, n, capture.dropped(), cpuMhz, batchBuffer);
+      edgeSocket.binaryAll(batchBuffer, len);
+      batchesSent++;
+      eventsSent += n;
+      bytesSent += len;
+    }
+    edgeSocket.cleanupClients();
+    vTaskDelay(pdMS_TO_TICKS(STREAM_INTERVAL_MS));
+  }
+}
+
+void printCaptureStats() {
+  static unsigned long lastReport = 0;
+  static uint32_t lastCaptured = 0;
+
+  unsigned long now = millis();
+  if (now - lastReport < STATS_INTERVAL_MS) {
+    return;
+  }
+  uint32_t captured = capture.captured();
+  float rate = (captured - lastCaptured) * 1000.0f / (now - lastReport);
+  lastReport = now;
+  lastCaptured = captured;
+
+  Serial.printf("Edges: %.0f/s, captured %u, dropped %u, max backlog %u/%u\n",
+                rate, captured, capture.dropped(), capture.maxBacklog(), EdgeCapture::RING_SIZE);
+  Serial.printf("Stream: %u batches sent, %u skipped, %.2f bytes/edge\n",
+                batchesSent, batchesSkipped, eventsSent ? (float)bytesSent / eventsSent : 0.0f);
+}
+
+#if BENCH_EDGE_RATE
+// PWM at increasing frequency; each period is two edges
+void benchEdgeRate() {
+  const uint32_t freqs[] = {1000, 5000, 10000, 25000, 50000, 75000, 100000};
+  uint32_t sustainable = 0;
+
+  Serial.println("Edge rate benchmark");
+  for (uint32_t freq : freqs) {
+    ledcSetup(0, freq, 8);
+    ledcAttachPin(DEMO_PIN, 0);
+
+    uint32_t capturedBefore = capture.captured();
+    uint32_t droppedBefore = capture.dropped();
+    ledcWrite(0, 128);
+    delay(BENCH_SECONDS * 1000);
+    ledcWrite(0, 0);
+    delay(2 * STREAM_INTERVAL_MS);  // let the stream task catch up
+
+    // No drops is not enough: edges that never raised an interrupt (ISR
+    // still busy with the previous one) don't show up as drops either
+    uint32_t expected = 2 * freq * BENCH_SECONDS;
+    uint32_t captured = capture.captured() - capturedBefore;
+    uint32_t dropped = capture.dropped() - droppedBefore;
+    float shortfall = captured < expected ? (float)(expected - captured) / expected : 0.0f;
+    Serial.printf("  %6u Hz: expected %7u edges/s, captured %7u/s (%.1f%% short), dropped %u\n",
+                  freq, 2 * freq, captured / BENCH_SECONDS, shortfall * 100, dropped);
+    if (dropped > 0 || shortfall > BENCH_TOLERANCE) {
+      break;
+    }
+    sustainable = 2 * freq;
+  }
+  ledcDetachPin(DEMO_PIN);
+  pinMode(DEMO_PIN, OUTPUT);
+  Serial.printf("Max sustainable edge rate: %u edges/s\n", sustainable);
+}
+#endif
+#endif
+
 void setup() {
   Serial.begin(115200);
   Serial.setDebugOutput(true);    // send ESP inbuilt log messages to Serial
-  
+
   pinMode(DEMO_PIN, OUTPUT);
 
   gpioViewer.connectToWifi(ssid, password);
+#if CAPTURE_MODE
+  for (uint8_t pin : WATCH_PINS) {
+    capture.watch(pin);
+  }
+  captureServer.on("/", HTTP_GET, [](AsyncWebServerRequest* request) {
+    request->send_P(200, "text/html", CAPTURE_PAGE);
+  });
+  captureServer.addHandler(&edgeSocket);
+  captureServer.begin();
+  // Capture ISRs run on this core (where watch() was called), streaming on the other
+  xTaskCreatePinnedToCore(streamTask, "EdgeStream", 4096, NULL, 1, NULL, 0);
+  Serial.printf("Edge capture on http://%s:%d/\n", WiFi.localIP().toString().c_str(), CAPTURE_PORT);
+#if BENCH_EDGE_RATE
+  benchEdgeRate();
+#endif
+#else
   gpioViewer.setSamplingInterval(125);
   gpioViewer.begin();
+#endif
 }
 
 void loop() {
   pinState = !pinState;
   digitalWrite(DEMO_PIN, pinState);
   log_i("Current pin state: %d", pinState);
+#if CAPTURE_MODE
+  printCaptureStats();
+#endif
   delay(1000);
-}
\ No newline at end of file
+}
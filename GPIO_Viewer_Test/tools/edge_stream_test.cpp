@@ -0,0 +1,229 @@
+// Host test for the edge capture pipeline: the capture ring, drain() and the
+// WebSocket batch encoding, with the same sizes and drain interval as the
+// sketch.
+//
+// One producer thread stands in for the GPIO ISR, which serves every watched
+// pin on one core, and pushes synthetic edges on two pins stamped from a
+// 240 MHz virtual cycle counter that starts just below its 32-bit wrap. A
+// consumer thread drains every 20 ms, encodes each batch, decodes it the way
+// the capture page does and checks:
+//   - every edge is either delivered or counted as dropped
+//   - edges arrive in time order across both pins, across the counter wrap
+//   - each pin's levels alternate unless edges were dropped
+//   - batches decode to exactly the drained events
+//
+//   g++ -O2 -std=c++17 -pthread -I../lib/EdgeCapture -o edge_stream_test
+//       edge_stream_test.cpp ../lib/EdgeCapture/EdgeBatch.cpp
+//
+//   ./edge_stream_test                  # sweep 10k..1M edges/s, 1 s each
+//   ./edge_stream_test 200000 5         # 200k edges/s for 5 s
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "EdgeBatch.h"
+#include "EdgeEvent.h"
+#include "EdgeRing.h"
+
+namespace {
+
+// Same as EdgeCapture::RING_SIZE and the sketch's stream settings
+constexpr size_t RING_SIZE = 2048;
+constexpr int STREAM_INTERVAL_MS = 20;
+constexpr size_t MAX_BATCH_EVENTS = 512;
+constexpr uint8_t CPU_MHZ = 240;
+// Half a second before the cycle counter wraps, so every run crosses it
+constexpr uint32_t CYCLE_START = 0xFFFFFFFFu - CPU_MHZ * 500000u;
+
+using Clock = std::chrono::steady_clock;
+using Ring = EdgeRing<EdgeEvent, RING_SIZE>;
+
+struct Result {
+    uint64_t generated = 0;
+    uint64_t delivered = 0;
+    uint64_t dropped = 0;
+    uint64_t errors = 0;
+    uint64_t bytes = 0;
+    size_t maxBacklog = 0;
+};
+
+Clock::time_point epoch;
+
+uint32_t cycleCount() {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - epoch).count();
+    return CYCLE_START + (uint32_t)(ns * CPU_MHZ / 1000);
+}
+
+const uint8_t PINS[2] = {4, 18};
+
+// Pushes edges at `rate` per second until `stop`, alternating between the pins
+void produce(Ring& ring, double rate, std::atomic<bool>& stop, std::atomic<uint64_t>& generated) {
+    auto start = Clock::now();
+    uint64_t sent = 0;
+    uint8_t levels[2] = {0, 0};
+    while (!stop.load(std::memory_order_relaxed)) {
+        double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        uint64_t due = (uint64_t)(elapsed * rate);
+        if (sent >= due) {
+            std::this_thread::yield();
+            continue;
+        }
+        for (; sent < due; sent++) {
+            int i = sent & 1;
+            levels[i] ^= 1;
+            ring.push(EdgeEvent{cycleCount(), PINS[i], levels[i]});
+        }
+    }
+    generated += sent;
+}
+
+size_t drain(Ring& ring, EdgeEvent* out, size_t max) {
+    size_t n = 0;
+    while (n < max && ring.pop(out[n])) {
+        n++;
+    }
+    return n;
+}
+
+// What the capture page does with a batch
+size_t decode(const uint8_t* p, size_t len, std::vector<EdgeEvent>& out, uint32_t& dropped) {
+    if (len < EdgeBatch::HEADER_SIZE || p[0] != EdgeBatch::VERSION) {
+        return 0;
+    }
+    size_t count = p[2] | p[3] << 8;
+    uint32_t cycles = p[4] | p[5] << 8 | p[6] << 16 | (uint32_t)p[7] << 24;
+    dropped = p[8] | p[9] << 8 | p[10] << 16 | (uint32_t)p[11] << 24;
+    size_t at = EdgeBatch::HEADER_SIZE;
+    out.clear();
+    for (size_t i = 0; i < count && at < len; i++) {
+        uint8_t pinLevel = p[at++];
+        uint32_t delta = 0;
+        int shift = 0;
+        uint8_t b;
+        do {
+            b = p[at++];
+            delta |= (uint32_t)(b & 0x7F) << shift;
+            shift += 7;
+        } while ((b & 0x80) && at < len);
+        cycles += delta;
+        out.push_back(EdgeEvent{cycles, (uint8_t)(pinLevel >> 1), (uint8_t)(pinLevel & 1)});
+    }
+    return at == len ? out.size() : 0;
+}
+
+Result run(double rate, double seconds) {
+    std::unique_ptr<Ring> ring(new Ring());
+
+    Result r;
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> generated{0};
+    epoch = Clock::now();
+    std::thread isr(produce, std::ref(*ring), rate, std::ref(stop), std::ref(generated));
+
+    static EdgeEvent batch[MAX_BATCH_EVENTS];
+    static uint8_t encoded[EdgeBatch::maxSize(MAX_BATCH_EVENTS)];
+    std::vector<EdgeEvent> decoded;
+    uint32_t lastCycles = 0;
+    bool first = true;
+    uint8_t lastLevel[2] = {0, 0};
+    bool seen[2] = {false, false};
+
+    auto end = Clock::now() + std::chrono::duration<double>(seconds);
+    bool producing = true;
+    while (true) {
+        if (producing && Clock::now() >= end) {
+            stop = true;
+            isr.join();
+            producing = false;
+        }
+        size_t backlog = ring->size();
+        if (backlog > r.maxBacklog) {
+            r.maxBacklog = backlog;
+        }
+        size_t n;
+        // EdgeCapture::drain()
+        while ((n = drain(*ring, batch, MAX_BATCH_EVENTS)) > 0) {
+            uint32_t dropped = ring->overruns();
+            size_t len = EdgeBatch::encode(batch, n, dropped, CPU_MHZ, encoded);
+            uint32_t decodedDropped;
+            if (decode(encoded, len, decoded, decodedDropped) != n || decodedDropped != dropped) {
+                r.errors++;
+            }
+            for (size_t i = 0; i < n; i++) {
+                const EdgeEvent& e = batch[i];
+                if (i < decoded.size() &&
+                    (decoded[i].cycles != e.cycles || decoded[i].pin != e.pin || decoded[i].level != e.level)) {
+                    r.errors++;
+                }
+                // One clock for every pin: strictly in time order
+                if (!first && (int32_t)(e.cycles - lastCycles) < 0) {
+                    r.errors++;
+                }
+                int pin = e.pin == PINS[0] ? 0 : 1;
+                // Levels alternate unless edges in between were dropped
+                if (seen[pin] && ring->overruns() == 0 && e.level == lastLevel[pin]) {
+                    r.errors++;
+                }
+                seen[pin] = true;
+                lastLevel[pin] = e.level;
+                lastCycles = e.cycles;
+                first = false;
+            }
+            r.delivered += n;
+            r.bytes += len;
+        }
+        if (!producing) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(STREAM_INTERVAL_MS));
+    }
+    r.generated = generated;
+    r.dropped = ring->overruns();
+    if (r.delivered + r.dropped != r.generated) {
+        r.errors++;
+    }
+    return r;
+}
+
+void report(double rate, const Result& r) {
+    printf("%8.0f edges/s: generated %8llu, delivered %8llu, dropped %7llu, max backlog %4zu/%zu, "
+           "%.2f bytes/edge, %llu errors\n",
+           rate, (unsigned long long)r.generated, (unsigned long long)r.delivered, (unsigned long long)r.dropped,
+           r.maxBacklog, RING_SIZE, r.delivered ? (double)r.bytes / r.delivered : 0.0,
+           (unsigned long long)r.errors);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::vector<double> rates = {10000, 50000, 100000, 200000, 500000, 1000000};
+    double seconds = 1;
+    if (argc > 1) {
+        rates = {atof(argv[1])};
+    }
+    if (argc > 2) {
+        seconds = atof(argv[2]);
+    }
+
+    uint64_t errors = 0;
+    double sustainable = 0;
+    bool keptUp = true;
+    for (double rate : rates) {
+        Result r = run(rate, seconds);
+        report(rate, r);
+        errors += r.errors;
+        // Sustained means nothing dropped and the producers kept their pace
+        keptUp = keptUp && r.dropped == 0 && r.generated >= rate * seconds * 0.98;
+        if (keptUp) {
+            sustainable = rate;
+        }
+    }
+    printf("Max rate without drops: %.0f edges/s (host consumer, %d ms drain interval)\n", sustainable,
+           STREAM_INTERVAL_MS);
+    printf("%s\n", errors ? "FAILED" : "all passed");
+    return errors ? 1 : 0;
+}
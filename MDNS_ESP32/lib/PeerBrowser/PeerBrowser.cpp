@@ -0,0 +1,216 @@
+#include "PeerBrowser.h"
+
+// How long a single background query listens for answers
+static const uint32_t QUERY_TIMEOUT_MS = 1500;
+static const size_t QUERY_MAX_RESULTS = 20;
+// TTL used when a responder does not report one
+static const uint32_t DEFAULT_TTL_S = 120;
+// Refresh records this long before they expire
+static const unsigned long EXPIRY_MARGIN_MS = 5000;
+
+PeerBrowser::PeerBrowser(const char* service, const char* proto)
+    : _service(service), _proto(proto) {}
+
+PeerBrowser::~PeerBrowser() {
+    end();
+}
+
+void PeerBrowser::begin(const String& selfHostname, unsigned long refreshIntervalMs) {
+    _self = selfHostname;
+    _refreshInterval = refreshIntervalMs;
+    _running = true;
+    _nextRefresh = millis();
+}
+
+void PeerBrowser::end() {
+    if (_search) {
+        mdns_query_async_delete(_search);
+        _search = nullptr;
+    }
+    _peers.clear();
+    _running = false;
+    _missPending = false;
+}
+
+void PeerBrowser::startQuery() {
+    _search = mdns_query_async_new(NULL, _service, _proto, MDNS_TYPE_PTR,
+                                   QUERY_TIMEOUT_MS, QUERY_MAX_RESULTS);
+    if (_search) {
+        _queries++;
+    } else {
+        // Could not allocate the query; try again on the next interval
+        scheduleNextRefresh();
+    }
+}
+
+void PeerBrowser::loop() {
+    if (!_running) {
+        return;
+    }
+
+    if (_search) {
+        mdns_result_t* results = NULL;
+        // Zero timeout: only checks whether the query has finished
+        if (mdns_query_async_get_results(_search, 0, &results)) {
+            collectResults(results);
+            if (results) {
+                mdns_query_results_free(results);
+            }
+            mdns_query_async_delete(_search);
+            _search = nullptr;
+
+            if (_missPending) {
+                _missMillis += millis() - _pendingMissAt;
+                _resolvedMisses++;
+                _missPending = false;
+            }
+            scheduleNextRefresh();
+        }
+        return;
+    }
+
+    evictExpired();
+    if ((long)(millis() - _nextRefresh) >= 0) {
+        startQuery();
+    }
+}
+
+void PeerBrowser::collectResults(mdns_result_t* results) {
+    unsigned long now = millis();
+
+    for (mdns_result_t* r = results; r; r = r->next) {
+        if (!r->hostname || _self.equalsIgnoreCase(r->hostname)) {
+            continue;
+        }
+
+        IPAddress ip;
+        for (mdns_ip_addr_t* a = r->addr; a; a = a->next) {
+            if (a->addr.type == ESP_IPADDR_TYPE_V4) {
+                ip = IPAddress(a->addr.u_addr.ip4.addr);
+                break;
+            }
+        }
+
+        uint32_t ttl = r->ttl ? r->ttl : DEFAULT_TTL_S;
+
+        Peer* peer = nullptr;
+        for (auto& p : _peers) {
+            if (p.hostname.equalsIgnoreCase(r->hostname)) {
+                peer = &p;
+                break;
+            }
+        }
+        if (!peer) {
+            _peers.push_back(Peer());
+            peer = &_peers.back();
+            peer->hostname = r->hostname;
+        }
+
+        peer->instance = r->instance_name ? r->instance_name : "";
+        peer->ip = ip;
+        peer->port = r->port;
+        peer->expiresAt = now + ttl * 1000UL;
+    }
+}
+
+void PeerBrowser::evictExpired() {
+    unsigned long now = millis();
+    for (size_t i = 0; i < _peers.size();) {
+        if ((long)(now - _peers[i].expiresAt) >= 0) {
+            _peers.erase(_peers.begin() + i);
+        } else {
+            i++;
+        }
+    }
+}
+
+void PeerBrowser::scheduleNextRefresh() {
+    unsigned long now = millis();
+    unsigned long next = now + _refreshInterval;
+
+    // Re-query before the first cached record expires
+    for (const auto& p : _peers) {
+        unsigned long due = p.expiresAt - EXPIRY_MARGIN_MS;
+        if ((long)(due - next) < 0) {
+            next = due;
+        }
+    }
+    if ((long)(next - now) < (long)QUERY_TIMEOUT_MS) {
+        next = now + QUERY_TIMEOUT_MS;
+    }
+    _nextRefresh = next;
+}
+
+const Peer* PeerBrowser::find(const String& hostname) {
+    unsigned long start = micros();
+    unsigned long now = millis();
+
+    for (const auto& p : _peers) {
+        if (p.hostname.equalsIgnoreCase(hostname) && (long)(now - p.expiresAt) < 0) {
+            _hits++;
+            _scanMicros += micros() - start;
+            return &p;
+        }
+    }
+
+    // Miss: ask the network right away instead of waiting for the next refresh
+    _misses++;
+    if (!_missPending) {
+        _missPending = true;
+        _pendingMissAt = now;
+    }
+    if (!_search) {
+        _nextRefresh = now;
+    }
+    return nullptr;
+}
+
+// JSON string literal; mDNS labels may hold any byte, quotes included
+static String jsonString(const String& s) {
+    String out = "\"";
+    for (size_t i = 0; i < s.length(); i++) {
+        char c = s[i];
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if ((uint8_t)c < 0x20) {
+            char esc[7];
+            snprintf(esc, sizeof(esc), "\\u%04x", (uint8_t)c);
+            out += esc;
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+    return out;
+}
+
+String PeerBrowser::toJson(const Peer& p) {
+    String json = "{\"hostname\":" + jsonString(p.hostname);
+    json += ",\"instance\":" + jsonString(p.instance);
+    json += ",\"ip\":\"" + p.ip.toString() + "\"";
+    json += ",\"port\":" + String(p.port);
+    json += ",\"ttl\":" + String((long)(p.expiresAt - millis()) / 1000) + "}";
+    return json;
+}
+
+String PeerBrowser::toJson() const {
+    String json = "{\"peers\":[";
+
+    for (size_t i = 0; i < _peers.size(); i++) {
+        if (i > 0) {
+            json += ",";
+        }
+        json += toJson(_peers[i]);
+    }
+
+    json += "],\"stats\":{";
+    json += "\"queries\":" + String(_queries);
+    json += ",\"hits\":" + String(_hits);
+    json += ",\"misses\":" + String(_misses);
+    // Hits only scan the cached vector; no network round trip is involved
+    json += ",\"avgCacheScanUs\":" + String(_hits ? (double)_scanMicros / _hits : 0.0, 2);
+    json += ",\"avgMissMs\":" + String(_resolvedMisses ? (double)_missMillis / _resolvedMisses : 0.0, 1);
+    json += "}}";
+    return json;
+}
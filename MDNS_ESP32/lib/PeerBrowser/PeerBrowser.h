@@ -0,0 +1,65 @@
+#pragma once
+
+#include <Arduino.h>
+#include <IPAddress.h>
+#include <vector>
+#include "mdns.h"
+
+// A peer discovered through mDNS service browsing
+struct Peer {
+    String hostname;
+    String instance;
+    IPAddress ip;
+    uint16_t port;
+    unsigned long expiresAt;  // millis() at which the record's TTL runs out
+};
+
+// Non-blocking mDNS service browser.
+// Queries run in the background through the ESP-IDF async query API and the
+// results are cached until their TTL expires, so lookups never block loop().
+class PeerBrowser {
+public:
+    PeerBrowser(const char* service, const char* proto);
+    ~PeerBrowser();
+
+    // Start browsing; the cache is refreshed at least every refreshIntervalMs
+    void begin(const String& selfHostname, unsigned long refreshIntervalMs = 60000);
+    // Drop any running query and the cache (e.g. when the network goes down)
+    void end();
+    // Drive the background query; call from loop()
+    void loop();
+
+    // Cache lookup by hostname (without ".local"). A miss schedules a query.
+    const Peer* find(const String& hostname);
+    const std::vector<Peer>& peers() const { return _peers; }
+
+    // JSON document with the peer list and lookup statistics
+    String toJson() const;
+    // One peer as a JSON object; names are escaped, as responders pick them
+    static String toJson(const Peer& peer);
+
+private:
+    void startQuery();
+    void collectResults(mdns_result_t* results);
+    void evictExpired();
+    void scheduleNextRefresh();
+
+    const char* _service;
+    const char* _proto;
+    String _self;
+    bool _running = false;
+    unsigned long _refreshInterval = 60000;
+    unsigned long _nextRefresh = 0;
+    mdns_search_once_t* _search = nullptr;
+    std::vector<Peer> _peers;
+
+    // Lookup statistics
+    uint32_t _queries = 0;
+    uint32_t _hits = 0;
+    uint32_t _misses = 0;
+    uint64_t _scanMicros = 0;  // time spent scanning _peers on hits, not network time
+    uint32_t _resolvedMisses = 0;
+    uint64_t _missMillis = 0;
+    unsigned long _pendingMissAt = 0;
+    bool _missPending = false;
+};
@@ -1,6 +1,8 @@
 #include <WiFi.h>
 #include <ESPmDNS.h>
 #include <WebServer.h>
+#include <PeerBrowser.h>
+#include <WiFiConnectionManager.h>
 
 const char* ssid = "Testwifi";
 const char* password = "x11y22z33";
@@ -9,6 +11,9 @@ const char* baseHostname = "esp32";
 WebServer server(80);
 String hostname;
 
+// Background discovery of other HTTP devices on the network
+PeerBrowser peerBrowser("_http", "_tcp");
+
 String generateHostname() {
     // Use the last 3 bytes of MAC address to create a unique hostname
     uint8_t mac[6];
@@ -18,27 +23,12 @@ String generateHostname() {
     return String(baseHostname) + "-" + String(chipId);
 }
 
-void setup() {
-    Serial.begin(115200);
-    
-    // Generate unique hostname
-    hostname = generateHostname();
-    
-    // Connect to WiFi
-    WiFi.begin(ssid, password);
-    while (WiFi.status() != WL_CONNECTED) {
-        delay(500);
-        Serial.print(".");
-    }
-    Serial.println("");
-    Serial.println("WiFi connected");
-    
-    // Initialize mDNS with unique hostname
+void startMdns() {
+    // Re-register from scratch on every (re)connect
+    MDNS.end();
     if (!MDNS.begin(hostname.c_str())) {
         Serial.println("Error setting up mDNS responder!");
-        while(1) {
-            delay(1000);
-        }
+        return;
     }
     Serial.println("mDNS responder started");
     Serial.print("Device hostname: ");
@@ -46,6 +36,22 @@ void setup() {
     
     // Add service to mDNS
     MDNS.addService("_http", "_tcp", 80);
+
+    peerBrowser.begin(hostname);
+}
+
+void setup() {
+    Serial.begin(115200);
+    
+    // Generate unique hostname
+    hostname = generateHostname();
+    
+    // Connect to WiFi in the background; mDNS follows the link state
+    Connectivity.onConnected(startMdns);
+    Connectivity.onDisconnected([]() {
+        peerBrowser.end();
+    });
+    Connectivity.begin(ssid, password);
     
     // Set up web server routes
     server.on("/", []() {
@@ -53,11 +59,27 @@ void setup() {
         html += "<p>Access this device using: " + hostname + ".local</p>";
         server.send(200, "text/html", html);
     });
+
+    // Discovered peers; "/peers?host=name" looks up a single peer in the cache
+    server.on("/peers", []() {
+        if (server.hasArg("host")) {
+            const Peer* peer = peerBrowser.find(server.arg("host"));
+            if (!peer) {
+                server.send(404, "application/json", "{\"error\":\"not cached, query scheduled\"}");
+                return;
+            }
+            server.send(200, "application/json", PeerBrowser::toJson(*peer));
+            return;
+        }
+        server.send(200, "application/json", peerBrowser.toJson());
+    });
     
     server.begin();
     Serial.println("HTTP server started");
 }
 
 void loop() {
+    Connectivity.loop();
     server.handleClient();
-}
\ No newline at end of file
+    peerBrowser.loop();
+}
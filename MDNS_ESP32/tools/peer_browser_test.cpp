@@ -0,0 +1,332 @@
+// Host test for lib/PeerBrowser against real multicast on lib/HostHAL.
+//
+// Forks responder processes that announce _http._tcp on a private mDNS port,
+// one of them with a quote and a backslash in its host and instance names,
+// then browses for them the way the sketch does: discovery, self filtering,
+// cache hits and misses, and eviction once a responder goes away and its
+// TTL runs out. Every JSON document must parse and decode back to the names
+// the responders announced. Prints how long discovery and a miss take and
+// what a cache hit costs (a scan of the cached vector, nothing more).
+//
+//   g++ -O2 -std=gnu++17 -pthread -I../../lib/HostHAL -I../lib/PeerBrowser
+//       -o peer_browser_test peer_browser_test.cpp ../lib/PeerBrowser/PeerBrowser.cpp
+//       ../../lib/HostHAL/*.cpp -lssl -lcrypto
+//
+//   ./peer_browser_test
+#include <signal.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <HostTest.h>
+
+#include "PeerBrowser.h"
+
+using HostTest::check;
+
+namespace {
+
+// Off 5353, so the test neither needs nor disturbs a system responder
+const char* MDNS_PORT = "15353";
+const char* RECORD_TTL_S = "6";
+const char* SELF = "self-node";
+
+struct Responder {
+    const char* hostname;
+    const char* instance;
+    uint16_t port;
+    pid_t pid;
+};
+
+Responder responders[] = {
+    {"node-a", "Node A", 8081, 0},
+    {"node\"quote\\back", "Lab \"bench\" \\ 2", 8082, 0},
+    {"node-c", "Node C", 8083, 0},
+};
+const size_t RESPONDERS = sizeof(responders) / sizeof(responders[0]);
+
+void announce(const char* hostname, const char* instance, uint16_t port) {
+    mdns_init();
+    mdns_hostname_set(hostname);
+    mdns_instance_name_set(instance);
+    mdns_service_add(instance, "_http", "_tcp", port, nullptr, 0);
+}
+
+// Runs in the child: connect the simulated STA so A records carry an
+// address, announce, and answer until killed
+void runResponder(const Responder& r) {
+    hostAdoptTask("loopTask");
+    WiFi.mode(WIFI_STA);
+    WiFi.begin("standin");
+    while (WiFi.status() != WL_CONNECTED) {
+        delay(10);
+    }
+    announce(r.hostname, r.instance, r.port);
+    while (true) {
+        pause();
+    }
+}
+
+// Minimal JSON parser; keeps every decoded string so names can be compared
+class JsonCheck {
+public:
+    explicit JsonCheck(const std::string& s) : _s(s) {}
+    bool valid() {
+        skip();
+        if (!value()) {
+            return false;
+        }
+        skip();
+        return _i == _s.size();
+    }
+    bool hasString(const std::string& s) const {
+        for (const auto& v : strings) {
+            if (v == s) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::vector<std::string> strings;
+
+private:
+    void skip() {
+        while (_i < _s.size() && isspace((unsigned char)_s[_i])) {
+            _i++;
+        }
+    }
+    bool literal(const char* word) {
+        size_t n = strlen(word);
+        if (_s.compare(_i, n, word) != 0) {
+            return false;
+        }
+        _i += n;
+        return true;
+    }
+    bool string() {
+        if (_i >= _s.size() || _s[_i] != '"') {
+            return false;
+        }
+        std::string out;
+        for (_i++; _i < _s.size(); _i++) {
+            char c = _s[_i];
+            if (c == '"') {
+                _i++;
+                strings.push_back(out);
+                return true;
+            }
+            if ((unsigned char)c < 0x20) {
+                return false;
+            }
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (++_i >= _s.size()) {
+                return false;
+            }
+            c = _s[_i];
+            if (c == 'u') {
+                if (_i + 4 >= _s.size()) {
+                    return false;
+                }
+                out += (char)strtol(_s.substr(_i + 1, 4).c_str(), nullptr, 16);
+                _i += 4;
+            } else if (strchr("\"\\/", c)) {
+                out += c;
+            } else if (strchr("bfnrt", c)) {
+                out += c == 'n' ? '\n' : c == 't' ? '\t' : c == 'r' ? '\r' : c == 'b' ? '\b' : '\f';
+            } else {
+                return false;
+            }
+        }
+        return false;
+    }
+    bool number() {
+        size_t start = _i;
+        if (_s[_i] == '-') {
+            _i++;
+        }
+        while (_i < _s.size() && (isdigit((unsigned char)_s[_i]) || strchr(".eE+-", _s[_i]))) {
+            _i++;
+        }
+        return _i > start;
+    }
+    bool value() {
+        skip();
+        if (_i >= _s.size()) {
+            return false;
+        }
+        char c = _s[_i];
+        if (c == '{' || c == '[') {
+            char close = c == '{' ? '}' : ']';
+            _i++;
+            skip();
+            if (_i < _s.size() && _s[_i] == close) {
+                _i++;
+                return true;
+            }
+            while (true) {
+                skip();
+                if (c == '{') {
+                    if (!string()) {
+                        return false;
+                    }
+                    skip();
+                    if (_i >= _s.size() || _s[_i++] != ':') {
+                        return false;
+                    }
+                }
+                if (!value()) {
+                    return false;
+                }
+                skip();
+                if (_i < _s.size() && _s[_i] == ',') {
+                    _i++;
+                    continue;
+                }
+                if (_i < _s.size() && _s[_i] == close) {
+                    _i++;
+                    return true;
+                }
+                return false;
+            }
+        }
+        if (c == '"') {
+            return string();
+        }
+        if (c == 't' || c == 'f' || c == 'n') {
+            return literal("true") || literal("false") || literal("null");
+        }
+        return number();
+    }
+
+    const std::string& _s;
+    size_t _i = 0;
+};
+
+bool cached(const PeerBrowser& browser, const char* hostname) {
+    for (const Peer& p : browser.peers()) {
+        if (p.hostname == hostname) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Drives loop() until done() holds; returns the milliseconds it took, or -1
+template <typename Done>
+long pollUntil(PeerBrowser& browser, unsigned long timeoutMs, Done done) {
+    unsigned long start = millis();
+    while (millis() - start < timeoutMs) {
+        browser.loop();
+        if (done()) {
+            return (long)(millis() - start);
+        }
+        delay(5);
+    }
+    return -1;
+}
+
+double threadMicros() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+void stopResponders() {
+    for (Responder& r : responders) {
+        if (r.pid > 0) {
+            kill(r.pid, SIGTERM);
+            waitpid(r.pid, nullptr, 0);
+            r.pid = 0;
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    setenv("HOST_MDNS_PORT", MDNS_PORT, 0);
+    setenv("HOST_MDNS_TTL", RECORD_TTL_S, 0);
+    unsigned long ttlMs = strtoul(getenv("HOST_MDNS_TTL"), nullptr, 10) * 1000UL;
+
+    // Fork before this process starts any HAL thread
+    for (Responder& r : responders) {
+        r.pid = fork();
+        if (r.pid == 0) {
+            runResponder(r);
+        }
+    }
+    hostAdoptTask("loopTask");
+    // Our own announcement must not come back as a peer
+    announce(SELF, "Self", 8080);
+    delay(300);
+
+    PeerBrowser browser("_http", "_tcp");
+    browser.begin(SELF, 60000);
+
+    long discoverMs = pollUntil(browser, 10000, [&] { return browser.peers().size() >= RESPONDERS; });
+    printf("discovery: %ld ms\n", discoverMs);
+    check(discoverMs >= 0 && browser.peers().size() == RESPONDERS, "all responders discovered");
+    check(!cached(browser, SELF), "own announcement filtered out");
+
+    const Peer* quoted = browser.find(responders[1].hostname);
+    check(quoted && quoted->instance == responders[1].instance && quoted->port == responders[1].port,
+          "quoted names survive the wire");
+    check(quoted && (uint32_t)quoted->ip != 0, "peer has an IPv4 address");
+    check(browser.find("NODE-A") != nullptr, "lookup ignores case");
+
+    // Hit cost: a linear scan of the cached vector
+    const int LOOKUPS = 100000;
+    double start = threadMicros();
+    for (int i = 0; i < LOOKUPS; i++) {
+        browser.find("node-c");
+    }
+    double perHit = (threadMicros() - start) / LOOKUPS;
+    printf("cache hit: %.3f us per find() with %u peers cached\n", perHit, (unsigned)browser.peers().size());
+
+    // Miss: the query starts right away and the stats time it
+    check(browser.find("absent-node") == nullptr, "unknown host misses");
+    long missMs = pollUntil(browser, 5000, [&] { return strstr(browser.toJson().c_str(), "\"avgMissMs\":0.0") == nullptr; });
+    printf("miss resolved: %ld ms\n", missMs);
+    check(missMs >= 0, "miss triggers an immediate query");
+
+    std::string list = browser.toJson().c_str();
+    JsonCheck listJson(list);
+    check(listJson.valid(), "peer list is valid JSON");
+    check(listJson.hasString(responders[1].hostname) && listJson.hasString(responders[1].instance),
+          "escaped names decode back");
+    check(listJson.hasString("avgCacheScanUs"), "hit stat is labelled as a cache scan");
+    if (quoted) {
+        std::string one = PeerBrowser::toJson(*quoted).c_str();
+        JsonCheck oneJson(one);
+        check(oneJson.valid() && oneJson.hasString(responders[1].hostname), "single peer is valid JSON");
+    }
+
+    // Eviction: stop one responder; its records expire, the rest refresh
+    Responder& gone = responders[2];
+    kill(gone.pid, SIGTERM);
+    waitpid(gone.pid, nullptr, 0);
+    gone.pid = 0;
+    long evictMs = pollUntil(browser, ttlMs + 5000, [&] { return !cached(browser, gone.hostname); });
+    printf("evicted after %ld ms (TTL %lu ms)\n", evictMs, ttlMs);
+    check(evictMs >= 0 && evictMs <= (long)ttlMs + 2000, "silent peer evicted once its TTL runs out");
+    pollUntil(browser, ttlMs, [] { return false; });
+    check(cached(browser, responders[0].hostname) && cached(browser, responders[1].hostname),
+          "live peers stay cached past their TTL");
+
+    printf("%s\n", browser.toJson().c_str());
+    browser.end();
+    mdns_free();
+    stopResponders();
+    return HostTest::finish();
+}
@@ -1,7 +1,80 @@
 import serial
+import threading
 import time
 
-def monitor_serial(port='/dev/ttyUSB0', baudrate=115200, timeout=1):
+from protocol import FrameDecoder, TYPE_ECHO, TYPE_HELLO, TYPE_SAMPLE, TYPE_TEXT
+
+# Upper bound for a single read; large reads keep per-call overhead low
+READ_CHUNK = 65536
+
+
+def read_chunk(ser):
+    # Block (up to the port timeout) for the first byte, then take
+    # everything else that is already buffered in one call
+    return ser.read(min(max(ser.in_waiting, 1), READ_CHUNK))
+
+
+def echo_test(ser, count=1000, interval=0.002, settle=1.0):
+    """Round-trip test: send numbered lines, match the ECHO records that come back.
+
+    Returns latency percentiles in ms and how many lines were never echoed.
+    """
+    sent_at = {}
+    rtts = []
+    done = threading.Event()
+
+    def sender():
+        for i in range(count):
+            line = f"ping {i}\n".encode()
+            sent_at[i] = time.perf_counter()
+            ser.write(line)
+            time.sleep(interval)
+        done.set()
+
+    decoder = FrameDecoder()
+    thread = threading.Thread(target=sender, daemon=True)
+    thread.start()
+
+    deadline = None
+    while deadline is None or time.perf_counter() < deadline:
+        if deadline is None and done.is_set():
+            # Give the last echoes time to arrive
+            deadline = time.perf_counter() + settle
+        for frame in decoder.feed(read_chunk(ser)):
+            if frame.type != TYPE_ECHO or not frame.payload.startswith(b'ping '):
+                continue
+            t0 = sent_at.pop(int(frame.payload[5:]), None)
+            if t0 is not None:
+                rtts.append((time.perf_counter() - t0) * 1000.0)
+        if len(rtts) == count:
+            break
+    thread.join()
+
+    rtts.sort()
+
+    def pct(p):
+        return rtts[min(len(rtts) - 1, int(p / 100.0 * len(rtts)))] if rtts else float('nan')
+
+    return {
+        'sent': count,
+        'echoed': len(rtts),
+        'lost': count - len(rtts),
+        'rtt_min_ms': rtts[0] if rtts else float('nan'),
+        'rtt_p50_ms': pct(50),
+        'rtt_p99_ms': pct(99),
+        'rtt_max_ms': rtts[-1] if rtts else float('nan'),
+        'bad_frames': decoder.bad_frames,
+    }
+
+
+def print_echo_result(r):
+    print(f"Echo: {r['echoed']}/{r['sent']} returned ({r['lost']} lost), "
+          f"RTT min {r['rtt_min_ms']:.2f} / p50 {r['rtt_p50_ms']:.2f} / "
+          f"p99 {r['rtt_p99_ms']:.2f} / max {r['rtt_max_ms']:.2f} ms, "
+          f"bad frames: {r['bad_frames']}")
+
+
+def monitor_serial(port='/dev/ttyUSB0', baudrate=921600, timeout=1):
     try:
         # Configure serial connection
         ser = serial.Serial(
@@ -12,30 +85,46 @@ def monitor_serial(port='/dev/ttyUSB0', baudrate=115200, timeout=1):
             parity=serial.PARITY_NONE,
             stopbits=serial.STOPBITS_ONE
         )
-        
+
         print(f"Connected to {port} at {baudrate} baud")
-        
+
+        decoder = FrameDecoder()
+        samples = 0
+        last_report = time.monotonic()
+
         while True:
-            # Read data if available
-            if ser.in_waiting > 0:
-                try:
-                    # Read line and decode
-                    line = ser.readline().decode('utf-8').strip()
-                    print(f"Received: {line}")
-                except UnicodeDecodeError:
-                    print("Error decoding message")
-                    
+            for frame in decoder.feed(read_chunk(ser)):
+                if frame.type == TYPE_SAMPLE:
+                    # Too many to print one by one; summarised below
+                    samples += 1
+                elif frame.type in (TYPE_HELLO, TYPE_TEXT):
+                    print(f"Received: {frame.payload.decode('utf-8', errors='replace')}")
+
+            now = time.monotonic()
+            if now - last_report >= 1.0:
+                print(f"Samples: {samples / (now - last_report):.0f}/s, "
+                      f"bad frames: {decoder.bad_frames}, lost frames: {decoder.lost_frames}")
+                samples = 0
+                last_report = now
+
     except serial.SerialException as e:
         print(f"Error: {e}")
-        
+
     finally:
         if 'ser' in locals():
             ser.close()
             print("Serial connection closed")
 
 if __name__ == "__main__":
+    import sys
+
     # Change these parameters according to your setup
-    PORT = "/dev/ttyUSB0"  
-    BAUD_RATE = 115200
-    
-    monitor_serial(PORT, BAUD_RATE)
\ No newline at end of file
+    PORT = "/dev/ttyUSB0"
+    BAUD_RATE = 921600
+
+    if "--echo" in sys.argv:
+        # Round-trip latency/loss against the device's line echo
+        with serial.Serial(PORT, BAUD_RATE, timeout=0.1) as ser:
+            print_echo_result(echo_test(ser))
+    else:
+        monitor_serial(PORT, BAUD_RATE)
@@ -0,0 +1,268 @@
+"""Throughput benchmark for the framed serial protocol over a pty loopback.
+
+A writer thread plays the ESP32: it streams sample records into the master
+side of a pseudo-terminal, paced to the chosen baud rate (10 bits per byte,
+8N1). The reader opens the slave side with pyserial and decodes it exactly
+like app.py does.
+
+    python bench.py                 # 115200 and 921600 baud, 5 s each
+    python bench.py -b 921600 -d 10
+    python bench.py --echo          # round-trip latency/loss via app.echo_test
+    python bench.py --ports 16      # collector.py against 16 simulated devices
+
+In echo mode the simulated device mirrors the firmware's RX path instead:
+it assembles lines from the master side and answers each with an ECHO
+record, delayed by the time the bytes would spend on the wire.
+
+In multi-port mode each simulated device is a separate process replaying
+pre-encoded frames, so the collector's CPU time is measured on its own.
+"""
+import argparse
+import asyncio
+import multiprocessing
+import os
+import tempfile
+import threading
+import time
+import tty
+
+import serial
+
+from app import echo_test, print_echo_result, read_chunk
+from collector import Collector
+from protocol import FrameDecoder, TYPE_ECHO, TYPE_SAMPLE, encode_frame, encode_sample
+
+WRITE_SLICE_S = 0.005
+
+
+def device_writer(fd, baudrate, stop):
+    bytes_per_s = baudrate / 10
+    seq = 0
+    pending = b''
+    start = time.perf_counter()
+    sent = 0
+
+    while not stop.is_set():
+        # Stay on the byte budget the UART would allow
+        budget = int((time.perf_counter() - start) * bytes_per_s) - sent
+        if budget <= 0:
+            time.sleep(WRITE_SLICE_S)
+            continue
+
+        while len(pending) < budget:
+            t_us = int(time.perf_counter() * 1e6)
+            pending += encode_sample(seq, t_us, 0, seq)
+            seq += 1
+
+        try:
+            n = os.write(fd, pending[:budget])
+        except OSError:
+            break
+        pending = pending[n:]
+        sent += n
+
+
+def device_echo(fd, baudrate, stop, max_line=255):
+    wire_s_per_byte = 10 / baudrate
+    line = bytearray()
+    discarding = False
+    seq = 0
+
+    while not stop.is_set():
+        try:
+            data = os.read(fd, 4096)
+        except OSError:
+            break
+        # Bytes can't arrive faster than the UART clocks them in
+        time.sleep(len(data) * wire_s_per_byte)
+
+        for c in data:
+            if c == 0x0D:
+                continue
+            if c == 0x0A:
+                if not discarding:
+                    frame = encode_frame(TYPE_ECHO, seq, bytes(line))
+                    seq += 1
+                    time.sleep(len(frame) * wire_s_per_byte)
+                    os.write(fd, frame)
+                discarding = False
+                line.clear()
+            elif discarding:
+                continue
+            elif len(line) >= max_line:
+                discarding = True
+            else:
+                line.append(c)
+
+
+def device_replayer(fd, frames, baudrate, duration):
+    bytes_per_s = baudrate / 10
+    pos = 0
+    sent = 0
+    # Never block on a full pty, so the run always ends on time
+    os.set_blocking(fd, False)
+    start = time.perf_counter()
+
+    while time.perf_counter() - start < duration:
+        budget = int((time.perf_counter() - start) * bytes_per_s) - sent
+        if budget <= 0:
+            time.sleep(WRITE_SLICE_S)
+            continue
+        chunk = frames[pos:pos + budget]
+        try:
+            n = os.write(fd, chunk)
+        except BlockingIOError:
+            time.sleep(WRITE_SLICE_S)
+            continue
+        except OSError:
+            break
+        pos = (pos + n) % len(frames)
+        sent += n
+
+
+def run_ports(count, baudrate, duration):
+    ptys = []
+    for _ in range(count):
+        master, slave = os.openpty()
+        tty.setraw(master)
+        tty.setraw(slave)
+        ptys.append((master, slave))
+
+    out = tempfile.NamedTemporaryFile(suffix='.arrows', delete=False)
+    out.close()
+    collector = Collector([os.ttyname(s) for _, s in ptys], out.name, baudrate, quiet=True)
+
+    # One full 16-bit sequence cycle of frames, encoded up front so the
+    # simulated devices cost next to nothing
+    frames = b''.join(encode_sample(seq, seq * 100, 0, seq) for seq in range(0x10000))
+    devices = [multiprocessing.Process(target=device_replayer, args=(m, frames, baudrate, duration + 1), daemon=True)
+               for m, _ in ptys]
+    for d in devices:
+        d.start()
+
+    cpu_start = time.process_time()
+    wall = asyncio.run(collector.run(duration))
+    cpu = time.process_time() - cpu_start
+
+    collector.close()
+    for d in devices:
+        d.join()
+    for m, s in ptys:
+        os.close(m)
+        os.close(s)
+
+    records = sum(r.records for r in collector.readers)
+    result = {
+        'ports': count,
+        'baud': baudrate,
+        'records_per_s': records / wall,
+        'link_utilisation': sum(r.bytes for r in collector.readers) / wall / (count * baudrate / 10),
+        'collector_cpu_percent': 100.0 * cpu / wall,
+        'bad_frames': sum(r.decoder.bad_frames for r in collector.readers),
+        'lost_frames': sum(r.decoder.lost_frames for r in collector.readers),
+        'file_bytes_per_record': os.path.getsize(out.name) / max(collector.rows_written, 1),
+    }
+    os.unlink(out.name)
+    return result
+
+
+def open_loopback(baudrate):
+    master, slave = os.openpty()
+    tty.setraw(master)
+    tty.setraw(slave)
+    ser = serial.Serial(os.ttyname(slave), baudrate=baudrate, timeout=0.1)
+    return master, slave, ser
+
+
+def run_echo(baudrate, count, interval):
+    master, slave, ser = open_loopback(baudrate)
+    stop = threading.Event()
+    device = threading.Thread(target=device_echo, args=(master, baudrate, stop), daemon=True)
+    device.start()
+
+    r = echo_test(ser, count=count, interval=interval)
+
+    stop.set()
+    ser.close()
+    # Closing the slave wakes the device thread's read with EIO
+    os.close(slave)
+    device.join()
+    os.close(master)
+    r['baud'] = baudrate
+    return r
+
+
+def run(baudrate, duration):
+    master, slave, ser = open_loopback(baudrate)
+    stop = threading.Event()
+    writer = threading.Thread(target=device_writer, args=(master, baudrate, stop), daemon=True)
+
+    decoder = FrameDecoder()
+    records = 0
+    received = 0
+
+    writer.start()
+    wall_start = time.perf_counter()
+    cpu_start = time.thread_time()
+    while time.perf_counter() - wall_start < duration:
+        data = read_chunk(ser)
+        received += len(data)
+        for frame in decoder.feed(data):
+            if frame.type == TYPE_SAMPLE:
+                records += 1
+    wall = time.perf_counter() - wall_start
+    cpu = time.thread_time() - cpu_start
+
+    stop.set()
+    writer.join()
+    ser.close()
+    os.close(master)
+    os.close(slave)
+
+    return {
+        'baud': baudrate,
+        'records_per_s': records / wall,
+        'bytes_per_s': received / wall,
+        'link_utilisation': received / wall / (baudrate / 10),
+        'reader_cpu_percent': 100.0 * cpu / wall,
+        'bad_frames': decoder.bad_frames,
+        'lost_frames': decoder.lost_frames,
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('-b', '--baud', type=int, action='append',
+                        help='baud rate to test (repeatable, default 115200 and 921600)')
+    parser.add_argument('-d', '--duration', type=float, default=5.0, help='seconds per run')
+    parser.add_argument('--echo', action='store_true', help='run the round-trip echo test instead')
+    parser.add_argument('-p', '--ports', type=int, help='benchmark collector.py with this many devices')
+    parser.add_argument('-n', '--count', type=int, default=1000, help='lines to send in echo mode')
+    parser.add_argument('-i', '--interval', type=float, default=0.002,
+                        help='seconds between echo lines')
+    args = parser.parse_args()
+
+    if args.ports:
+        for baud in args.baud or [921600]:
+            r = run_ports(args.ports, baud, args.duration)
+            print(f"{r['ports']} ports @ {r['baud']} baud: {r['records_per_s']:8.0f} records/s "
+                  f"({r['link_utilisation']:.0%} of links), collector CPU {r['collector_cpu_percent']:4.1f}%, "
+                  f"{r['file_bytes_per_record']:.1f} bytes/record on disk, "
+                  f"bad {r['bad_frames']}, lost {r['lost_frames']}")
+        return
+
+    for baud in args.baud or [115200, 921600]:
+        if args.echo:
+            r = run_echo(baud, args.count, args.interval)
+            print(f"{r['baud']:>7} baud: ", end='')
+            print_echo_result(r)
+            continue
+        r = run(baud, args.duration)
+        print(f"{r['baud']:>7} baud: {r['records_per_s']:8.0f} records/s, "
+              f"{r['bytes_per_s'] / 1024:6.1f} KiB/s ({r['link_utilisation']:.0%} of link), "
+              f"reader CPU {r['reader_cpu_percent']:4.1f}%, "
+              f"bad {r['bad_frames']}, lost {r['lost_frames']}")
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,198 @@
+"""Event-driven collector for many framed-serial devices at once.
+
+Every port is registered with the asyncio event loop (add_reader), so the
+process sleeps until one of them has data instead of polling in_waiting.
+Each chunk is stamped with its arrival time, decoded, and sample records are
+appended to column buffers that are written out as Arrow IPC record batches
+(streaming format, append-only) every flush interval.
+
+    python collector.py /dev/ttyUSB0 /dev/ttyUSB1 -o rack.arrows
+    python replay.py rack.arrows
+"""
+import argparse
+import asyncio
+import os
+import time
+from array import array
+
+import pyarrow as pa
+import serial
+
+from protocol import FrameDecoder, SAMPLE, TYPE_HELLO, TYPE_SAMPLE, TYPE_TEXT
+
+READ_CHUNK = 65536
+FLUSH_INTERVAL_S = 1.0
+# Flush early if this many rows are buffered, to bound memory
+FLUSH_ROWS = 262144
+REPORT_INTERVAL_S = 5.0
+
+SCHEMA = pa.schema([
+    ('port', pa.uint16()),
+    ('arrival_ns', pa.int64()),
+    ('seq', pa.uint16()),
+    ('t_us', pa.uint32()),
+    ('channel', pa.uint16()),
+    ('value', pa.int32()),
+])
+
+
+
+def column(arrow_type, values):
+    # Wraps the array's memory directly, no per-value conversion
+    return pa.Array.from_buffers(arrow_type, len(values), [None, pa.py_buffer(values)])
+
+
+class PortReader:
+    def __init__(self, index, name, fd, collector):
+        self.index = index
+        self.name = name
+        self.fd = fd
+        self.collector = collector
+        self.decoder = FrameDecoder()
+        self.records = 0
+        self.bytes = 0
+
+    def on_readable(self):
+        try:
+            data = os.read(self.fd, READ_CHUNK)
+        except BlockingIOError:
+            return
+        except OSError:
+            data = b''
+        if not data:
+            # Device went away
+            self.collector.remove(self)
+            return
+
+        arrival = time.time_ns()
+        self.bytes += len(data)
+        sink = self.collector
+        n = 0
+        for frame in self.decoder.feed(data):
+            if frame.type == TYPE_SAMPLE:
+                if len(frame.payload) == SAMPLE.size:
+                    sink.seqs.append(frame.seq)
+                    sink.payloads += frame.payload
+                    n += 1
+            elif frame.type in (TYPE_HELLO, TYPE_TEXT):
+                print(f"[{self.name}] {frame.payload.decode('utf-8', errors='replace')}")
+        if n:
+            # Everything in one read arrived together, so it shares a timestamp
+            sink.ports.extend([self.index] * n)
+            sink.arrivals.extend([arrival] * n)
+            self.records += n
+            if len(sink.ports) >= FLUSH_ROWS:
+                sink.flush()
+
+
+class Collector:
+    def __init__(self, ports, output, baudrate=921600, flush_interval=FLUSH_INTERVAL_S, quiet=False):
+        self.output = output
+        self.flush_interval = flush_interval
+        self.quiet = quiet
+        self.readers = []
+        self.rows_written = 0
+        self.batches_written = 0
+
+        self.ports = array('H')
+        self.arrivals = array('q')
+        self.seqs = array('H')
+        self.payloads = bytearray()
+
+        self._serials = []
+        for index, name in enumerate(ports):
+            ser = serial.Serial(name, baudrate=baudrate, timeout=0)
+            self._serials.append(ser)
+            self.readers.append(PortReader(index, name, ser.fileno(), self))
+
+        metadata = {'ports': ','.join(ports)}
+        self._sink = pa.OSFile(output, 'wb')
+        self._writer = pa.ipc.new_stream(self._sink, SCHEMA.with_metadata(metadata))
+
+    def remove(self, reader):
+        asyncio.get_running_loop().remove_reader(reader.fd)
+        print(f"[{reader.name}] closed")
+
+    def flush(self):
+        rows = len(self.ports)
+        if rows == 0:
+            return
+        # Payloads are packed records; split them into columns in one pass
+        t_us, channel, value = zip(*SAMPLE.iter_unpack(self.payloads))
+        batch = pa.RecordBatch.from_arrays([
+            column(pa.uint16(), self.ports),
+            column(pa.int64(), self.arrivals),
+            column(pa.uint16(), self.seqs),
+            column(pa.uint32(), array('I', t_us)),
+            column(pa.uint16(), array('H', channel)),
+            column(pa.int32(), array('i', value)),
+        ], schema=SCHEMA)
+        self._writer.write_batch(batch)
+        # Push it to the OS so a crash loses at most one interval
+        self._sink.flush()
+
+        self.rows_written += rows
+        self.batches_written += 1
+        self.ports = array('H')
+        self.arrivals = array('q')
+        self.seqs = array('H')
+        self.payloads = bytearray()
+
+    def report(self, elapsed):
+        total = sum(r.records for r in self.readers)
+        print(f"{total / elapsed:.0f} records/s from {len(self.readers)} ports, "
+              f"{self.rows_written} rows in {self.batches_written} batches")
+        for r in self.readers:
+            d = r.decoder
+            if d.bad_frames or d.lost_frames:
+                print(f"  [{r.name}] bad frames: {d.bad_frames}, lost frames: {d.lost_frames}")
+
+    async def run(self, duration=None):
+        loop = asyncio.get_running_loop()
+        for r in self.readers:
+            loop.add_reader(r.fd, r.on_readable)
+
+        start = time.monotonic()
+        last_report = start
+        try:
+            while duration is None or time.monotonic() - start < duration:
+                await asyncio.sleep(self.flush_interval)
+                self.flush()
+                now = time.monotonic()
+                if not self.quiet and now - last_report >= REPORT_INTERVAL_S:
+                    self.report(now - start)
+                    last_report = now
+        finally:
+            for r in self.readers:
+                loop.remove_reader(r.fd)
+            self.flush()
+        return time.monotonic() - start
+
+    def close(self):
+        self._writer.close()
+        self._sink.close()
+        for ser in self._serials:
+            ser.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('ports', nargs='+', help='serial devices to collect from')
+    parser.add_argument('-b', '--baud', type=int, default=921600)
+    parser.add_argument('-o', '--output', default=time.strftime('capture-%Y%m%d-%H%M%S.arrows'))
+    parser.add_argument('-f', '--flush-interval', type=float, default=FLUSH_INTERVAL_S,
+                        help='seconds between record batch writes')
+    args = parser.parse_args()
+
+    collector = Collector(args.ports, args.output, args.baud, args.flush_interval)
+    print(f"Collecting from {len(args.ports)} ports into {args.output}")
+    try:
+        asyncio.run(collector.run())
+    except KeyboardInterrupt:
+        pass
+    finally:
+        collector.close()
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,130 @@
+"""Binary framed serial protocol shared with pyserial.ino.
+
+Frame on the wire:  COBS(header | payload | crc16) 0x00
+
+    header   type:u8  seq:u16le  len:u8
+    crc16    CRC-16/CCITT-FALSE over header + payload, little endian
+
+COBS guarantees 0x00 only appears as the frame delimiter, so a receiver can
+resynchronise after line noise by skipping to the next zero byte.
+"""
+import binascii
+import struct
+from collections import namedtuple
+
+TYPE_HELLO = 0x01
+TYPE_SAMPLE = 0x02
+TYPE_TEXT = 0x03
+TYPE_ECHO = 0x04  # payload is a received line, verbatim
+
+HEADER = struct.Struct('<BHB')
+SAMPLE = struct.Struct('<IHi')  # t_us:u32, channel:u16, value:i32
+
+Frame = namedtuple('Frame', 'type seq payload')
+Sample = namedtuple('Sample', 't_us channel value')
+
+
+def crc16(data, crc=0xFFFF):
+    # crc_hqx is CRC-CCITT (poly 0x1021, no reflection); with a 0xFFFF seed
+    # it matches CRC-16/CCITT-FALSE as computed on the device
+    return binascii.crc_hqx(data, crc)
+
+
+def cobs_encode(data):
+    out = bytearray()
+    for block in bytes(data).split(b'\x00'):
+        # Blocks longer than 254 bytes are split with 0xFF codes
+        while len(block) >= 254:
+            out.append(0xFF)
+            out += block[:254]
+            block = block[254:]
+        out.append(len(block) + 1)
+        out += block
+    return bytes(out)
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    n = len(data)
+    while i < n:
+        code = data[i]
+        if code == 0 or i + code > n + 1:
+            raise ValueError('invalid COBS code')
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < n:
+            out.append(0)
+    return bytes(out)
+
+
+def encode_frame(frame_type, seq, payload=b''):
+    body = HEADER.pack(frame_type, seq & 0xFFFF, len(payload)) + payload
+    body += struct.pack('<H', crc16(body))
+    return cobs_encode(body) + b'\x00'
+
+
+def encode_sample(seq, t_us, channel, value):
+    return encode_frame(TYPE_SAMPLE, seq, SAMPLE.pack(t_us & 0xFFFFFFFF, channel, value))
+
+
+def parse_sample(payload):
+    return Sample._make(SAMPLE.unpack(payload))
+
+
+class FrameDecoder:
+    """Incremental decoder: feed it whatever bytes arrived, get whole frames.
+
+    Tracks CRC/format errors and sequence gaps so link quality can be reported.
+    """
+
+    def __init__(self):
+        self._buf = bytearray()
+        self._next_seq = None
+        self.frames = 0
+        self.bad_frames = 0
+        self.lost_frames = 0
+
+    def feed(self, data):
+        self._buf += data
+        if b'\x00' not in data:
+            return []
+
+        *chunks, rest = self._buf.split(b'\x00')
+        self._buf = bytearray(rest)
+
+        frames = []
+        for chunk in chunks:
+            if not chunk:
+                continue
+            frame = self._decode(chunk)
+            if frame is not None:
+                frames.append(frame)
+        return frames
+
+    def _decode(self, chunk):
+        try:
+            body = cobs_decode(chunk)
+        except ValueError:
+            self.bad_frames += 1
+            return None
+
+        if len(body) < HEADER.size + 2:
+            self.bad_frames += 1
+            return None
+        (crc,) = struct.unpack_from('<H', body, len(body) - 2)
+        if crc16(memoryview(body)[:-2]) != crc:
+            self.bad_frames += 1
+            return None
+
+        frame_type, seq, length = HEADER.unpack_from(body)
+        payload = body[HEADER.size:-2]
+        if len(payload) != length:
+            self.bad_frames += 1
+            return None
+
+        if self._next_seq is not None and seq != self._next_seq:
+            self.lost_frames += (seq - self._next_seq) & 0xFFFF
+        self._next_seq = (seq + 1) & 0xFFFF
+        self.frames += 1
+        return Frame(frame_type, seq, payload)
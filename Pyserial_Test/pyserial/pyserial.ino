@@ -1,18 +1,176 @@
-// Basic communication example
+// Binary framed communication example
+//
+// Every record goes out as COBS(header | payload | crc16) followed by 0x00,
+// matching protocol.py on the host:
+//   header: type (u8), seq (u16 LE), payload length (u8)
+//   crc16:  CRC-16/CCITT-FALSE over header + payload (LE)
+
+#define SERIAL_BAUD 921600
+// UART driver TX ring buffer; the driver drains it from its ISR
+#define TX_BUFFER_SIZE 8192
+// UART driver RX ring buffer, filled from the RX interrupt; large enough to
+// ride out a few ms of loop() latency at full baud rate
+#define RX_BUFFER_SIZE 4096
+// Sample records per second (0 = as fast as the link allows)
+#define SAMPLE_RATE_HZ 0
+#define HELLO_INTERVAL_MS 1000
+
+#define TYPE_HELLO 0x01
+#define TYPE_SAMPLE 0x02
+#define TYPE_TEXT 0x03
+#define TYPE_ECHO 0x04
+
+#define MAX_PAYLOAD 255
+// Worst case COBS overhead is one byte per 254, plus the delimiter
+#define MAX_FRAME (4 + MAX_PAYLOAD + 2 + 3 + 1)
+
+uint16_t txSeq = 0;
+uint32_t framesSent = 0;
+uint32_t framesDropped = 0;
+unsigned long lastHello = 0;
+unsigned long lastSampleUs = 0;
+
+// Incoming line being assembled, byte by byte
+char rxLine[MAX_PAYLOAD + 1];
+size_t rxLen = 0;
+bool rxDiscarding = false;
+uint32_t linesReceived = 0;
+uint32_t rxOverflows = 0;
+
+uint16_t crc16(const uint8_t* data, size_t len, uint16_t crc = 0xFFFF) {
+  while (len--) {
+    crc ^= (uint16_t)(*data++) << 8;
+    for (int i = 0; i < 8; i++) {
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+// COBS-encode src into dst and append the 0x00 delimiter; returns the size
+size_t cobsEncode(const uint8_t* src, size_t len, uint8_t* dst) {
+  size_t out = 1;
+  size_t codeAt = 0;
+  uint8_t code = 1;
+
+  for (size_t i = 0; i < len; i++) {
+    if (src[i] == 0) {
+      dst[codeAt] = code;
+      codeAt = out++;
+      code = 1;
+    } else {
+      dst[out++] = src[i];
+      if (++code == 0xFF) {
+        dst[codeAt] = code;
+        codeAt = out++;
+        code = 1;
+      }
+    }
+  }
+  dst[codeAt] = code;
+  dst[out++] = 0;
+  return out;
+}
+
+// Queue one frame without blocking; dropped (and counted) if the TX buffer
+// can't take it whole
+bool sendFrame(uint8_t type, const void* payload, uint8_t len) {
+  uint8_t raw[4 + MAX_PAYLOAD + 2];
+  uint8_t frame[MAX_FRAME];
+
+  raw[0] = type;
+  raw[1] = txSeq & 0xFF;
+  raw[2] = txSeq >> 8;
+  raw[3] = len;
+  memcpy(raw + 4, payload, len);
+  uint16_t crc = crc16(raw, 4 + len);
+  raw[4 + len] = crc & 0xFF;
+  raw[5 + len] = crc >> 8;
+
+  size_t n = cobsEncode(raw, 6 + len, frame);
+  if ((size_t)Serial.availableForWrite() < n) {
+    framesDropped++;
+    return false;
+  }
+  Serial.write(frame, n);
+  txSeq++;
+  framesSent++;
+  return true;
+}
+
+void sendText(const char* text) {
+  size_t len = strlen(text);
+  sendFrame(TYPE_TEXT, text, len > MAX_PAYLOAD ? MAX_PAYLOAD : len);
+}
+
+struct __attribute__((packed)) SampleRecord {
+  uint32_t tUs;
+  uint16_t channel;
+  int32_t value;
+};
+
+// Echo each complete line back as an ECHO record
+void handleLine(const char* line, size_t len) {
+  linesReceived++;
+  sendFrame(TYPE_ECHO, line, len);
+}
+
+// Drain whatever the RX interrupt has buffered; never waits for more
+void serviceRx() {
+  int n = Serial.available();
+  while (n-- > 0) {
+    char c = (char)Serial.read();
+    if (c == '\r') {
+      continue;
+    }
+    if (c == '\n') {
+      if (!rxDiscarding) {
+        handleLine(rxLine, rxLen);
+      }
+      rxDiscarding = false;
+      rxLen = 0;
+    } else if (rxDiscarding) {
+      continue;
+    } else if (rxLen >= MAX_PAYLOAD) {
+      // Longer than one record can carry: drop the rest of the line
+      rxOverflows++;
+      rxDiscarding = true;
+    } else {
+      rxLine[rxLen++] = c;
+    }
+  }
+}
+
 void setup() {
-  Serial.begin(115200);  // Initialize serial communication at 115200 baud
+  Serial.setRxBufferSize(RX_BUFFER_SIZE);
+  Serial.setTxBufferSize(TX_BUFFER_SIZE);
+  Serial.begin(SERIAL_BAUD);  // Initialize serial communication
   delay(1000);  // Give time for serial to initialize
 }
 
 void loop() {
+  unsigned long nowMs = millis();
+  unsigned long nowUs = micros();
+
   // Send data to computer
-  Serial.println("Hello from ESP32!");
-  delay(1000);  // Send every second
+  if (nowMs - lastHello >= HELLO_INTERVAL_MS) {
+    lastHello = nowMs;
+    char hello[96];
+    int n = snprintf(hello, sizeof(hello), "Hello from ESP32! lines=%u overflows=%u dropped=%u",
+                     linesReceived, rxOverflows, framesDropped);
+    sendFrame(TYPE_HELLO, hello, n);
+  }
 
-  // Check for incoming data
-  if (Serial.available()) {
-    String received = Serial.readStringUntil('\n');
-    Serial.print("ESP32 received: ");
-    Serial.println(received);
+  if (SAMPLE_RATE_HZ == 0 || nowUs - lastSampleUs >= 1000000UL / (SAMPLE_RATE_HZ ? SAMPLE_RATE_HZ : 1)) {
+    lastSampleUs = nowUs;
+    SampleRecord rec = {nowUs, 0, (int32_t)framesSent};
+    // Only fill the buffer while there is room, so the loop never blocks,
+    // and always leave space for an echo
+    if ((size_t)Serial.availableForWrite() >= 2 * MAX_FRAME) {
+      sendFrame(TYPE_SAMPLE, &rec, sizeof(rec));
+    }
   }
-}
\ No newline at end of file
+
+  // Check for incoming data
+  serviceRx();
+}
@@ -0,0 +1,97 @@
+"""Replay a capture written by collector.py.
+
+By default prints a per-port summary. With --to, the sample records are
+re-encoded as frames and written to a serial port (or pty) with their
+original arrival timing, so app.py or the collector can be exercised
+against a recorded session.
+
+    python replay.py rack.arrows
+    python replay.py rack.arrows --port 3 --to /dev/pts/7 --speed 2
+"""
+import argparse
+import time
+
+import pyarrow as pa
+import serial
+
+from protocol import encode_sample
+
+
+def read_batches(path):
+    # Stream format has no footer, so a capture cut short by a crash is
+    # still readable up to the last complete batch
+    with pa.OSFile(path, 'rb') as source:
+        reader = pa.ipc.open_stream(source)
+        ports = reader.schema.metadata.get(b'ports', b'').decode().split(',')
+        while True:
+            try:
+                batch = reader.read_next_batch()
+            except StopIteration:
+                return
+            except (pa.ArrowInvalid, OSError):
+                print("Warning: capture ends with a truncated batch")
+                return
+            yield ports, batch
+
+
+def summarize(path):
+    stats = {}
+    ports = []
+    for ports, batch in read_batches(path):
+        cols = batch.to_pydict()
+        for port, arrival in zip(cols['port'], cols['arrival_ns']):
+            s = stats.setdefault(port, [0, arrival, arrival])
+            s[0] += 1
+            s[1] = min(s[1], arrival)
+            s[2] = max(s[2], arrival)
+
+    for port in sorted(stats):
+        count, first, last = stats[port]
+        span = (last - first) / 1e9
+        name = ports[port] if port < len(ports) else str(port)
+        rate = count / span if span > 0 else 0.0
+        print(f"{name}: {count} records over {span:.1f} s ({rate:.0f}/s)")
+
+
+def replay(path, port, target, baudrate, speed):
+    ser = serial.Serial(target, baudrate=baudrate)
+    start_wall = None
+    start_arrival = None
+    sent = 0
+
+    for _, batch in read_batches(path):
+        cols = batch.to_pydict()
+        for i, p in enumerate(cols['port']):
+            if p != port:
+                continue
+            arrival = cols['arrival_ns'][i]
+            if start_wall is None:
+                start_wall = time.perf_counter()
+                start_arrival = arrival
+            delay = (arrival - start_arrival) / 1e9 / speed - (time.perf_counter() - start_wall)
+            if delay > 0:
+                time.sleep(delay)
+            ser.write(encode_sample(cols['seq'][i], cols['t_us'][i], cols['channel'][i], cols['value'][i]))
+            sent += 1
+
+    ser.close()
+    print(f"Replayed {sent} records from port {port}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('capture')
+    parser.add_argument('--to', help='serial device to replay into')
+    parser.add_argument('--port', type=int, default=0, help='port index from the capture to replay')
+    parser.add_argument('-b', '--baud', type=int, default=921600)
+    parser.add_argument('--speed', type=float, default=1.0, help='playback speed factor')
+    args = parser.parse_args()
+
+    if args.to:
+        replay(args.capture, args.port, args.to, args.baud, args.speed)
+    else:
+        summarize(args.capture)
+
+
+if __name__ == '__main__':
+    main()
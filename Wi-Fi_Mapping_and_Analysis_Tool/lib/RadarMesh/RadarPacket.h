@@ -0,0 +1,109 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// UDP packet a radar node sends to the site collector. Plain C++ so the
+// Linux collector/simulator can share it. All fields little endian.
+//
+//   header (16 bytes)
+//     u8   magic 'R'
+//     u8   version
+//     u16  node id
+//     u32  sequence number, per node
+//     u32  node clock (ms) when the scan finished
+//     i16  node x position, decimetres
+//     i16  node y position, decimetres
+//   entries (8 bytes each, up to MAX_ENTRIES)
+//     u8[6] bssid
+//     i8    rssi in dBm, RSSI_LOST if the node no longer sees the AP
+//     u8    channel
+//
+// Entries only cover APs whose RSSI moved since the node last reported
+// them, so a quiet site costs a few bytes per scan.
+namespace RadarPacket {
+
+constexpr uint8_t MAGIC = 'R';
+constexpr uint8_t VERSION = 1;
+constexpr size_t HEADER_SIZE = 16;
+constexpr size_t ENTRY_SIZE = 8;
+constexpr size_t MAX_ENTRIES = 64;
+constexpr size_t MAX_SIZE = HEADER_SIZE + MAX_ENTRIES * ENTRY_SIZE;
+constexpr int8_t RSSI_LOST = -128;
+
+struct Header {
+    uint16_t nodeId;
+    uint32_t seq;
+    uint32_t nodeTimeMs;
+    int16_t xDm;
+    int16_t yDm;
+};
+
+struct Entry {
+    uint8_t bssid[6];
+    int8_t rssi;
+    uint8_t channel;
+};
+
+inline uint64_t bssidKey(const uint8_t* bssid) {
+    uint64_t key = 0;
+    for (int i = 0; i < 6; i++) {
+        key = (key << 8) | bssid[i];
+    }
+    return key;
+}
+
+inline void keyToBssid(uint64_t key, uint8_t* bssid) {
+    for (int i = 5; i >= 0; i--) {
+        bssid[i] = key & 0xFF;
+        key >>= 8;
+    }
+}
+
+inline void writeHeader(uint8_t* out, const Header& h) {
+    out[0] = MAGIC;
+    out[1] = VERSION;
+    out[2] = h.nodeId & 0xFF;
+    out[3] = h.nodeId >> 8;
+    for (int i = 0; i < 4; i++) {
+        out[4 + i] = (h.seq >> (8 * i)) & 0xFF;
+        out[8 + i] = (h.nodeTimeMs >> (8 * i)) & 0xFF;
+    }
+    out[12] = (uint16_t)h.xDm & 0xFF;
+    out[13] = (uint16_t)h.xDm >> 8;
+    out[14] = (uint16_t)h.yDm & 0xFF;
+    out[15] = (uint16_t)h.yDm >> 8;
+}
+
+inline void writeEntry(uint8_t* out, const Entry& e) {
+    memcpy(out, e.bssid, 6);
+    out[6] = (uint8_t)e.rssi;
+    out[7] = e.channel;
+}
+
+// Returns the number of entries, or -1 if the packet is malformed
+inline int readHeader(const uint8_t* in, size_t len, Header& h) {
+    if (len < HEADER_SIZE || in[0] != MAGIC || in[1] != VERSION ||
+        (len - HEADER_SIZE) % ENTRY_SIZE != 0) {
+        return -1;
+    }
+    h.nodeId = in[2] | (in[3] << 8);
+    h.seq = 0;
+    h.nodeTimeMs = 0;
+    for (int i = 0; i < 4; i++) {
+        h.seq |= (uint32_t)in[4 + i] << (8 * i);
+        h.nodeTimeMs |= (uint32_t)in[8 + i] << (8 * i);
+    }
+    h.xDm = (int16_t)(in[12] | (in[13] << 8));
+    h.yDm = (int16_t)(in[14] | (in[15] << 8));
+    return (len - HEADER_SIZE) / ENTRY_SIZE;
+}
+
+inline void readEntry(const uint8_t* in, Entry& e) {
+    memcpy(e.bssid, in, 6);
+    e.rssi = (int8_t)in[6];
+    e.channel = in[7];
+}
+
+}  // namespace RadarPacket
@@ -0,0 +1,87 @@
+#include "ScanDelta.h"
+
+#include <stdlib.h>
+
+ScanDelta::ScanDelta(uint16_t nodeId, float xM, float yM, Sink sink) : _sink(sink) {
+    _header.nodeId = nodeId;
+    _header.seq = 0;
+    _header.nodeTimeMs = 0;
+    _header.xDm = (int16_t)(xM * 10.0f);
+    _header.yDm = (int16_t)(yM * 10.0f);
+}
+
+void ScanDelta::add(const uint8_t* bssid, int rssi, uint8_t channel) {
+    _observations++;
+    if (rssi < -127) rssi = -127;
+    if (rssi > 0) rssi = 0;
+
+    Known& k = _known[RadarPacket::bssidKey(bssid)];
+    // A fresh entry is value-initialised: never sent, not seen
+    k.current = rssi;
+    k.channel = channel;
+    k.missed = 0;
+    k.seen = true;
+}
+
+void ScanDelta::queue(uint64_t key, int8_t rssi, uint8_t channel) {
+    RadarPacket::Entry e;
+    RadarPacket::keyToBssid(key, e.bssid);
+    e.rssi = rssi;
+    e.channel = channel;
+    _pending.push_back(e);
+}
+
+size_t ScanDelta::finishScan(uint32_t nowMs) {
+    _pending.clear();
+
+    for (auto it = _known.begin(); it != _known.end();) {
+        Known& k = it->second;
+        if (!k.seen) {
+            if (++k.missed >= MISSES_BEFORE_LOST) {
+                if (k.everSent) {
+                    queue(it->first, RadarPacket::RSSI_LOST, k.channel);
+                }
+                it = _known.erase(it);
+                continue;
+            }
+        } else if (!k.everSent || abs(k.current - k.sent) >= _thresholdDb ||
+                   nowMs - k.sentMs >= _refreshMs) {
+            queue(it->first, k.current, k.channel);
+            k.sent = k.current;
+            k.sentMs = nowMs;
+            k.everSent = true;
+        }
+        k.seen = false;
+        ++it;
+    }
+
+    size_t count = _pending.size();
+    sendPending(nowMs);
+    return count;
+}
+
+void ScanDelta::sendPending(uint32_t nowMs) {
+    uint8_t packet[RadarPacket::MAX_SIZE];
+    _header.nodeTimeMs = nowMs;
+
+    size_t offset = 0;
+    do {
+        size_t n = _pending.size() - offset;
+        if (n > RadarPacket::MAX_ENTRIES) {
+            n = RadarPacket::MAX_ENTRIES;
+        }
+        RadarPacket::writeHeader(packet, _header);
+        for (size_t i = 0; i < n; i++) {
+            RadarPacket::writeEntry(packet + RadarPacket::HEADER_SIZE + i * RadarPacket::ENTRY_SIZE,
+                                    _pending[offset + i]);
+        }
+        size_t len = RadarPacket::HEADER_SIZE + n * RadarPacket::ENTRY_SIZE;
+        _sink(packet, len);
+
+        _header.seq++;
+        _packets++;
+        _bytes += len;
+        _entries += n;
+        offset += n;
+    } while (offset < _pending.size());
+}
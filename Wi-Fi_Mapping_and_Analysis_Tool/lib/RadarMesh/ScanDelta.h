@@ -0,0 +1,62 @@
+#pragma once
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include "RadarPacket.h"
+
+// Node side of the site survey: turns successive full scans into compact
+// delta packets for the collector.
+//
+// An AP is reported when it first appears, when its RSSI moves by at least
+// the threshold, and at least once per refresh period; it is reported lost
+// after it has been missing from a few scans in a row (single scans miss
+// APs all the time). Plain C++, shared with the Linux simulator.
+class ScanDelta {
+public:
+    using Sink = std::function<void(const uint8_t* packet, size_t len)>;
+
+    ScanDelta(uint16_t nodeId, float xM, float yM, Sink sink);
+
+    void setThreshold(int db) { _thresholdDb = db; }
+    void setRefreshMs(uint32_t refreshMs) { _refreshMs = refreshMs; }
+
+    void add(const uint8_t* bssid, int rssi, uint8_t channel);
+    // Call once all APs of a scan were added; sends at least one packet so
+    // the collector knows the node is alive. Returns the entries sent.
+    size_t finishScan(uint32_t nowMs);
+
+    uint32_t packetsSent() const { return _packets; }
+    uint32_t bytesSent() const { return _bytes; }
+    uint32_t entriesSent() const { return _entries; }
+    uint32_t observations() const { return _observations; }
+
+private:
+    static const uint8_t MISSES_BEFORE_LOST = 2;
+
+    struct Known {
+        int8_t current;
+        int8_t sent;
+        uint8_t channel;
+        uint8_t missed;
+        bool seen;
+        bool everSent;
+        uint32_t sentMs;
+    };
+
+    void queue(uint64_t key, int8_t rssi, uint8_t channel);
+    void sendPending(uint32_t nowMs);
+
+    RadarPacket::Header _header;
+    Sink _sink;
+    int _thresholdDb = 3;
+    uint32_t _refreshMs = 30000;
+
+    std::unordered_map<uint64_t, Known> _known;
+    std::vector<RadarPacket::Entry> _pending;
+
+    uint32_t _packets = 0;
+    uint32_t _bytes = 0;
+    uint32_t _entries = 0;
+    uint32_t _observations = 0;
+};
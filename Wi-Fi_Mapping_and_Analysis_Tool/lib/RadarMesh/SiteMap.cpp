@@ -0,0 +1,241 @@
+#include "SiteMap.h"
+
+#include <math.h>
+#include <stdio.h>
+
+float SiteMap::rssiToDistance(int rssi) {
+    return powf(10.0f, (RSSI_AT_1M - rssi) / (10.0f * PATH_LOSS_EXPONENT));
+}
+
+SiteMap::Node& SiteMap::node(const RadarPacket::Header& h, uint32_t nowMs) {
+    int64_t offset = (int64_t)nowMs - h.nodeTimeMs;
+    for (Node& n : _nodes) {
+        if (n.id != h.nodeId) {
+            continue;
+        }
+        if (h.seq < n.lastSeq) {
+            // Node rebooted: its clock and sequence started over
+            n.clockOffsetMs = offset;
+        } else {
+            if (h.seq > n.lastSeq) {
+                n.lostPackets += h.seq - n.lastSeq - 1;
+            }
+            // The fastest packet seen bounds the clock offset best
+            if (offset < n.clockOffsetMs) {
+                n.clockOffsetMs = offset;
+            }
+        }
+        n.x = h.xDm / 10.0f;
+        n.y = h.yDm / 10.0f;
+        n.lastSeq = h.seq;
+        return n;
+    }
+
+    Node n;
+    n.id = h.nodeId;
+    n.x = h.xDm / 10.0f;
+    n.y = h.yDm / 10.0f;
+    n.lastSeq = h.seq;
+    n.clockOffsetMs = offset;
+    n.lastHeardMs = nowMs;
+    n.packets = 0;
+    n.lostPackets = 0;
+    _nodes.push_back(n);
+    return _nodes.back();
+}
+
+bool SiteMap::ingest(const uint8_t* data, size_t len, uint32_t nowMs) {
+    RadarPacket::Header h;
+    int count = RadarPacket::readHeader(data, len, h);
+    if (count < 0) {
+        _badPackets++;
+        return false;
+    }
+
+    Node& n = node(h, nowMs);
+    n.packets++;
+    n.lastHeardMs = nowMs;
+    _packets++;
+    uint32_t seenMs = toCollectorTime(n, h.nodeTimeMs);
+
+    for (int i = 0; i < count; i++) {
+        RadarPacket::Entry e;
+        RadarPacket::readEntry(data + RadarPacket::HEADER_SIZE + i * RadarPacket::ENTRY_SIZE, e);
+        _entries++;
+
+        uint64_t key = RadarPacket::bssidKey(e.bssid);
+        if (e.rssi == RadarPacket::RSSI_LOST) {
+            auto it = _aps.find(key);
+            if (it == _aps.end()) {
+                continue;
+            }
+            std::vector<Observation>& obs = it->second.observations;
+            for (size_t j = 0; j < obs.size(); j++) {
+                if (obs[j].node == h.nodeId) {
+                    obs.erase(obs.begin() + j);
+                    it->second.dirty = true;
+                    break;
+                }
+            }
+            if (obs.empty()) {
+                _aps.erase(it);
+            }
+            continue;
+        }
+
+        AccessPoint& ap = _aps[key];
+        ap.channel = e.channel;
+        ap.dirty = true;
+        ap.updatedMs = nowMs;
+        bool found = false;
+        for (Observation& o : ap.observations) {
+            if (o.node == h.nodeId) {
+                o.rssi = e.rssi;
+                o.seenMs = seenMs;
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            ap.observations.push_back({h.nodeId, e.rssi, seenMs});
+        }
+    }
+    return true;
+}
+
+void SiteMap::expire(uint32_t nowMs, uint32_t maxAgeMs) {
+    for (auto it = _aps.begin(); it != _aps.end();) {
+        std::vector<Observation>& obs = it->second.observations;
+        for (size_t j = 0; j < obs.size();) {
+            if ((int32_t)(nowMs - obs[j].seenMs) > (int32_t)maxAgeMs) {
+                obs.erase(obs.begin() + j);
+                it->second.dirty = true;
+            } else {
+                j++;
+            }
+        }
+        if (obs.empty()) {
+            it = _aps.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+size_t SiteMap::locate() {
+    size_t n = 0;
+    for (auto& kv : _aps) {
+        if (kv.second.dirty) {
+            trilaterate(kv.second);
+            kv.second.dirty = false;
+            n++;
+        }
+    }
+    return n;
+}
+
+void SiteMap::trilaterate(AccessPoint& ap) {
+    struct Point {
+        float x, y, d, w;
+    };
+    Point pts[16];
+    size_t count = 0;
+
+    for (const Observation& o : ap.observations) {
+        if (count >= sizeof(pts) / sizeof(pts[0])) {
+            break;
+        }
+        for (const Node& n : _nodes) {
+            if (n.id == o.node) {
+                float d = rssiToDistance(o.rssi);
+                // Distance error grows with distance, so near nodes count more
+                pts[count++] = {n.x, n.y, d, 1.0f / fmaxf(d * d, 1.0f)};
+                break;
+            }
+        }
+    }
+
+    ap.located = count > 0;
+    if (count == 0) {
+        return;
+    }
+
+    // Weighted centroid: the answer for one or two nodes, and the fallback
+    // when the nodes are (nearly) collinear
+    float sw = 0, cx = 0, cy = 0;
+    for (size_t i = 0; i < count; i++) {
+        sw += pts[i].w;
+        cx += pts[i].w * pts[i].x;
+        cy += pts[i].w * pts[i].y;
+    }
+    ap.x = cx / sw;
+    ap.y = cy / sw;
+    if (count < 3) {
+        return;
+    }
+
+    // Linearise the circle equations against the nearest node and solve the
+    // weighted least-squares normal equations (2x2)
+    size_t ref = 0;
+    for (size_t i = 1; i < count; i++) {
+        if (pts[i].d < pts[ref].d) {
+            ref = i;
+        }
+    }
+    const Point& r = pts[ref];
+    float m00 = 0, m01 = 0, m11 = 0, v0 = 0, v1 = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (i == ref) {
+            continue;
+        }
+        const Point& p = pts[i];
+        float a0 = 2.0f * (p.x - r.x);
+        float a1 = 2.0f * (p.y - r.y);
+        float b = (p.x * p.x - r.x * r.x) + (p.y * p.y - r.y * r.y) - (p.d * p.d - r.d * r.d);
+        m00 += p.w * a0 * a0;
+        m01 += p.w * a0 * a1;
+        m11 += p.w * a1 * a1;
+        v0 += p.w * a0 * b;
+        v1 += p.w * a1 * b;
+    }
+    float det = m00 * m11 - m01 * m01;
+    if (fabsf(det) <= 1e-6f * m00 * m11) {
+        return;
+    }
+    ap.x = (m11 * v0 - m01 * v1) / det;
+    ap.y = (m00 * v1 - m01 * v0) / det;
+}
+
+void SiteMap::toJson(std::string& out, uint32_t nowMs) const {
+    char buf[160];
+    out = "{\"nodes\":[";
+    for (size_t i = 0; i < _nodes.size(); i++) {
+        const Node& n = _nodes[i];
+        snprintf(buf, sizeof(buf), "%s{\"id\":%u,\"x\":%.1f,\"y\":%.1f,\"packets\":%u,\"lost\":%u,\"ageMs\":%u}",
+                 i ? "," : "", n.id, n.x, n.y, (unsigned)n.packets, (unsigned)n.lostPackets,
+                 (unsigned)(nowMs - n.lastHeardMs));
+        out += buf;
+    }
+    out += "],\"aps\":[";
+
+    bool first = true;
+    for (const auto& kv : _aps) {
+        const AccessPoint& ap = kv.second;
+        uint8_t b[6];
+        RadarPacket::keyToBssid(kv.first, b);
+        snprintf(buf, sizeof(buf),
+                 "%s{\"bssid\":\"%02X:%02X:%02X:%02X:%02X:%02X\",\"channel\":%u,\"located\":%s,"
+                 "\"x\":%.1f,\"y\":%.1f,\"rssi\":{",
+                 first ? "" : ",", b[0], b[1], b[2], b[3], b[4], b[5], ap.channel,
+                 ap.located ? "true" : "false", ap.located ? ap.x : 0.0f, ap.located ? ap.y : 0.0f);
+        out += buf;
+        for (size_t j = 0; j < ap.observations.size(); j++) {
+            snprintf(buf, sizeof(buf), "%s\"%u\":%d", j ? "," : "", ap.observations[j].node,
+                     ap.observations[j].rssi);
+            out += buf;
+        }
+        out += "}}";
+        first = false;
+    }
+    out += "]}";
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "RadarPacket.h"
+
+// Collector side of the site survey: merges delta packets from all radar
+// nodes into one per-BSSID map and estimates where each AP is.
+//
+// Node clocks are not synchronised; each node's offset to the collector
+// clock is estimated as the smallest (arrival - node time) seen so far, so
+// observation ages stay meaningful. Plain C++, shared with the Linux
+// collector/simulator; the caller supplies the clock.
+class SiteMap {
+public:
+    struct Node {
+        uint16_t id;
+        float x;
+        float y;
+        uint32_t lastSeq;
+        int64_t clockOffsetMs;
+        uint32_t lastHeardMs;
+        uint32_t packets;
+        uint32_t lostPackets;
+    };
+
+    struct Observation {
+        uint16_t node;
+        int8_t rssi;
+        uint32_t seenMs;  // collector clock
+    };
+
+    struct AccessPoint {
+        uint8_t channel;
+        std::vector<Observation> observations;
+        float x;
+        float y;
+        bool located;
+        bool dirty;
+        uint32_t updatedMs;
+    };
+
+    // Returns false for malformed packets
+    bool ingest(const uint8_t* data, size_t len, uint32_t nowMs);
+    // Forget observations older than maxAgeMs and APs nobody sees any more
+    void expire(uint32_t nowMs, uint32_t maxAgeMs);
+    // Re-run trilateration for APs whose observations changed
+    size_t locate();
+
+    void toJson(std::string& out, uint32_t nowMs) const;
+
+    const std::unordered_map<uint64_t, AccessPoint>& accessPoints() const { return _aps; }
+    const std::vector<Node>& nodes() const { return _nodes; }
+
+    // Node-clock time of an observation translated to the collector clock
+    uint32_t toCollectorTime(const Node& node, uint32_t nodeTimeMs) const {
+        return (uint32_t)((int64_t)nodeTimeMs + node.clockOffsetMs);
+    }
+
+    uint32_t packets() const { return _packets; }
+    uint32_t badPackets() const { return _badPackets; }
+    uint32_t entries() const { return _entries; }
+
+    // Log-distance path loss model; same constants as the radar UI
+    static constexpr float RSSI_AT_1M = -40.0f;
+    static constexpr float PATH_LOSS_EXPONENT = 2.0f;
+    static float rssiToDistance(int rssi);
+
+private:
+    Node& node(const RadarPacket::Header& h, uint32_t nowMs);
+    void trilaterate(AccessPoint& ap);
+
+    std::vector<Node> _nodes;
+    std::unordered_map<uint64_t, AccessPoint> _aps;
+
+    uint32_t _packets = 0;
+    uint32_t _badPackets = 0;
+    uint32_t _entries = 0;
+};
@@ -2,6 +2,48 @@
 #include <WebServer.h>
 #include <ArduinoJson.h>
 
+// 1 = run the on-device benchmark suite at boot and print JSON results
+#ifndef BENCH_SUITE
+#define BENCH_SUITE 0
+#endif
+
+#if BENCH_SUITE
+#include <BenchSuite.h>
+#endif
+
+// 1 = record spans/counters for /trace (Chrome trace JSON); send 't' on
+// Serial for the same dump there
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 0
+#endif
+#include <Trace.h>
+
+// 1 = join the site network and take part in a multi-unit survey
+#define SITE_SURVEY 0
+// Site network the units use to reach the collector
+#define SITE_SSID ""
+#define SITE_PASSWORD ""
+// This unit's id and position on the floor plan, in metres
+#define NODE_ID 1
+#define NODE_X_M 0.0f
+#define NODE_Y_M 0.0f
+// 1 = this unit also merges everyone's scans into the site map (/site)
+#define SITE_COLLECTOR 0
+// Where scan deltas go: the collector unit, or a Linux host running
+// tools/site_collector
+#define COLLECTOR_HOST "192.168.1.50"
+#define SITE_UDP_PORT 4210
+#define SURVEY_SCAN_INTERVAL_MS 5000
+#define SITE_MAX_OBSERVATION_AGE_MS 60000
+#define SURVEY_STATS_INTERVAL_MS 60000
+
+#if SITE_SURVEY
+#include <WiFiUdp.h>
+#include <WiFiConnectionManager.h>
+#include <ScanDelta.h>
+#include <SiteMap.h>
+#endif
+
 WebServer server(80);
 
 // Store network information
@@ -20,6 +62,16 @@ struct NetworkInfo {
   int frequency;
 };
 
+// One access point from a scan, decoupled from the WiFi driver so the
+// processing pipeline can also be fed from recorded fixtures
+struct ScanRecord {
+  String ssid;
+  String bssid;
+  int signal;
+  int channel;
+  wifi_auth_mode_t encryption;
+};
+
 std::vector<NetworkInfo> networksList;
 const int MAX_HISTORY_SIZE = 10;
 const int SIGNAL_HISTORY_INTERVAL = 60000;
@@ -375,6 +427,7 @@ const char* getSecurityAnalysis(wifi_auth_mode_t encryption) {
 }
 
 NetworkInfo* findOrCreateNetwork(const String& ssid, const String& bssid) {
+    TRACE_SCOPE("findOrCreateNetwork");
     for (auto& network : networksList) {
         if (network.bssid == bssid) {
             return &network;
@@ -392,6 +445,7 @@ NetworkInfo* findOrCreateNetwork(const String& ssid, const String& bssid) {
 }
 
 void updateSignalStability(NetworkInfo* network, int newSignal) {
+    TRACE_SCOPE("updateSignalStability");
     network->lastSeen = millis();
     
     if (network->signalHistory.size() >= MAX_HISTORY_SIZE) {
@@ -412,57 +466,259 @@ void handleRoot() {
     server.send(200, "text/html", index_html);
 }
 
+// Merge one scan into networksList and append each network to the response
+void processScan(const ScanRecord* records, int count, JsonArray networks) {
+    for (int i = 0; i < count; i++) {
+        const ScanRecord& record = records[i];
+
+        // Create or find the network info object
+        NetworkInfo* network = findOrCreateNetwork(record.ssid, record.bssid);
+
+        // Update signal strength stability and frequency
+        updateSignalStability(network, record.signal);
+        network->frequency = calculateFrequency(record.channel).toInt();
+
+        // Set network properties
+        network->ssid = record.ssid;
+        network->signal = record.signal;
+        network->encryption = getSecurityAnalysis(record.encryption);
+        network->channel = record.channel;
+        network->isHidden = record.ssid.isEmpty();  // Check if SSID is empty, which indicates a hidden network
+        network->lastSeen = millis();
+
+        // Create JSON object for each network
+        JsonObject networkObj = networks.createNestedObject();
+        networkObj["ssid"] = network->ssid;
+        networkObj["signal"] = network->signal;
+        networkObj["avgSignal"] = network->avgSignal;
+        networkObj["encryption"] = network->encryption;
+        networkObj["channel"] = network->channel;
+        networkObj["isHidden"] = network->isHidden;
+        networkObj["bssid"] = network->bssid;
+        networkObj["frequency"] = network->frequency;
+        networkObj["signalQuality"] = getSignalQuality(network->signal);
+    }
+}
+
+#if SITE_SURVEY
+WiFiUDP siteUdp;
+IPAddress collectorIp;
+// Latest background scan; /scan serves this instead of scanning itself
+std::vector<ScanRecord> lastScan;
+unsigned long lastSurveyScan = 0;
+bool surveyScanRunning = false;
+#if SITE_COLLECTOR
+SiteMap siteMap;
+#endif
+
+void sendScanDelta(const uint8_t* packet, size_t len) {
+#if SITE_COLLECTOR
+    // Our own scans don't need the network
+    siteMap.ingest(packet, len, millis());
+#else
+    // While offline the delta is lost; the periodic refresh catches up
+    if (!Connectivity.connected()) {
+        return;
+    }
+    siteUdp.beginPacket(collectorIp, SITE_UDP_PORT);
+    siteUdp.write(packet, len);
+    siteUdp.endPacket();
+#endif
+}
+
+ScanDelta scanDelta(NODE_ID, NODE_X_M, NODE_Y_M, sendScanDelta);
+
+// Scans on a fixed cadence without blocking the web server
+void surveyScan() {
+    unsigned long now = millis();
+    if (!surveyScanRunning) {
+        if (now - lastSurveyScan >= SURVEY_SCAN_INTERVAL_MS) {
+            TRACE_INSTANT("surveyScan.start");
+            WiFi.scanNetworks(true, true, false, 300);
+            surveyScanRunning = true;
+            lastSurveyScan = now;
+        }
+        return;
+    }
+
+    int n = WiFi.scanComplete();
+    if (n == WIFI_SCAN_RUNNING) {
+        return;
+    }
+    surveyScanRunning = false;
+    TRACE_SCOPE("surveyScan.merge");
+    if (n < 0) {
+        // Failed; try again next interval
+        return;
+    }
+
+    lastScan.resize(n);
+    for (int i = 0; i < n; i++) {
+        lastScan[i].ssid = WiFi.SSID(i);
+        lastScan[i].bssid = WiFi.BSSIDstr(i);
+        lastScan[i].signal = WiFi.RSSI(i);
+        lastScan[i].channel = WiFi.channel(i);
+        lastScan[i].encryption = WiFi.encryptionType(i);
+        scanDelta.add(WiFi.BSSID(i), lastScan[i].signal, lastScan[i].channel);
+    }
+    scanDelta.finishScan(millis());
+    WiFi.scanDelete();
+}
+
+#if SITE_COLLECTOR
+void receiveScanDeltas() {
+    uint8_t packet[RadarPacket::MAX_SIZE];
+    while (siteUdp.parsePacket() > 0) {
+        int len = siteUdp.read(packet, sizeof(packet));
+        if (len > 0) {
+            siteMap.ingest(packet, len, millis());
+        }
+    }
+}
+
+void handleSite() {
+    unsigned long now = millis();
+    siteMap.expire(now, SITE_MAX_OBSERVATION_AGE_MS);
+    siteMap.locate();
+    std::string json;
+    siteMap.toJson(json, now);
+    server.send(200, "application/json", json.c_str());
+}
+#endif
+
+void printSurveyStats() {
+    static unsigned long lastReport = 0;
+    if (millis() - lastReport < SURVEY_STATS_INTERVAL_MS) {
+        return;
+    }
+    lastReport = millis();
+    Serial.printf("Survey: %u APs observed, %u reported in %u packets (%u bytes)\n",
+                  scanDelta.observations(), scanDelta.entriesSent(),
+                  scanDelta.packetsSent(), scanDelta.bytesSent());
+#if SITE_COLLECTOR
+    Serial.printf("Site map: %u nodes, %u APs, %u packets merged, %u bad\n",
+                  siteMap.nodes().size(), siteMap.accessPoints().size(),
+                  siteMap.packets(), siteMap.badPackets());
+#endif
+}
+#endif
+
 void handleScan() {
+    TRACE_SCOPE("handleScan");
     StaticJsonDocument<16384> doc;
     JsonArray networks = doc.createNestedArray("networks");
 
-    int numNetworks = WiFi.scanNetworks(false, true, false, 300);
+#if SITE_SURVEY
+    processScan(lastScan.data(), lastScan.size(), networks);
+#else
+    int numNetworks;
+    {
+        TRACE_SCOPE("WiFi.scanNetworks");
+        numNetworks = WiFi.scanNetworks(false, true, false, 300);
+    }
+    TRACE_COUNTER("scanResults", numNetworks);
 
     if (numNetworks > 0) {
+        std::vector<ScanRecord> records(numNetworks);
         for (int i = 0; i < numNetworks; i++) {
-            String ssid = WiFi.SSID(i);
-            String bssid = WiFi.BSSIDstr(i);
-            int signal = WiFi.RSSI(i);
-            int channel = WiFi.channel(i);
-            wifi_auth_mode_t encryption = WiFi.encryptionType(i);
-            
-            // Create or find the network info object
-            NetworkInfo* network = findOrCreateNetwork(ssid, bssid);
-
-            // Update signal strength stability and frequency
-            updateSignalStability(network, signal);
-            network->frequency = calculateFrequency(channel).toInt();
-
-            // Set network properties
-            network->ssid = ssid;
-            network->signal = signal;
-            network->encryption = getSecurityAnalysis(encryption);
-            network->channel = channel;
-            network->isHidden = ssid.isEmpty();  // Check if SSID is empty, which indicates a hidden network
-            network->lastSeen = millis();
-
-            // Create JSON object for each network
-            JsonObject networkObj = networks.createNestedObject();
-            networkObj["ssid"] = network->ssid;
-            networkObj["signal"] = network->signal;
-            networkObj["avgSignal"] = network->avgSignal;
-            networkObj["encryption"] = network->encryption;
-            networkObj["channel"] = network->channel;
-            networkObj["isHidden"] = network->isHidden;
-            networkObj["bssid"] = network->bssid;
-            networkObj["frequency"] = network->frequency;
-            networkObj["signalQuality"] = getSignalQuality(network->signal);
+            records[i].ssid = WiFi.SSID(i);
+            records[i].bssid = WiFi.BSSIDstr(i);
+            records[i].signal = WiFi.RSSI(i);
+            records[i].channel = WiFi.channel(i);
+            records[i].encryption = WiFi.encryptionType(i);
         }
+        processScan(records.data(), numNetworks, networks);
     }
+#endif
 
+    TRACE_COUNTER("networksTracked", (int32_t)networksList.size());
     String response;
-    serializeJson(doc, response);
+    {
+        TRACE_SCOPE("serializeJson");
+        serializeJson(doc, response);
+    }
+    TRACE_SCOPE("server.send");
     server.send(200, "application/json", response);
 }
 
+#if TRACE_ENABLED
+void handleTrace() {
+    // Streamed straight to the socket; the dump is too large for a String
+    WiFiClient client = server.client();
+    client.print("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n"
+                 "Content-Disposition: attachment; filename=\"radar.trace.json\"\r\n"
+                 "Connection: close\r\n\r\n");
+    Trace::dump(client);
+    client.stop();
+}
+
+// Runs in the WiFi event task, which gets its own track
+void onWiFiEvent(arduino_event_id_t event) {
+    TRACE_INSTANT(WiFi.eventName(event));
+}
+#endif
+
+#if BENCH_SUITE
+// Recorded from a scan in an apartment block; hidden networks have no SSID
+const ScanRecord SCAN_FIXTURE[] = {
+    {"HomeNet", "A4:2B:B0:11:22:01", -42, 1, WIFI_AUTH_WPA2_PSK},
+    {"HomeNet_Guest", "A4:2B:B0:11:22:02", -44, 1, WIFI_AUTH_OPEN},
+    {"TP-Link_5C3A", "50:C7:BF:5C:3A:10", -58, 6, WIFI_AUTH_WPA_WPA2_PSK},
+    {"FRITZ!Box 7530", "3C:A6:2F:8E:01:99", -61, 11, WIFI_AUTH_WPA2_PSK},
+    {"", "3C:A6:2F:8E:01:9A", -62, 11, WIFI_AUTH_WPA2_PSK},
+    {"Vodafone-A8F2", "9C:C7:A6:A8:F2:00", -65, 1, WIFI_AUTH_WPA2_PSK},
+    {"DIRECT-7B-HP OfficeJet", "FA:B4:6A:7B:00:01", -67, 6, WIFI_AUTH_WPA2_PSK},
+    {"eduroam", "00:1A:1E:40:22:31", -70, 13, WIFI_AUTH_WPA2_ENTERPRISE},
+    {"linksys", "20:AA:4B:01:02:03", -72, 6, WIFI_AUTH_WEP},
+    {"NETGEAR42", "C0:FF:D4:42:42:42", -73, 3, WIFI_AUTH_WPA2_PSK},
+    {"Pixel_7894", "6E:1D:3B:78:94:00", -75, 9, WIFI_AUTH_WPA2_PSK},
+    {"", "B0:BE:76:00:10:20", -77, 4, WIFI_AUTH_WPA2_PSK},
+    {"Telekom_FON", "34:31:C4:F0:0F:01", -79, 1, WIFI_AUTH_OPEN},
+    {"MagentaWLAN-X2Q", "34:31:C4:F0:0F:00", -79, 1, WIFI_AUTH_WPA_WPA2_PSK},
+    {"UPC1234567", "64:7C:34:12:34:56", -81, 11, WIFI_AUTH_WPA2_PSK},
+    {"iPhone von Anna", "82:2D:9A:01:AB:CD", -83, 6, WIFI_AUTH_WPA2_PSK},
+    {"ESP_3A0F11", "24:6F:28:3A:0F:11", -85, 1, WIFI_AUTH_OPEN},
+    {"Chromecast4821", "FA:8F:CA:48:21:00", -86, 6, WIFI_AUTH_OPEN},
+    {"SKYNET", "00:24:01:AA:BB:CC", -88, 13, WIFI_AUTH_WPA_PSK},
+    {"WLAN-Kabel", "CC:CE:1E:77:88:99", -90, 5, WIFI_AUTH_WPA2_PSK},
+};
+const int SCAN_FIXTURE_SIZE = sizeof(SCAN_FIXTURE) / sizeof(SCAN_FIXTURE[0]);
+
+void runBenchmarks() {
+    BenchSuite suite("radar");
+
+    // The /scan handler minus the radio scan and the socket write
+    suite.add("scan_pipeline/20", [] {
+        StaticJsonDocument<16384> doc;
+        JsonArray networks = doc.createNestedArray("networks");
+        processScan(SCAN_FIXTURE, SCAN_FIXTURE_SIZE, networks);
+        String response;
+        serializeJson(doc, response);
+        BenchSuite::doNotOptimize(response);
+    });
+    suite.add("find_network/20", [] {
+        BenchSuite::doNotOptimize(findOrCreateNetwork(SCAN_FIXTURE[SCAN_FIXTURE_SIZE - 1].ssid,
+                                                      SCAN_FIXTURE[SCAN_FIXTURE_SIZE - 1].bssid));
+    });
+    suite.add("signal_stability", [] {
+        updateSignalStability(&networksList.front(), -60);
+    });
+
+    suite.run();
+    // Leave no trace of the fixture in the live view
+    networksList.clear();
+}
+#endif
 
 void setup() {
     Serial.begin(115200);
+#if BENCH_SUITE
+    runBenchmarks();
+#endif
+#if TRACE_ENABLED
+    Trace::printOverhead();
+    WiFi.onEvent(onWiFiEvent);
+#endif
     WiFi.mode(WIFI_AP);
     delay(100);
     // Start ESP32 as an open access point
@@ -474,10 +730,39 @@ void setup() {
 
     server.on("/", handleRoot);
     server.on("/scan", handleScan);
+#if TRACE_ENABLED
+    server.on("/trace", handleTrace);
+#endif
+#if SITE_SURVEY && SITE_COLLECTOR
+    server.on("/site", handleSite);
+#endif
     server.begin();
+
+#if SITE_SURVEY
+    // Joins the site network next to the "radar" AP
+    collectorIp.fromString(COLLECTOR_HOST);
+    Connectivity.onConnected([] {
+        siteUdp.begin(SITE_UDP_PORT);
+        Serial.printf("Survey node %d on site network, IP %s\n", NODE_ID, WiFi.localIP().toString().c_str());
+    });
+    Connectivity.begin(SITE_SSID, SITE_PASSWORD);
+#endif
     Serial.println("WiFi Radar System initialized");
 }
 
 void loop() {
     server.handleClient();
+#if TRACE_ENABLED
+    if (Serial.available() && Serial.read() == 't') {
+        Trace::dump(Serial);
+    }
+#endif
+#if SITE_SURVEY
+    Connectivity.loop();
+    surveyScan();
+#if SITE_COLLECTOR
+    receiveScanDeltas();
+#endif
+    printSurveyStats();
+#endif
 }
\ No newline at end of file
@@ -0,0 +1,302 @@
+// Linux site-survey collector and multi-node simulator.
+//
+// Shares RadarPacket/ScanDelta/SiteMap with the firmware, so what is
+// measured here is the code that runs on the collector ESP32.
+//
+//   g++ -O2 -std=c++17 -pthread -I../lib/RadarMesh -o site_collector
+//       site_collector.cpp ../lib/RadarMesh/ScanDelta.cpp ../lib/RadarMesh/SiteMap.cpp
+//
+//   ./site_collector --listen 4210            # collect from real nodes
+//   ./site_collector --simulate 10            # 10 virtual nodes over UDP loopback
+//   ./site_collector --simulate 10 --scan-ms 20 --seconds 20
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "RadarPacket.h"
+#include "ScanDelta.h"
+#include "SiteMap.h"
+
+namespace {
+
+const int DEFAULT_PORT = 4210;
+// Observations older than this are dropped from the map
+const uint32_t MAX_OBSERVATION_AGE_MS = 60000;
+const uint32_t LOCATE_INTERVAL_MS = 100;
+
+uint32_t nowMs() {
+    using namespace std::chrono;
+    return (uint32_t)duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+double nowUs() {
+    using namespace std::chrono;
+    return duration_cast<duration<double, std::micro>>(steady_clock::now().time_since_epoch()).count();
+}
+
+double threadCpuUs() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+int openSocket(int port) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        exit(1);
+    }
+    int rcvbuf = 4 * 1024 * 1024;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    timeval tv = {0, LOCATE_INTERVAL_MS * 1000};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("bind");
+        exit(1);
+    }
+    return fd;
+}
+
+double percentile(std::vector<double>& v, double p) {
+    if (v.empty()) {
+        return 0;
+    }
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, (size_t)(p / 100.0 * v.size()))];
+}
+
+// --- Real collector --------------------------------------------------------
+
+void listen(int port) {
+    int fd = openSocket(port);
+    SiteMap map;
+    uint8_t buf[RadarPacket::MAX_SIZE + 1];
+    uint32_t lastPrint = nowMs();
+    std::string json;
+
+    fprintf(stderr, "Listening on UDP %d\n", port);
+    while (true) {
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        uint32_t now = nowMs();
+        if (n > 0) {
+            map.ingest(buf, n, now);
+        }
+        if (now - lastPrint >= 5000) {
+            map.expire(now, MAX_OBSERVATION_AGE_MS);
+            map.locate();
+            map.toJson(json, now);
+            printf("%s\n", json.c_str());
+            fflush(stdout);
+            lastPrint = now;
+        }
+    }
+}
+
+// --- Simulation ------------------------------------------------------------
+
+struct SimAp {
+    uint8_t bssid[6];
+    float x, y;
+    uint8_t channel;
+};
+
+struct Sim {
+    int nodes;
+    uint32_t scanMs;
+    double seconds;
+    int port;
+    std::vector<SimAp> aps;
+    std::atomic<bool> stop{false};
+};
+
+void nodeThread(Sim& sim, int id, float x, float y, int32_t clockSkewMs) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in dst = {};
+    dst.sin_family = AF_INET;
+    dst.sin_port = htons(sim.port);
+    dst.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    ScanDelta delta(id, x, y, [&](const uint8_t* packet, size_t len) {
+        sendto(fd, packet, len, 0, (sockaddr*)&dst, sizeof(dst));
+    });
+
+    std::mt19937 rng(id * 7919);
+    std::normal_distribution<float> shadowing(0.0f, 4.0f);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    // Offsets scans of different nodes like real, unsynchronised units
+    std::this_thread::sleep_for(std::chrono::milliseconds((uint32_t)(uniform(rng) * sim.scanMs)));
+
+    while (!sim.stop.load()) {
+        for (const SimAp& ap : sim.aps) {
+            float d = std::max(1.0f, std::hypot(ap.x - x, ap.y - y));
+            float rssi = SiteMap::RSSI_AT_1M - 10.0f * SiteMap::PATH_LOSS_EXPONENT * log10f(d) + shadowing(rng);
+            // Too weak to decode, or simply missed this scan
+            if (rssi < -92.0f || uniform(rng) < 0.1f) {
+                continue;
+            }
+            delta.add(ap.bssid, (int)lroundf(rssi), ap.channel);
+        }
+        delta.finishScan(nowMs() + clockSkewMs);
+        std::this_thread::sleep_for(std::chrono::milliseconds(sim.scanMs));
+    }
+    close(fd);
+}
+
+void simulate(Sim& sim) {
+    // A 60 x 40 m floor with 40 APs; nodes on a grid across it
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> ux(0.0f, 60.0f), uy(0.0f, 40.0f);
+    for (int i = 0; i < 40; i++) {
+        SimAp ap;
+        uint8_t b[6] = {0x02, 0x00, 0x5E, 0x10, (uint8_t)(i >> 8), (uint8_t)i};
+        memcpy(ap.bssid, b, 6);
+        ap.x = ux(rng);
+        ap.y = uy(rng);
+        ap.channel = 1 + (i * 5) % 13;
+        sim.aps.push_back(ap);
+    }
+
+    int fd = openSocket(sim.port);
+    int cols = (int)ceil(sqrt(sim.nodes * 1.5));
+    int rows = (sim.nodes + cols - 1) / cols;
+    std::vector<int32_t> skew(sim.nodes + 1);
+    std::vector<std::thread> threads;
+    std::uniform_int_distribution<int32_t> skewDist(-100000, 100000);
+    for (int i = 0; i < sim.nodes; i++) {
+        float x = 60.0f * (i % cols + 0.5f) / cols;
+        float y = 40.0f * (i / cols + 0.5f) / rows;
+        skew[i + 1] = skewDist(rng);
+        threads.emplace_back(nodeThread, std::ref(sim), i + 1, x, y, skew[i + 1]);
+    }
+
+    SiteMap map;
+    uint8_t buf[RadarPacket::MAX_SIZE + 1];
+    std::vector<double> mergeLatencyMs;
+    std::vector<double> mapAgeMs;
+    double mergeCpuUs = 0;
+    double locateCpuUs = 0;
+    uint32_t located = 0;
+    uint32_t lastLocate = nowMs();
+    double start = nowUs();
+
+    while (nowUs() - start < sim.seconds * 1e6) {
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        uint32_t now = nowMs();
+        if (n > 0) {
+            double c0 = threadCpuUs();
+            map.ingest(buf, n, now);
+            mergeCpuUs += threadCpuUs() - c0;
+
+            RadarPacket::Header h;
+            if (RadarPacket::readHeader(buf, n, h) >= 0 && h.nodeId <= sim.nodes) {
+                // True scan time on the collector clock, using the real skew
+                mergeLatencyMs.push_back((double)(int32_t)(now - (h.nodeTimeMs - skew[h.nodeId])));
+            }
+        }
+
+        if (now - lastLocate >= LOCATE_INTERVAL_MS) {
+            double c0 = threadCpuUs();
+            map.expire(now, MAX_OBSERVATION_AGE_MS);
+            located += map.locate();
+            locateCpuUs += threadCpuUs() - c0;
+            lastLocate = now;
+
+            // How old is what the map shows right now
+            for (const auto& kv : map.accessPoints()) {
+                for (const SiteMap::Observation& o : kv.second.observations) {
+                    mapAgeMs.push_back((double)(int32_t)(now - o.seenMs));
+                }
+            }
+        }
+    }
+    double wall = (nowUs() - start) / 1e6;
+    sim.stop = true;
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    close(fd);
+
+    // Location error against the ground truth
+    double errSum = 0;
+    int errCount = 0;
+    for (const SimAp& ap : sim.aps) {
+        auto it = map.accessPoints().find(RadarPacket::bssidKey(ap.bssid));
+        if (it != map.accessPoints().end() && it->second.located && it->second.observations.size() >= 3) {
+            errSum += std::hypot(it->second.x - ap.x, it->second.y - ap.y);
+            errCount++;
+        }
+    }
+    uint32_t lost = 0;
+    for (const SiteMap::Node& node : map.nodes()) {
+        lost += node.lostPackets;
+    }
+
+    printf("%d nodes, %u ms scans, %.1f s\n", sim.nodes, sim.scanMs, wall);
+    printf("  merged %u packets (%.0f/s), %u entries (%.0f/s), %u lost, %u bad\n",
+           map.packets(), map.packets() / wall, map.entries(), map.entries() / wall, lost, map.badPackets());
+    printf("  merge cost %.2f us/packet -> ~%.0f packets/s per core; locate %.1f us/AP\n",
+           mergeCpuUs / std::max<uint32_t>(map.packets(), 1),
+           1e6 / std::max(mergeCpuUs / std::max<uint32_t>(map.packets(), 1), 1e-3),
+           locateCpuUs / std::max<uint32_t>(located, 1));
+    printf("  scan-to-merge latency p50 %.1f / p99 %.1f ms; map age p50 %.0f / p99 %.0f ms\n",
+           percentile(mergeLatencyMs, 50), percentile(mergeLatencyMs, 99),
+           percentile(mapAgeMs, 50), percentile(mapAgeMs, 99));
+    printf("  %zu APs mapped, mean location error %.1f m over %d APs seen by 3+ nodes\n",
+           map.accessPoints().size(), errCount ? errSum / errCount : 0.0, errCount);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int port = DEFAULT_PORT;
+    int nodes = 0;
+    uint32_t scanMs = 100;
+    double seconds = 10;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        const char* next = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (arg == "--listen" && next) {
+            port = atoi(argv[++i]);
+        } else if (arg == "--simulate" && next) {
+            nodes = atoi(argv[++i]);
+        } else if (arg == "--scan-ms" && next) {
+            scanMs = atoi(argv[++i]);
+        } else if (arg == "--seconds" && next) {
+            seconds = atof(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [--listen PORT] [--simulate NODES [--scan-ms MS] [--seconds S]]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (nodes > 0) {
+        Sim sim;
+        sim.nodes = nodes;
+        sim.scanMs = scanMs;
+        sim.seconds = seconds;
+        sim.port = port;
+        simulate(sim);
+    } else {
+        listen(port);
+    }
+    return 0;
+}
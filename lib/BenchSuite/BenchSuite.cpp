@@ -0,0 +1,70 @@
+#include "BenchSuite.h"
+
+#include <esp_timer.h>
+
+#ifdef HOST_HAL
+#include <HostHAL.h>
+#endif
+
+BenchSuite::Result BenchSuite::measure(const Benchmark& b) {
+    // Warm-up: fills caches and lets lazily-allocated state settle
+    b.body();
+
+    uint32_t batch = 1;
+    uint32_t iterations = 0;
+    int64_t elapsedUs = 0;
+    uint32_t heapBefore = ESP.getFreeHeap();
+    int64_t budgetUs = (int64_t)_minTimeMs * 1000;
+
+    while (elapsedUs < budgetUs) {
+        int64_t start = esp_timer_get_time();
+        for (uint32_t i = 0; i < batch; i++) {
+            b.body();
+        }
+        elapsedUs += esp_timer_get_time() - start;
+        iterations += batch;
+        // Grow batches so timer overhead stays negligible for fast bodies
+        if (batch < 1000000) {
+            batch *= 2;
+        }
+        // Block for a tick so the idle task runs and feeds its watchdog on
+        // long runs; yield() only switches to tasks of the same priority
+        vTaskDelay(1);
+    }
+
+    Result r;
+    r.name = b.name;
+    r.iterations = iterations;
+    r.nsPerIteration = elapsedUs * 1000.0 / iterations;
+    r.heapDelta = (int32_t)ESP.getFreeHeap() - (int32_t)heapBefore;
+    return r;
+}
+
+void BenchSuite::run(Print& out) {
+    std::vector<Result> results;
+    results.reserve(_benchmarks.size());
+    for (const Benchmark& b : _benchmarks) {
+        results.push_back(measure(b));
+    }
+
+    out.printf("{\"context\":{\"executable\":\"%s\",\"host_name\":\"%s\",\"num_cpus\":%u,"
+               "\"mhz_per_cpu\":%u,\"library_build_type\":\"release\",\"sdk\":\"%s\"},"
+               "\"benchmarks\":[",
+               _name, ESP.getChipModel(), ESP.getChipCores(), ESP.getCpuFreqMHz(), ESP.getSdkVersion());
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        // Single-threaded and never blocking, so CPU time equals real time
+        out.printf("%s{\"name\":\"%s/%s\",\"run_type\":\"iteration\",\"iterations\":%u,"
+                   "\"real_time\":%.1f,\"cpu_time\":%.1f,\"time_unit\":\"ns\",\"heap_delta\":%d}",
+                   i ? "," : "", _name, r.name, r.iterations, r.nsPerIteration, r.nsPerIteration,
+                   r.heapDelta);
+    }
+    out.print("]}\n");
+#ifdef HOST_HAL
+    // Native build started with --bench: the report is all CI wants
+    if (HostHAL::benchOnly()) {
+        out.flush();
+        exit(0);
+    }
+#endif
+}
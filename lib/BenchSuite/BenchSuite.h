@@ -0,0 +1,49 @@
+#pragma once
+
+#include <Arduino.h>
+#include <functional>
+#include <vector>
+
+// Tiny on-device micro-benchmark runner shared by the sketches.
+//
+// Each benchmark body runs in batches until minTimeMs has elapsed, like
+// Google Benchmark does; the result is printed to Serial as one line of JSON
+// in Google Benchmark's output format, so runs can be saved per release and
+// compared with the usual tooling (e.g. benchmark's compare.py).
+class BenchSuite {
+public:
+    using Body = std::function<void()>;
+
+    explicit BenchSuite(const char* name) : _name(name) {}
+
+    void add(const char* name, Body body) { _benchmarks.push_back({name, body}); }
+    void setMinTime(uint32_t minTimeMs) { _minTimeMs = minTimeMs; }
+
+    // Runs everything and prints the JSON report
+    void run(Print& out = Serial);
+
+    // Keep the compiler from optimising away a result
+    template <typename T>
+    static void doNotOptimize(const T& value) {
+        asm volatile("" : : "r"(&value) : "memory");
+    }
+
+private:
+    struct Benchmark {
+        const char* name;
+        Body body;
+    };
+
+    struct Result {
+        const char* name;
+        uint32_t iterations;
+        double nsPerIteration;
+        int32_t heapDelta;
+    };
+
+    Result measure(const Benchmark& b);
+
+    const char* _name;
+    std::vector<Benchmark> _benchmarks;
+    uint32_t _minTimeMs = 500;
+};
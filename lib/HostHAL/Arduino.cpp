@@ -0,0 +1,130 @@
+#include "Arduino.h"
+
+#include <chrono>
+#include <random>
+#include <thread>
+
+using Clock = std::chrono::steady_clock;
+
+// Boot time; a function-local static so it is set before any global
+// constructor of the sketch can ask for the time
+static Clock::time_point bootTime() {
+    static const Clock::time_point boot = Clock::now();
+    return boot;
+}
+
+// ...and at the latest when the program starts, so millis() counts from boot
+// and not from whichever task reads it first
+[[maybe_unused]] static const Clock::time_point bootAtStart = bootTime();
+
+int64_t esp_timer_get_time() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - bootTime()).count();
+}
+
+unsigned long millis() {
+    return (unsigned long)(esp_timer_get_time() / 1000);
+}
+
+unsigned long micros() {
+    return (unsigned long)esp_timer_get_time();
+}
+
+void delay(uint32_t ms) {
+    if (ms == 0) {
+        std::this_thread::yield();
+        return;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(uint32_t us) {
+    // Busy-waits like the core does; a sleep would overshoot short delays
+    int64_t until = esp_timer_get_time() + us;
+    while (esp_timer_get_time() < until) {
+    }
+}
+
+void yield() {
+    std::this_thread::yield();
+}
+
+static const uint8_t PIN_COUNT = 64;
+static uint8_t pinLevels[PIN_COUNT];
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    (void)pin;
+    (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+    if (pin < PIN_COUNT) {
+        pinLevels[pin] = val ? HIGH : LOW;
+    }
+}
+
+int digitalRead(uint8_t pin) {
+    return pin < PIN_COUNT ? pinLevels[pin] : LOW;
+}
+
+static std::minstd_rand& rng() {
+    static std::minstd_rand generator;
+    return generator;
+}
+
+long random(long howbig) {
+    if (howbig <= 0) {
+        return 0;
+    }
+    return (long)(rng()() % (unsigned long)howbig);
+}
+
+long random(long howsmall, long howbig) {
+    if (howsmall >= howbig) {
+        return howsmall;
+    }
+    return random(howbig - howsmall) + howsmall;
+}
+
+void randomSeed(unsigned long seed) {
+    if (seed != 0) {
+        rng().seed(seed);
+    }
+}
+
+long map(long x, long in_min, long in_max, long out_min, long out_max) {
+    const long dividend = out_max - out_min;
+    const long divisor = in_max - in_min;
+    if (divisor == 0) {
+        return -1;
+    }
+    return (x - in_min) * dividend / divisor + out_min;
+}
+
+void configTime(long gmtOffset_sec, int daylightOffset_sec, const char* server1, const char* server2,
+                const char* server3) {
+    (void)gmtOffset_sec;
+    (void)daylightOffset_sec;
+    (void)server1;
+    (void)server2;
+    (void)server3;
+}
+
+#if !defined(__GLIBC__) || !__GLIBC_PREREQ(2, 38)
+size_t strlcpy(char* dst, const char* src, size_t size) {
+    size_t len = strlen(src);
+    if (size) {
+        size_t n = len < size - 1 ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return len;
+}
+
+size_t strlcat(char* dst, const char* src, size_t size) {
+    size_t used = strnlen(dst, size);
+    if (used == size) {
+        return size + strlen(src);
+    }
+    return used + strlcpy(dst + used, src, size - used);
+}
+#endif
@@ -0,0 +1,253 @@
+#include "BlynkSimpleEsp32.h"
+
+BlynkWifi Blynk;
+
+void BlynkWifi::connectWiFi(const char* ssid, const char* pass) {
+    if (WiFi.status() == WL_CONNECTED) {
+        return;
+    }
+    WiFi.mode(WIFI_STA);
+    WiFi.begin(ssid, pass);
+    while (WiFi.status() != WL_CONNECTED) {
+        delay(500);
+    }
+}
+
+void BlynkWifi::config(const char* auth, IPAddress ip, uint16_t port) {
+    config(auth, ip.toString().c_str(), port);
+}
+
+void BlynkWifi::config(const char* auth, const char* domain, uint16_t port) {
+    _auth = auth;
+    _host = domain;
+    _port = port;
+    // Host only: point the sketch at a stand-in server
+    const char* server = getenv("BLYNK_SERVER");
+    if (server && *server) {
+        String s = server;
+        int colon = s.indexOf(':');
+        _host = colon < 0 ? s : s.substring(0, colon);
+        if (colon >= 0) {
+            _port = (uint16_t)s.substring(colon + 1).toInt();
+        }
+    }
+}
+
+void BlynkWifi::begin(const char* auth, const char* ssid, const char* pass, IPAddress ip, uint16_t port) {
+    connectWiFi(ssid, pass);
+    config(auth, ip, port);
+    while (!connect()) {
+    }
+}
+
+void BlynkWifi::begin(const char* auth, const char* ssid, const char* pass, const char* domain, uint16_t port) {
+    connectWiFi(ssid, pass);
+    config(auth, domain, port);
+    while (!connect()) {
+    }
+}
+
+uint16_t BlynkWifi::nextId() {
+    if (++_msgId == 0) {
+        _msgId = 1;
+    }
+    return _msgId;
+}
+
+bool BlynkWifi::sendCmd(uint8_t cmd, uint16_t id, const char* data, size_t len) {
+    uint8_t header[5] = {cmd, (uint8_t)(id >> 8), (uint8_t)id, (uint8_t)(len >> 8), (uint8_t)len};
+    // One write per message, as the library assembles it in a buffer
+    uint8_t buf[5 + 256];
+    if (len > sizeof(buf) - 5) {
+        return false;
+    }
+    memcpy(buf, header, 5);
+    if (len) {
+        memcpy(buf + 5, data, len);
+    }
+    if (_client.write(buf, 5 + len) != 5 + len) {
+        disconnect();
+        return false;
+    }
+    _lastActivityOut = millis();
+    return true;
+}
+
+bool BlynkWifi::readMessage(uint32_t timeout, uint8_t& cmd, uint16_t& id, uint16_t& len) {
+    uint8_t header[5];
+    _client.Stream::setTimeout(timeout);
+    if (_client.readBytes((char*)header, 5) != 5) {
+        return false;
+    }
+    cmd = header[0];
+    id = (uint16_t)(header[1] << 8 | header[2]);
+    len = (uint16_t)(header[3] << 8 | header[4]);
+    _lastActivityIn = millis();
+    return true;
+}
+
+bool BlynkWifi::connect(uint32_t timeout) {
+    disconnect();
+    if (!_client.connect(_host.c_str(), _port, (int32_t)timeout)) {
+        delay(BLYNK_TIMEOUT_MS);
+        return false;
+    }
+    uint16_t id = nextId();
+    if (!sendCmd(BLYNK_CMD_HW_LOGIN, id, _auth.c_str(), _auth.length())) {
+        return false;
+    }
+    unsigned long start = millis();
+    uint8_t cmd;
+    uint16_t rid, len;
+    while (millis() - start < timeout) {
+        if (!readMessage(timeout, cmd, rid, len)) {
+            break;
+        }
+        if (cmd == BLYNK_CMD_RESPONSE && rid == id) {
+            if (len != BLYNK_SUCCESS) {
+                break;
+            }
+            _state = CONNECTED;
+            _lastHeartbeat = _lastActivityIn;
+            return true;
+        }
+    }
+    disconnect();
+    delay(BLYNK_TIMEOUT_MS);
+    return false;
+}
+
+void BlynkWifi::disconnect() {
+    _client.stop();
+    _state = IDLE;
+}
+
+void BlynkWifi::run() {
+    if (_state != CONNECTED) {
+        // The library reconnects from run(); connect() blocks meanwhile
+        connect();
+        return;
+    }
+    while (_client.available() >= 5) {
+        uint8_t cmd;
+        uint16_t id, len;
+        if (!readMessage(BLYNK_TIMEOUT_MS, cmd, id, len)) {
+            disconnect();
+            return;
+        }
+        // RESPONSE carries a status, not a length
+        if (cmd != BLYNK_CMD_RESPONSE) {
+            char skip[256];
+            while (len > 0) {
+                size_t n = _client.readBytes(skip, len < sizeof(skip) ? len : sizeof(skip));
+                if (n == 0) {
+                    disconnect();
+                    return;
+                }
+                len -= n;
+            }
+        }
+        if (cmd == BLYNK_CMD_PING) {
+            // The status goes where the length would be
+            uint8_t ok[5] = {BLYNK_CMD_RESPONSE, (uint8_t)(id >> 8), (uint8_t)id, 0, BLYNK_SUCCESS};
+            _client.write(ok, sizeof(ok));
+            _lastActivityOut = millis();
+        }
+    }
+
+    unsigned long now = millis();
+    if (now - _lastActivityIn > 1000UL * BLYNK_HEARTBEAT * 23 / 10) {
+        // Server went silent
+        disconnect();
+        return;
+    }
+    if (now - _lastHeartbeat > 1000UL * BLYNK_HEARTBEAT &&
+        (now - _lastActivityIn > 1000UL * BLYNK_HEARTBEAT || now - _lastActivityOut > 1000UL * BLYNK_HEARTBEAT)) {
+        _lastHeartbeat = now;
+        sendCmd(BLYNK_CMD_PING, nextId(), nullptr, 0);
+    }
+    if (!_client.connected()) {
+        disconnect();
+    }
+}
+
+void BlynkWifi::virtualWrite(int pin, const String& value) {
+    if (_state != CONNECTED) {
+        return;
+    }
+    // "vw\0<pin>\0<value>"
+    char body[128];
+    int n = snprintf(body, sizeof(body), "vw%c%d%c%s", 0, pin, 0, value.c_str());
+    if (n < 0 || n >= (int)sizeof(body)) {
+        return;
+    }
+    sendCmd(BLYNK_CMD_HARDWARE, nextId(), body, (size_t)n);
+}
+
+int BlynkTimer::setupTimer(unsigned long d, timer_callback f, unsigned n) {
+    for (int i = 0; i < MAX_TIMERS; i++) {
+        if (!_timers[i].callback) {
+            _timers[i].callback = f;
+            _timers[i].delay = d;
+            _timers[i].maxRuns = n;
+            _timers[i].numRuns = 0;
+            _timers[i].enabled = true;
+            _timers[i].prevMillis = millis();
+            _numTimers++;
+            return i;
+        }
+    }
+    return -1;
+}
+
+void BlynkTimer::deleteTimer(int numTimer) {
+    if (numTimer >= 0 && numTimer < MAX_TIMERS && _timers[numTimer].callback) {
+        _timers[numTimer] = Timer();
+        _numTimers--;
+    }
+}
+
+void BlynkTimer::restartTimer(int numTimer) {
+    if (numTimer >= 0 && numTimer < MAX_TIMERS) {
+        _timers[numTimer].prevMillis = millis();
+    }
+}
+
+bool BlynkTimer::isEnabled(int numTimer) const {
+    return numTimer >= 0 && numTimer < MAX_TIMERS && _timers[numTimer].enabled;
+}
+
+void BlynkTimer::enable(int numTimer) {
+    if (numTimer >= 0 && numTimer < MAX_TIMERS) {
+        _timers[numTimer].enabled = true;
+    }
+}
+
+void BlynkTimer::disable(int numTimer) {
+    if (numTimer >= 0 && numTimer < MAX_TIMERS) {
+        _timers[numTimer].enabled = false;
+    }
+}
+
+void BlynkTimer::run() {
+    unsigned long now = millis();
+    for (int i = 0; i < MAX_TIMERS; i++) {
+        Timer& t = _timers[i];
+        if (!t.callback || now - t.prevMillis < t.delay) {
+            continue;
+        }
+        // Catch up without bursting, like SimpleTimer
+        t.prevMillis += t.delay;
+        if (now - t.prevMillis >= t.delay) {
+            t.prevMillis = now;
+        }
+        if (!t.enabled) {
+            continue;
+        }
+        timer_callback callback = t.callback;
+        if (t.maxRuns != RUN_FOREVER && ++t.numRuns >= t.maxRuns) {
+            deleteTimer(i);
+        }
+        callback();
+    }
+}
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <functional>
+
+#include "WiFi.h"
+
+// The part of the Blynk library the Blynk sketch uses, speaking the Blynk
+// binary protocol over WiFiClient: 5-byte header (command, message id,
+// length or status), HW_LOGIN with the auth token, HARDWARE "vw" writes and
+// PING heartbeats. BLYNK_SERVER=host:port redirects begin() to a local
+// stand-in server.
+
+#define BLYNK_CMD_RESPONSE 0
+#define BLYNK_CMD_PING 6
+#define BLYNK_CMD_HARDWARE 20
+#define BLYNK_CMD_HW_LOGIN 29
+#define BLYNK_SUCCESS 200
+
+#define BLYNK_HEARTBEAT 10
+#define BLYNK_TIMEOUT_MS 3000UL
+#define BLYNK_DEFAULT_PORT 80
+
+#define V0 0
+#define V1 1
+#define V2 2
+#define V3 3
+#define V4 4
+#define V5 5
+#define V6 6
+#define V7 7
+#define V8 8
+#define V9 9
+#define V10 10
+#define V11 11
+#define V12 12
+#define V13 13
+#define V14 14
+#define V15 15
+#define V16 16
+#define V17 17
+#define V18 18
+#define V19 19
+#define V20 20
+#define V21 21
+#define V22 22
+#define V23 23
+#define V24 24
+#define V25 25
+#define V26 26
+#define V27 27
+#define V28 28
+#define V29 29
+#define V30 30
+#define V31 31
+#define V32 32
+#define V33 33
+#define V34 34
+#define V35 35
+#define V36 36
+#define V37 37
+#define V38 38
+#define V39 39
+#define V40 40
+#define V41 41
+#define V42 42
+#define V43 43
+#define V44 44
+#define V45 45
+#define V46 46
+#define V47 47
+#define V48 48
+#define V49 49
+#define V50 50
+#define V51 51
+#define V52 52
+#define V53 53
+#define V54 54
+#define V55 55
+#define V56 56
+#define V57 57
+#define V58 58
+#define V59 59
+#define V60 60
+#define V61 61
+#define V62 62
+#define V63 63
+#define V64 64
+#define V65 65
+#define V66 66
+#define V67 67
+#define V68 68
+#define V69 69
+#define V70 70
+#define V71 71
+#define V72 72
+#define V73 73
+#define V74 74
+#define V75 75
+#define V76 76
+#define V77 77
+#define V78 78
+#define V79 79
+#define V80 80
+#define V81 81
+#define V82 82
+#define V83 83
+#define V84 84
+#define V85 85
+#define V86 86
+#define V87 87
+#define V88 88
+#define V89 89
+#define V90 90
+#define V91 91
+#define V92 92
+#define V93 93
+#define V94 94
+#define V95 95
+#define V96 96
+#define V97 97
+#define V98 98
+#define V99 99
+#define V100 100
+#define V101 101
+#define V102 102
+#define V103 103
+#define V104 104
+#define V105 105
+#define V106 106
+#define V107 107
+#define V108 108
+#define V109 109
+#define V110 110
+#define V111 111
+#define V112 112
+#define V113 113
+#define V114 114
+#define V115 115
+#define V116 116
+#define V117 117
+#define V118 118
+#define V119 119
+#define V120 120
+#define V121 121
+#define V122 122
+#define V123 123
+#define V124 124
+#define V125 125
+#define V126 126
+#define V127 127
+
+class BlynkWifi {
+public:
+    void begin(const char* auth, const char* ssid, const char* pass, IPAddress ip, uint16_t port = BLYNK_DEFAULT_PORT);
+    void begin(const char* auth, const char* ssid, const char* pass, const char* domain = "blynk.cloud",
+               uint16_t port = BLYNK_DEFAULT_PORT);
+    void config(const char* auth, IPAddress ip, uint16_t port = BLYNK_DEFAULT_PORT);
+    void config(const char* auth, const char* domain = "blynk.cloud", uint16_t port = BLYNK_DEFAULT_PORT);
+    bool connect(uint32_t timeout = BLYNK_TIMEOUT_MS * 3);
+    void disconnect();
+    bool connected() { return _state == CONNECTED; }
+    void run();
+
+    void virtualWrite(int pin, long value) { virtualWrite(pin, String(value)); }
+    void virtualWrite(int pin, int value) { virtualWrite(pin, String(value)); }
+    void virtualWrite(int pin, unsigned long value) { virtualWrite(pin, String(value)); }
+    void virtualWrite(int pin, double value) { virtualWrite(pin, String(value, 3)); }
+    void virtualWrite(int pin, const char* value) { virtualWrite(pin, String(value)); }
+    void virtualWrite(int pin, const String& value);
+
+private:
+    enum State { IDLE, CONNECTED };
+
+    void connectWiFi(const char* ssid, const char* pass);
+    bool sendCmd(uint8_t cmd, uint16_t id, const char* data, size_t len);
+    bool readMessage(uint32_t timeout, uint8_t& cmd, uint16_t& id, uint16_t& len);
+    uint16_t nextId();
+
+    WiFiClient _client;
+    String _auth;
+    String _host;
+    uint16_t _port = BLYNK_DEFAULT_PORT;
+    State _state = IDLE;
+    uint16_t _msgId = 0;
+    unsigned long _lastActivityIn = 0;
+    unsigned long _lastActivityOut = 0;
+    unsigned long _lastHeartbeat = 0;
+};
+
+extern BlynkWifi Blynk;
+
+// SimpleTimer as shipped with Blynk: interval callbacks run from run()
+class BlynkTimer {
+public:
+    typedef void (*timer_callback)();
+    static const int MAX_TIMERS = 16;
+
+    int setInterval(unsigned long d, timer_callback f) { return setupTimer(d, f, RUN_FOREVER); }
+    int setTimeout(unsigned long d, timer_callback f) { return setupTimer(d, f, RUN_ONCE); }
+    int setTimer(unsigned long d, timer_callback f, unsigned n) { return setupTimer(d, f, n); }
+    void deleteTimer(int numTimer);
+    void restartTimer(int numTimer);
+    bool isEnabled(int numTimer) const;
+    void enable(int numTimer);
+    void disable(int numTimer);
+    int getNumTimers() const { return _numTimers; }
+    void run();
+
+private:
+    static const unsigned RUN_FOREVER = 0;
+    static const unsigned RUN_ONCE = 1;
+
+    struct Timer {
+        timer_callback callback = nullptr;
+        unsigned long delay = 0;
+        unsigned long prevMillis = 0;
+        unsigned maxRuns = 0;
+        unsigned numRuns = 0;
+        bool enabled = false;
+    };
+
+    int setupTimer(unsigned long d, timer_callback f, unsigned n);
+
+    Timer _timers[MAX_TIMERS];
+    int _numTimers = 0;
+};
@@ -0,0 +1,93 @@
+#include "DNSServer.h"
+
+static const size_t DNS_HEADER_SIZE = 12;
+static const size_t DNS_MAX_PACKET = 512;
+
+bool DNSServer::start(uint16_t port, const String& domainName, const IPAddress& resolvedIP) {
+    _domainName = domainName;
+    _domainName.toLowerCase();
+    if (_domainName.startsWith("www.")) {
+        _domainName.remove(0, 4);
+    }
+    _resolvedIP = resolvedIP;
+    return _udp.begin(port) == 1;
+}
+
+void DNSServer::stop() {
+    _udp.stop();
+}
+
+// The question's name, without a leading "www.", against the domain
+bool DNSServer::matches(const uint8_t* question, size_t len) const {
+    if (_domainName == "*") {
+        return true;
+    }
+    String name;
+    size_t i = 0;
+    while (i < len && question[i]) {
+        uint8_t label = question[i++];
+        if (i + label > len) {
+            return false;
+        }
+        if (name.length()) {
+            name += '.';
+        }
+        name.concat((const char*)question + i, label);
+        i += label;
+    }
+    name.toLowerCase();
+    if (name.startsWith("www.")) {
+        name.remove(0, 4);
+    }
+    return name == _domainName;
+}
+
+void DNSServer::processNextRequest() {
+    int size = _udp.parsePacket();
+    if (size < (int)DNS_HEADER_SIZE || size > (int)DNS_MAX_PACKET) {
+        return;
+    }
+    uint8_t packet[DNS_MAX_PACKET + 16];
+    _udp.read(packet, size);
+
+    bool query = (packet[2] & 0x80) == 0;
+    uint8_t opcode = (packet[2] >> 3) & 0x0F;
+    uint16_t questions = (packet[4] << 8) | packet[5];
+    if (!query) {
+        return;
+    }
+
+    // Question section: name, type, class
+    size_t nameEnd = DNS_HEADER_SIZE;
+    while (nameEnd < (size_t)size && packet[nameEnd]) {
+        nameEnd += packet[nameEnd] + 1;
+    }
+    size_t questionEnd = nameEnd + 5;
+
+    _udp.beginPacket(_udp.remoteIP(), _udp.remotePort());
+    if (opcode == 0 && questions == 1 && questionEnd <= (size_t)size &&
+        matches(packet + DNS_HEADER_SIZE, nameEnd - DNS_HEADER_SIZE)) {
+        // QR, AA; RA; one answer; no authority or additional records
+        packet[2] = 0x84 | (packet[2] & 0x01);
+        packet[3] = 0x80;
+        packet[6] = 0;
+        packet[7] = 1;
+        memset(packet + 8, 0, 4);
+        _udp.write(packet, questionEnd);
+        uint8_t answer[16] = {
+            0xC0, 0x0C,  // pointer to the question's name
+            0x00, 0x01,  // A
+            0x00, 0x01,  // IN
+            (uint8_t)(_ttl >> 24), (uint8_t)(_ttl >> 16), (uint8_t)(_ttl >> 8), (uint8_t)_ttl,
+            0x00, 0x04,
+            _resolvedIP[0], _resolvedIP[1], _resolvedIP[2], _resolvedIP[3],
+        };
+        _udp.write(answer, sizeof(answer));
+    } else {
+        packet[2] = 0x80 | (packet[2] & 0x79);
+        packet[3] = (uint8_t)_errorReplyCode;
+        memset(packet + 4, 0, 8);
+        _udp.write(packet, DNS_HEADER_SIZE);
+    }
+    _udp.endPacket();
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "WiFiUdp.h"
+
+enum class DNSReplyCode {
+    NoError = 0,
+    FormError = 1,
+    ServerFailure = 2,
+    NonExistentDomain = 3,
+    NotImplemented = 4,
+    Refused = 5
+};
+
+// The core's captive-portal DNS server: every query for the domain ("*" for
+// any) gets an A record with the given address; other queries get the
+// error reply code. Port 53 is served on 8053 by default (see HostHAL.h).
+class DNSServer {
+public:
+    bool start(uint16_t port, const String& domainName, const IPAddress& resolvedIP);
+    void stop();
+    // Answers at most one waiting query; never blocks
+    void processNextRequest();
+
+    void setErrorReplyCode(DNSReplyCode replyCode) { _errorReplyCode = replyCode; }
+    void setTTL(uint32_t ttl) { _ttl = ttl; }
+
+private:
+    bool matches(const uint8_t* question, size_t len) const;
+
+    WiFiUDP _udp;
+    String _domainName;
+    IPAddress _resolvedIP;
+    DNSReplyCode _errorReplyCode = DNSReplyCode::NonExistentDomain;
+    uint32_t _ttl = 60;
+};
@@ -0,0 +1,42 @@
+#include "ESPmDNS.h"
+
+// Like the core, a leading '_' is added when the sketch leaves it out
+static String underscored(const char* name) {
+    return name[0] == '_' ? String(name) : String("_") + name;
+}
+
+bool MDNSResponder::begin(const String& hostName) {
+    if (mdns_init() != ESP_OK) {
+        return false;
+    }
+    if (mdns_hostname_set(hostName.c_str()) != ESP_OK) {
+        mdns_free();
+        return false;
+    }
+    _hostname = hostName;
+    return true;
+}
+
+void MDNSResponder::end() {
+    mdns_free();
+}
+
+void MDNSResponder::setInstanceName(const String& name) {
+    if (name.length() <= 63) {
+        mdns_instance_name_set(name.c_str());
+    }
+}
+
+bool MDNSResponder::addService(const char* service, const char* proto, uint16_t port) {
+    String s = underscored(service);
+    String p = underscored(proto);
+    return mdns_service_add(nullptr, s.c_str(), p.c_str(), port, nullptr, 0) == ESP_OK;
+}
+
+bool MDNSResponder::addServiceTxt(const char* name, const char* proto, const char* key, const char* value) {
+    String s = underscored(name);
+    String p = underscored(proto);
+    return mdns_service_txt_item_set(s.c_str(), p.c_str(), key, value) == ESP_OK;
+}
+
+MDNSResponder MDNS;
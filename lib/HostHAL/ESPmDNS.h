@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Arduino.h"
+#include "mdns.h"
+
+// The core's wrapper over the IDF responder
+class MDNSResponder {
+public:
+    bool begin(const String& hostName);
+    void end();
+
+    void setInstanceName(const String& name);
+    bool addService(const char* service, const char* proto, uint16_t port);
+    bool addService(const String& service, const String& proto, uint16_t port) {
+        return addService(service.c_str(), proto.c_str(), port);
+    }
+    bool addServiceTxt(const char* name, const char* proto, const char* key, const char* value);
+    void addServiceTxt(const String& name, const String& proto, const String& key, const String& value) {
+        addServiceTxt(name.c_str(), proto.c_str(), key.c_str(), value.c_str());
+    }
+
+private:
+    String _hostname;
+};
+
+extern MDNSResponder MDNS;
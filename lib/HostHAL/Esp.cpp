@@ -0,0 +1,214 @@
+#include "Esp.h"
+
+#include <errno.h>
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Arduino.h"
+#include "HostHAL.h"
+#include "esp_heap_caps.h"
+
+EspClass ESP;
+
+// glibc's allocator under its internal names; the wrappers below replace the
+// public ones for the whole program, libstdc++ included
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* ptr);
+}
+
+static std::atomic<long> liveBytes{0};
+static std::atomic<long> peakBytes{0};
+// What the C++ runtime held before the program proper started; not counted
+static long baselineBytes = 0;
+
+static void track(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+    long live = liveBytes.fetch_add((long)malloc_usable_size(ptr)) + (long)malloc_usable_size(ptr);
+    long peak = peakBytes.load(std::memory_order_relaxed);
+    while (live > peak && !peakBytes.compare_exchange_weak(peak, live)) {
+    }
+}
+
+static void untrack(void* ptr) {
+    if (ptr) {
+        liveBytes.fetch_sub((long)malloc_usable_size(ptr));
+    }
+}
+
+__attribute__((constructor(101))) static void captureHeapBaseline() {
+    baselineBytes = liveBytes.load();
+    peakBytes.store(baselineBytes);
+}
+
+extern "C" {
+
+void* malloc(size_t size) {
+    void* ptr = __libc_malloc(size);
+    track(ptr);
+    return ptr;
+}
+
+void* calloc(size_t count, size_t size) {
+    void* ptr = __libc_calloc(count, size);
+    track(ptr);
+    return ptr;
+}
+
+void* realloc(void* ptr, size_t size) {
+    if (!ptr) {
+        return malloc(size);
+    }
+    size_t old = malloc_usable_size(ptr);
+    void* moved = __libc_realloc(ptr, size);
+    if (moved || size == 0) {
+        liveBytes.fetch_sub((long)old);
+        track(moved);
+    }
+    return moved;
+}
+
+void free(void* ptr) {
+    untrack(ptr);
+    __libc_free(ptr);
+}
+
+void* memalign(size_t alignment, size_t size) {
+    void* ptr = __libc_memalign(alignment, size);
+    track(ptr);
+    return ptr;
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    return memalign(alignment, size);
+}
+
+int posix_memalign(void** out, size_t alignment, size_t size) {
+    void* ptr = memalign(alignment, size);
+    if (!ptr) {
+        return ENOMEM;
+    }
+    *out = ptr;
+    return 0;
+}
+
+}  // extern "C"
+
+static long heapBytes() {
+    static const long bytes = HostHAL::envLong("HOST_HEAP_BYTES", 320 * 1024);
+    return bytes;
+}
+
+static uint32_t freeFor(long used) {
+    long free = heapBytes() - (used - baselineBytes);
+    return free > 0 ? (uint32_t)free : 0;
+}
+
+uint32_t EspClass::getHeapSize() {
+    return (uint32_t)heapBytes();
+}
+
+uint32_t EspClass::getFreeHeap() {
+    return freeFor(liveBytes.load());
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+    return freeFor(peakBytes.load());
+}
+
+uint32_t EspClass::getMaxAllocHeap() {
+    return getFreeHeap();
+}
+
+const char* EspClass::getChipModel() {
+    static char model[sizeof(utsname::machine)];
+    if (!model[0]) {
+        utsname name;
+        strlcpy(model, uname(&name) == 0 ? name.machine : "host", sizeof(model));
+    }
+    return model;
+}
+
+uint8_t EspClass::getChipCores() {
+    return (uint8_t)std::thread::hardware_concurrency();
+}
+
+uint32_t EspClass::getCpuFreqMHz() {
+    FILE* f = fopen("/proc/cpuinfo", "r");
+    if (!f) {
+        return 0;
+    }
+    char line[256];
+    double mhz = 0;
+    while (fgets(line, sizeof(line), f)) {
+        if (sscanf(line, "cpu MHz : %lf", &mhz) == 1) {
+            break;
+        }
+    }
+    fclose(f);
+    return (uint32_t)mhz;
+}
+
+void EspClass::restart() {
+    // argv as the kernel saw it, NUL separated
+    std::string cmdline;
+    FILE* f = fopen("/proc/self/cmdline", "r");
+    if (f) {
+        int c;
+        while ((c = fgetc(f)) != EOF) {
+            cmdline += (char)c;
+        }
+        fclose(f);
+    }
+    std::vector<char*> args;
+    for (size_t i = 0; i < cmdline.size(); i += strlen(&cmdline[i]) + 1) {
+        args.push_back(&cmdline[i]);
+    }
+    args.push_back(nullptr);
+    fflush(stdout);
+    execv("/proc/self/exe", args.data());
+    _exit(1);
+}
+
+size_t heap_caps_get_free_size(uint32_t caps) {
+    (void)caps;
+    return ESP.getFreeHeap();
+}
+
+size_t heap_caps_get_minimum_free_size(uint32_t caps) {
+    (void)caps;
+    return ESP.getMinFreeHeap();
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps) {
+    (void)caps;
+    return ESP.getMaxAllocHeap();
+}
+
+size_t heap_caps_get_total_size(uint32_t caps) {
+    (void)caps;
+    return ESP.getHeapSize();
+}
+
+void* heap_caps_malloc(size_t size, uint32_t caps) {
+    (void)caps;
+    return malloc(size);
+}
+
+void heap_caps_free(void* ptr) {
+    free(ptr);
+}
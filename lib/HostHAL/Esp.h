@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdint.h>
+
+// The ESP object. Heap figures come from the HAL's malloc wrappers: the heap
+// is HOST_HEAP_BYTES large and everything the program allocates after start
+// counts against it, so the numbers move the way they do on the device.
+class EspClass {
+public:
+    uint32_t getHeapSize();
+    uint32_t getFreeHeap();
+    // Exact low-water mark since start
+    uint32_t getMinFreeHeap();
+    // The host heap does not fragment; same as getFreeHeap()
+    uint32_t getMaxAllocHeap();
+    uint32_t getPsramSize() { return 0; }
+    uint32_t getFreePsram() { return 0; }
+
+    const char* getChipModel();
+    uint8_t getChipRevision() { return 0; }
+    uint8_t getChipCores();
+    uint32_t getCpuFreqMHz();
+    const char* getSdkVersion() { return "HostHAL"; }
+
+    // Starts the program again with the same arguments
+    void restart();
+};
+
+extern EspClass ESP;
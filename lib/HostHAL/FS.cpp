@@ -0,0 +1,364 @@
+#include "FS.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "HostHAL.h"
+#include "LittleFS.h"
+
+namespace fs {
+
+struct FileImpl {
+    FS* fs = nullptr;
+    std::string path;      // as the sketch sees it, "/www/index.html"
+    std::string hostPath;
+    FILE* file = nullptr;
+    size_t size = 0;
+    bool writable = false;
+
+    bool directory = false;
+    std::vector<std::string> entries;
+    size_t nextEntry = 0;
+
+    ~FileImpl() { close(); }
+
+    void close() {
+        if (file) {
+            fclose(file);
+            file = nullptr;
+        }
+        directory = false;
+        entries.clear();
+    }
+};
+
+static bool isDir(const std::string& path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+static size_t fileSize(const std::string& path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode) ? (size_t)st.st_size : 0;
+}
+
+static size_t treeSize(const std::string& dir) {
+    size_t total = 0;
+    DIR* d = opendir(dir.c_str());
+    if (!d) {
+        return 0;
+    }
+    while (dirent* e = readdir(d)) {
+        if (strcmp(e->d_name, ".") == 0 || strcmp(e->d_name, "..") == 0) {
+            continue;
+        }
+        std::string child = dir + "/" + e->d_name;
+        total += isDir(child) ? treeSize(child) : fileSize(child);
+    }
+    closedir(d);
+    return total;
+}
+
+static void makeDirs(const std::string& path) {
+    for (size_t i = 1; i <= path.size(); i++) {
+        if (i == path.size() || path[i] == '/') {
+            ::mkdir(path.substr(0, i).c_str(), 0755);
+        }
+    }
+}
+
+size_t File::write(const uint8_t* buf, size_t size) {
+    if (!_impl || !_impl->file || !_impl->writable) {
+        return 0;
+    }
+    long pos = ftell(_impl->file);
+    size_t end = (size_t)pos + size;
+    size_t growth = end > _impl->size ? end - _impl->size : 0;
+    size_t allowed = _impl->fs->reserve(growth);
+    if (allowed < growth) {
+        // Partition full: only what fits is written
+        size -= growth - allowed;
+    }
+    size_t n = fwrite(buf, 1, size, _impl->file);
+    if ((size_t)pos + n > _impl->size) {
+        _impl->size = (size_t)pos + n;
+    }
+    return n;
+}
+
+int File::available() {
+    if (!_impl || !_impl->file) {
+        return 0;
+    }
+    long pos = ftell(_impl->file);
+    return pos < 0 || (size_t)pos >= _impl->size ? 0 : (int)(_impl->size - pos);
+}
+
+int File::read() {
+    if (!_impl || !_impl->file) {
+        return -1;
+    }
+    int c = fgetc(_impl->file);
+    return c == EOF ? -1 : c;
+}
+
+int File::peek() {
+    if (!_impl || !_impl->file) {
+        return -1;
+    }
+    int c = fgetc(_impl->file);
+    if (c == EOF) {
+        return -1;
+    }
+    ungetc(c, _impl->file);
+    return c;
+}
+
+void File::flush() {
+    if (_impl && _impl->file) {
+        fflush(_impl->file);
+    }
+}
+
+size_t File::read(uint8_t* buf, size_t size) {
+    if (!_impl || !_impl->file) {
+        return 0;
+    }
+    return fread(buf, 1, size, _impl->file);
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+    if (!_impl || !_impl->file) {
+        return false;
+    }
+    int whence = mode == SeekCur ? SEEK_CUR : (mode == SeekEnd ? SEEK_END : SEEK_SET);
+    return fseek(_impl->file, (long)pos, whence) == 0;
+}
+
+size_t File::position() const {
+    return _impl && _impl->file ? (size_t)ftell(_impl->file) : 0;
+}
+
+size_t File::size() const {
+    return _impl ? _impl->size : 0;
+}
+
+void File::close() {
+    if (_impl) {
+        _impl->close();
+        _impl.reset();
+    }
+}
+
+File::operator bool() const {
+    return _impl && (_impl->file || _impl->directory);
+}
+
+time_t File::getLastWrite() {
+    struct stat st;
+    return _impl && stat(_impl->hostPath.c_str(), &st) == 0 ? st.st_mtime : 0;
+}
+
+const char* File::path() const {
+    return _impl ? _impl->path.c_str() : nullptr;
+}
+
+const char* File::name() const {
+    if (!_impl) {
+        return nullptr;
+    }
+    size_t slash = _impl->path.rfind('/');
+    return _impl->path.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+}
+
+bool File::isDirectory() const {
+    return _impl && _impl->directory;
+}
+
+File File::openNextFile(const char* mode) {
+    if (!_impl || !_impl->directory || _impl->nextEntry >= _impl->entries.size()) {
+        return File();
+    }
+    std::string child = _impl->path;
+    if (child.empty() || child.back() != '/') {
+        child += '/';
+    }
+    child += _impl->entries[_impl->nextEntry++];
+    return _impl->fs->open(child.c_str(), mode);
+}
+
+void File::rewindDirectory() {
+    if (_impl) {
+        _impl->nextEntry = 0;
+    }
+}
+
+std::string FS::hostPath(const char* path) const {
+    std::string p = path ? path : "";
+    if (p.empty() || p[0] != '/') {
+        p = "/" + p;
+    }
+    return _root + p;
+}
+
+File FS::open(const char* path, const char* mode, const bool create) {
+    if (!_mounted || !path) {
+        return File();
+    }
+    auto impl = std::make_shared<FileImpl>();
+    impl->fs = this;
+    impl->path = path[0] == '/' ? path : std::string("/") + path;
+    impl->hostPath = hostPath(path);
+
+    bool reading = mode[0] == 'r' && mode[1] != '+';
+    if (reading && isDir(impl->hostPath)) {
+        DIR* d = opendir(impl->hostPath.c_str());
+        if (!d) {
+            return File();
+        }
+        while (dirent* e = readdir(d)) {
+            if (strcmp(e->d_name, ".") != 0 && strcmp(e->d_name, "..") != 0) {
+                impl->entries.push_back(e->d_name);
+            }
+        }
+        closedir(d);
+        // LittleFS lists in name order
+        std::sort(impl->entries.begin(), impl->entries.end());
+        impl->directory = true;
+        return File(impl);
+    }
+
+    if (!reading && create) {
+        size_t slash = impl->hostPath.rfind('/');
+        makeDirs(impl->hostPath.substr(0, slash));
+    }
+    size_t oldSize = fileSize(impl->hostPath);
+    impl->file = fopen(impl->hostPath.c_str(), mode);
+    if (!impl->file) {
+        return File();
+    }
+    impl->writable = !reading;
+    if (mode[0] == 'w') {
+        release(oldSize);
+        impl->size = 0;
+    } else {
+        impl->size = oldSize;
+    }
+    return File(impl);
+}
+
+bool FS::exists(const char* path) {
+    struct stat st;
+    return _mounted && stat(hostPath(path).c_str(), &st) == 0;
+}
+
+bool FS::remove(const char* path) {
+    if (!_mounted) {
+        return false;
+    }
+    std::string p = hostPath(path);
+    size_t size = fileSize(p);
+    if (::unlink(p.c_str()) != 0) {
+        return false;
+    }
+    release(size);
+    return true;
+}
+
+bool FS::rename(const char* pathFrom, const char* pathTo) {
+    if (!_mounted) {
+        return false;
+    }
+    std::string to = hostPath(pathTo);
+    size_t replaced = fileSize(to);
+    if (::rename(hostPath(pathFrom).c_str(), to.c_str()) != 0) {
+        return false;
+    }
+    release(replaced);
+    return true;
+}
+
+bool FS::mkdir(const char* path) {
+    return _mounted && ::mkdir(hostPath(path).c_str(), 0755) == 0;
+}
+
+bool FS::rmdir(const char* path) {
+    return _mounted && ::rmdir(hostPath(path).c_str()) == 0;
+}
+
+size_t FS::reserve(size_t bytes) {
+    size_t used = _used.load();
+    while (true) {
+        size_t room = _capacity > used ? _capacity - used : 0;
+        size_t granted = bytes < room ? bytes : room;
+        if (_used.compare_exchange_weak(used, used + granted)) {
+            return granted;
+        }
+    }
+}
+
+void FS::release(size_t bytes) {
+    size_t used = _used.load();
+    while (!_used.compare_exchange_weak(used, used > bytes ? used - bytes : 0)) {
+    }
+}
+
+bool LittleFSFS::begin(bool formatOnFail, const char* basePath, uint8_t maxOpenFiles, const char* partitionLabel) {
+    (void)basePath;
+    (void)maxOpenFiles;
+    (void)partitionLabel;
+    _root = HostHAL::fsDir();
+    _capacity = (size_t)HostHAL::envLong("HOST_FS_BYTES", 1408 * 1024);
+    if (!isDir(_root)) {
+        if (!formatOnFail) {
+            return false;
+        }
+        makeDirs(_root);
+        if (!isDir(_root)) {
+            return false;
+        }
+    }
+    _used = treeSize(_root);
+    _mounted = true;
+    return true;
+}
+
+static void removeTree(const std::string& dir) {
+    DIR* d = opendir(dir.c_str());
+    if (!d) {
+        return;
+    }
+    while (dirent* e = readdir(d)) {
+        if (strcmp(e->d_name, ".") == 0 || strcmp(e->d_name, "..") == 0) {
+            continue;
+        }
+        std::string child = dir + "/" + e->d_name;
+        if (isDir(child)) {
+            removeTree(child);
+            ::rmdir(child.c_str());
+        } else {
+            ::unlink(child.c_str());
+        }
+    }
+    closedir(d);
+}
+
+bool LittleFSFS::format() {
+    if (_root.empty()) {
+        _root = HostHAL::fsDir();
+    }
+    makeDirs(_root);
+    removeTree(_root);
+    _used = 0;
+    return true;
+}
+
+}  // namespace fs
+
+fs::LittleFSFS LittleFS;
@@ -0,0 +1,250 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Arduino.h"
+
+struct HostTask {
+    char name[configMAX_TASK_NAME_LEN];
+    std::mutex lock;
+    std::condition_variable notified;
+    uint32_t notifyCount = 0;
+    // The thread's CPU clock stands in for the scheduler's run time counter
+    clockid_t cpuClock;
+    bool running = false;
+};
+
+struct HostQueue {
+    size_t length;
+    size_t itemSize;
+    std::deque<std::vector<uint8_t>> items;
+    std::mutex lock;
+    std::condition_variable changed;
+};
+
+static thread_local TaskHandle_t currentTask = nullptr;
+static std::mutex tasksLock;
+static std::vector<TaskHandle_t> tasks;
+
+static TaskHandle_t newTask(const char* name) {
+    TaskHandle_t task = new HostTask();
+    strlcpy(task->name, name ? name : "", sizeof(task->name));
+    return task;
+}
+
+// Called on the task's own thread
+static void startTask(TaskHandle_t task) {
+    currentTask = task;
+    std::lock_guard<std::mutex> guard(tasksLock);
+    task->running = pthread_getcpuclockid(pthread_self(), &task->cpuClock) == 0;
+    tasks.push_back(task);
+}
+
+static void stopTask(TaskHandle_t task) {
+    std::lock_guard<std::mutex> guard(tasksLock);
+    task->running = false;
+}
+
+TaskHandle_t hostAdoptTask(const char* name) {
+    if (!currentTask) {
+        startTask(newTask(name));
+    }
+    return currentTask;
+}
+
+// Waits until the deadline, or forever for portMAX_DELAY
+template <typename Predicate>
+static bool waitFor(std::condition_variable& cv, std::unique_lock<std::mutex>& lock, TickType_t ticks,
+                    Predicate ready) {
+    if (ticks == portMAX_DELAY) {
+        cv.wait(lock, ready);
+        return true;
+    }
+    return cv.wait_for(lock, std::chrono::milliseconds(ticks * portTICK_PERIOD_MS), ready);
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char* name, uint32_t stackDepth,
+                                   void* parameters, UBaseType_t priority, TaskHandle_t* created,
+                                   BaseType_t coreId) {
+    (void)stackDepth;
+    (void)priority;
+    (void)coreId;
+    TaskHandle_t task = newTask(name);
+    if (created) {
+        *created = task;
+    }
+    std::thread([task, code, parameters] {
+        startTask(task);
+        char threadName[16];
+        strlcpy(threadName, task->name, sizeof(threadName));
+        pthread_setname_np(pthread_self(), threadName);
+        code(parameters);
+        stopTask(task);
+    }).detach();
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t code, const char* name, uint32_t stackDepth, void* parameters,
+                       UBaseType_t priority, TaskHandle_t* created) {
+    return xTaskCreatePinnedToCore(code, name, stackDepth, parameters, priority, created, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    if (task == nullptr || task == currentTask) {
+        // The handle stays valid: other tasks may still hold it
+        stopTask(currentTask);
+        pthread_exit(nullptr);
+    }
+}
+
+void vTaskDelay(TickType_t ticks) {
+    delay(ticks * portTICK_PERIOD_MS);
+}
+
+void vTaskDelayUntil(TickType_t* previousWakeTime, TickType_t timeIncrement) {
+    *previousWakeTime += timeIncrement;
+    TickType_t now = xTaskGetTickCount();
+    if ((int32_t)(*previousWakeTime - now) > 0) {
+        vTaskDelay(*previousWakeTime - now);
+    }
+}
+
+TickType_t xTaskGetTickCount() {
+    return (TickType_t)millis();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    // Threads not started through xTaskCreate: the main thread is the
+    // Arduino loop task
+    return hostAdoptTask("loopTask");
+}
+
+char* pcTaskGetName(TaskHandle_t task) {
+    return (task ? task : xTaskGetCurrentTaskHandle())->name;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    (void)task;
+    return 0;
+}
+
+static uint32_t cpuMicros(clockid_t clock) {
+    timespec ts;
+    if (clock_gettime(clock, &ts) != 0) {
+        return 0;
+    }
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+}
+
+UBaseType_t uxTaskGetNumberOfTasks() {
+    std::lock_guard<std::mutex> guard(tasksLock);
+    UBaseType_t count = 0;
+    for (TaskHandle_t task : tasks) {
+        count += task->running;
+    }
+    return count;
+}
+
+UBaseType_t uxTaskGetSystemState(TaskStatus_t* statuses, UBaseType_t arraySize, uint32_t* totalRunTime) {
+    std::lock_guard<std::mutex> guard(tasksLock);
+    UBaseType_t filled = 0;
+    for (TaskHandle_t task : tasks) {
+        if (!task->running || filled >= arraySize) {
+            continue;
+        }
+        TaskStatus_t& s = statuses[filled++];
+        s.xHandle = task;
+        s.pcTaskName = task->name;
+        s.ulRunTimeCounter = cpuMicros(task->cpuClock);
+        s.usStackHighWaterMark = 0;
+    }
+    if (totalRunTime) {
+        *totalRunTime = (uint32_t)micros();
+    }
+    return filled;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait) {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> lock(self->lock);
+    waitFor(self->notified, lock, ticksToWait, [self] { return self->notifyCount > 0; });
+    uint32_t count = self->notifyCount;
+    if (count > 0) {
+        self->notifyCount = clearCountOnExit ? 0 : count - 1;
+    }
+    return count;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    {
+        std::lock_guard<std::mutex> lock(task->lock);
+        task->notifyCount++;
+    }
+    task->notified.notify_one();
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higherPriorityTaskWoken) {
+    xTaskNotifyGive(task);
+    if (higherPriorityTaskWoken) {
+        *higherPriorityTaskWoken = pdFALSE;
+    }
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    QueueHandle_t queue = new HostQueue();
+    queue->length = length;
+    queue->itemSize = itemSize;
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    delete queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+    std::unique_lock<std::mutex> lock(queue->lock);
+    if (!waitFor(queue->changed, lock, ticksToWait, [queue] { return queue->items.size() < queue->length; })) {
+        return errQUEUE_FULL;
+    }
+    const uint8_t* bytes = (const uint8_t*)item;
+    queue->items.emplace_back(bytes, bytes + queue->itemSize);
+    lock.unlock();
+    queue->changed.notify_all();
+    return pdPASS;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void* item, BaseType_t* higherPriorityTaskWoken) {
+    if (higherPriorityTaskWoken) {
+        *higherPriorityTaskWoken = pdFALSE;
+    }
+    return xQueueSend(queue, item, 0);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* buffer, TickType_t ticksToWait) {
+    std::unique_lock<std::mutex> lock(queue->lock);
+    if (!waitFor(queue->changed, lock, ticksToWait, [queue] { return !queue->items.empty(); })) {
+        return pdFALSE;
+    }
+    memcpy(buffer, queue->items.front().data(), queue->itemSize);
+    queue->items.pop_front();
+    lock.unlock();
+    queue->changed.notify_all();
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    std::lock_guard<std::mutex> lock(queue->lock);
+    return (UBaseType_t)queue->items.size();
+}
@@ -0,0 +1,323 @@
+#include "HTTPClient.h"
+
+#include "WiFiClientSecure.h"
+
+HTTPClient::~HTTPClient() {
+    if (_client) {
+        _client->stop();
+    }
+}
+
+static bool parseUrl(const String& url, bool& secure, String& host, uint16_t& port, String& uri) {
+    int schemeEnd = url.indexOf("://");
+    if (schemeEnd < 0) {
+        return false;
+    }
+    String scheme = url.substring(0, schemeEnd);
+    if (scheme == "https") {
+        secure = true;
+    } else if (scheme == "http") {
+        secure = false;
+    } else {
+        return false;
+    }
+    String rest = url.substring(schemeEnd + 3);
+    int slash = rest.indexOf('/');
+    String authority = slash < 0 ? rest : rest.substring(0, slash);
+    uri = slash < 0 ? String("/") : rest.substring(slash);
+    int at = authority.indexOf('@');
+    if (at >= 0) {
+        authority = authority.substring(at + 1);
+    }
+    int colon = authority.indexOf(':');
+    if (colon >= 0) {
+        host = authority.substring(0, colon);
+        port = (uint16_t)authority.substring(colon + 1).toInt();
+    } else {
+        host = authority;
+        port = secure ? 443 : 80;
+    }
+    return host.length() > 0;
+}
+
+bool HTTPClient::begin(const String& url) {
+    if (!parseUrl(url, _secure, _host, _port, _uri)) {
+        return false;
+    }
+    if (!_ownClient) {
+        _ownClient.reset(_secure ? new WiFiClientSecure() : new WiFiClient());
+    }
+    _client = _ownClient.get();
+    _headers = "";
+    return true;
+}
+
+bool HTTPClient::begin(WiFiClient& client, const String& url) {
+    if (!parseUrl(url, _secure, _host, _port, _uri)) {
+        return false;
+    }
+    _ownClient.reset();
+    _client = &client;
+    _headers = "";
+    return true;
+}
+
+bool HTTPClient::connected() {
+    return _client && _client->connected();
+}
+
+bool HTTPClient::connect() {
+    if (connected()) {
+        // Reuse the kept-alive connection; drop anything left unread
+        while (_client->available() > 0) {
+            _client->read();
+        }
+        return true;
+    }
+    if (!_client) {
+        return false;
+    }
+    int ok = _connectTimeout > 0 ? _client->connect(_host.c_str(), _port, _connectTimeout)
+                                 : _client->connect(_host.c_str(), _port);
+    if (!ok) {
+        return false;
+    }
+    _client->setTimeout((_tcpTimeout + 500) / 1000);
+    return true;
+}
+
+void HTTPClient::addHeader(const String& name, const String& value, bool first, bool replace) {
+    // The client sets these itself
+    if (name.equalsIgnoreCase("Connection") || name.equalsIgnoreCase("User-Agent") ||
+        name.equalsIgnoreCase("Host")) {
+        return;
+    }
+    String line = name + ": ";
+    if (replace) {
+        int at = _headers.indexOf(line);
+        if (at >= 0) {
+            int end = _headers.indexOf('\n', at);
+            _headers.remove(at, end - at + 1);
+        }
+    }
+    line += value + "\r\n";
+    if (first) {
+        _headers = line + _headers;
+    } else {
+        _headers += line;
+    }
+}
+
+int HTTPClient::GET() {
+    return sendRequest("GET");
+}
+
+int HTTPClient::POST(uint8_t* payload, size_t size) {
+    return sendRequest("POST", payload, size);
+}
+
+int HTTPClient::PUT(uint8_t* payload, size_t size) {
+    return sendRequest("PUT", payload, size);
+}
+
+int HTTPClient::PATCH(uint8_t* payload, size_t size) {
+    return sendRequest("PATCH", payload, size);
+}
+
+int HTTPClient::returnError(int error) {
+    if (error < 0 && _client) {
+        _client->stop();
+    }
+    return error;
+}
+
+int HTTPClient::sendRequest(const char* type, uint8_t* payload, size_t size) {
+    _returnCode = 0;
+    _size = -1;
+    _chunked = false;
+    _bodyRead = false;
+    if (payload && size > 0) {
+        addHeader("Content-Length", String((unsigned long)size));
+    }
+    if (!connect()) {
+        return returnError(HTTPC_ERROR_CONNECTION_REFUSED);
+    }
+
+    String header = String(type) + " " + (_uri.length() ? _uri : String("/")) + " HTTP/1." +
+                    (_useHTTP10 ? "0" : "1");
+    header += "\r\nHost: " + _host;
+    if (_port != 80 && _port != 443) {
+        header += ":" + String(_port);
+    }
+    header += "\r\nUser-Agent: " + _userAgent + "\r\nConnection: ";
+    header += _reuse ? "keep-alive" : "close";
+    header += "\r\n";
+    if (!_useHTTP10) {
+        header += "Accept-Encoding: identity;q=1,chunked;q=0.1,*;q=0\r\n";
+    }
+    header += _headers + "\r\n";
+
+    if (_client->write((const uint8_t*)header.c_str(), header.length()) != header.length()) {
+        return returnError(HTTPC_ERROR_SEND_HEADER_FAILED);
+    }
+    if (payload && size > 0 && _client->write(payload, size) != size) {
+        return returnError(HTTPC_ERROR_SEND_PAYLOAD_FAILED);
+    }
+    return returnError(handleHeaderResponse());
+}
+
+bool HTTPClient::readLine(String& line) {
+    line = "";
+    unsigned long start = millis();
+    while (millis() - start < _tcpTimeout) {
+        int c = _client->read();
+        if (c < 0) {
+            if (!_client->connected()) {
+                return false;
+            }
+            delay(1);
+            continue;
+        }
+        if (c == '\n') {
+            if (line.endsWith("\r")) {
+                line.remove(line.length() - 1);
+            }
+            return true;
+        }
+        line += (char)c;
+    }
+    return false;
+}
+
+int HTTPClient::handleHeaderResponse() {
+    _canReuse = _reuse;
+    bool statusSeen = false;
+    String line;
+    while (true) {
+        if (!readLine(line)) {
+            if (!_client->connected()) {
+                return HTTPC_ERROR_CONNECTION_LOST;
+            }
+            return HTTPC_ERROR_READ_TIMEOUT;
+        }
+        if (!statusSeen) {
+            if (!line.startsWith("HTTP/1.")) {
+                return HTTPC_ERROR_NO_HTTP_SERVER;
+            }
+            if (line.startsWith("HTTP/1.0")) {
+                _canReuse = false;
+            }
+            _returnCode = line.substring(9, 12).toInt();
+            statusSeen = true;
+            continue;
+        }
+        if (line.length() == 0) {
+            if (_returnCode == HTTP_CODE_CONTINUE) {
+                statusSeen = false;
+                continue;
+            }
+            break;
+        }
+        int colon = line.indexOf(':');
+        if (colon <= 0) {
+            continue;
+        }
+        String name = line.substring(0, colon);
+        String value = line.substring(colon + 1);
+        value.trim();
+        if (name.equalsIgnoreCase("Content-Length")) {
+            _size = value.toInt();
+        } else if (name.equalsIgnoreCase("Connection")) {
+            if (value.indexOf("close") >= 0 && value.indexOf("keep-alive") < 0) {
+                _canReuse = false;
+            }
+        } else if (name.equalsIgnoreCase("Transfer-Encoding")) {
+            _chunked = value.equalsIgnoreCase("chunked");
+        }
+    }
+    if (_size == 0 || _returnCode == HTTP_CODE_NO_CONTENT || _returnCode == HTTP_CODE_NOT_MODIFIED) {
+        _bodyRead = true;
+    }
+    return _returnCode;
+}
+
+String HTTPClient::getString() {
+    String body;
+    if (!_client || _bodyRead) {
+        return body;
+    }
+    _bodyRead = true;
+    _client->Stream::setTimeout(_tcpTimeout);
+    if (_chunked) {
+        String line;
+        while (readLine(line)) {
+            long chunk = strtol(line.c_str(), nullptr, 16);
+            if (chunk <= 0) {
+                readLine(line);
+                break;
+            }
+            while (chunk > 0) {
+                char buf[512];
+                size_t n = _client->readBytes(buf, chunk < (long)sizeof(buf) ? chunk : sizeof(buf));
+                if (n == 0) {
+                    return body;
+                }
+                body.concat(buf, n);
+                chunk -= n;
+            }
+            readLine(line);
+        }
+        return body;
+    }
+    if (_size > 0) {
+        body.reserve(_size);
+        while ((int)body.length() < _size) {
+            char buf[512];
+            size_t want = _size - body.length();
+            size_t n = _client->readBytes(buf, want < sizeof(buf) ? want : sizeof(buf));
+            if (n == 0) {
+                break;
+            }
+            body.concat(buf, n);
+        }
+        return body;
+    }
+    // No length: the body runs until the server closes
+    _canReuse = false;
+    body = _client->readString();
+    return body;
+}
+
+void HTTPClient::end() {
+    if (!_client) {
+        return;
+    }
+    if (_client->connected() && _reuse && _canReuse) {
+        // Read what the caller left, so the next response starts clean
+        if (!_bodyRead && (_size > 0 || _chunked)) {
+            getString();
+        }
+        while (_client->available() > 0) {
+            _client->read();
+        }
+        return;
+    }
+    _client->stop();
+}
+
+String HTTPClient::errorToString(int error) {
+    switch (error) {
+    case HTTPC_ERROR_CONNECTION_REFUSED: return "connection refused";
+    case HTTPC_ERROR_SEND_HEADER_FAILED: return "send header failed";
+    case HTTPC_ERROR_SEND_PAYLOAD_FAILED: return "send payload failed";
+    case HTTPC_ERROR_NOT_CONNECTED: return "not connected";
+    case HTTPC_ERROR_CONNECTION_LOST: return "connection lost";
+    case HTTPC_ERROR_NO_STREAM: return "no stream";
+    case HTTPC_ERROR_NO_HTTP_SERVER: return "no HTTP server";
+    case HTTPC_ERROR_TOO_LESS_RAM: return "too less ram";
+    case HTTPC_ERROR_ENCODING: return "Transfer-Encoding not supported";
+    case HTTPC_ERROR_STREAM_WRITE: return "Stream write error";
+    case HTTPC_ERROR_READ_TIMEOUT: return "read Timeout";
+    default: return String();
+    }
+}
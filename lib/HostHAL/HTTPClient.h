@@ -0,0 +1,111 @@
+#pragma once
+
+#include <memory>
+
+#include "WiFiClient.h"
+
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED (-4)
+#define HTTPC_ERROR_CONNECTION_LOST (-5)
+#define HTTPC_ERROR_NO_STREAM (-6)
+#define HTTPC_ERROR_NO_HTTP_SERVER (-7)
+#define HTTPC_ERROR_TOO_LESS_RAM (-8)
+#define HTTPC_ERROR_ENCODING (-9)
+#define HTTPC_ERROR_STREAM_WRITE (-10)
+#define HTTPC_ERROR_READ_TIMEOUT (-11)
+
+#define HTTPCLIENT_DEFAULT_TCP_TIMEOUT (5000)
+
+typedef enum {
+    HTTP_CODE_CONTINUE = 100,
+    HTTP_CODE_OK = 200,
+    HTTP_CODE_CREATED = 201,
+    HTTP_CODE_ACCEPTED = 202,
+    HTTP_CODE_NO_CONTENT = 204,
+    HTTP_CODE_PARTIAL_CONTENT = 206,
+    HTTP_CODE_MOVED_PERMANENTLY = 301,
+    HTTP_CODE_FOUND = 302,
+    HTTP_CODE_NOT_MODIFIED = 304,
+    HTTP_CODE_BAD_REQUEST = 400,
+    HTTP_CODE_UNAUTHORIZED = 401,
+    HTTP_CODE_FORBIDDEN = 403,
+    HTTP_CODE_NOT_FOUND = 404,
+    HTTP_CODE_REQUEST_TIMEOUT = 408,
+    HTTP_CODE_PAYLOAD_TOO_LARGE = 413,
+    HTTP_CODE_UNPROCESSABLE_ENTITY = 422,
+    HTTP_CODE_TOO_MANY_REQUESTS = 429,
+    HTTP_CODE_INTERNAL_SERVER_ERROR = 500,
+    HTTP_CODE_BAD_GATEWAY = 502,
+    HTTP_CODE_SERVICE_UNAVAILABLE = 503,
+    HTTP_CODE_GATEWAY_TIMEOUT = 504
+} t_http_codes;
+
+// The core's HTTPClient: the same request bytes on the wire (headers,
+// keep-alive with setReuse(true)), Content-Length and chunked responses.
+class HTTPClient {
+public:
+    HTTPClient() {}
+    ~HTTPClient();
+
+    // http:// or https://; https without a client verifies nothing, as in
+    // the core
+    bool begin(const String& url);
+    bool begin(WiFiClient& client, const String& url);
+    void end();
+    bool connected();
+
+    void setReuse(bool reuse) { _reuse = reuse; }
+    void setUserAgent(const String& userAgent) { _userAgent = userAgent; }
+    void setTimeout(uint16_t timeout) { _tcpTimeout = timeout; }
+    void setConnectTimeout(int32_t connectTimeout) { _connectTimeout = connectTimeout; }
+    void useHTTP10(bool usehttp10 = true) { _useHTTP10 = usehttp10; }
+    void addHeader(const String& name, const String& value, bool first = false, bool replace = true);
+
+    int GET();
+    int POST(uint8_t* payload, size_t size);
+    int POST(const String& payload) { return POST((uint8_t*)payload.c_str(), payload.length()); }
+    int PUT(uint8_t* payload, size_t size);
+    int PUT(const String& payload) { return PUT((uint8_t*)payload.c_str(), payload.length()); }
+    int PATCH(uint8_t* payload, size_t size);
+    int PATCH(const String& payload) { return PATCH((uint8_t*)payload.c_str(), payload.length()); }
+    int sendRequest(const char* type, uint8_t* payload = nullptr, size_t size = 0);
+    int sendRequest(const char* type, const String& payload) {
+        return sendRequest(type, (uint8_t*)payload.c_str(), payload.length());
+    }
+
+    // -1 when the server sent no Content-Length
+    int getSize() const { return _size; }
+    String getString();
+    WiFiClient& getStream() { return *_client; }
+    WiFiClient* getStreamPtr() { return _client; }
+    static String errorToString(int error);
+
+private:
+    bool connect();
+    int handleHeaderResponse();
+    bool readLine(String& line);
+    int returnError(int error);
+
+    std::unique_ptr<WiFiClient> _ownClient;
+    WiFiClient* _client = nullptr;
+
+    String _host;
+    uint16_t _port = 0;
+    String _uri;
+    bool _secure = false;
+
+    String _headers;
+    String _userAgent = "ESP32HTTPClient";
+    uint16_t _tcpTimeout = HTTPCLIENT_DEFAULT_TCP_TIMEOUT;
+    int32_t _connectTimeout = -1;
+    bool _useHTTP10 = false;
+    bool _reuse = true;
+    bool _canReuse = false;
+
+    int _returnCode = 0;
+    int _size = -1;
+    bool _chunked = false;
+    bool _bodyRead = false;
+};
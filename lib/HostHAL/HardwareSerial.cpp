@@ -0,0 +1,112 @@
+#include "HardwareSerial.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <thread>
+
+HardwareSerial Serial(0);
+
+void HardwareSerial::begin(unsigned long baud, uint32_t config, int8_t rxPin, int8_t txPin) {
+    (void)config;
+    (void)rxPin;
+    (void)txPin;
+    _baud = baud;
+    if (_inFd >= 0) {
+        return;
+    }
+
+    const char* mode = getenv("HOST_SERIAL");
+    if (mode && strcmp(mode, "pty") == 0) {
+        int master = posix_openpt(O_RDWR | O_NOCTTY);
+        if (master >= 0 && grantpt(master) == 0 && unlockpt(master) == 0) {
+            fprintf(stderr, "Serial on %s\n", ptsname(master));
+            _inFd = master;
+            _outFd = master;
+        }
+    }
+    if (_inFd < 0) {
+        _inFd = 0;
+    }
+    std::thread(&HardwareSerial::readerTask, this).detach();
+}
+
+size_t HardwareSerial::setRxBufferSize(size_t size) {
+    std::lock_guard<std::mutex> lock(_lock);
+    if (_inFd >= 0 || size == 0) {
+        return 0;
+    }
+    _rx.assign(size, 0);
+    return size;
+}
+
+void HardwareSerial::readerTask() {
+    uint8_t buf[128];
+    while (true) {
+        ssize_t n = ::read(_inFd, buf, sizeof(buf));
+        if (n <= 0) {
+            // End of input; the sketch just sees no more bytes
+            return;
+        }
+        std::lock_guard<std::mutex> lock(_lock);
+        for (ssize_t i = 0; i < n; i++) {
+            if (_count == _rx.size()) {
+                _overflow++;
+                continue;
+            }
+            _rx[(_head + _count++) % _rx.size()] = buf[i];
+        }
+    }
+}
+
+int HardwareSerial::available() {
+    std::lock_guard<std::mutex> lock(_lock);
+    return (int)_count;
+}
+
+int HardwareSerial::read() {
+    std::lock_guard<std::mutex> lock(_lock);
+    if (_count == 0) {
+        return -1;
+    }
+    uint8_t c = _rx[_head];
+    _head = (_head + 1) % _rx.size();
+    _count--;
+    return c;
+}
+
+int HardwareSerial::peek() {
+    std::lock_guard<std::mutex> lock(_lock);
+    return _count ? _rx[_head] : -1;
+}
+
+size_t HardwareSerial::read(uint8_t* buffer, size_t size) {
+    std::lock_guard<std::mutex> lock(_lock);
+    size_t n = 0;
+    while (n < size && _count) {
+        buffer[n++] = _rx[_head];
+        _head = (_head + 1) % _rx.size();
+        _count--;
+    }
+    return n;
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = ::write(_outFd, buffer + done, size - done);
+        if (n <= 0) {
+            break;
+        }
+        done += n;
+    }
+    return done;
+}
+
+uint32_t HardwareSerial::rxOverflowBytes() {
+    std::lock_guard<std::mutex> lock(_lock);
+    return _overflow;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <mutex>
+#include <vector>
+
+#include "Stream.h"
+
+#define SERIAL_8N1 0x800001c
+
+// UART0. Output goes to stdout; input comes from stdin, or from a
+// pseudo-terminal with HOST_SERIAL=pty (its path is printed on stderr), so
+// a serial tool can drive the sketch. A reader thread plays the UART driver:
+// bytes land in an RX buffer of setRxBufferSize() bytes, and what does not
+// fit is dropped, as on the device.
+class HardwareSerial : public Stream {
+public:
+    explicit HardwareSerial(int uartNum) : _uartNum(uartNum) {}
+
+    void begin(unsigned long baud, uint32_t config = SERIAL_8N1, int8_t rxPin = -1, int8_t txPin = -1);
+    void end() {}
+    // Call before begin(), like on the device
+    size_t setRxBufferSize(size_t size);
+    unsigned long baudRate() const { return _baud; }
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t read(uint8_t* buffer, size_t size);
+    using Print::write;
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override;
+    int availableForWrite() override { return 128; }
+    void flush() override {}
+    operator bool() const { return true; }
+
+    // Host only: bytes lost because the RX buffer was full
+    uint32_t rxOverflowBytes();
+
+private:
+    void readerTask();
+
+    int _uartNum;
+    unsigned long _baud = 0;
+    int _inFd = -1;
+    int _outFd = 1;
+
+    std::mutex _lock;
+    std::vector<uint8_t> _rx = std::vector<uint8_t>(256);
+    size_t _head = 0;
+    size_t _count = 0;
+    uint32_t _overflow = 0;
+};
+
+extern HardwareSerial Serial;
@@ -0,0 +1,44 @@
+#include "HostHAL.h"
+
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+
+static bool benchOnlyFlag = false;
+
+void HostHAL::init(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--bench") == 0) {
+            benchOnlyFlag = true;
+        }
+    }
+    // A client that goes away mid-response must not kill the server, just
+    // like lwIP reports it as a failed write
+    signal(SIGPIPE, SIG_IGN);
+}
+
+bool HostHAL::benchOnly() {
+    return benchOnlyFlag;
+}
+
+long HostHAL::envLong(const char* name, long fallback) {
+    const char* value = getenv(name);
+    return value && *value ? strtol(value, nullptr, 10) : fallback;
+}
+
+uint16_t HostHAL::mapPort(uint16_t port) {
+    if (port == 0 || port >= 1024) {
+        return port;
+    }
+    return (uint16_t)(port + envLong("HOST_PORT_OFFSET", 8000));
+}
+
+const char* HostHAL::fsDir() {
+    const char* dir = getenv("HOST_FS_DIR");
+    return dir && *dir ? dir : "data";
+}
+
+const char* HostHAL::nvsDir() {
+    const char* dir = getenv("HOST_NVS_DIR");
+    return dir && *dir ? dir : ".nvs";
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stdint.h>
+
+// Host-only controls of the native build; nothing here exists on the device.
+//
+// The HAL is configured through the environment, so the same binary serves a
+// dev box and CI:
+//
+//   HOST_PORT_OFFSET   added to ports below 1024 (default 8000: 80 -> 8080)
+//   HOST_FS_DIR        directory that backs LittleFS (default ./data)
+//   HOST_FS_BYTES      LittleFS capacity (default 1408 KB, the 4 MB layout)
+//   HOST_NVS_DIR       directory that backs Preferences (default ./.nvs)
+//   HOST_HEAP_BYTES    size of the simulated heap (default 320 KB)
+//   HOST_SERIAL        "stdin" (default) or "pty" for a pseudo-terminal
+//   HOST_SCAN_FIXTURE  CSV of recorded scan results (ssid,bssid,rssi,channel,auth)
+//   HOST_SCAN_MS       how long a simulated scan takes (default 0)
+//   HOST_CONNECT_MS    how long WiFi.begin() takes to get an IP (default 200)
+//   HOST_MDNS_PORT     mDNS port (default 5353)
+//   HOST_MDNS_TTL      TTL of the records the responder announces (default 120 s)
+//   BLYNK_SERVER       host:port that Blynk.begin() connects to instead
+namespace HostHAL {
+
+// Called by main() before setup()
+void init(int argc, char** argv);
+
+// Started with --bench: BenchSuite exits after printing its report
+bool benchOnly();
+
+// Privileged ports are moved up so the sketches run unprivileged
+uint16_t mapPort(uint16_t port);
+
+const char* fsDir();
+const char* nvsDir();
+
+// Environment variable as a number, or fallback when unset
+long envLong(const char* name, long fallback);
+
+}  // namespace HostHAL
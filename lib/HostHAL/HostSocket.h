@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+// A connected TCP socket, shared by all copies of a WiFiClient like the
+// core's socket handle. WiFiClientSecure swaps in a TLS subclass.
+class HostSocket {
+public:
+    explicit HostSocket(int fd) : fd(fd) {}
+    virtual ~HostSocket() { close(); }
+
+    // Blocking within the socket's timeouts; < 0 with errno on failure
+    virtual ssize_t recv(uint8_t* buf, size_t len);
+    virtual ssize_t send(const uint8_t* buf, size_t len);
+    // Bytes already decoded but not yet returned by recv()
+    virtual size_t pending() { return 0; }
+    virtual void close();
+
+    // Waits up to timeoutMs for something to read; true if there is
+    bool waitReadable(int timeoutMs);
+
+    int fd;
+    // Receive buffer, one TCP segment's worth like lwIP's pbuf chain
+    uint8_t rx[1460];
+    size_t rxPos = 0;
+    size_t rxLen = 0;
+};
+
+// Resolves host (name or dotted quad) and connects within timeoutMs;
+// returns the socket, or -1
+int hostConnect(const char* host, uint16_t port, int timeoutMs);
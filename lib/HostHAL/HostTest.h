@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdio.h>
+
+// Pass/fail reporting shared by the g++ harnesses in the projects' tools/
+// folders; nothing here exists on the device.
+namespace HostTest {
+
+inline int failures = 0;
+
+inline void check(bool ok, const char* what) {
+    printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+    if (!ok) {
+        failures++;
+    }
+}
+
+// Prints the verdict; the result is main()'s exit code
+inline int finish() {
+    printf("%s\n", failures ? "FAILED" : "all checks passed");
+    return failures ? 1 : 0;
+}
+
+}  // namespace HostTest
@@ -0,0 +1,62 @@
+#include "IPAddress.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "Print.h"
+
+bool IPAddress::fromString(const char* address) {
+    uint16_t acc = 0;
+    uint8_t dots = 0;
+    bool digits = false;
+
+    for (; *address; address++) {
+        char c = *address;
+        if (c >= '0' && c <= '9') {
+            acc = acc * 10 + (c - '0');
+            digits = true;
+            if (acc > 255) {
+                return false;
+            }
+        } else if (c == '.' && digits) {
+            if (dots == 3) {
+                return false;
+            }
+            _address[dots++] = (uint8_t)acc;
+            acc = 0;
+            digits = false;
+        } else {
+            return false;
+        }
+    }
+    if (dots != 3 || !digits) {
+        return false;
+    }
+    _address[3] = (uint8_t)acc;
+    return true;
+}
+
+IPAddress::operator uint32_t() const {
+    uint32_t value;
+    memcpy(&value, _address, sizeof(value));
+    return value;
+}
+
+bool IPAddress::operator==(const uint8_t* addr) const {
+    return memcmp(addr, _address, sizeof(_address)) == 0;
+}
+
+IPAddress& IPAddress::operator=(uint32_t address) {
+    memcpy(_address, &address, sizeof(_address));
+    return *this;
+}
+
+size_t IPAddress::printTo(Print& p) const {
+    return p.print(toString());
+}
+
+String IPAddress::toString() const {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", _address[0], _address[1], _address[2], _address[3]);
+    return String(buf);
+}
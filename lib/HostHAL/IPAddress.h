@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "Printable.h"
+#include "WString.h"
+
+// IPv4 address. As a uint32_t it is in network byte order, first octet in
+// the low byte, like lwIP's ip4_addr_t on the (little-endian) ESP32.
+class IPAddress : public Printable {
+public:
+    IPAddress() : _address{0, 0, 0, 0} {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : _address{a, b, c, d} {}
+    IPAddress(uint32_t address) { *this = address; }
+    explicit IPAddress(const uint8_t* address) : _address{address[0], address[1], address[2], address[3]} {}
+
+    bool fromString(const char* address);
+    bool fromString(const String& address) { return fromString(address.c_str()); }
+
+    operator uint32_t() const;
+    bool operator==(const IPAddress& addr) const { return (uint32_t)*this == (uint32_t)addr; }
+    bool operator!=(const IPAddress& addr) const { return !(*this == addr); }
+    bool operator==(const uint8_t* addr) const;
+
+    uint8_t operator[](int index) const { return _address[index]; }
+    uint8_t& operator[](int index) { return _address[index]; }
+
+    IPAddress& operator=(uint32_t address);
+
+    size_t printTo(Print& p) const override;
+    String toString() const;
+
+private:
+    uint8_t _address[4];
+};
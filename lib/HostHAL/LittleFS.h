@@ -0,0 +1,23 @@
+#pragma once
+
+#include "FS.h"
+
+namespace fs {
+
+// LittleFS on HOST_FS_DIR (default ./data, the folder "pio run -t uploadfs"
+// takes its image from), HOST_FS_BYTES large
+class LittleFSFS : public FS {
+public:
+    // Without formatOnFail a missing directory fails the mount, like an
+    // unformatted partition
+    bool begin(bool formatOnFail = false, const char* basePath = "/littlefs", uint8_t maxOpenFiles = 10,
+               const char* partitionLabel = "spiffs");
+    void end() { _mounted = false; }
+    bool format();
+    size_t totalBytes() { return _capacity; }
+    size_t usedBytes() { return _used; }
+};
+
+}  // namespace fs
+
+extern fs::LittleFSFS LittleFS;
@@ -0,0 +1,147 @@
+#include "Preferences.h"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "HostHAL.h"
+
+// NVS_KEY_NAME_MAX_SIZE - 1
+static const size_t KEY_MAX = 15;
+
+bool Preferences::begin(const char* name, bool readOnly, const char* partitionLabel) {
+    (void)partitionLabel;
+    if (_started || !name || !*name || strlen(name) > KEY_MAX) {
+        return false;
+    }
+    _dir = std::string(HostHAL::nvsDir()) + "/" + name;
+    struct stat st;
+    if (stat(_dir.c_str(), &st) != 0) {
+        // nvs_open() in read-only mode fails on a namespace never written
+        if (readOnly) {
+            return false;
+        }
+        ::mkdir(HostHAL::nvsDir(), 0755);
+        if (::mkdir(_dir.c_str(), 0755) != 0) {
+            return false;
+        }
+    }
+    _readOnly = readOnly;
+    _started = true;
+    return true;
+}
+
+void Preferences::end() {
+    _started = false;
+}
+
+std::string Preferences::keyPath(const char* key) const {
+    return _dir + "/" + key;
+}
+
+bool Preferences::clear() {
+    if (!_started || _readOnly) {
+        return false;
+    }
+    DIR* d = opendir(_dir.c_str());
+    if (!d) {
+        return false;
+    }
+    while (dirent* e = readdir(d)) {
+        if (e->d_name[0] != '.') {
+            ::unlink(keyPath(e->d_name).c_str());
+        }
+    }
+    closedir(d);
+    return true;
+}
+
+bool Preferences::remove(const char* key) {
+    if (!_started || _readOnly || !key) {
+        return false;
+    }
+    return ::unlink(keyPath(key).c_str()) == 0;
+}
+
+bool Preferences::isKey(const char* key) {
+    struct stat st;
+    return _started && key && stat(keyPath(key).c_str(), &st) == 0;
+}
+
+size_t Preferences::put(const char* key, Type type, const void* value, size_t len) {
+    if (!_started || _readOnly || !key || !*key || strlen(key) > KEY_MAX) {
+        return 0;
+    }
+    // Written to a temp file and renamed, so a crash keeps the old value as
+    // NVS does
+    std::string path = keyPath(key);
+    std::string tmp = path + ".tmp";
+    FILE* f = fopen(tmp.c_str(), "wb");
+    if (!f) {
+        return 0;
+    }
+    bool ok = fputc(type, f) != EOF && fwrite(value, 1, len, f) == len;
+    ok = fclose(f) == 0 && ok;
+    if (!ok || ::rename(tmp.c_str(), path.c_str()) != 0) {
+        ::unlink(tmp.c_str());
+        return 0;
+    }
+    return len;
+}
+
+long Preferences::get(const char* key, Type type, void* buf, size_t maxLen) {
+    if (!_started || !key) {
+        return -1;
+    }
+    FILE* f = fopen(keyPath(key).c_str(), "rb");
+    if (!f) {
+        return -1;
+    }
+    long n = -1;
+    if (fgetc(f) == type) {
+        fseek(f, 0, SEEK_END);
+        long len = ftell(f) - 1;
+        fseek(f, 1, SEEK_SET);
+        if (!buf) {
+            n = len;
+        } else if (len >= 0 && (size_t)len <= maxLen) {
+            n = (long)fread(buf, 1, len, f);
+        }
+    }
+    fclose(f);
+    return n;
+}
+
+size_t Preferences::getString(const char* key, char* value, size_t maxLen) {
+    long len = get(key, TYPE_STR, nullptr, 0);
+    if (len < 0 || !value || (size_t)len + 1 > maxLen) {
+        return 0;
+    }
+    get(key, TYPE_STR, value, maxLen);
+    value[len] = 0;
+    return len + 1;
+}
+
+String Preferences::getString(const char* key, const String& defaultValue) {
+    long len = get(key, TYPE_STR, nullptr, 0);
+    if (len < 0) {
+        return defaultValue;
+    }
+    std::string buf(len, '\0');
+    String value;
+    if (get(key, TYPE_STR, &buf[0], len) == len) {
+        value.concat(buf.data(), len);
+    }
+    return value;
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    long len = get(key, TYPE_BLOB, nullptr, 0);
+    return len < 0 ? 0 : len;
+}
+
+size_t Preferences::getBytes(const char* key, void* buf, size_t maxLen) {
+    long len = get(key, TYPE_BLOB, buf, maxLen);
+    return len < 0 ? 0 : len;
+}
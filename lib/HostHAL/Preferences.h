@@ -0,0 +1,72 @@
+#pragma once
+
+#include <string>
+
+#include "Arduino.h"
+
+// NVS on the host: HOST_NVS_DIR/<namespace>/<key>, one file per key holding a
+// type tag and the raw value. Keys and namespaces keep the 15 character limit.
+class Preferences {
+public:
+    ~Preferences() { end(); }
+
+    bool begin(const char* name, bool readOnly = false, const char* partitionLabel = nullptr);
+    void end();
+    bool clear();
+    bool remove(const char* key);
+    bool isKey(const char* key);
+
+    size_t putChar(const char* key, int8_t value) { return put(key, TYPE_I8, &value, sizeof(value)); }
+    size_t putUChar(const char* key, uint8_t value) { return put(key, TYPE_U8, &value, sizeof(value)); }
+    size_t putShort(const char* key, int16_t value) { return put(key, TYPE_I16, &value, sizeof(value)); }
+    size_t putUShort(const char* key, uint16_t value) { return put(key, TYPE_U16, &value, sizeof(value)); }
+    size_t putInt(const char* key, int32_t value) { return put(key, TYPE_I32, &value, sizeof(value)); }
+    size_t putUInt(const char* key, uint32_t value) { return put(key, TYPE_U32, &value, sizeof(value)); }
+    size_t putLong(const char* key, int32_t value) { return putInt(key, value); }
+    size_t putULong(const char* key, uint32_t value) { return putUInt(key, value); }
+    size_t putLong64(const char* key, int64_t value) { return put(key, TYPE_I64, &value, sizeof(value)); }
+    size_t putULong64(const char* key, uint64_t value) { return put(key, TYPE_U64, &value, sizeof(value)); }
+    size_t putFloat(const char* key, float value) { return put(key, TYPE_BLOB, &value, sizeof(value)); }
+    size_t putDouble(const char* key, double value) { return put(key, TYPE_BLOB, &value, sizeof(value)); }
+    size_t putBool(const char* key, bool value) { return putUChar(key, value ? 1 : 0); }
+    size_t putString(const char* key, const char* value) { return put(key, TYPE_STR, value, strlen(value)); }
+    size_t putString(const char* key, const String& value) { return putString(key, value.c_str()); }
+    size_t putBytes(const char* key, const void* value, size_t len) { return put(key, TYPE_BLOB, value, len); }
+
+    int8_t getChar(const char* key, int8_t defaultValue = 0) { return getValue(key, TYPE_I8, defaultValue); }
+    uint8_t getUChar(const char* key, uint8_t defaultValue = 0) { return getValue(key, TYPE_U8, defaultValue); }
+    int16_t getShort(const char* key, int16_t defaultValue = 0) { return getValue(key, TYPE_I16, defaultValue); }
+    uint16_t getUShort(const char* key, uint16_t defaultValue = 0) { return getValue(key, TYPE_U16, defaultValue); }
+    int32_t getInt(const char* key, int32_t defaultValue = 0) { return getValue(key, TYPE_I32, defaultValue); }
+    uint32_t getUInt(const char* key, uint32_t defaultValue = 0) { return getValue(key, TYPE_U32, defaultValue); }
+    int32_t getLong(const char* key, int32_t defaultValue = 0) { return getInt(key, defaultValue); }
+    uint32_t getULong(const char* key, uint32_t defaultValue = 0) { return getUInt(key, defaultValue); }
+    int64_t getLong64(const char* key, int64_t defaultValue = 0) { return getValue(key, TYPE_I64, defaultValue); }
+    uint64_t getULong64(const char* key, uint64_t defaultValue = 0) { return getValue(key, TYPE_U64, defaultValue); }
+    float getFloat(const char* key, float defaultValue = NAN) { return getValue(key, TYPE_BLOB, defaultValue); }
+    double getDouble(const char* key, double defaultValue = NAN) { return getValue(key, TYPE_BLOB, defaultValue); }
+    bool getBool(const char* key, bool defaultValue = false) { return getUChar(key, defaultValue ? 1 : 0) == 1; }
+    size_t getString(const char* key, char* value, size_t maxLen);
+    String getString(const char* key, const String& defaultValue = String());
+    size_t getBytesLength(const char* key);
+    size_t getBytes(const char* key, void* buf, size_t maxLen);
+
+private:
+    enum Type : uint8_t { TYPE_U8, TYPE_I8, TYPE_U16, TYPE_I16, TYPE_U32, TYPE_I32, TYPE_U64, TYPE_I64, TYPE_STR, TYPE_BLOB };
+
+    size_t put(const char* key, Type type, const void* value, size_t len);
+    // Bytes of the value when the key exists with this type, otherwise -1
+    long get(const char* key, Type type, void* buf, size_t maxLen);
+
+    template <typename T>
+    T getValue(const char* key, Type type, T defaultValue) {
+        T value;
+        return get(key, type, &value, sizeof(value)) == (long)sizeof(value) ? value : defaultValue;
+    }
+
+    std::string keyPath(const char* key) const;
+
+    std::string _dir;
+    bool _started = false;
+    bool _readOnly = false;
+};
@@ -0,0 +1,61 @@
+#include "Print.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size--) {
+        if (!write(*buffer++)) {
+            break;
+        }
+        n++;
+    }
+    return n;
+}
+
+size_t Print::printf(const char* format, ...) {
+    char small[64];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(small, sizeof(small), format, args);
+    va_end(args);
+    if (len < 0) {
+        return 0;
+    }
+    if ((size_t)len < sizeof(small)) {
+        return write((const uint8_t*)small, len);
+    }
+
+    char* big = (char*)malloc(len + 1);
+    if (!big) {
+        return 0;
+    }
+    va_start(args, format);
+    vsnprintf(big, len + 1, format, args);
+    va_end(args);
+    size_t n = write((const uint8_t*)big, len);
+    free(big);
+    return n;
+}
+
+size_t Print::print(long long n, int base) {
+    if (base == DEC && n < 0) {
+        return print('-') + print(0 - (unsigned long long)n, base);
+    }
+    return print((unsigned long long)n, base);
+}
+
+size_t Print::print(unsigned long long n, int base) {
+    if (base == 0) {
+        return write((uint8_t)n);
+    }
+    return print(String(n, (unsigned char)base));
+}
+
+size_t Print::print(double n, int digits) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", digits, n);
+    return write(buf);
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <stddef.h>
+
+class Print;
+
+// Objects that know how to print themselves, e.g. IPAddress
+class Printable {
+public:
+    virtual ~Printable() {}
+    virtual size_t printTo(Print& p) const = 0;
+};
@@ -0,0 +1,152 @@
+#include "WString.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <strings.h>
+
+static std::string toBase(unsigned long long value, unsigned char base, bool negative) {
+    if (base < 2 || base > 36) {
+        base = 10;
+    }
+    char digits[66];
+    size_t n = 0;
+    do {
+        unsigned d = value % base;
+        digits[n++] = (char)(d < 10 ? '0' + d : 'a' + d - 10);
+        value /= base;
+    } while (value);
+    std::string s;
+    if (negative) {
+        s += '-';
+    }
+    while (n) {
+        s += digits[--n];
+    }
+    return s;
+}
+
+// Negative values in other bases are printed as their two's complement, like
+// the core's ltoa()
+static std::string signedToString(long long value, unsigned char base, unsigned long long mask) {
+    if (base == 10) {
+        return toBase(value < 0 ? 0 - (unsigned long long)value : (unsigned long long)value, 10, value < 0);
+    }
+    return toBase((unsigned long long)value & mask, base, false);
+}
+
+static std::string floatToString(double value, unsigned int decimalPlaces) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", (int)decimalPlaces, value);
+    return buf;
+}
+
+String::String(unsigned char value, unsigned char base) : _s(toBase(value, base, false)) {}
+String::String(int value, unsigned char base) : _s(signedToString(value, base, 0xFFFFFFFFull)) {}
+String::String(unsigned int value, unsigned char base) : _s(toBase(value, base, false)) {}
+String::String(long value, unsigned char base) : _s(signedToString(value, base, ~0ull)) {}
+String::String(unsigned long value, unsigned char base) : _s(toBase(value, base, false)) {}
+String::String(long long value, unsigned char base) : _s(signedToString(value, base, ~0ull)) {}
+String::String(unsigned long long value, unsigned char base) : _s(toBase(value, base, false)) {}
+String::String(float value, unsigned int decimalPlaces) : _s(floatToString(value, decimalPlaces)) {}
+String::String(double value, unsigned int decimalPlaces) : _s(floatToString(value, decimalPlaces)) {}
+
+bool String::equalsIgnoreCase(const String& s) const {
+    return _s.length() == s._s.length() && strcasecmp(_s.c_str(), s._s.c_str()) == 0;
+}
+
+bool String::startsWith(const String& prefix, unsigned int offset) const {
+    if (offset > _s.length() || prefix._s.length() > _s.length() - offset) {
+        return false;
+    }
+    return _s.compare(offset, prefix._s.length(), prefix._s) == 0;
+}
+
+bool String::endsWith(const String& suffix) const {
+    if (suffix._s.length() > _s.length()) {
+        return false;
+    }
+    return _s.compare(_s.length() - suffix._s.length(), suffix._s.length(), suffix._s) == 0;
+}
+
+void String::getBytes(unsigned char* buf, unsigned int bufsize, unsigned int index) const {
+    if (!bufsize || !buf) {
+        return;
+    }
+    if (index >= _s.length()) {
+        buf[0] = 0;
+        return;
+    }
+    unsigned int n = bufsize - 1;
+    if (n > _s.length() - index) {
+        n = _s.length() - index;
+    }
+    memcpy(buf, _s.data() + index, n);
+    buf[n] = 0;
+}
+
+String String::substring(unsigned int left, unsigned int right) const {
+    if (left > right) {
+        unsigned int temp = right;
+        right = left;
+        left = temp;
+    }
+    if (left >= _s.length()) {
+        return String();
+    }
+    if (right > _s.length()) {
+        right = _s.length();
+    }
+    String out;
+    out._s.assign(_s, left, right - left);
+    return out;
+}
+
+void String::replace(char find, char replace) {
+    for (char& c : _s) {
+        if (c == find) {
+            c = replace;
+        }
+    }
+}
+
+void String::replace(const String& find, const String& replace) {
+    if (find._s.empty()) {
+        return;
+    }
+    size_t pos = 0;
+    while ((pos = _s.find(find._s, pos)) != std::string::npos) {
+        _s.replace(pos, find._s.length(), replace._s);
+        pos += replace._s.length();
+    }
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+    if (index >= _s.length()) {
+        return;
+    }
+    _s.erase(index, count);
+}
+
+void String::toLowerCase() {
+    for (char& c : _s) {
+        c = (char)tolower((unsigned char)c);
+    }
+}
+
+void String::toUpperCase() {
+    for (char& c : _s) {
+        c = (char)toupper((unsigned char)c);
+    }
+}
+
+void String::trim() {
+    size_t first = 0;
+    while (first < _s.length() && isspace((unsigned char)_s[first])) {
+        first++;
+    }
+    size_t last = _s.length();
+    while (last > first && isspace((unsigned char)_s[last - 1])) {
+        last--;
+    }
+    _s = _s.substr(first, last - first);
+}
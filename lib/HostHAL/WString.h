@@ -0,0 +1,186 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+#include "pgmspace.h"
+
+class __FlashStringHelper;
+#define FPSTR(pstr_pointer) (reinterpret_cast<const __FlashStringHelper*>(pstr_pointer))
+#define F(string_literal) (FPSTR(PSTR(string_literal)))
+
+// Arduino String over std::string. Both keep short strings inline, so the
+// allocation behaviour is close to the core's; assigning a null pointer
+// empties the string, which is what ArduinoJson relies on.
+class String {
+public:
+    String(const char* cstr = "") : _s(cstr ? cstr : "") {}
+    String(const char* cstr, unsigned int length) : _s(cstr ? cstr : "", cstr ? length : 0) {}
+    String(const __FlashStringHelper* str) : String(reinterpret_cast<const char*>(str)) {}
+    String(const String& str) = default;
+    String(String&& str) noexcept = default;
+    explicit String(char c) : _s(1, c) {}
+    explicit String(unsigned char value, unsigned char base = 10);
+    explicit String(int value, unsigned char base = 10);
+    explicit String(unsigned int value, unsigned char base = 10);
+    explicit String(long value, unsigned char base = 10);
+    explicit String(unsigned long value, unsigned char base = 10);
+    explicit String(long long value, unsigned char base = 10);
+    explicit String(unsigned long long value, unsigned char base = 10);
+    explicit String(float value, unsigned int decimalPlaces = 2);
+    explicit String(double value, unsigned int decimalPlaces = 2);
+
+    String& operator=(const String& rhs) = default;
+    String& operator=(String&& rhs) noexcept = default;
+    String& operator=(const char* cstr) {
+        _s.assign(cstr ? cstr : "");
+        return *this;
+    }
+    String& operator=(const __FlashStringHelper* str) { return *this = reinterpret_cast<const char*>(str); }
+
+    bool reserve(unsigned int size) {
+        _s.reserve(size);
+        return true;
+    }
+    unsigned int length() const { return (unsigned int)_s.length(); }
+    bool isEmpty() const { return _s.empty(); }
+    void clear() { _s.clear(); }
+
+    bool concat(const String& str) {
+        _s += str._s;
+        return true;
+    }
+    bool concat(const char* cstr) {
+        if (!cstr) {
+            return false;
+        }
+        _s += cstr;
+        return true;
+    }
+    bool concat(const char* cstr, unsigned int length) {
+        if (!cstr) {
+            return false;
+        }
+        _s.append(cstr, length);
+        return true;
+    }
+    bool concat(const uint8_t* cstr, unsigned int length) { return concat((const char*)cstr, length); }
+    bool concat(char c) {
+        _s += c;
+        return true;
+    }
+    bool concat(unsigned char num) { return concat(String(num)); }
+    bool concat(int num) { return concat(String(num)); }
+    bool concat(unsigned int num) { return concat(String(num)); }
+    bool concat(long num) { return concat(String(num)); }
+    bool concat(unsigned long num) { return concat(String(num)); }
+    bool concat(long long num) { return concat(String(num)); }
+    bool concat(unsigned long long num) { return concat(String(num)); }
+    bool concat(float num) { return concat(String(num)); }
+    bool concat(double num) { return concat(String(num)); }
+    bool concat(const __FlashStringHelper* str) { return concat(reinterpret_cast<const char*>(str)); }
+
+    template <typename T>
+    String& operator+=(const T& rhs) {
+        concat(rhs);
+        return *this;
+    }
+
+    int compareTo(const String& s) const { return _s.compare(s._s); }
+    bool equals(const String& s) const { return _s == s._s; }
+    bool equals(const char* cstr) const { return _s == (cstr ? cstr : ""); }
+    bool equalsIgnoreCase(const String& s) const;
+    bool equalsConstantTime(const String& s) const { return equals(s); }
+    bool operator==(const String& rhs) const { return equals(rhs); }
+    bool operator==(const char* cstr) const { return equals(cstr); }
+    bool operator!=(const String& rhs) const { return !equals(rhs); }
+    bool operator!=(const char* cstr) const { return !equals(cstr); }
+    bool operator<(const String& rhs) const { return compareTo(rhs) < 0; }
+    bool operator>(const String& rhs) const { return compareTo(rhs) > 0; }
+    bool operator<=(const String& rhs) const { return compareTo(rhs) <= 0; }
+    bool operator>=(const String& rhs) const { return compareTo(rhs) >= 0; }
+
+    bool startsWith(const String& prefix) const { return startsWith(prefix, 0); }
+    bool startsWith(const String& prefix, unsigned int offset) const;
+    bool endsWith(const String& suffix) const;
+
+    char charAt(unsigned int index) const { return index < _s.length() ? _s[index] : 0; }
+    void setCharAt(unsigned int index, char c) {
+        if (index < _s.length()) {
+            _s[index] = c;
+        }
+    }
+    char operator[](unsigned int index) const { return charAt(index); }
+    char& operator[](unsigned int index) { return _s[index]; }
+    void getBytes(unsigned char* buf, unsigned int bufsize, unsigned int index = 0) const;
+    void toCharArray(char* buf, unsigned int bufsize, unsigned int index = 0) const {
+        getBytes((unsigned char*)buf, bufsize, index);
+    }
+    const char* c_str() const { return _s.c_str(); }
+    char* begin() { return &_s[0]; }
+    char* end() { return &_s[0] + _s.length(); }
+    const char* begin() const { return c_str(); }
+    const char* end() const { return c_str() + _s.length(); }
+
+    int indexOf(char ch, unsigned int fromIndex = 0) const { return find(_s.find(ch, fromIndex)); }
+    int indexOf(const String& str, unsigned int fromIndex = 0) const { return find(_s.find(str._s, fromIndex)); }
+    int indexOf(const char* str, unsigned int fromIndex = 0) const { return find(_s.find(str, fromIndex)); }
+    int lastIndexOf(char ch) const { return find(_s.rfind(ch)); }
+    int lastIndexOf(char ch, unsigned int fromIndex) const { return find(_s.rfind(ch, fromIndex)); }
+    int lastIndexOf(const String& str) const { return find(_s.rfind(str._s)); }
+    int lastIndexOf(const String& str, unsigned int fromIndex) const { return find(_s.rfind(str._s, fromIndex)); }
+    String substring(unsigned int beginIndex) const { return substring(beginIndex, length()); }
+    String substring(unsigned int beginIndex, unsigned int endIndex) const;
+
+    void replace(char find, char replace);
+    void replace(const String& find, const String& replace);
+    void remove(unsigned int index) { remove(index, (unsigned int)-1); }
+    void remove(unsigned int index, unsigned int count);
+    void toLowerCase();
+    void toUpperCase();
+    void trim();
+
+    long toInt() const { return atol(_s.c_str()); }
+    float toFloat() const { return (float)toDouble(); }
+    double toDouble() const { return atof(_s.c_str()); }
+
+private:
+    static int find(size_t pos) { return pos == std::string::npos ? -1 : (int)pos; }
+
+    std::string _s;
+};
+
+inline String operator+(const String& lhs, const String& rhs) {
+    String s(lhs);
+    s += rhs;
+    return s;
+}
+inline String operator+(const String& lhs, const char* rhs) {
+    String s(lhs);
+    s += rhs;
+    return s;
+}
+inline String operator+(const char* lhs, const String& rhs) {
+    String s(lhs);
+    s += rhs;
+    return s;
+}
+inline String operator+(const String& lhs, char rhs) {
+    String s(lhs);
+    s += rhs;
+    return s;
+}
+inline String operator+(const String& lhs, const __FlashStringHelper* rhs) {
+    String s(lhs);
+    s += rhs;
+    return s;
+}
+inline String operator+(const String& lhs, int rhs) { return lhs + String(rhs); }
+inline String operator+(const String& lhs, unsigned int rhs) { return lhs + String(rhs); }
+inline String operator+(const String& lhs, long rhs) { return lhs + String(rhs); }
+inline String operator+(const String& lhs, unsigned long rhs) { return lhs + String(rhs); }
+inline String operator+(const String& lhs, long long rhs) { return lhs + String(rhs); }
+inline String operator+(const String& lhs, unsigned long long rhs) { return lhs + String(rhs); }
+inline String operator+(const String& lhs, float rhs) { return lhs + String(rhs); }
+inline String operator+(const String& lhs, double rhs) { return lhs + String(rhs); }
@@ -0,0 +1,349 @@
+#include "WebServer.h"
+
+static const char* reasonPhrase(int code) {
+    switch (code) {
+    case 100: return "Continue";
+    case 200: return "OK";
+    case 201: return "Created";
+    case 202: return "Accepted";
+    case 204: return "No Content";
+    case 206: return "Partial Content";
+    case 301: return "Moved Permanently";
+    case 302: return "Found";
+    case 303: return "See Other";
+    case 304: return "Not Modified";
+    case 307: return "Temporary Redirect";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 408: return "Request Time-out";
+    case 411: return "Length Required";
+    case 413: return "Request Entity Too Large";
+    case 414: return "Request-URI Too Large";
+    case 416: return "Requested range not satisfiable";
+    case 500: return "Internal Server Error";
+    case 501: return "Not Implemented";
+    case 503: return "Service Unavailable";
+    default: return "";
+    }
+}
+
+static HTTPMethod parseMethod(const String& name) {
+    if (name == "GET") return HTTP_GET;
+    if (name == "HEAD") return HTTP_HEAD;
+    if (name == "POST") return HTTP_POST;
+    if (name == "PUT") return HTTP_PUT;
+    if (name == "PATCH") return HTTP_PATCH;
+    if (name == "DELETE") return HTTP_DELETE;
+    if (name == "OPTIONS") return HTTP_OPTIONS;
+    return HTTP_ANY;
+}
+
+void WebServer::on(const String& uri, HTTPMethod method, THandlerFunction handler) {
+    _routes.push_back({uri, method, handler});
+}
+
+void WebServer::close() {
+    _server.end();
+    _client = WiFiClient();
+    _status = HC_NONE;
+}
+
+void WebServer::handleClient() {
+    if (_status == HC_NONE) {
+        WiFiClient client = _server.available();
+        if (!client) {
+            return;
+        }
+        _client = client;
+        _status = HC_WAIT_READ;
+        _statusChange = millis();
+    }
+
+    bool keepClient = false;
+    if (_client.connected()) {
+        switch (_status) {
+        case HC_WAIT_READ:
+            if (_client.available()) {
+                if (parseRequest()) {
+                    _contentLength = CONTENT_LENGTH_NOT_SET;
+                    handleRequest();
+                    if (_client.connected()) {
+                        _status = HC_WAIT_CLOSE;
+                        _statusChange = millis();
+                        keepClient = true;
+                    }
+                }
+            } else if (millis() - _statusChange <= HTTP_MAX_DATA_WAIT) {
+                keepClient = true;
+            }
+            break;
+        case HC_WAIT_CLOSE:
+            // We said "Connection: close"; give the client a moment to go
+            if (millis() - _statusChange <= HTTP_MAX_CLOSE_WAIT) {
+                keepClient = true;
+            }
+            break;
+        case HC_NONE:
+            break;
+        }
+    }
+
+    if (!keepClient) {
+        _client = WiFiClient();
+        _status = HC_NONE;
+    }
+}
+
+bool WebServer::readLine(String& line, unsigned long deadline) {
+    line = "";
+    while (true) {
+        int c = _client.read();
+        if (c < 0) {
+            if (!_client.connected() || (long)(millis() - deadline) >= 0) {
+                return false;
+            }
+            delay(1);
+            continue;
+        }
+        if (c == '\n') {
+            if (line.endsWith("\r")) {
+                line.remove(line.length() - 1);
+            }
+            return true;
+        }
+        line += (char)c;
+    }
+}
+
+void WebServer::resetRequest() {
+    _uri = "";
+    _method = HTTP_GET;
+    _args.clear();
+    _headers.clear();
+    _hostHeader = "";
+    _responseHeaders = "";
+    _chunked = false;
+}
+
+bool WebServer::parseRequest() {
+    resetRequest();
+    unsigned long deadline = millis() + HTTP_MAX_DATA_WAIT;
+
+    String line;
+    if (!readLine(line, deadline)) {
+        return false;
+    }
+    // "GET /path?query HTTP/1.1"
+    int sp1 = line.indexOf(' ');
+    int sp2 = line.indexOf(' ', sp1 + 1);
+    if (sp1 < 0 || sp2 < 0) {
+        return false;
+    }
+    _method = parseMethod(line.substring(0, sp1));
+    String url = line.substring(sp1 + 1, sp2);
+    int q = url.indexOf('?');
+    _uri = urlDecode(q < 0 ? url : url.substring(0, q));
+    if (q >= 0) {
+        parseArgs(url.substring(q + 1));
+    }
+
+    size_t contentLength = 0;
+    String contentType;
+    while (readLine(line, deadline) && line.length()) {
+        int colon = line.indexOf(':');
+        if (colon <= 0) {
+            continue;
+        }
+        String name = line.substring(0, colon);
+        String value = line.substring(colon + 1);
+        value.trim();
+        if (name.equalsIgnoreCase("Host")) {
+            _hostHeader = value;
+        } else if (name.equalsIgnoreCase("Content-Length")) {
+            contentLength = value.toInt();
+        } else if (name.equalsIgnoreCase("Content-Type")) {
+            contentType = value;
+        }
+        for (const String& key : _collect) {
+            if (key.equalsIgnoreCase(name)) {
+                _headers.push_back({key, value});
+            }
+        }
+    }
+
+    if (contentLength) {
+        String body;
+        body.reserve(contentLength);
+        while (body.length() < contentLength) {
+            int c = _client.read();
+            if (c < 0) {
+                if (!_client.connected() || (long)(millis() - deadline) >= 0) {
+                    return false;
+                }
+                delay(1);
+                continue;
+            }
+            body += (char)c;
+        }
+        if (contentType.startsWith("application/x-www-form-urlencoded")) {
+            parseArgs(body);
+        }
+        _args.push_back({"plain", body});
+    }
+    return true;
+}
+
+void WebServer::parseArgs(const String& query) {
+    int start = 0;
+    while (start < (int)query.length()) {
+        int end = query.indexOf('&', start);
+        if (end < 0) {
+            end = query.length();
+        }
+        String pair = query.substring(start, end);
+        int eq = pair.indexOf('=');
+        if (pair.length()) {
+            if (eq < 0) {
+                _args.push_back({urlDecode(pair), ""});
+            } else {
+                _args.push_back({urlDecode(pair.substring(0, eq)), urlDecode(pair.substring(eq + 1))});
+            }
+        }
+        start = end + 1;
+    }
+}
+
+String WebServer::urlDecode(const String& text) {
+    String decoded;
+    decoded.reserve(text.length());
+    for (unsigned int i = 0; i < text.length(); i++) {
+        char c = text[i];
+        if (c == '+') {
+            decoded += ' ';
+        } else if (c == '%' && i + 2 < text.length()) {
+            char hex[3] = {text[i + 1], text[i + 2], 0};
+            decoded += (char)strtol(hex, nullptr, 16);
+            i += 2;
+        } else {
+            decoded += c;
+        }
+    }
+    return decoded;
+}
+
+void WebServer::handleRequest() {
+    for (const Route& r : _routes) {
+        if (r.uri == _uri && (r.method == HTTP_ANY || r.method == _method)) {
+            r.handler();
+            return;
+        }
+    }
+    if (_notFound) {
+        _notFound();
+    } else {
+        send(404, "text/plain", String("Not found: ") + _uri);
+    }
+}
+
+String WebServer::arg(const String& name) const {
+    for (const Pair& p : _args) {
+        if (p.key == name) {
+            return p.value;
+        }
+    }
+    return String();
+}
+
+String WebServer::arg(int i) const {
+    return i >= 0 && i < (int)_args.size() ? _args[i].value : String();
+}
+
+String WebServer::argName(int i) const {
+    return i >= 0 && i < (int)_args.size() ? _args[i].key : String();
+}
+
+bool WebServer::hasArg(const String& name) const {
+    for (const Pair& p : _args) {
+        if (p.key == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void WebServer::collectHeaders(const char* headerKeys[], size_t headerKeysCount) {
+    _collect.clear();
+    for (size_t i = 0; i < headerKeysCount; i++) {
+        _collect.push_back(headerKeys[i]);
+    }
+}
+
+String WebServer::header(const String& name) const {
+    for (const Pair& p : _headers) {
+        if (p.key.equalsIgnoreCase(name)) {
+            return p.value;
+        }
+    }
+    return String();
+}
+
+bool WebServer::hasHeader(const String& name) const {
+    for (const Pair& p : _headers) {
+        if (p.key.equalsIgnoreCase(name)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void WebServer::sendHeader(const String& name, const String& value, bool first) {
+    String line = name + ": " + value + "\r\n";
+    if (first) {
+        _responseHeaders = line + _responseHeaders;
+    } else {
+        _responseHeaders += line;
+    }
+}
+
+void WebServer::send(int code, const char* contentType, const String& content) {
+    String response = String("HTTP/1.1 ") + code + " " + reasonPhrase(code) + "\r\n";
+    sendHeader("Content-Type", contentType ? contentType : "text/html", true);
+    if (_contentLength == CONTENT_LENGTH_NOT_SET) {
+        sendHeader("Content-Length", String(content.length()));
+    } else if (_contentLength != CONTENT_LENGTH_UNKNOWN) {
+        sendHeader("Content-Length", String((unsigned long)_contentLength));
+    } else {
+        _chunked = true;
+        sendHeader("Accept-Ranges", "none");
+        sendHeader("Transfer-Encoding", "chunked");
+    }
+    sendHeader("Connection", "close");
+    response += _responseHeaders;
+    response += "\r\n";
+    _responseHeaders = "";
+
+    _client.write(response.c_str(), response.length());
+    if (content.length()) {
+        sendContent(content);
+    }
+}
+
+void WebServer::sendContent(const char* content, size_t size) {
+    if (_chunked) {
+        char header[12];
+        snprintf(header, sizeof(header), "%x\r\n", (unsigned)size);
+        _client.write(header, strlen(header));
+        if (size) {
+            _client.write(content, size);
+        }
+        _client.write("\r\n", 2);
+        if (size == 0) {
+            _chunked = false;
+        }
+        return;
+    }
+    _client.write(content, size);
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "WiFi.h"
+
+typedef enum {
+    HTTP_DELETE = 0,
+    HTTP_GET = 1,
+    HTTP_HEAD = 2,
+    HTTP_POST = 3,
+    HTTP_PUT = 4,
+    HTTP_OPTIONS = 6,
+    HTTP_PATCH = 28,
+    HTTP_ANY = 255
+} HTTPMethod;
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+#define CONTENT_LENGTH_NOT_SET ((size_t)-2)
+
+// Times from the core
+#define HTTP_MAX_DATA_WAIT 5000
+#define HTTP_MAX_CLOSE_WAIT 2000
+
+// The core's synchronous WebServer: handleClient() serves at most one
+// request, answers with "Connection: close", and waits (without blocking)
+// for the client to close before taking the next connection.
+class WebServer {
+public:
+    typedef std::function<void(void)> THandlerFunction;
+
+    explicit WebServer(int port = 80) : _server(port) {}
+
+    void begin() { _server.begin(); }
+    void begin(uint16_t port) { _server.begin(port); }
+    void handleClient();
+    void close();
+    void stop() { close(); }
+
+    void on(const String& uri, THandlerFunction handler) { on(uri, HTTP_ANY, handler); }
+    void on(const String& uri, HTTPMethod method, THandlerFunction handler);
+    void onNotFound(THandlerFunction fn) { _notFound = fn; }
+
+    String uri() const { return _uri; }
+    HTTPMethod method() const { return _method; }
+    WiFiClient client() { return _client; }
+
+    String arg(const String& name) const;
+    String arg(int i) const;
+    String argName(int i) const;
+    int args() const { return (int)_args.size(); }
+    bool hasArg(const String& name) const;
+
+    // Only the headers named here are kept (plus Host)
+    void collectHeaders(const char* headerKeys[], size_t headerKeysCount);
+    String header(const String& name) const;
+    bool hasHeader(const String& name) const;
+    String hostHeader() const { return _hostHeader; }
+
+    void sendHeader(const String& name, const String& value, bool first = false);
+    void setContentLength(size_t contentLength) { _contentLength = contentLength; }
+    void send(int code, const char* contentType = nullptr, const String& content = String(""));
+    void send(int code, const String& contentType, const String& content) {
+        send(code, contentType.c_str(), content);
+    }
+    void send_P(int code, PGM_P contentType, PGM_P content) { send(code, contentType, String(content)); }
+    void sendContent(const String& content) { sendContent(content.c_str(), content.length()); }
+    void sendContent(const char* content, size_t size);
+
+    static String urlDecode(const String& text);
+
+private:
+    struct Route {
+        String uri;
+        HTTPMethod method;
+        THandlerFunction handler;
+    };
+    struct Pair {
+        String key;
+        String value;
+    };
+
+    enum ClientStatus { HC_NONE, HC_WAIT_READ, HC_WAIT_CLOSE };
+
+    bool parseRequest();
+    bool readLine(String& line, unsigned long deadline);
+    void parseArgs(const String& query);
+    void handleRequest();
+    void resetRequest();
+
+    WiFiServer _server;
+    WiFiClient _client;
+    ClientStatus _status = HC_NONE;
+    unsigned long _statusChange = 0;
+
+    std::vector<Route> _routes;
+    THandlerFunction _notFound;
+
+    String _uri;
+    HTTPMethod _method = HTTP_GET;
+    std::vector<Pair> _args;
+    std::vector<String> _collect;
+    std::vector<Pair> _headers;
+    String _hostHeader;
+
+    String _responseHeaders;
+    size_t _contentLength = CONTENT_LENGTH_NOT_SET;
+    bool _chunked = false;
+};
@@ -0,0 +1,501 @@
+#include "WiFi.h"
+
+#include <arpa/inet.h>
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <netinet/in.h>
+
+#include "HostHAL.h"
+
+WiFiClass WiFi;
+
+struct PostedEvent {
+    arduino_event_id_t id;
+    arduino_event_info_t info;
+};
+
+// Recorded from a scan in an apartment block; hidden networks have no SSID
+static const struct {
+    const char* ssid;
+    const char* bssid;
+    int32_t rssi;
+    int32_t channel;
+    wifi_auth_mode_t auth;
+} DEFAULT_SCAN[] = {
+    {"HomeNet", "A4:2B:B0:11:22:01", -42, 1, WIFI_AUTH_WPA2_PSK},
+    {"HomeNet_Guest", "A4:2B:B0:11:22:02", -44, 1, WIFI_AUTH_OPEN},
+    {"TP-Link_5C3A", "50:C7:BF:5C:3A:10", -58, 6, WIFI_AUTH_WPA_WPA2_PSK},
+    {"FRITZ!Box 7530", "3C:A6:2F:8E:01:99", -61, 11, WIFI_AUTH_WPA2_PSK},
+    {"", "3C:A6:2F:8E:01:9A", -62, 11, WIFI_AUTH_WPA2_PSK},
+    {"Vodafone-A8F2", "9C:C7:A6:A8:F2:00", -65, 1, WIFI_AUTH_WPA2_PSK},
+    {"DIRECT-7B-HP OfficeJet", "FA:B4:6A:7B:00:01", -67, 6, WIFI_AUTH_WPA2_PSK},
+    {"eduroam", "00:1A:1E:40:22:31", -70, 13, WIFI_AUTH_WPA2_ENTERPRISE},
+    {"linksys", "20:AA:4B:01:02:03", -72, 6, WIFI_AUTH_WEP},
+    {"NETGEAR42", "C0:FF:D4:42:42:42", -73, 3, WIFI_AUTH_WPA2_PSK},
+    {"Pixel_7894", "6E:1D:3B:78:94:00", -75, 9, WIFI_AUTH_WPA2_PSK},
+    {"", "B0:BE:76:00:10:20", -77, 4, WIFI_AUTH_WPA2_PSK},
+    {"Telekom_FON", "34:31:C4:F0:0F:01", -79, 1, WIFI_AUTH_OPEN},
+    {"MagentaWLAN-X2Q", "34:31:C4:F0:0F:00", -79, 1, WIFI_AUTH_WPA_WPA2_PSK},
+    {"UPC1234567", "64:7C:34:12:34:56", -81, 11, WIFI_AUTH_WPA2_PSK},
+    {"iPhone von Anna", "82:2D:9A:01:AB:CD", -83, 6, WIFI_AUTH_WPA2_PSK},
+    {"ESP_3A0F11", "24:6F:28:3A:0F:11", -85, 1, WIFI_AUTH_OPEN},
+    {"Chromecast4821", "FA:8F:CA:48:21:00", -86, 6, WIFI_AUTH_OPEN},
+    {"SKYNET", "00:24:01:AA:BB:CC", -88, 13, WIFI_AUTH_WPA_PSK},
+    {"WLAN-Kabel", "CC:CE:1E:77:88:99", -90, 5, WIFI_AUTH_WPA2_PSK},
+};
+
+static bool parseMac(const char* text, uint8_t* mac) {
+    unsigned int b[6];
+    if (sscanf(text, "%x:%x:%x:%x:%x:%x", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5]) != 6) {
+        return false;
+    }
+    for (int i = 0; i < 6; i++) {
+        mac[i] = (uint8_t)b[i];
+    }
+    return true;
+}
+
+static String macToString(const uint8_t* mac) {
+    char buf[18];
+    snprintf(buf, sizeof(buf), "%02X:%02X:%02X:%02X:%02X:%02X", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+    return String(buf);
+}
+
+// First interface that is up and not loopback
+static bool hostInterface(char* name, size_t nameSize, sockaddr_in* addr, sockaddr_in* mask) {
+    ifaddrs* list = nullptr;
+    if (getifaddrs(&list) != 0) {
+        return false;
+    }
+    bool found = false;
+    for (ifaddrs* i = list; i && !found; i = i->ifa_next) {
+        if (!i->ifa_addr || i->ifa_addr->sa_family != AF_INET || !(i->ifa_flags & IFF_UP) ||
+            (i->ifa_flags & IFF_LOOPBACK)) {
+            continue;
+        }
+        strlcpy(name, i->ifa_name, nameSize);
+        if (addr) {
+            *addr = *(sockaddr_in*)i->ifa_addr;
+        }
+        if (mask && i->ifa_netmask) {
+            *mask = *(sockaddr_in*)i->ifa_netmask;
+        }
+        found = true;
+    }
+    freeifaddrs(list);
+    return found;
+}
+
+static IPAddress hostAddress() {
+    char name[IFNAMSIZ];
+    sockaddr_in addr;
+    if (!hostInterface(name, sizeof(name), &addr, nullptr)) {
+        return IPAddress(127, 0, 0, 1);
+    }
+    return IPAddress((uint32_t)addr.sin_addr.s_addr);
+}
+
+bool WiFiClass::mode(wifi_mode_t mode) {
+    wifi_mode_t old = _mode;
+    _mode = mode;
+    bool staWas = old == WIFI_MODE_STA || old == WIFI_MODE_APSTA;
+    bool staNow = mode == WIFI_MODE_STA || mode == WIFI_MODE_APSTA;
+    bool apWas = old == WIFI_MODE_AP || old == WIFI_MODE_APSTA;
+    bool apNow = mode == WIFI_MODE_AP || mode == WIFI_MODE_APSTA;
+    if (old == WIFI_MODE_NULL && mode != WIFI_MODE_NULL) {
+        postEvent(ARDUINO_EVENT_WIFI_READY);
+    }
+    if (staNow != staWas) {
+        postEvent(staNow ? ARDUINO_EVENT_WIFI_STA_START : ARDUINO_EVENT_WIFI_STA_STOP);
+    }
+    if (apNow != apWas) {
+        postEvent(apNow ? ARDUINO_EVENT_WIFI_AP_START : ARDUINO_EVENT_WIFI_AP_STOP);
+    }
+    return true;
+}
+
+bool WiFiClass::enableSTA(bool enable) {
+    bool ap = _mode == WIFI_MODE_AP || _mode == WIFI_MODE_APSTA;
+    return mode(enable ? (ap ? WIFI_MODE_APSTA : WIFI_MODE_STA) : (ap ? WIFI_MODE_AP : WIFI_MODE_NULL));
+}
+
+bool WiFiClass::enableAP(bool enable) {
+    bool sta = _mode == WIFI_MODE_STA || _mode == WIFI_MODE_APSTA;
+    return mode(enable ? (sta ? WIFI_MODE_APSTA : WIFI_MODE_AP) : (sta ? WIFI_MODE_STA : WIFI_MODE_NULL));
+}
+
+bool WiFiClass::setHostname(const char* hostname) {
+    _hostname = hostname;
+    return true;
+}
+
+void WiFiClass::startEventTask() {
+    if (_events) {
+        return;
+    }
+    _events = xQueueCreate(32, sizeof(PostedEvent));
+    xTaskCreatePinnedToCore(eventTask, "arduino_events", 4096, this, 19, nullptr, 1);
+}
+
+void WiFiClass::postEvent(arduino_event_id_t event, const arduino_event_info_t* info) {
+    startEventTask();
+    PostedEvent posted;
+    memset(&posted, 0, sizeof(posted));
+    posted.id = event;
+    if (info) {
+        posted.info = *info;
+    }
+    xQueueSend(_events, &posted, portMAX_DELAY);
+}
+
+void WiFiClass::eventTask(void* arg) {
+    WiFiClass* self = (WiFiClass*)arg;
+    PostedEvent posted;
+    while (xQueueReceive(self->_events, &posted, portMAX_DELAY)) {
+        // The status follows the events before any handler sees them
+        switch (posted.id) {
+        case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+            self->_status = WL_CONNECTED;
+            break;
+        case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+        case ARDUINO_EVENT_WIFI_STA_STOP:
+            self->_status = WL_DISCONNECTED;
+            break;
+        case ARDUINO_EVENT_WIFI_STA_LOST_IP:
+            self->_status = WL_CONNECTION_LOST;
+            break;
+        default:
+            break;
+        }
+
+        std::vector<Handler> handlers;
+        {
+            std::lock_guard<std::mutex> lock(self->_handlersLock);
+            handlers = self->_handlers;
+        }
+        for (const Handler& h : handlers) {
+            if (h.event != ARDUINO_EVENT_MAX && h.event != posted.id) {
+                continue;
+            }
+            if (h.cb) {
+                h.cb(posted.id);
+            } else if (h.funcCb) {
+                h.funcCb(posted.id, posted.info);
+            }
+        }
+    }
+}
+
+wifi_event_id_t WiFiClass::onEvent(WiFiEventCb cb, arduino_event_id_t event) {
+    std::lock_guard<std::mutex> lock(_handlersLock);
+    _handlers.push_back({_nextHandlerId, event, cb, nullptr});
+    return _nextHandlerId++;
+}
+
+wifi_event_id_t WiFiClass::onEvent(WiFiEventFuncCb cb, arduino_event_id_t event) {
+    std::lock_guard<std::mutex> lock(_handlersLock);
+    _handlers.push_back({_nextHandlerId, event, nullptr, cb});
+    return _nextHandlerId++;
+}
+
+void WiFiClass::removeEvent(wifi_event_id_t id) {
+    std::lock_guard<std::mutex> lock(_handlersLock);
+    for (size_t i = 0; i < _handlers.size(); i++) {
+        if (_handlers[i].id == id) {
+            _handlers.erase(_handlers.begin() + i);
+            return;
+        }
+    }
+}
+
+const char* WiFiClass::eventName(arduino_event_id_t id) {
+    static const char* const NAMES[] = {
+        "WIFI_READY",       "SCAN_DONE",       "STA_START",       "STA_STOP",           "STA_CONNECTED",
+        "STA_DISCONNECTED", "STA_AUTHMODE_CHANGE", "STA_GOT_IP",  "STA_GOT_IP6",        "STA_LOST_IP",
+        "AP_START",         "AP_STOP",         "AP_STACONNECTED", "AP_STADISCONNECTED", "AP_STAIPASSIGNED",
+        "AP_PROBEREQRECVED", "AP_GOT_IP6",
+    };
+    return (unsigned)id < sizeof(NAMES) / sizeof(NAMES[0]) ? NAMES[id] : "UNKNOWN";
+}
+
+wl_status_t WiFiClass::begin(const char* ssid, const char* passphrase, int32_t channel, const uint8_t* bssid,
+                             bool connect) {
+    (void)passphrase;
+    if (_mode != WIFI_MODE_STA && _mode != WIFI_MODE_APSTA) {
+        enableSTA(true);
+    }
+    _staSsid = ssid ? ssid : "";
+    _staChannel = channel ? channel : 6;
+    if (bssid) {
+        memcpy(_staBssid, bssid, sizeof(_staBssid));
+    }
+    _status = WL_DISCONNECTED;
+    uint32_t generation = ++_connectGeneration;
+    if (connect) {
+        xTaskCreatePinnedToCore(connectTask, "wifi", 2048, (void*)(uintptr_t)generation, 23, nullptr, 0);
+    }
+    return _status;
+}
+
+void WiFiClass::connectTask(void* arg) {
+    uint32_t generation = (uint32_t)(uintptr_t)arg;
+    delay(HostHAL::envLong("HOST_CONNECT_MS", 200));
+    // A disconnect() or a newer begin() in the meantime wins
+    if (generation == WiFi._connectGeneration) {
+        arduino_event_info_t info;
+        memset(&info, 0, sizeof(info));
+        size_t len = WiFi._staSsid.length() < 32 ? WiFi._staSsid.length() : 32;
+        memcpy(info.wifi_sta_connected.ssid, WiFi._staSsid.c_str(), len);
+        info.wifi_sta_connected.ssid_len = (uint8_t)len;
+        memcpy(info.wifi_sta_connected.bssid, WiFi._staBssid, 6);
+        info.wifi_sta_connected.channel = (uint8_t)WiFi._staChannel;
+        WiFi.postEvent(ARDUINO_EVENT_WIFI_STA_CONNECTED, &info);
+
+        memset(&info, 0, sizeof(info));
+        info.got_ip.ip_info.ip.addr = (uint32_t)hostAddress();
+        info.got_ip.ip_info.netmask.addr = (uint32_t)WiFi.subnetMask();
+        info.got_ip.ip_changed = true;
+        WiFi.postEvent(ARDUINO_EVENT_WIFI_STA_GOT_IP, &info);
+    }
+    vTaskDelete(NULL);
+}
+
+bool WiFiClass::disconnect(bool wifiOff, bool eraseAp) {
+    (void)eraseAp;
+    ++_connectGeneration;
+    if (_status == WL_CONNECTED) {
+        arduino_event_info_t info;
+        memset(&info, 0, sizeof(info));
+        // WIFI_REASON_ASSOC_LEAVE
+        info.wifi_sta_disconnected.reason = 8;
+        postEvent(ARDUINO_EVENT_WIFI_STA_DISCONNECTED, &info);
+    }
+    if (wifiOff) {
+        enableSTA(false);
+    }
+    return true;
+}
+
+bool WiFiClass::reconnect() {
+    if (_staSsid.length() == 0 && _status == WL_IDLE_STATUS) {
+        return false;
+    }
+    disconnect();
+    begin(_staSsid.c_str(), nullptr, _staChannel, _staBssid);
+    return true;
+}
+
+IPAddress WiFiClass::localIP() const {
+    return _status == WL_CONNECTED ? hostAddress() : IPAddress();
+}
+
+IPAddress WiFiClass::subnetMask() const {
+    char name[IFNAMSIZ];
+    sockaddr_in mask = {};
+    if (!hostInterface(name, sizeof(name), nullptr, &mask)) {
+        return IPAddress(255, 0, 0, 0);
+    }
+    return IPAddress((uint32_t)mask.sin_addr.s_addr);
+}
+
+IPAddress WiFiClass::gatewayIP() const {
+    // Not worth parsing the routing table; the usual .1 of the subnet
+    IPAddress ip = hostAddress();
+    IPAddress mask = subnetMask();
+    IPAddress gw((uint32_t)ip & (uint32_t)mask);
+    gw[3] |= 1;
+    return gw;
+}
+
+uint8_t* WiFiClass::BSSID() {
+    return _status == WL_CONNECTED ? _staBssid : nullptr;
+}
+
+String WiFiClass::BSSIDstr() {
+    return macToString(_staBssid);
+}
+
+uint8_t* WiFiClass::macAddress(uint8_t* mac) {
+    // The host interface's address, so every machine gets its own hostname
+    static const uint8_t FALLBACK[6] = {0x24, 0x6f, 0x28, 0x12, 0x34, 0x56};
+    memcpy(mac, FALLBACK, 6);
+    char name[IFNAMSIZ];
+    if (hostInterface(name, sizeof(name), nullptr, nullptr)) {
+        char path[64];
+        snprintf(path, sizeof(path), "/sys/class/net/%s/address", name);
+        FILE* f = fopen(path, "r");
+        if (f) {
+            char line[32];
+            if (fgets(line, sizeof(line), f)) {
+                parseMac(line, mac);
+            }
+            fclose(f);
+        }
+    }
+    return mac;
+}
+
+String WiFiClass::macAddress() {
+    uint8_t mac[6];
+    return macToString(macAddress(mac));
+}
+
+bool WiFiClass::softAP(const char* ssid, const char* passphrase, int channel, int ssidHidden,
+                       int maxConnection) {
+    (void)passphrase;
+    (void)channel;
+    (void)ssidHidden;
+    (void)maxConnection;
+    if (!ssid || !*ssid) {
+        return false;
+    }
+    _apSsid = ssid;
+    if (_mode != WIFI_MODE_AP && _mode != WIFI_MODE_APSTA) {
+        enableAP(true);
+    }
+    return true;
+}
+
+bool WiFiClass::softAPConfig(IPAddress localIp, IPAddress gateway, IPAddress subnet) {
+    (void)gateway;
+    _apIp = localIp;
+    _apMask = subnet;
+    return true;
+}
+
+bool WiFiClass::softAPdisconnect(bool wifiOff) {
+    _apSsid = "";
+    if (wifiOff) {
+        enableAP(false);
+    }
+    return true;
+}
+
+// Loads HOST_SCAN_FIXTURE (ssid,bssid,rssi,channel,auth per line, auth as a
+// wifi_auth_mode_t number; '#' starts a comment) or the built-in scan
+static std::vector<WiFiClass::ScanResult> loadScanFixture() {
+    std::vector<WiFiClass::ScanResult> results;
+    const char* path = getenv("HOST_SCAN_FIXTURE");
+    FILE* f = path && *path ? fopen(path, "r") : nullptr;
+    if (!f) {
+        if (path && *path) {
+            Serial.printf("WiFi: cannot read %s, using the built-in scan\n", path);
+        }
+        for (const auto& ap : DEFAULT_SCAN) {
+            WiFiClass::ScanResult r;
+            r.ssid = ap.ssid;
+            parseMac(ap.bssid, r.bssid);
+            r.rssi = ap.rssi;
+            r.channel = ap.channel;
+            r.auth = ap.auth;
+            results.push_back(r);
+        }
+        return results;
+    }
+
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        if (line[0] == '#' || line[0] == '\n') {
+            continue;
+        }
+        char* comma = strchr(line, ',');
+        if (!comma) {
+            continue;
+        }
+        *comma = '\0';
+        WiFiClass::ScanResult r;
+        r.ssid = line;
+        char bssid[18];
+        int rssi, channel, auth;
+        if (sscanf(comma + 1, "%17[^,],%d,%d,%d", bssid, &rssi, &channel, &auth) != 4 ||
+            !parseMac(bssid, r.bssid)) {
+            continue;
+        }
+        r.rssi = rssi;
+        r.channel = channel;
+        r.auth = (wifi_auth_mode_t)auth;
+        results.push_back(r);
+    }
+    fclose(f);
+    return results;
+}
+
+void WiFiClass::runScan() {
+    static const std::vector<ScanResult> fixture = loadScanFixture();
+    delay(HostHAL::envLong("HOST_SCAN_MS", 0));
+    std::vector<ScanResult> results;
+    for (ScanResult r : fixture) {
+        if (!_showHidden && r.ssid.isEmpty()) {
+            continue;
+        }
+        // Signals wander by a couple of dB between scans
+        r.rssi += random(-2, 3);
+        results.push_back(r);
+    }
+    _scan = results;
+    _scanState = (int16_t)_scan.size();
+    postEvent(ARDUINO_EVENT_WIFI_SCAN_DONE);
+}
+
+void WiFiClass::scanTask(void* arg) {
+    ((WiFiClass*)arg)->runScan();
+    vTaskDelete(NULL);
+}
+
+int16_t WiFiClass::scanNetworks(bool async, bool showHidden, bool passive, uint32_t maxMsPerChan,
+                                uint8_t channel) {
+    (void)passive;
+    (void)maxMsPerChan;
+    (void)channel;
+    if (_scanState == WIFI_SCAN_RUNNING) {
+        return WIFI_SCAN_RUNNING;
+    }
+    if (_mode == WIFI_MODE_NULL) {
+        enableSTA(true);
+    }
+    scanDelete();
+    _showHidden = showHidden;
+    _scanState = WIFI_SCAN_RUNNING;
+    if (async) {
+        xTaskCreatePinnedToCore(scanTask, "wifi_scan", 2048, this, 23, nullptr, 0);
+        return WIFI_SCAN_RUNNING;
+    }
+    runScan();
+    return _scanState;
+}
+
+int16_t WiFiClass::scanComplete() {
+    return _scanState;
+}
+
+void WiFiClass::scanDelete() {
+    if (_scanState == WIFI_SCAN_RUNNING) {
+        return;
+    }
+    _scan.clear();
+    _scanState = WIFI_SCAN_FAILED;
+}
+
+String WiFiClass::SSID(uint8_t i) const {
+    return i < _scan.size() ? _scan[i].ssid : String();
+}
+
+wifi_auth_mode_t WiFiClass::encryptionType(uint8_t i) const {
+    return i < _scan.size() ? _scan[i].auth : WIFI_AUTH_OPEN;
+}
+
+int32_t WiFiClass::RSSI(uint8_t i) const {
+    return i < _scan.size() ? _scan[i].rssi : 0;
+}
+
+uint8_t* WiFiClass::BSSID(uint8_t i) {
+    return i < _scan.size() ? _scan[i].bssid : nullptr;
+}
+
+String WiFiClass::BSSIDstr(uint8_t i) const {
+    return i < _scan.size() ? macToString(_scan[i].bssid) : String();
+}
+
+int32_t WiFiClass::channel(uint8_t i) const {
+    return i < _scan.size() ? _scan[i].channel : 0;
+}
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "Arduino.h"
+#include "WiFiClient.h"
+#include "WiFiServer.h"
+#include "WiFiUdp.h"
+
+typedef enum {
+    WIFI_MODE_NULL = 0,
+    WIFI_MODE_STA,
+    WIFI_MODE_AP,
+    WIFI_MODE_APSTA,
+    WIFI_MODE_MAX
+} wifi_mode_t;
+
+#define WIFI_OFF WIFI_MODE_NULL
+#define WIFI_STA WIFI_MODE_STA
+#define WIFI_AP WIFI_MODE_AP
+#define WIFI_AP_STA WIFI_MODE_APSTA
+
+typedef enum {
+    WL_NO_SHIELD = 255,
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_SCAN_COMPLETED = 2,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum {
+    WIFI_AUTH_OPEN = 0,
+    WIFI_AUTH_WEP,
+    WIFI_AUTH_WPA_PSK,
+    WIFI_AUTH_WPA2_PSK,
+    WIFI_AUTH_WPA_WPA2_PSK,
+    WIFI_AUTH_WPA2_ENTERPRISE,
+    WIFI_AUTH_WPA3_PSK,
+    WIFI_AUTH_WPA2_WPA3_PSK,
+    WIFI_AUTH_WAPI_PSK,
+    WIFI_AUTH_MAX
+} wifi_auth_mode_t;
+
+#define WIFI_SCAN_RUNNING (-1)
+#define WIFI_SCAN_FAILED (-2)
+
+typedef enum {
+    ARDUINO_EVENT_WIFI_READY = 0,
+    ARDUINO_EVENT_WIFI_SCAN_DONE,
+    ARDUINO_EVENT_WIFI_STA_START,
+    ARDUINO_EVENT_WIFI_STA_STOP,
+    ARDUINO_EVENT_WIFI_STA_CONNECTED,
+    ARDUINO_EVENT_WIFI_STA_DISCONNECTED,
+    ARDUINO_EVENT_WIFI_STA_AUTHMODE_CHANGE,
+    ARDUINO_EVENT_WIFI_STA_GOT_IP,
+    ARDUINO_EVENT_WIFI_STA_GOT_IP6,
+    ARDUINO_EVENT_WIFI_STA_LOST_IP,
+    ARDUINO_EVENT_WIFI_AP_START,
+    ARDUINO_EVENT_WIFI_AP_STOP,
+    ARDUINO_EVENT_WIFI_AP_STACONNECTED,
+    ARDUINO_EVENT_WIFI_AP_STADISCONNECTED,
+    ARDUINO_EVENT_WIFI_AP_STAIPASSIGNED,
+    ARDUINO_EVENT_WIFI_AP_PROBEREQRECVED,
+    ARDUINO_EVENT_WIFI_AP_GOT_IP6,
+    ARDUINO_EVENT_MAX
+} arduino_event_id_t;
+
+// The parts of the core's event payload the HAL fills in
+typedef union {
+    struct {
+        uint8_t ssid[33];
+        uint8_t ssid_len;
+        uint8_t bssid[6];
+        uint8_t reason;
+    } wifi_sta_disconnected;
+    struct {
+        uint8_t ssid[33];
+        uint8_t ssid_len;
+        uint8_t bssid[6];
+        uint8_t channel;
+    } wifi_sta_connected;
+    struct {
+        struct {
+            struct {
+                uint32_t addr;
+            } ip, netmask, gw;
+        } ip_info;
+        bool ip_changed;
+    } got_ip;
+} arduino_event_info_t;
+
+typedef int wifi_event_id_t;
+typedef void (*WiFiEventCb)(arduino_event_id_t event);
+typedef std::function<void(arduino_event_id_t event, arduino_event_info_t info)> WiFiEventFuncCb;
+
+// The WiFi object. The host is always on a network, so the station side
+// "connects" to whatever SSID it is given: begin() runs through the same
+// events as on the device (STA_START, STA_CONNECTED, STA_GOT_IP) from the
+// "arduino_events" task, and localIP() is the host's address. The soft AP
+// only keeps its settings; clients reach the servers through the host's
+// interfaces. Scans return recorded results (HOST_SCAN_FIXTURE, or a
+// built-in apartment-block scan) with a little RSSI jitter per scan.
+class WiFiClass {
+public:
+    bool mode(wifi_mode_t mode);
+    wifi_mode_t getMode() const { return _mode; }
+    bool enableSTA(bool enable);
+    bool enableAP(bool enable);
+    void persistent(bool persistent) { (void)persistent; }
+    bool setAutoReconnect(bool autoReconnect) {
+        (void)autoReconnect;
+        return true;
+    }
+    bool setSleep(bool enabled) {
+        (void)enabled;
+        return true;
+    }
+    bool setHostname(const char* hostname);
+    const char* getHostname() const { return _hostname.c_str(); }
+
+    wifi_event_id_t onEvent(WiFiEventCb cb, arduino_event_id_t event = ARDUINO_EVENT_MAX);
+    wifi_event_id_t onEvent(WiFiEventFuncCb cb, arduino_event_id_t event = ARDUINO_EVENT_MAX);
+    void removeEvent(wifi_event_id_t id);
+    static const char* eventName(arduino_event_id_t id);
+
+    // Station
+    wl_status_t begin(const char* ssid, const char* passphrase = nullptr, int32_t channel = 0,
+                      const uint8_t* bssid = nullptr, bool connect = true);
+    wl_status_t begin(const String& ssid, const String& passphrase = String(), int32_t channel = 0,
+                      const uint8_t* bssid = nullptr, bool connect = true) {
+        return begin(ssid.c_str(), passphrase.c_str(), channel, bssid, connect);
+    }
+    bool disconnect(bool wifiOff = false, bool eraseAp = false);
+    bool reconnect();
+    wl_status_t status() const { return _status; }
+    bool isConnected() const { return _status == WL_CONNECTED; }
+    IPAddress localIP() const;
+    IPAddress subnetMask() const;
+    IPAddress gatewayIP() const;
+    String SSID() const { return _staSsid; }
+    uint8_t* BSSID();
+    String BSSIDstr();
+    int32_t channel() const { return _staChannel; }
+    int8_t RSSI() const { return _status == WL_CONNECTED ? -55 : 0; }
+    uint8_t* macAddress(uint8_t* mac);
+    String macAddress();
+
+    // Soft AP
+    bool softAP(const char* ssid, const char* passphrase = nullptr, int channel = 1, int ssidHidden = 0,
+                int maxConnection = 4);
+    bool softAPConfig(IPAddress localIp, IPAddress gateway, IPAddress subnet);
+    bool softAPdisconnect(bool wifiOff = false);
+    IPAddress softAPIP() const { return _apIp; }
+    uint8_t softAPgetStationNum() const { return 0; }
+    String softAPSSID() const { return _apSsid; }
+
+    // Scan; max_ms_per_chan is accepted, HOST_SCAN_MS sets the duration
+    int16_t scanNetworks(bool async = false, bool showHidden = false, bool passive = false,
+                         uint32_t maxMsPerChan = 300, uint8_t channel = 0);
+    int16_t scanComplete();
+    void scanDelete();
+    String SSID(uint8_t i) const;
+    wifi_auth_mode_t encryptionType(uint8_t i) const;
+    int32_t RSSI(uint8_t i) const;
+    uint8_t* BSSID(uint8_t i);
+    String BSSIDstr(uint8_t i) const;
+    int32_t channel(uint8_t i) const;
+
+    // Posts an event to the event task, like the WiFi driver does
+    void postEvent(arduino_event_id_t event, const arduino_event_info_t* info = nullptr);
+
+    struct ScanResult {
+        String ssid;
+        uint8_t bssid[6];
+        int32_t rssi;
+        int32_t channel;
+        wifi_auth_mode_t auth;
+    };
+
+private:
+    struct Handler {
+        wifi_event_id_t id;
+        arduino_event_id_t event;
+        WiFiEventCb cb;
+        WiFiEventFuncCb funcCb;
+    };
+
+    void startEventTask();
+    static void eventTask(void* arg);
+    static void connectTask(void* arg);
+    static void scanTask(void* arg);
+    void runScan();
+
+    wifi_mode_t _mode = WIFI_MODE_NULL;
+    wl_status_t _status = WL_IDLE_STATUS;
+    String _hostname = "esp32-host";
+    String _staSsid;
+    int32_t _staChannel = 0;
+    uint8_t _staBssid[6] = {0x24, 0x6f, 0x28, 0x00, 0x00, 0x01};
+    uint32_t _connectGeneration = 0;
+
+    String _apSsid;
+    IPAddress _apIp = IPAddress(192, 168, 4, 1);
+    IPAddress _apMask = IPAddress(255, 255, 255, 0);
+
+    std::mutex _handlersLock;
+    std::vector<Handler> _handlers;
+    wifi_event_id_t _nextHandlerId = 1;
+    QueueHandle_t _events = nullptr;
+
+    std::vector<ScanResult> _scan;
+    volatile int16_t _scanState = WIFI_SCAN_FAILED;
+    bool _showHidden = false;
+};
+
+extern WiFiClass WiFi;
@@ -0,0 +1,261 @@
+#include "WiFiClient.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "HostSocket.h"
+
+ssize_t HostSocket::recv(uint8_t* buf, size_t len) {
+    return ::recv(fd, buf, len, 0);
+}
+
+ssize_t HostSocket::send(const uint8_t* buf, size_t len) {
+    return ::send(fd, buf, len, MSG_NOSIGNAL);
+}
+
+void HostSocket::close() {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+bool HostSocket::waitReadable(int timeoutMs) {
+    if (fd < 0) {
+        return false;
+    }
+    if (pending()) {
+        return true;
+    }
+    pollfd p = {fd, POLLIN, 0};
+    return poll(&p, 1, timeoutMs) > 0;
+}
+
+static void setTimeouts(int fd, uint32_t seconds) {
+    timeval tv = {(time_t)seconds, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+}
+
+int hostConnect(const char* host, uint16_t port, int timeoutMs) {
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* res = nullptr;
+    char service[8];
+    snprintf(service, sizeof(service), "%u", port);
+    if (getaddrinfo(host, service, &hints, &res) != 0 || !res) {
+        return -1;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        freeaddrinfo(res);
+        return -1;
+    }
+    // Non-blocking connect, so the timeout applies like on the device
+    int flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    int rc = ::connect(fd, res->ai_addr, res->ai_addrlen);
+    freeaddrinfo(res);
+    if (rc < 0 && errno == EINPROGRESS) {
+        pollfd p = {fd, POLLOUT, 0};
+        int err = 0;
+        socklen_t len = sizeof(err);
+        if (poll(&p, 1, timeoutMs) == 1 && getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) == 0 && err == 0) {
+            rc = 0;
+        }
+    }
+    if (rc < 0) {
+        ::close(fd);
+        return -1;
+    }
+    fcntl(fd, F_SETFL, flags);
+    return fd;
+}
+
+WiFiClient::WiFiClient(int fd) : _socket(std::make_shared<HostSocket>(fd)) {
+    setTimeouts(fd, _timeoutSeconds);
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port, int32_t timeoutMs) {
+    return connect(ip.toString().c_str(), port, timeoutMs);
+}
+
+int WiFiClient::connect(const char* host, uint16_t port, int32_t timeoutMs) {
+    stop();
+    int fd = hostConnect(host, port, timeoutMs);
+    if (fd < 0) {
+        return 0;
+    }
+    _socket = std::make_shared<HostSocket>(fd);
+    setTimeouts(fd, _timeoutSeconds);
+    return 1;
+}
+
+size_t WiFiClient::write(const uint8_t* buf, size_t size) {
+    if (!_socket || _socket->fd < 0) {
+        return 0;
+    }
+    size_t sent = 0;
+    while (sent < size) {
+        ssize_t n = _socket->send(buf + sent, size - sent);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            // Timed out or reset: the connection is unusable, as in the core
+            _socket->close();
+            break;
+        }
+        sent += n;
+    }
+    return sent;
+}
+
+bool WiFiClient::fill(int timeoutMs) {
+    if (!_socket || _socket->fd < 0) {
+        return false;
+    }
+    HostSocket& s = *_socket;
+    if (s.rxPos < s.rxLen) {
+        return true;
+    }
+    if (!s.waitReadable(timeoutMs)) {
+        return false;
+    }
+    ssize_t n = s.recv(s.rx, sizeof(s.rx));
+    if (n <= 0) {
+        if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            // Peer closed or reset
+            s.close();
+        }
+        return false;
+    }
+    s.rxPos = 0;
+    s.rxLen = n;
+    return true;
+}
+
+int WiFiClient::available() {
+    if (!fill(0)) {
+        return 0;
+    }
+    return (int)(_socket->rxLen - _socket->rxPos + _socket->pending());
+}
+
+int WiFiClient::read() {
+    if (!fill(0)) {
+        return -1;
+    }
+    return _socket->rx[_socket->rxPos++];
+}
+
+int WiFiClient::read(uint8_t* buf, size_t size) {
+    if (!fill(0)) {
+        return -1;
+    }
+    HostSocket& s = *_socket;
+    size_t n = s.rxLen - s.rxPos;
+    if (n > size) {
+        n = size;
+    }
+    memcpy(buf, s.rx + s.rxPos, n);
+    s.rxPos += n;
+    return (int)n;
+}
+
+int WiFiClient::peek() {
+    if (!fill(0)) {
+        return -1;
+    }
+    return _socket->rx[_socket->rxPos];
+}
+
+void WiFiClient::stop() {
+    if (_socket) {
+        _socket->close();
+        _socket.reset();
+    }
+}
+
+uint8_t WiFiClient::connected() {
+    if (!_socket || _socket->fd < 0) {
+        return 0;
+    }
+    if (_socket->rxPos < _socket->rxLen || _socket->pending()) {
+        return 1;
+    }
+    // Readable with nothing to read means the peer has closed
+    pollfd p = {_socket->fd, POLLIN, 0};
+    if (poll(&p, 1, 0) > 0) {
+        uint8_t c;
+        ssize_t n = ::recv(_socket->fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+            _socket->close();
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int WiFiClient::setTimeout(uint32_t seconds) {
+    Stream::setTimeout(seconds * 1000);
+    _timeoutSeconds = seconds;
+    if (_socket && _socket->fd >= 0) {
+        setTimeouts(_socket->fd, seconds);
+    }
+    return 0;
+}
+
+int WiFiClient::setNoDelay(bool nodelay) {
+    int flag = nodelay;
+    return _socket ? setsockopt(_socket->fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag)) : -1;
+}
+
+int WiFiClient::fd() const {
+    return _socket ? _socket->fd : -1;
+}
+
+static IPAddress addressOf(int fd, bool peer, uint16_t* port) {
+    sockaddr_in addr = {};
+    socklen_t len = sizeof(addr);
+    int rc = peer ? getpeername(fd, (sockaddr*)&addr, &len) : getsockname(fd, (sockaddr*)&addr, &len);
+    if (fd < 0 || rc != 0) {
+        if (port) {
+            *port = 0;
+        }
+        return IPAddress();
+    }
+    if (port) {
+        *port = ntohs(addr.sin_port);
+    }
+    return IPAddress((uint32_t)addr.sin_addr.s_addr);
+}
+
+IPAddress WiFiClient::remoteIP() const {
+    return addressOf(fd(), true, nullptr);
+}
+
+uint16_t WiFiClient::remotePort() const {
+    uint16_t port;
+    addressOf(fd(), true, &port);
+    return port;
+}
+
+IPAddress WiFiClient::localIP() const {
+    return addressOf(fd(), false, nullptr);
+}
+
+uint16_t WiFiClient::localPort() const {
+    uint16_t port;
+    addressOf(fd(), false, &port);
+    return port;
+}
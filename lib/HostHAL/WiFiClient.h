@@ -0,0 +1,54 @@
+#pragma once
+
+#include <memory>
+
+#include "Arduino.h"
+#include "Client.h"
+
+class HostSocket;
+
+// TCP client over a BSD socket. Copies share the socket, as in the core: a
+// WiFiClient returned by WebServer::client() and the server's own handle
+// are the same connection, and stop() on either closes it.
+class WiFiClient : public Client {
+public:
+    WiFiClient() {}
+    explicit WiFiClient(int fd);
+    ~WiFiClient() override {}
+
+    int connect(IPAddress ip, uint16_t port) override { return connect(ip, port, _connectTimeoutMs); }
+    int connect(IPAddress ip, uint16_t port, int32_t timeoutMs);
+    int connect(const char* host, uint16_t port) override { return connect(host, port, _connectTimeoutMs); }
+    int connect(const char* host, uint16_t port, int32_t timeoutMs);
+
+    using Print::write;
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buf, size_t size) override;
+    int available() override;
+    int read() override;
+    int read(uint8_t* buf, size_t size) override;
+    int peek() override;
+    void flush() override {}
+    void stop() override;
+    uint8_t connected() override;
+    operator bool() override { return connected(); }
+    bool operator==(const WiFiClient& rhs) const { return _socket == rhs._socket; }
+
+    // Read and write timeout in seconds, as in the core
+    int setTimeout(uint32_t seconds);
+    int setNoDelay(bool nodelay);
+    int fd() const;
+
+    IPAddress remoteIP() const;
+    uint16_t remotePort() const;
+    IPAddress localIP() const;
+    uint16_t localPort() const;
+
+protected:
+    // Fills the receive buffer; waits up to timeoutMs when it is empty
+    bool fill(int timeoutMs);
+
+    std::shared_ptr<HostSocket> _socket;
+    int32_t _connectTimeoutMs = 3000;
+    uint32_t _timeoutSeconds = 10;
+};
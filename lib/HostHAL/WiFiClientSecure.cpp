@@ -0,0 +1,123 @@
+#include "WiFiClientSecure.h"
+
+#include <errno.h>
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "HostSocket.h"
+
+class TlsSocket : public HostSocket {
+public:
+    TlsSocket(int fd, SSL_CTX* ctx, SSL* ssl) : HostSocket(fd), _ctx(ctx), _ssl(ssl) {}
+    ~TlsSocket() override { close(); }
+
+    ssize_t recv(uint8_t* buf, size_t len) override {
+        int n = SSL_read(_ssl, buf, (int)len);
+        if (n > 0) {
+            return n;
+        }
+        int error = SSL_get_error(_ssl, n);
+        if (error == SSL_ERROR_WANT_READ) {
+            // Only handshake records (e.g. a TLS 1.3 session ticket) arrived
+            errno = EAGAIN;
+            return -1;
+        }
+        // A clean close_notify reads as end of stream
+        return error == SSL_ERROR_ZERO_RETURN ? 0 : -1;
+    }
+
+    ssize_t send(const uint8_t* buf, size_t len) override {
+        int n = SSL_write(_ssl, buf, (int)len);
+        return n > 0 ? n : -1;
+    }
+
+    size_t pending() override { return _ssl ? (size_t)SSL_pending(_ssl) : 0; }
+
+    void close() override {
+        if (_ssl) {
+            if (fd >= 0) {
+                SSL_shutdown(_ssl);
+            }
+            SSL_free(_ssl);
+            _ssl = nullptr;
+        }
+        if (_ctx) {
+            SSL_CTX_free(_ctx);
+            _ctx = nullptr;
+        }
+        HostSocket::close();
+    }
+
+private:
+    SSL_CTX* _ctx;
+    SSL* _ssl;
+};
+
+static bool loadCa(SSL_CTX* ctx, const char* pem) {
+    BIO* bio = BIO_new_mem_buf(pem, -1);
+    X509_STORE* store = SSL_CTX_get_cert_store(ctx);
+    int loaded = 0;
+    X509* cert;
+    while ((cert = PEM_read_bio_X509(bio, nullptr, nullptr, nullptr)) != nullptr) {
+        loaded += X509_STORE_add_cert(store, cert);
+        X509_free(cert);
+    }
+    BIO_free(bio);
+    ERR_clear_error();
+    return loaded > 0;
+}
+
+int WiFiClientSecure::connect(const char* host, uint16_t port) {
+    return connect(host, port, _connectTimeoutMs);
+}
+
+int WiFiClientSecure::connect(const char* host, uint16_t port, int32_t timeoutMs) {
+    stop();
+    _lastError = "";
+    int fd = hostConnect(host, port, timeoutMs);
+    if (fd < 0) {
+        _lastError = "connect failed";
+        return 0;
+    }
+    timeval tv = {(time_t)_handshakeTimeoutSeconds, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    SSL_CTX* ctx = SSL_CTX_new(TLS_client_method());
+    SSL_CTX_set_min_proto_version(ctx, TLS1_2_VERSION);
+    // Return to the caller after non-application records instead of
+    // blocking for data that may not be coming
+    SSL_CTX_clear_mode(ctx, SSL_MODE_AUTO_RETRY);
+    if (_caCert) {
+        if (!loadCa(ctx, _caCert)) {
+            _lastError = "bad CA certificate";
+            SSL_CTX_free(ctx);
+            ::close(fd);
+            return 0;
+        }
+        SSL_CTX_set_verify(ctx, SSL_VERIFY_PEER, nullptr);
+    } else {
+        SSL_CTX_set_verify(ctx, SSL_VERIFY_NONE, nullptr);
+    }
+
+    SSL* ssl = SSL_new(ctx);
+    SSL_set_fd(ssl, fd);
+    SSL_set_tlsext_host_name(ssl, host);
+    if (_caCert) {
+        SSL_set1_host(ssl, host);
+    }
+    // From here the socket owns ctx, ssl and fd
+    auto socket = std::make_shared<TlsSocket>(fd, ctx, ssl);
+    if (SSL_connect(ssl) != 1) {
+        char err[160];
+        ERR_error_string_n(ERR_get_error(), err, sizeof(err));
+        _lastError = err;
+        return 0;
+    }
+    _socket = socket;
+    setTimeout(_timeoutSeconds);
+    return 1;
+}
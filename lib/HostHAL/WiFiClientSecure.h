@@ -0,0 +1,25 @@
+#pragma once
+
+#include "WiFiClient.h"
+
+// TLS client on OpenSSL. As in the core: with a CA the server certificate is
+// verified against it, without one (or after setInsecure()) it is not.
+class WiFiClientSecure : public WiFiClient {
+public:
+    WiFiClientSecure() {}
+
+    int connect(IPAddress ip, uint16_t port) override { return connect(ip.toString().c_str(), port); }
+    int connect(const char* host, uint16_t port) override;
+    int connect(const char* host, uint16_t port, int32_t timeoutMs);
+
+    void setCACert(const char* rootCA) { _caCert = rootCA; }
+    void setInsecure() { _caCert = nullptr; }
+    void setHandshakeTimeout(unsigned long seconds) { _handshakeTimeoutSeconds = seconds; }
+    // Host only: the last handshake error, empty after a good one
+    const String& lastError() const { return _lastError; }
+
+private:
+    const char* _caCert = nullptr;
+    unsigned long _handshakeTimeoutSeconds = 120;
+    String _lastError;
+};
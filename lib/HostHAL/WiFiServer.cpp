@@ -0,0 +1,60 @@
+#include "WiFiServer.h"
+
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "HostHAL.h"
+
+void WiFiServer::begin(uint16_t port) {
+    if (port) {
+        _port = port;
+    }
+    end();
+    _fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (_fd < 0) {
+        return;
+    }
+    int on = 1;
+    setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(HostHAL::mapPort(_port));
+    if (bind(_fd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(_fd, _maxClients) != 0) {
+        Serial.printf("WiFiServer: cannot listen on port %u\n", HostHAL::mapPort(_port));
+        ::close(_fd);
+        _fd = -1;
+    }
+}
+
+bool WiFiServer::hasClient() {
+    if (_fd < 0) {
+        return false;
+    }
+    pollfd p = {_fd, POLLIN, 0};
+    return poll(&p, 1, 0) > 0;
+}
+
+WiFiClient WiFiServer::available() {
+    if (!hasClient()) {
+        return WiFiClient();
+    }
+    int fd = ::accept(_fd, nullptr, nullptr);
+    if (fd < 0) {
+        return WiFiClient();
+    }
+    WiFiClient client(fd);
+    if (_noDelay) {
+        client.setNoDelay(true);
+    }
+    return client;
+}
+
+void WiFiServer::end() {
+    if (_fd >= 0) {
+        ::close(_fd);
+        _fd = -1;
+    }
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "WiFiClient.h"
+
+// Listening TCP socket on all interfaces; ports below 1024 are moved up by
+// HOST_PORT_OFFSET (see HostHAL.h)
+class WiFiServer {
+public:
+    explicit WiFiServer(uint16_t port = 80, uint8_t maxClients = 4) : _port(port), _maxClients(maxClients) {}
+    ~WiFiServer() { end(); }
+
+    void begin(uint16_t port = 0);
+    // Never blocks; an unconnected client when nobody is waiting
+    WiFiClient available();
+    WiFiClient accept() { return available(); }
+    bool hasClient();
+    void setNoDelay(bool nodelay) { _noDelay = nodelay; }
+    void end();
+    void close() { end(); }
+    void stop() { end(); }
+    operator bool() { return _fd >= 0; }
+
+private:
+    uint16_t _port;
+    uint8_t _maxClients;
+    bool _noDelay = false;
+    int _fd = -1;
+};
@@ -0,0 +1,153 @@
+#include "WiFiUdp.h"
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "HostHAL.h"
+
+// Largest datagram lwIP hands over on the device
+static const size_t MAX_DATAGRAM = 1460;
+
+bool WiFiUDP::open() {
+    if (_fd >= 0) {
+        return true;
+    }
+    _fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (_fd < 0) {
+        return false;
+    }
+    int on = 1;
+    setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    return true;
+}
+
+uint8_t WiFiUDP::begin(IPAddress address, uint16_t port) {
+    stop();
+    if (!open()) {
+        return 0;
+    }
+    _port = port;
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = (uint32_t)address;
+    addr.sin_port = htons(HostHAL::mapPort(port));
+    if (bind(_fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        stop();
+        return 0;
+    }
+    return 1;
+}
+
+uint8_t WiFiUDP::begin(uint16_t port) {
+    return begin(IPAddress(), port);
+}
+
+uint8_t WiFiUDP::beginMulticast(IPAddress multicast, uint16_t port) {
+    if (!begin(IPAddress(), port)) {
+        return 0;
+    }
+    _multicast = multicast;
+    ip_mreq mreq = {};
+    mreq.imr_multiaddr.s_addr = (uint32_t)multicast;
+    mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+    if (setsockopt(_fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) != 0) {
+        stop();
+        return 0;
+    }
+    return 1;
+}
+
+void WiFiUDP::stop() {
+    if (_fd >= 0) {
+        close(_fd);
+        _fd = -1;
+    }
+    _tx.clear();
+    _rx.clear();
+    _rxPos = 0;
+}
+
+int WiFiUDP::beginPacket(IPAddress ip, uint16_t port) {
+    if (!open()) {
+        return 0;
+    }
+    _txIp = ip;
+    _txPort = port;
+    _tx.clear();
+    return 1;
+}
+
+int WiFiUDP::beginPacket(const char* host, uint16_t port) {
+    IPAddress ip;
+    if (!ip.fromString(host)) {
+        addrinfo hints = {};
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_DGRAM;
+        addrinfo* res = nullptr;
+        if (getaddrinfo(host, nullptr, &hints, &res) != 0 || !res) {
+            return 0;
+        }
+        ip = IPAddress((uint32_t)((sockaddr_in*)res->ai_addr)->sin_addr.s_addr);
+        freeaddrinfo(res);
+    }
+    return beginPacket(ip, port);
+}
+
+size_t WiFiUDP::write(const uint8_t* buffer, size_t size) {
+    if (_tx.size() + size > MAX_DATAGRAM) {
+        size = MAX_DATAGRAM - _tx.size();
+    }
+    _tx.insert(_tx.end(), buffer, buffer + size);
+    return size;
+}
+
+int WiFiUDP::endPacket() {
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = (uint32_t)_txIp;
+    addr.sin_port = htons(_txPort);
+    ssize_t n = sendto(_fd, _tx.data(), _tx.size(), 0, (sockaddr*)&addr, sizeof(addr));
+    _tx.clear();
+    return n >= 0;
+}
+
+int WiFiUDP::parsePacket() {
+    if (_fd < 0) {
+        return 0;
+    }
+    _rx.resize(MAX_DATAGRAM);
+    sockaddr_in from = {};
+    socklen_t len = sizeof(from);
+    ssize_t n = recvfrom(_fd, _rx.data(), _rx.size(), MSG_DONTWAIT, (sockaddr*)&from, &len);
+    if (n <= 0) {
+        _rx.clear();
+        _rxPos = 0;
+        return 0;
+    }
+    _rx.resize(n);
+    _rxPos = 0;
+    _remoteIp = IPAddress((uint32_t)from.sin_addr.s_addr);
+    _remotePort = ntohs(from.sin_port);
+    return (int)n;
+}
+
+int WiFiUDP::read() {
+    return _rxPos < _rx.size() ? _rx[_rxPos++] : -1;
+}
+
+int WiFiUDP::read(unsigned char* buffer, size_t len) {
+    size_t n = _rx.size() - _rxPos;
+    if (n > len) {
+        n = len;
+    }
+    memcpy(buffer, _rx.data() + _rxPos, n);
+    _rxPos += n;
+    return (int)n;
+}
+
+int WiFiUDP::peek() {
+    return _rxPos < _rx.size() ? _rx[_rxPos] : -1;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+
+#include "Arduino.h"
+
+// UDP over a BSD socket. Packets are assembled between beginPacket() and
+// endPacket(), and read one datagram per parsePacket(), as in the core.
+class WiFiUDP : public Stream {
+public:
+    WiFiUDP() {}
+    ~WiFiUDP() override { stop(); }
+
+    // Ports below 1024 are moved up by HOST_PORT_OFFSET (see HostHAL.h)
+    uint8_t begin(uint16_t port);
+    uint8_t begin(IPAddress address, uint16_t port);
+    uint8_t beginMulticast(IPAddress multicast, uint16_t port);
+    void stop();
+
+    int beginPacket(IPAddress ip, uint16_t port);
+    int beginPacket(const char* host, uint16_t port);
+    int beginMulticastPacket() { return beginPacket(_multicast, _port); }
+    int endPacket();
+    using Print::write;
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override;
+
+    // Size of the next datagram, 0 when none is waiting
+    int parsePacket();
+    int available() override { return (int)(_rx.size() - _rxPos); }
+    int read() override;
+    int read(unsigned char* buffer, size_t len);
+    int read(char* buffer, size_t len) { return read((unsigned char*)buffer, len); }
+    int peek() override;
+    void flush() override { _rxPos = _rx.size(); }
+
+    IPAddress remoteIP() const { return _remoteIp; }
+    uint16_t remotePort() const { return _remotePort; }
+
+private:
+    bool open();
+
+    int _fd = -1;
+    uint16_t _port = 0;
+    IPAddress _multicast;
+
+    std::vector<uint8_t> _tx;
+    IPAddress _txIp;
+    uint16_t _txPort = 0;
+
+    std::vector<uint8_t> _rx;
+    size_t _rxPos = 0;
+    IPAddress _remoteIp;
+    uint16_t _remotePort = 0;
+};
+
+using WiFiUdp = WiFiUDP;
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdint.h>
+
+// FreeRTOS types and constants as configured in the ESP32 Arduino core;
+// tasks are threads and ticks are milliseconds
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE ((BaseType_t)0)
+#define pdTRUE ((BaseType_t)1)
+#define pdFAIL pdFALSE
+#define pdPASS pdTRUE
+#define errQUEUE_EMPTY ((BaseType_t)0)
+#define errQUEUE_FULL ((BaseType_t)0)
+
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define configTICK_RATE_HZ 1000
+#define portTICK_PERIOD_MS ((TickType_t)1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(xTimeInMs) ((TickType_t)(((TickType_t)(xTimeInMs) * (TickType_t)configTICK_RATE_HZ) / (TickType_t)1000U))
+#define configMAX_TASK_NAME_LEN 16
+#define tskNO_AFFINITY 0x7FFFFFFF
+#define configUSE_TRACE_FACILITY 1
+#define configGENERATE_RUN_TIME_STATS 1
+
+// There are no interrupts on the host; ISR-only calls become plain calls
+#define portYIELD_FROM_ISR(...) do {} while (0)
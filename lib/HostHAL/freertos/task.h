@@ -0,0 +1,49 @@
+#pragma once
+
+#include "FreeRTOS.h"
+
+// Each task is a detached std::thread. The thread that runs setup() and
+// loop() is "loopTask", like on the device.
+struct HostTask;
+typedef HostTask* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+// Priority, stack depth and core are accepted and ignored: the host
+// scheduler decides
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char* name, uint32_t stackDepth,
+                                   void* parameters, UBaseType_t priority, TaskHandle_t* created,
+                                   BaseType_t coreId);
+BaseType_t xTaskCreate(TaskFunction_t code, const char* name, uint32_t stackDepth, void* parameters,
+                       UBaseType_t priority, TaskHandle_t* created);
+// Only a task deleting itself (NULL) is supported
+void vTaskDelete(TaskHandle_t task);
+
+void vTaskDelay(TickType_t ticks);
+void vTaskDelayUntil(TickType_t* previousWakeTime, TickType_t timeIncrement);
+TickType_t xTaskGetTickCount();
+#define taskYIELD() vTaskDelay(0)
+
+TaskHandle_t xTaskGetCurrentTaskHandle();
+char* pcTaskGetName(TaskHandle_t task);
+// Stack use is not measured on the host; always 0
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+
+// Run time statistics; the counters are each thread's CPU time in
+// microseconds, the total is micros()
+typedef struct {
+    TaskHandle_t xHandle;
+    const char* pcTaskName;
+    uint32_t ulRunTimeCounter;
+    uint32_t usStackHighWaterMark;
+} TaskStatus_t;
+
+UBaseType_t uxTaskGetNumberOfTasks();
+UBaseType_t uxTaskGetSystemState(TaskStatus_t* statuses, UBaseType_t arraySize, uint32_t* totalRunTime);
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higherPriorityTaskWoken);
+
+// Names the calling thread's task; for threads the HAL starts itself, such
+// as the WiFi event task
+TaskHandle_t hostAdoptTask(const char* name);
@@ -0,0 +1,16 @@
+#include <Arduino.h>
+
+#include "HostHAL.h"
+
+// The core's app_main(): setup() once, then loop() back to back in
+// loopTask. Kept out of the library root so the tools/ harnesses, which have
+// their own main(), can link the HAL sources directly.
+int main(int argc, char** argv) {
+    HostHAL::init(argc, argv);
+    hostAdoptTask("loopTask");
+    setup();
+    while (true) {
+        loop();
+        yield();
+    }
+}
@@ -0,0 +1,678 @@
+#include "mdns.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Arduino.h"
+#include "HostHAL.h"
+#include "WiFi.h"
+
+static const char* MDNS_GROUP = "224.0.0.251";
+static const uint16_t CLASS_IN = 1;
+static const uint16_t CACHE_FLUSH = 0x8000;
+
+static uint16_t mdnsPort() {
+    return (uint16_t)HostHAL::envLong("HOST_MDNS_PORT", 5353);
+}
+
+// The IDF responder announces 120 s; shorter TTLs let tests watch expiry
+static uint32_t recordTtl() {
+    return (uint32_t)HostHAL::envLong("HOST_MDNS_TTL", 120);
+}
+
+// ---- Wire format --------------------------------------------------------
+
+static void putU16(std::string& out, uint16_t v) {
+    out += (char)(v >> 8);
+    out += (char)(v & 0xFF);
+}
+
+static void putU32(std::string& out, uint32_t v) {
+    putU16(out, v >> 16);
+    putU16(out, v & 0xFFFF);
+}
+
+// Labels without compression; "a.b.local" -> 1a1b5local0
+static void putName(std::string& out, const std::string& name) {
+    size_t start = 0;
+    while (start < name.size()) {
+        size_t dot = name.find('.', start);
+        if (dot == std::string::npos) {
+            dot = name.size();
+        }
+        out += (char)(dot - start);
+        out.append(name, start, dot - start);
+        start = dot + 1;
+    }
+    out += '\0';
+}
+
+static uint16_t getU16(const uint8_t* p) {
+    return (uint16_t)(p[0] << 8 | p[1]);
+}
+
+static uint32_t getU32(const uint8_t* p) {
+    return (uint32_t)getU16(p) << 16 | getU16(p + 2);
+}
+
+// Reads a possibly compressed name at *off; false on a malformed packet
+static bool getName(const uint8_t* pkt, size_t len, size_t* off, std::string& name) {
+    name.clear();
+    size_t pos = *off;
+    bool jumped = false;
+    for (int hops = 0; hops < 32; hops++) {
+        if (pos >= len) {
+            return false;
+        }
+        uint8_t l = pkt[pos];
+        if (l == 0) {
+            if (!jumped) {
+                *off = pos + 1;
+            }
+            return true;
+        }
+        if ((l & 0xC0) == 0xC0) {
+            if (pos + 1 >= len) {
+                return false;
+            }
+            if (!jumped) {
+                *off = pos + 2;
+            }
+            pos = (l & 0x3F) << 8 | pkt[pos + 1];
+            jumped = true;
+            continue;
+        }
+        if (pos + 1 + l > len) {
+            return false;
+        }
+        if (!name.empty()) {
+            name += '.';
+        }
+        name.append((const char*)pkt + pos + 1, l);
+        pos += 1 + l;
+    }
+    return false;
+}
+
+static void putRecordHeader(std::string& out, const std::string& name, uint16_t type, uint16_t cls, uint32_t ttl) {
+    putName(out, name);
+    putU16(out, type);
+    putU16(out, cls);
+    putU32(out, ttl);
+}
+
+// ---- Responder ------------------------------------------------------------
+
+struct Service {
+    std::string instance;
+    std::string type;   // "_http._tcp"
+    uint16_t port;
+    std::vector<std::pair<std::string, std::string>> txt;
+};
+
+static std::mutex responderMutex;
+static std::string hostName;
+static std::string defaultInstance;
+static std::vector<Service> services;
+static std::thread responderThread;
+static std::atomic<bool> responderRunning{false};
+static int responderFd = -1;
+
+static std::string hostFqdn() {
+    return hostName + ".local";
+}
+
+static std::string instanceFqdn(const Service& s) {
+    std::string instance = !s.instance.empty() ? s.instance : (!defaultInstance.empty() ? defaultInstance : hostName);
+    return instance + "." + s.type + ".local";
+}
+
+static void putA(std::string& out, uint16_t& count) {
+    uint32_t ip = (uint32_t)WiFi.localIP();
+    if (!ip) {
+        return;
+    }
+    putRecordHeader(out, hostFqdn(), MDNS_TYPE_A, CLASS_IN | CACHE_FLUSH, recordTtl());
+    putU16(out, 4);
+    out.append((const char*)&ip, 4);
+    count++;
+}
+
+static void putSrv(std::string& out, const Service& s, uint16_t& count) {
+    putRecordHeader(out, instanceFqdn(s), MDNS_TYPE_SRV, CLASS_IN | CACHE_FLUSH, recordTtl());
+    std::string rdata;
+    putU16(rdata, 0);  // priority
+    putU16(rdata, 0);  // weight
+    putU16(rdata, s.port);
+    putName(rdata, hostFqdn());
+    putU16(out, (uint16_t)rdata.size());
+    out += rdata;
+    count++;
+}
+
+static void putTxt(std::string& out, const Service& s, uint16_t& count) {
+    putRecordHeader(out, instanceFqdn(s), MDNS_TYPE_TXT, CLASS_IN | CACHE_FLUSH, recordTtl());
+    std::string rdata;
+    for (const auto& kv : s.txt) {
+        std::string item = kv.first + "=" + kv.second;
+        rdata += (char)std::min<size_t>(item.size(), 255);
+        rdata.append(item, 0, 255);
+    }
+    if (rdata.empty()) {
+        rdata += '\0';
+    }
+    putU16(out, (uint16_t)rdata.size());
+    out += rdata;
+    count++;
+}
+
+static void putPtr(std::string& out, const Service& s, uint16_t& count) {
+    putRecordHeader(out, s.type + ".local", MDNS_TYPE_PTR, CLASS_IN, recordTtl());
+    std::string rdata;
+    putName(rdata, instanceFqdn(s));
+    putU16(out, (uint16_t)rdata.size());
+    out += rdata;
+    count++;
+}
+
+static bool nameEquals(const std::string& a, const std::string& b) {
+    return strcasecmp(a.c_str(), b.c_str()) == 0;
+}
+
+// Builds the answer to one query packet; empty when nothing is ours
+static std::string answerQuery(const uint8_t* pkt, size_t len, bool legacy) {
+    std::lock_guard<std::mutex> lock(responderMutex);
+    if (hostName.empty() || len < 12 || (pkt[2] & 0x80)) {
+        return std::string();
+    }
+    uint16_t qdcount = getU16(pkt + 4);
+    std::string answers, additional, questions;
+    uint16_t ancount = 0, arcount = 0, echoed = 0;
+
+    size_t off = 12;
+    for (uint16_t q = 0; q < qdcount; q++) {
+        size_t qstart = off;
+        std::string name;
+        if (!getName(pkt, len, &off, name) || off + 4 > len) {
+            break;
+        }
+        uint16_t qtype = getU16(pkt + off);
+        off += 4;
+        bool matched = false;
+
+        if ((qtype == MDNS_TYPE_A || qtype == MDNS_TYPE_ANY) && nameEquals(name, hostFqdn())) {
+            putA(answers, ancount);
+            matched = true;
+        }
+        for (const Service& s : services) {
+            if ((qtype == MDNS_TYPE_PTR || qtype == MDNS_TYPE_ANY) && nameEquals(name, s.type + ".local")) {
+                putPtr(answers, s, ancount);
+                putSrv(additional, s, arcount);
+                putTxt(additional, s, arcount);
+                putA(additional, arcount);
+                matched = true;
+            } else if (nameEquals(name, instanceFqdn(s))) {
+                if (qtype == MDNS_TYPE_SRV || qtype == MDNS_TYPE_ANY) {
+                    putSrv(answers, s, ancount);
+                    putA(additional, arcount);
+                    matched = true;
+                }
+                if (qtype == MDNS_TYPE_TXT || qtype == MDNS_TYPE_ANY) {
+                    putTxt(answers, s, ancount);
+                    matched = true;
+                }
+            }
+        }
+        if (matched && legacy) {
+            // Legacy unicast replies repeat the question
+            std::string qname;
+            size_t qoff = qstart;
+            getName(pkt, len, &qoff, qname);
+            putName(questions, qname);
+            putU16(questions, qtype);
+            putU16(questions, CLASS_IN);
+            echoed++;
+        }
+    }
+    if (!ancount) {
+        return std::string();
+    }
+
+    std::string reply;
+    putU16(reply, legacy ? getU16(pkt) : 0);
+    putU16(reply, 0x8400);  // response, authoritative
+    putU16(reply, echoed);
+    putU16(reply, ancount);
+    putU16(reply, 0);
+    putU16(reply, arcount);
+    return reply + questions + answers + additional;
+}
+
+static int openMdnsSocket(uint16_t port) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on));
+    unsigned char loop = 1;
+    setsockopt(fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+    unsigned char ttl = 255;
+    setsockopt(fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    if (port) {
+        ip_mreq mreq = {};
+        mreq.imr_multiaddr.s_addr = inet_addr(MDNS_GROUP);
+        mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+        if (setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) != 0) {
+            close(fd);
+            return -1;
+        }
+    }
+    return fd;
+}
+
+static void responderLoop() {
+    uint16_t port = mdnsPort();
+    uint8_t pkt[1500];
+    while (responderRunning) {
+        pollfd p = {responderFd, POLLIN, 0};
+        if (poll(&p, 1, 100) <= 0) {
+            continue;
+        }
+        sockaddr_in from = {};
+        socklen_t fromLen = sizeof(from);
+        ssize_t n = recvfrom(responderFd, pkt, sizeof(pkt), 0, (sockaddr*)&from, &fromLen);
+        if (n <= 0) {
+            continue;
+        }
+        bool legacy = ntohs(from.sin_port) != port;
+        std::string reply = answerQuery(pkt, (size_t)n, legacy);
+        if (reply.empty()) {
+            continue;
+        }
+        sockaddr_in to = from;
+        if (!legacy) {
+            to.sin_addr.s_addr = inet_addr(MDNS_GROUP);
+            to.sin_port = htons(port);
+        }
+        sendto(responderFd, reply.data(), reply.size(), 0, (sockaddr*)&to, sizeof(to));
+    }
+}
+
+esp_err_t mdns_init(void) {
+    if (responderRunning) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    responderFd = openMdnsSocket(mdnsPort());
+    if (responderFd < 0) {
+        return ESP_FAIL;
+    }
+    responderRunning = true;
+    responderThread = std::thread(responderLoop);
+    return ESP_OK;
+}
+
+void mdns_free(void) {
+    if (!responderRunning) {
+        return;
+    }
+    responderRunning = false;
+    responderThread.join();
+    close(responderFd);
+    responderFd = -1;
+    std::lock_guard<std::mutex> lock(responderMutex);
+    hostName.clear();
+    defaultInstance.clear();
+    services.clear();
+}
+
+esp_err_t mdns_hostname_set(const char* hostname) {
+    if (!responderRunning) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!hostname || !*hostname || strlen(hostname) > 63) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    std::lock_guard<std::mutex> lock(responderMutex);
+    hostName = hostname;
+    return ESP_OK;
+}
+
+esp_err_t mdns_instance_name_set(const char* instance_name) {
+    if (!responderRunning) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!instance_name || strlen(instance_name) > 63) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    std::lock_guard<std::mutex> lock(responderMutex);
+    defaultInstance = instance_name;
+    return ESP_OK;
+}
+
+esp_err_t mdns_service_add(const char* instance_name, const char* service_type, const char* proto, uint16_t port,
+                           mdns_txt_item_t txt[], size_t num_items) {
+    if (!responderRunning) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!service_type || !proto || !port) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    Service s;
+    s.instance = instance_name ? instance_name : "";
+    s.type = std::string(service_type) + "." + proto;
+    s.port = port;
+    for (size_t i = 0; i < num_items; i++) {
+        s.txt.push_back({txt[i].key, txt[i].value ? txt[i].value : ""});
+    }
+    std::lock_guard<std::mutex> lock(responderMutex);
+    for (const Service& existing : services) {
+        if (existing.type == s.type) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    services.push_back(s);
+    return ESP_OK;
+}
+
+esp_err_t mdns_service_txt_item_set(const char* service_type, const char* proto, const char* key, const char* value) {
+    if (!service_type || !proto || !key) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    std::string type = std::string(service_type) + "." + proto;
+    std::lock_guard<std::mutex> lock(responderMutex);
+    for (Service& s : services) {
+        if (s.type != type) {
+            continue;
+        }
+        for (auto& kv : s.txt) {
+            if (kv.first == key) {
+                kv.second = value ? value : "";
+                return ESP_OK;
+            }
+        }
+        s.txt.push_back({key, value ? value : ""});
+        return ESP_OK;
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+// ---- Queries --------------------------------------------------------------
+
+struct mdns_search_once_s {
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable doneCv;
+    std::atomic<bool> cancel{false};
+    bool done = false;
+    mdns_result_t* results = nullptr;
+};
+
+static char* dupString(const std::string& s) {
+    return strdup(s.c_str());
+}
+
+static std::string stripLocal(const std::string& name) {
+    const std::string suffix = ".local";
+    if (name.size() > suffix.size() && strcasecmp(name.c_str() + name.size() - suffix.size(), suffix.c_str()) == 0) {
+        return name.substr(0, name.size() - suffix.size());
+    }
+    return name;
+}
+
+struct Answer {
+    std::string instance;   // full PTR target
+    uint32_t ttl = 0;
+    std::string target;     // SRV target
+    uint16_t port = 0;
+    std::vector<std::string> txt;
+};
+
+struct Collected {
+    std::vector<Answer> answers;
+    std::vector<std::pair<std::string, uint32_t>> addresses;
+};
+
+static Answer* findAnswer(Collected& c, const std::string& instance) {
+    for (Answer& a : c.answers) {
+        if (nameEquals(a.instance, instance)) {
+            return &a;
+        }
+    }
+    return nullptr;
+}
+
+static void parseResponse(const uint8_t* pkt, size_t len, const std::string& service, Collected& c, size_t max) {
+    if (len < 12 || !(pkt[2] & 0x80)) {
+        return;
+    }
+    uint16_t qd = getU16(pkt + 4);
+    uint16_t records = getU16(pkt + 6) + getU16(pkt + 8) + getU16(pkt + 10);
+    size_t off = 12;
+    std::string name;
+    for (uint16_t i = 0; i < qd; i++) {
+        if (!getName(pkt, len, &off, name) || off + 4 > len) {
+            return;
+        }
+        off += 4;
+    }
+    for (uint16_t i = 0; i < records; i++) {
+        if (!getName(pkt, len, &off, name) || off + 10 > len) {
+            return;
+        }
+        uint16_t type = getU16(pkt + off);
+        uint32_t ttl = getU32(pkt + off + 4);
+        uint16_t rdlen = getU16(pkt + off + 8);
+        off += 10;
+        if (off + rdlen > len) {
+            return;
+        }
+        size_t rd = off;
+        off += rdlen;
+
+        if (type == MDNS_TYPE_PTR && nameEquals(name, service)) {
+            std::string instance;
+            if (getName(pkt, len, &rd, instance) && !findAnswer(c, instance) && c.answers.size() < max) {
+                Answer a;
+                a.instance = instance;
+                a.ttl = ttl;
+                c.answers.push_back(a);
+            }
+        } else if (type == MDNS_TYPE_SRV && rdlen > 6) {
+            if (Answer* a = findAnswer(c, name)) {
+                a->port = getU16(pkt + rd + 4);
+                size_t t = rd + 6;
+                getName(pkt, len, &t, a->target);
+            }
+        } else if (type == MDNS_TYPE_TXT) {
+            if (Answer* a = findAnswer(c, name)) {
+                a->txt.clear();
+                for (size_t p = rd; p < rd + rdlen && p + 1 + pkt[p] <= rd + rdlen;) {
+                    if (pkt[p]) {
+                        a->txt.push_back(std::string((const char*)pkt + p + 1, pkt[p]));
+                    }
+                    p += 1 + pkt[p];
+                }
+            }
+        } else if (type == MDNS_TYPE_A && rdlen == 4) {
+            uint32_t ip;
+            memcpy(&ip, pkt + rd, 4);
+            c.addresses.push_back({name, ip});
+        }
+    }
+}
+
+static mdns_result_t* buildResults(const Collected& c, const std::string& serviceType, const std::string& proto) {
+    mdns_result_t* head = nullptr;
+    mdns_result_t** tail = &head;
+    for (const Answer& a : c.answers) {
+        mdns_result_t* r = (mdns_result_t*)calloc(1, sizeof(mdns_result_t));
+        // The instance label is what precedes "._service._proto.local"
+        std::string instance = a.instance;
+        size_t dot = instance.find("._");
+        r->instance_name = dupString(dot == std::string::npos ? instance : instance.substr(0, dot));
+        r->service_type = dupString(serviceType);
+        r->proto = dupString(proto);
+        r->ttl = a.ttl;
+        r->tcpip_if = MDNS_IF_STA;
+        r->ip_protocol = MDNS_IP_PROTOCOL_V4;
+        r->port = a.port;
+        if (!a.target.empty()) {
+            r->hostname = dupString(stripLocal(a.target));
+        }
+        if (!a.txt.empty()) {
+            r->txt = (mdns_txt_item_t*)calloc(a.txt.size(), sizeof(mdns_txt_item_t));
+            r->txt_value_len = (uint8_t*)calloc(a.txt.size(), 1);
+            for (size_t i = 0; i < a.txt.size(); i++) {
+                size_t eq = a.txt[i].find('=');
+                r->txt[i].key = dupString(a.txt[i].substr(0, eq));
+                std::string value = eq == std::string::npos ? "" : a.txt[i].substr(eq + 1);
+                r->txt[i].value = dupString(value);
+                r->txt_value_len[i] = (uint8_t)value.size();
+            }
+            r->txt_count = a.txt.size();
+        }
+        mdns_ip_addr_t** addrTail = &r->addr;
+        for (const auto& addr : c.addresses) {
+            if (nameEquals(addr.first, a.target)) {
+                mdns_ip_addr_t* ip = (mdns_ip_addr_t*)calloc(1, sizeof(mdns_ip_addr_t));
+                ip->addr.type = ESP_IPADDR_TYPE_V4;
+                ip->addr.u_addr.ip4.addr = addr.second;
+                *addrTail = ip;
+                addrTail = &ip->next;
+            }
+        }
+        *tail = r;
+        tail = &r->next;
+    }
+    return head;
+}
+
+static void runQuery(mdns_search_once_t* search, std::string serviceType, std::string proto, uint32_t timeout,
+                     size_t max) {
+    std::string service = serviceType + "." + proto + ".local";
+    Collected collected;
+
+    int fd = openMdnsSocket(0);
+    if (fd >= 0) {
+        std::string query;
+        putU16(query, (uint16_t)random(1, 0xFFFF));
+        putU16(query, 0);
+        putU16(query, 1);
+        putU16(query, 0);
+        putU16(query, 0);
+        putU16(query, 0);
+        putName(query, service);
+        putU16(query, MDNS_TYPE_PTR);
+        putU16(query, CLASS_IN);
+
+        sockaddr_in to = {};
+        to.sin_family = AF_INET;
+        to.sin_addr.s_addr = inet_addr(MDNS_GROUP);
+        to.sin_port = htons(mdnsPort());
+        sendto(fd, query.data(), query.size(), 0, (sockaddr*)&to, sizeof(to));
+
+        unsigned long start = millis();
+        uint8_t pkt[1500];
+        while (!search->cancel && millis() - start < timeout) {
+            pollfd p = {fd, POLLIN, 0};
+            if (poll(&p, 1, 50) <= 0) {
+                continue;
+            }
+            ssize_t n = recv(fd, pkt, sizeof(pkt), 0);
+            if (n > 0) {
+                parseResponse(pkt, (size_t)n, service, collected, max);
+            }
+        }
+        close(fd);
+    }
+
+    mdns_result_t* results = buildResults(collected, serviceType, proto);
+    std::lock_guard<std::mutex> lock(search->mutex);
+    search->results = results;
+    search->done = true;
+    search->doneCv.notify_all();
+}
+
+mdns_search_once_t* mdns_query_async_new(const char* name, const char* service_type, const char* proto, uint16_t type,
+                                         uint32_t timeout, size_t max_results) {
+    // Only service browsing (PTR) is needed by the sketches
+    (void)name;
+    if (type != MDNS_TYPE_PTR || !service_type || !proto || !timeout) {
+        return nullptr;
+    }
+    mdns_search_once_t* search = new mdns_search_once_t();
+    search->worker = std::thread(runQuery, search, std::string(service_type), std::string(proto), timeout,
+                                 max_results ? max_results : (size_t)-1);
+    return search;
+}
+
+bool mdns_query_async_get_results(mdns_search_once_t* search, uint32_t timeout, mdns_result_t** results) {
+    std::unique_lock<std::mutex> lock(search->mutex);
+    if (!search->done && timeout) {
+        search->doneCv.wait_for(lock, std::chrono::milliseconds(timeout), [search] { return search->done; });
+    }
+    if (!search->done) {
+        return false;
+    }
+    if (results) {
+        *results = search->results;
+        search->results = nullptr;
+    }
+    return true;
+}
+
+void mdns_query_async_delete(mdns_search_once_t* search) {
+    if (!search) {
+        return;
+    }
+    search->cancel = true;
+    search->worker.join();
+    mdns_query_results_free(search->results);
+    delete search;
+}
+
+void mdns_query_results_free(mdns_result_t* results) {
+    while (results) {
+        mdns_result_t* next = results->next;
+        free(results->instance_name);
+        free(results->service_type);
+        free(results->proto);
+        free(results->hostname);
+        for (size_t i = 0; i < results->txt_count; i++) {
+            free((void*)results->txt[i].key);
+            free((void*)results->txt[i].value);
+        }
+        free(results->txt);
+        free(results->txt_value_len);
+        while (results->addr) {
+            mdns_ip_addr_t* nextAddr = results->addr->next;
+            free(results->addr);
+            results->addr = nextAddr;
+        }
+        free(results);
+        results = next;
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+// The ESP-IDF 4.4 mDNS API as far as the sketches use it: a responder for
+// one host and its services, and async PTR/SRV/TXT/A queries. IPv4 only.
+
+#define MDNS_TYPE_A 0x0001
+#define MDNS_TYPE_PTR 0x000C
+#define MDNS_TYPE_TXT 0x0010
+#define MDNS_TYPE_AAAA 0x001C
+#define MDNS_TYPE_SRV 0x0021
+#define MDNS_TYPE_ANY 0x00FF
+
+#define ESP_IPADDR_TYPE_V4 0
+#define ESP_IPADDR_TYPE_V6 6
+
+typedef struct {
+    uint32_t addr;  // network byte order
+} esp_ip4_addr_t;
+
+typedef struct {
+    uint32_t addr[4];
+    uint8_t zone;
+} esp_ip6_addr_t;
+
+typedef struct {
+    union {
+        esp_ip6_addr_t ip6;
+        esp_ip4_addr_t ip4;
+    } u_addr;
+    uint8_t type;
+} esp_ip_addr_t;
+
+typedef enum { MDNS_IP_PROTOCOL_V4, MDNS_IP_PROTOCOL_V6, MDNS_IP_PROTOCOL_MAX } mdns_ip_protocol_t;
+typedef enum { MDNS_IF_STA = 0, MDNS_IF_AP = 1, MDNS_IF_ETH = 2, MDNS_IF_MAX } mdns_if_t;
+
+typedef struct {
+    const char* key;
+    const char* value;
+} mdns_txt_item_t;
+
+typedef struct mdns_ip_addr_s {
+    esp_ip_addr_t addr;
+    struct mdns_ip_addr_s* next;
+} mdns_ip_addr_t;
+
+typedef struct mdns_result_s {
+    struct mdns_result_s* next;
+    mdns_if_t tcpip_if;
+    uint32_t ttl;
+    mdns_ip_protocol_t ip_protocol;
+    char* instance_name;
+    char* service_type;
+    char* proto;
+    char* hostname;
+    uint16_t port;
+    mdns_txt_item_t* txt;
+    uint8_t* txt_value_len;
+    size_t txt_count;
+    mdns_ip_addr_t* addr;
+} mdns_result_t;
+
+typedef struct mdns_search_once_s mdns_search_once_t;
+
+esp_err_t mdns_init(void);
+void mdns_free(void);
+esp_err_t mdns_hostname_set(const char* hostname);
+esp_err_t mdns_instance_name_set(const char* instance_name);
+esp_err_t mdns_service_add(const char* instance_name, const char* service_type, const char* proto, uint16_t port,
+                           mdns_txt_item_t txt[], size_t num_items);
+esp_err_t mdns_service_txt_item_set(const char* service_type, const char* proto, const char* key, const char* value);
+
+// The query is sent from its own socket, so responders answer it unicast
+// (RFC 6762 legacy unicast) whatever the mDNS port is
+mdns_search_once_t* mdns_query_async_new(const char* name, const char* service_type, const char* proto, uint16_t type,
+                                         uint32_t timeout, size_t max_results);
+// True once the query has finished; *results then belongs to the caller
+bool mdns_query_async_get_results(mdns_search_once_t* search, uint32_t timeout, mdns_result_t** results);
+void mdns_query_async_delete(mdns_search_once_t* search);
+void mdns_query_results_free(mdns_result_t* results);
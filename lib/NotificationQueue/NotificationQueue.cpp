@@ -0,0 +1,234 @@
+#include "NotificationQueue.h"
+#include <LittleFS.h>
+
+static const unsigned long BACKOFF_MIN_MS = 2000;
+static const unsigned long BACKOFF_MAX_MS = 300000;
+// Batch flash writes while messages are arriving quickly
+static const unsigned long SAVE_DEBOUNCE_MS = 5000;
+
+// Shortens s to at most maxBytes without splitting a multi-byte character
+static void truncateUtf8(String& s, size_t maxBytes) {
+    if (s.length() <= maxBytes) {
+        return;
+    }
+    // Back up while the first byte cut off is a continuation byte (10xxxxxx)
+    while (maxBytes > 0 && ((uint8_t)s[maxBytes] & 0xC0) == 0x80) {
+        maxBytes--;
+    }
+    s = s.substring(0, maxBytes);
+}
+
+void NotificationQueue::begin(const char* persistPath) {
+    _persistPath = persistPath;
+    _persistReady = LittleFS.begin(true);
+    if (!_persistReady) {
+        Serial.println("Notifications: LittleFS mount failed, queue is RAM only");
+    }
+    _lastRefill = millis();
+    load();
+}
+
+void NotificationQueue::setRateLimit(float messagesPerMinute, uint8_t burst) {
+    _tokensPerMs = messagesPerMinute / 60000.0f;
+    _burst = burst;
+    _tokens = burst;
+}
+
+bool NotificationQueue::push(const String& text) {
+    _stats.enqueued++;
+
+    for (auto& entry : _pending) {
+        if (entry.text == text) {
+            if (entry.count < UINT16_MAX) {
+                entry.count++;
+            }
+            _stats.coalesced++;
+            _dirty = true;
+            return true;
+        }
+    }
+
+    if (_pending.size() >= _maxPending) {
+        // Keep what is already queued; the next message reports the loss
+        _stats.dropped++;
+        _droppedSinceSend++;
+        return false;
+    }
+
+    _pending.push_back({text, 1});
+    _dirty = true;
+    return true;
+}
+
+void NotificationQueue::refill() {
+    unsigned long now = millis();
+    _tokens += (now - _lastRefill) * _tokensPerMs;
+    if (_tokens > _burst) {
+        _tokens = _burst;
+    }
+    _lastRefill = now;
+}
+
+String NotificationQueue::buildMessage(size_t& consumed, uint32_t& notifications) {
+    String msg;
+    // Counts and notes go after the text and survive truncation
+    String suffix;
+    consumed = 0;
+    notifications = 0;
+
+    if (_pending.size() == 1) {
+        const Entry& e = _pending.front();
+        msg = e.text;
+        if (e.count > 1) {
+            suffix = " (x" + String(e.count) + ")";
+        }
+        consumed = 1;
+        notifications = e.count;
+    } else {
+        // Several different messages waiting: send them as one digest
+        msg = "Digest: " + String(_pending.size()) + " alerts";
+        for (const auto& e : _pending) {
+            String line = "\n- " + e.text;
+            if (e.count > 1) {
+                line += " (x" + String(e.count) + ")";
+            }
+            if (consumed > 0 && msg.length() + line.length() > _maxLength) {
+                break;
+            }
+            msg += line;
+            consumed++;
+            notifications += e.count;
+        }
+        if (consumed < _pending.size()) {
+            suffix = "\n(" + String(_pending.size() - consumed) + " more follow)";
+        }
+    }
+
+    if (_droppedSinceSend > 0) {
+        suffix += "\n(" + String(_droppedSinceSend) + " alerts dropped, queue full)";
+    }
+    truncateUtf8(msg, suffix.length() < _maxLength ? _maxLength - suffix.length() : 0);
+    msg += suffix;
+    truncateUtf8(msg, _maxLength);
+    return msg;
+}
+
+void NotificationQueue::loop(bool online) {
+    unsigned long now = millis();
+    refill();
+
+    if (online && !_pending.empty() && (long)(now - _retryAt) >= 0 && _tokens >= 1.0f) {
+        size_t consumed;
+        uint32_t notifications;
+        String msg = buildMessage(consumed, notifications);
+
+        // Every request costs a token, including failed ones
+        _tokens -= 1.0f;
+        _stats.sends++;
+        int code = _transport(msg);
+
+        if (code == 200) {
+            if (consumed > 1) {
+                _stats.digests++;
+            }
+            _pending.erase(_pending.begin(), _pending.begin() + consumed);
+            _stats.delivered += notifications;
+            _droppedSinceSend = 0;
+            _backoff = 0;
+            _dirty = true;
+        } else if (!retryable(code)) {
+            // The API refused the message itself; resending it cannot succeed
+            _stats.failedSends++;
+            _stats.rejected += notifications;
+            _pending.erase(_pending.begin(), _pending.begin() + consumed);
+            _backoff = 0;
+            _dirty = true;
+            Serial.printf("Notifications: send rejected (HTTP %d), %u alerts dropped\n", code,
+                          (unsigned)notifications);
+        } else {
+            _stats.failedSends++;
+            _backoff = _backoff ? min(_backoff * 2, BACKOFF_MAX_MS) : BACKOFF_MIN_MS;
+            _retryAt = millis() + _backoff;
+            Serial.printf("Notifications: send failed (HTTP %d), retry in %lu ms\n", code, _backoff);
+        }
+    }
+
+    if (_dirty && millis() - _lastSave >= SAVE_DEBOUNCE_MS) {
+        save();
+    }
+}
+
+bool NotificationQueue::retryable(int code) {
+    return code < 0 || code == 429 || code >= 500;
+}
+
+// One message per line: "<count>\t<text>", with '\\' and newlines escaped
+void NotificationQueue::save() {
+    _dirty = false;
+    _lastSave = millis();
+    if (!_persistReady) {
+        return;
+    }
+
+    if (_pending.empty()) {
+        LittleFS.remove(_persistPath);
+        return;
+    }
+
+    File f = LittleFS.open(_persistPath, FILE_WRITE);
+    if (!f) {
+        return;
+    }
+    for (const auto& e : _pending) {
+        String text = e.text;
+        text.replace("\\", "\\\\");
+        text.replace("\n", "\\n");
+        f.print(e.count);
+        f.print('\t');
+        f.print(text);
+        f.print('\n');
+    }
+    f.close();
+}
+
+void NotificationQueue::load() {
+    if (!_persistReady || !LittleFS.exists(_persistPath)) {
+        return;
+    }
+
+    File f = LittleFS.open(_persistPath, FILE_READ);
+    if (!f) {
+        return;
+    }
+    while (f.available() && _pending.size() < _maxPending) {
+        String line = f.readStringUntil('\n');
+        int tab = line.indexOf('\t');
+        if (tab <= 0) {
+            continue;
+        }
+
+        String text;
+        for (unsigned int i = tab + 1; i < line.length(); i++) {
+            char c = line[i];
+            if (c == '\\' && i + 1 < line.length()) {
+                c = line[++i] == 'n' ? '\n' : line[i];
+            }
+            text += c;
+        }
+        _pending.push_back({text, (uint16_t)line.substring(0, tab).toInt()});
+    }
+    f.close();
+
+    if (!_pending.empty()) {
+        Serial.printf("Notifications: restored %u undelivered messages\n", (unsigned)_pending.size());
+    }
+}
+
+void NotificationQueue::printStats() const {
+    float minutes = millis() / 60000.0f;
+    Serial.printf("Notifications: %u queued, %u delivered (%.2f/min) in %u requests (%u digests, %u failed), "
+                  "%u coalesced, %u dropped, %u rejected, %u pending\n",
+                  _stats.enqueued, _stats.delivered, minutes > 0 ? _stats.delivered / minutes : 0.0f,
+                  _stats.sends, _stats.digests, _stats.failedSends,
+                  _stats.coalesced, _stats.dropped, _stats.rejected, (unsigned)_pending.size());
+}
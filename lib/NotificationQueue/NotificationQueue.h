@@ -0,0 +1,87 @@
+#pragma once
+
+#include <Arduino.h>
+#include <deque>
+#include <functional>
+
+// Outbound notification queue shared by the messaging sketches.
+//
+// - Token-bucket rate limiting, so an alarm storm can't get the number or
+//   bot throttled by the messaging API.
+// - Identical pending messages are coalesced ("text (x5)"); when several
+//   different messages are waiting they go out as one digest message.
+// - Transport errors, 429 and 5xx are retried with exponential backoff. Any
+//   other status (400, 403, ...) would fail the same way again, so the
+//   message is dropped and counted as rejected.
+// - Messages longer than the limit are cut at a UTF-8 character boundary,
+//   keeping the "(x5)" and dropped-alert notes.
+// - Pending messages are saved to LittleFS and restored after a reboot.
+//
+// The transport does the actual HTTP request and returns the status code.
+class NotificationQueue {
+public:
+    using Transport = std::function<int(const String& text)>;
+
+    struct Stats {
+        uint32_t enqueued = 0;
+        uint32_t coalesced = 0;
+        uint32_t dropped = 0;
+        uint32_t delivered = 0;   // notifications, counting coalesced ones
+        uint32_t sends = 0;       // HTTP requests made
+        uint32_t failedSends = 0;
+        uint32_t rejected = 0;    // notifications dropped on a permanent error
+        uint32_t digests = 0;
+    };
+
+    explicit NotificationQueue(Transport transport) : _transport(transport) {}
+
+    // Mount LittleFS and restore messages left over from before a reboot
+    void begin(const char* persistPath = "/notify_q.txt");
+
+    void setRateLimit(float messagesPerMinute, uint8_t burst);
+    void setMaxPending(size_t maxPending) { _maxPending = maxPending; }
+    void setMaxMessageLength(size_t maxLength) { _maxLength = maxLength; }
+
+    // Never blocks; returns false if the message had to be dropped
+    bool push(const String& text);
+    // Call from every loop(), online or not: sends at most one request per
+    // call, and only when online, but saves pending messages either way
+    void loop(bool online);
+
+    size_t pending() const { return _pending.size(); }
+    const Stats& stats() const { return _stats; }
+    void printStats() const;
+
+private:
+    struct Entry {
+        String text;
+        uint16_t count;
+    };
+
+    static bool retryable(int code);
+    void refill();
+    String buildMessage(size_t& consumed, uint32_t& notifications);
+    void load();
+    void save();
+
+    Transport _transport;
+    std::deque<Entry> _pending;
+    size_t _maxPending = 32;
+    size_t _maxLength = 1000;
+
+    float _tokens = 1;
+    float _tokensPerMs = 1.0f / 60000;
+    float _burst = 1;
+    unsigned long _lastRefill = 0;
+
+    unsigned long _backoff = 0;
+    unsigned long _retryAt = 0;
+    uint32_t _droppedSinceSend = 0;
+
+    const char* _persistPath = nullptr;
+    bool _persistReady = false;
+    bool _dirty = false;
+    unsigned long _lastSave = 0;
+
+    Stats _stats;
+};
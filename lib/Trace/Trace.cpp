@@ -0,0 +1,141 @@
+#include "Trace.h"
+
+Trace::Ring Trace::_rings[Trace::MAX_TASKS];
+std::atomic<uint32_t> Trace::_ringCount{0};
+
+// One dump line is formatted here before it goes out
+static const size_t LINE_BYTES = 160;
+
+Trace::Ring* Trace::ringForCurrentTask() {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    uint32_t count = _ringCount.load(std::memory_order_acquire);
+    if (count > MAX_TASKS) {
+        count = MAX_TASKS;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        if (_rings[i].task.load(std::memory_order_relaxed) == self) {
+            return &_rings[i];
+        }
+    }
+
+    // First event of this task: claim a ring. Only this task ever writes it.
+    uint32_t i = _ringCount.fetch_add(1, std::memory_order_acq_rel);
+    if (i >= MAX_TASKS) {
+        return nullptr;
+    }
+    Ring& r = _rings[i];
+    strlcpy(r.taskName, pcTaskGetName(self), sizeof(r.taskName));
+    r.head.store(0, std::memory_order_relaxed);
+    r.task.store(self, std::memory_order_release);
+    return &r;
+}
+
+void Trace::record(char phase, const char* name, uint32_t tsUs, uint32_t value) {
+    Ring* r = ringForCurrentTask();
+    if (!r) {
+        return;
+    }
+    uint32_t head = r->head.load(std::memory_order_relaxed);
+    Event& e = r->events[head & (RING_EVENTS - 1)];
+    e.tsUs = tsUs;
+    e.value = value;
+    e.name = name;
+    e.phase = phase;
+    // Publishes the event to dump()
+    r->head.store(head + 1, std::memory_order_release);
+}
+
+void Trace::dump(Print& out) {
+    // 32-bit timestamps wrap every ~71 minutes; a ring only covers the last
+    // moments, so each is unwrapped against the current time. The age is
+    // signed: other tasks keep recording while the dump runs, so an event
+    // can be newer than now32.
+    int64_t now64 = esp_timer_get_time();
+    uint32_t now32 = (uint32_t)now64;
+
+    char line[LINE_BYTES];
+    out.print("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    bool first = true;
+    uint32_t overwritten = 0;
+
+    uint32_t count = _ringCount.load(std::memory_order_acquire);
+    uint32_t lostTasks = count > MAX_TASKS ? count - MAX_TASKS : 0;
+    if (count > MAX_TASKS) {
+        count = MAX_TASKS;
+    }
+    for (uint32_t t = 0; t < count; t++) {
+        Ring& r = _rings[t];
+        if (!r.task.load(std::memory_order_acquire)) {
+            continue;
+        }
+        snprintf(line, sizeof(line), "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                 first ? "" : ",", (unsigned)t, r.taskName);
+        out.print(line);
+        first = false;
+
+        uint32_t head = r.head.load(std::memory_order_acquire);
+        uint32_t start = head > RING_EVENTS ? head - RING_EVENTS : 0;
+        overwritten += start;
+        for (uint32_t i = start; i < head; i++) {
+            Event e = r.events[i & (RING_EVENTS - 1)];
+            // The owner kept recording; skip slots it has reused meanwhile
+            if (r.head.load(std::memory_order_acquire) - i >= RING_EVENTS) {
+                continue;
+            }
+            long long ts = now64 - (int32_t)(now32 - e.tsUs);
+            switch (e.phase) {
+            case 'X':
+                snprintf(line, sizeof(line), ",{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%u,\"pid\":1,\"tid\":%u}",
+                         e.name, ts, (unsigned)e.value, (unsigned)t);
+                break;
+            case 'C':
+                snprintf(line, sizeof(line), ",{\"name\":\"%s\",\"ph\":\"C\",\"ts\":%lld,\"pid\":1,\"tid\":%u,\"args\":{\"value\":%d}}",
+                         e.name, ts, (unsigned)t, (int)(int32_t)e.value);
+                break;
+            default:
+                snprintf(line, sizeof(line), ",{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%lld,\"pid\":1,\"tid\":%u}",
+                         e.name, ts, (unsigned)t);
+                break;
+            }
+            out.print(line);
+        }
+    }
+
+    snprintf(line, sizeof(line), "],\"otherData\":{\"overwrittenEvents\":%u,\"untracedTasks\":%u}}\n",
+             (unsigned)overwritten, (unsigned)lostTasks);
+    out.print(line);
+}
+
+void Trace::printOverhead(Print& out) {
+    const uint32_t ITERATIONS = 2000;
+
+    int64_t start = esp_timer_get_time();
+    for (uint32_t i = 0; i < ITERATIONS; i++) {
+        Scope scope("trace_overhead");
+    }
+    int64_t spanUs = esp_timer_get_time() - start;
+
+    start = esp_timer_get_time();
+    for (uint32_t i = 0; i < ITERATIONS; i++) {
+        counter("trace_overhead", (int32_t)i);
+    }
+    int64_t counterUs = esp_timer_get_time() - start;
+
+    start = esp_timer_get_time();
+    for (uint32_t i = 0; i < ITERATIONS; i++) {
+        Scope scope("trace_overhead", UINT32_MAX);
+    }
+    int64_t filteredUs = esp_timer_get_time() - start;
+
+    // Don't leave thousands of measurement events in this task's ring
+    Ring* r = ringForCurrentTask();
+    if (r) {
+        r->head.store(0, std::memory_order_release);
+    }
+
+    out.printf("Trace: %.0f ns per span, %.0f ns per counter, %.0f ns per filtered slow scope "
+               "(%u tasks x %u events, %u bytes)\n",
+               spanUs * 1000.0 / ITERATIONS, counterUs * 1000.0 / ITERATIONS,
+               filteredUs * 1000.0 / ITERATIONS, (unsigned)MAX_TASKS, (unsigned)RING_EVENTS,
+               (unsigned)sizeof(_rings));
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <atomic>
+
+// Flight-recorder tracing for finding where a sketch stalls.
+//
+// Each task writes into its own ring of the most recent events, so
+// recording takes no lock and one task never waits for another. A dump
+// writes Chrome trace-event JSON (load it in chrome://tracing or
+// ui.perfetto.dev), one track per task.
+//
+// The macros compile to nothing unless the sketch defines TRACE_ENABLED to
+// 1 before including this header; their arguments are then not evaluated.
+// Names must have static storage, since only the pointer is stored: string
+// literals, or strings such as WiFi.eventName() that return them. Don't
+// trace from ISRs: a ring has exactly one writer, its task.
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 0
+#endif
+
+#if TRACE_ENABLED
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+// Records the enclosing block as one span
+#define TRACE_SCOPE(name) Trace::Scope TRACE_CONCAT(_traceScope, __COUNTER__)(name)
+// Like TRACE_SCOPE, but only spans of at least minUs are kept; for polling
+// loops where the fast path is not interesting
+#define TRACE_SLOW_SCOPE(name, minUs) Trace::Scope TRACE_CONCAT(_traceScope, __COUNTER__)(name, minUs)
+#define TRACE_COUNTER(name, value) Trace::counter(name, value)
+#define TRACE_INSTANT(name) Trace::instant(name)
+#else
+#define TRACE_SCOPE(name) do {} while (0)
+#define TRACE_SLOW_SCOPE(name, minUs) do {} while (0)
+#define TRACE_COUNTER(name, value) do {} while (0)
+#define TRACE_INSTANT(name) do {} while (0)
+#endif
+
+class Trace {
+public:
+    static const size_t MAX_TASKS = 8;
+    // Per task; a power of two. 8 x 128 events take ~16 KB of RAM, which is
+    // only linked in when a sketch enables tracing.
+    static const size_t RING_EVENTS = 128;
+
+    class Scope {
+    public:
+        explicit Scope(const char* name, uint32_t minUs = 0) : _name(name), _minUs(minUs), _start(now()) {}
+        ~Scope() {
+            uint32_t dur = now() - _start;
+            if (dur >= _minUs) {
+                record('X', _name, _start, dur);
+            }
+        }
+
+    private:
+        const char* _name;
+        uint32_t _minUs;
+        uint32_t _start;
+    };
+
+    static void counter(const char* name, int32_t value) { record('C', name, now(), (uint32_t)value); }
+    static void instant(const char* name) { record('i', name, now(), 0); }
+
+    // Writes every task's ring as one Chrome trace JSON document
+    static void dump(Print& out);
+    // Times spans and counters on this task and prints the cost per event
+    static void printOverhead(Print& out = Serial);
+
+    static uint32_t now() { return (uint32_t)esp_timer_get_time(); }
+
+private:
+    struct Event {
+        uint32_t tsUs;
+        uint32_t value;  // duration for spans
+        const char* name;
+        char phase;
+    };
+
+    struct Ring {
+        std::atomic<TaskHandle_t> task;
+        char taskName[configMAX_TASK_NAME_LEN];
+        std::atomic<uint32_t> head;
+        Event events[RING_EVENTS];
+    };
+
+    static void record(char phase, const char* name, uint32_t tsUs, uint32_t value);
+    static Ring* ringForCurrentTask();
+
+    static Ring _rings[MAX_TASKS];
+    static std::atomic<uint32_t> _ringCount;
+};
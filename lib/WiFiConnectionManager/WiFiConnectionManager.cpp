@@ -0,0 +1,157 @@
+#include "WiFiConnectionManager.h"
+#include <Preferences.h>
+
+// Give up on an attempt that has not produced an IP after this long
+static const unsigned long CONNECT_TIMEOUT_MS = 15000;
+static const unsigned long BACKOFF_MIN_MS = 500;
+static const unsigned long BACKOFF_MAX_MS = 60000;
+
+static const char* PREFS_NAMESPACE = "wifi_cm";
+
+WiFiConnectionManager Connectivity;
+
+void WiFiConnectionManager::begin(const char* ssid, const char* password) {
+    _ssid = ssid;
+    _password = password;
+
+    // Reconnects are driven from loop(); keep the core from racing us
+    WiFi.persistent(false);
+    // Adds the station interface; a soft AP the sketch runs stays up
+    WiFi.enableSTA(true);
+    WiFi.setAutoReconnect(false);
+    WiFi.onEvent([this](arduino_event_id_t event, arduino_event_info_t info) {
+        handleEvent(event, info);
+    });
+
+    _haveCache = loadCachedNetwork();
+    startAttempt();
+}
+
+void WiFiConnectionManager::handleEvent(arduino_event_id_t event, arduino_event_info_t info) {
+    // Runs in the WiFi event task: only flag, loop() does the work
+    switch (event) {
+        case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+            _gotIp = true;
+            break;
+        case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+        case ARDUINO_EVENT_WIFI_STA_LOST_IP:
+            _lostLink = true;
+            break;
+        default:
+            break;
+    }
+}
+
+void WiFiConnectionManager::startAttempt() {
+    _attemptStart = millis();
+    _state = State::Connecting;
+    _lastAttemptFast = _haveCache;
+
+    if (_lastAttemptFast) {
+        WiFi.begin(_ssid, _password, _cachedChannel, _cachedBssid);
+    } else {
+        WiFi.begin(_ssid, _password);
+    }
+}
+
+void WiFiConnectionManager::scheduleRetry() {
+    // A failed fast-connect usually means the AP moved; fall back to a scan
+    if (_lastAttemptFast) {
+        _haveCache = false;
+    }
+
+    _backoff = _backoff ? min(_backoff * 2, BACKOFF_MAX_MS) : BACKOFF_MIN_MS;
+    _retryAt = millis() + _backoff;
+    _state = State::Backoff;
+    WiFi.disconnect();
+
+    Serial.printf("WiFi: retry in %lu ms\n", _backoff);
+}
+
+void WiFiConnectionManager::loop() {
+    if (_state == State::Idle) {
+        return;
+    }
+
+    if (_lostLink) {
+        _lostLink = false;
+        if (WiFi.status() != WL_CONNECTED) {
+            if (_state == State::Connected) {
+                Serial.println("WiFi: connection lost");
+                for (auto& cb : _onDisconnected) {
+                    cb();
+                }
+                _lastAttemptFast = false;
+                scheduleRetry();
+            } else if (_state == State::Connecting) {
+                scheduleRetry();
+            }
+        }
+    }
+
+    if (_gotIp) {
+        _gotIp = false;
+        if (_state != State::Connected && WiFi.status() == WL_CONNECTED) {
+            _state = State::Connected;
+            _backoff = 0;
+            unsigned long connectMs = millis() - _attemptStart;
+            saveCachedNetwork();
+
+            Serial.printf("WiFi: connected to %s (ch %d) in %lu ms, %s, IP %s\n",
+                          WiFi.BSSIDstr().c_str(), WiFi.channel(), connectMs,
+                          _lastAttemptFast ? "fast-connect" : "full scan",
+                          WiFi.localIP().toString().c_str());
+
+            for (auto& cb : _onConnected) {
+                cb();
+            }
+        }
+    }
+
+    unsigned long now = millis();
+    if (_state == State::Connecting && now - _attemptStart > CONNECT_TIMEOUT_MS) {
+        Serial.println("WiFi: connect attempt timed out");
+        scheduleRetry();
+    } else if (_state == State::Backoff && (long)(now - _retryAt) >= 0) {
+        startAttempt();
+    }
+}
+
+bool WiFiConnectionManager::loadCachedNetwork() {
+    Preferences prefs;
+    if (!prefs.begin(PREFS_NAMESPACE, true)) {
+        return false;
+    }
+
+    bool valid = prefs.getString("ssid", "") == _ssid &&
+                 prefs.getBytes("bssid", _cachedBssid, sizeof(_cachedBssid)) == sizeof(_cachedBssid);
+    _cachedChannel = prefs.getInt("channel", 0);
+    prefs.end();
+
+    return valid && _cachedChannel > 0;
+}
+
+void WiFiConnectionManager::saveCachedNetwork() {
+    uint8_t* bssid = WiFi.BSSID();
+    int32_t channel = WiFi.channel();
+    if (!bssid) {
+        return;
+    }
+
+    // Only touch flash when the AP actually changed
+    if (_haveCache && channel == _cachedChannel && memcmp(bssid, _cachedBssid, 6) == 0) {
+        return;
+    }
+
+    memcpy(_cachedBssid, bssid, 6);
+    _cachedChannel = channel;
+    _haveCache = true;
+
+    Preferences prefs;
+    if (prefs.begin(PREFS_NAMESPACE, false)) {
+        prefs.putString("ssid", _ssid);
+        prefs.putBytes("bssid", _cachedBssid, sizeof(_cachedBssid));
+        prefs.putInt("channel", _cachedChannel);
+        prefs.end();
+    }
+}
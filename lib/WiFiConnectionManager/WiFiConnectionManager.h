@@ -0,0 +1,59 @@
+#pragma once
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <functional>
+#include <vector>
+
+// Event-driven WiFi station bring-up shared by the sketches.
+//
+// - Never blocks: setup() calls begin(), loop() calls loop().
+// - Reconnects with exponential backoff after a drop or a failed attempt.
+// - Remembers the BSSID/channel of the last good connection in NVS and uses
+//   them to skip the full channel scan on the next connect (fast-connect).
+// - Logs each connect's duration, tagged "fast-connect" or "full scan".
+// - Runs the registered callbacks from loop() context, so dependents can
+//   re-register mDNS, reopen sockets, etc. without racing the WiFi task.
+class WiFiConnectionManager {
+public:
+    using Callback = std::function<void()>;
+
+    void begin(const char* ssid, const char* password);
+    void loop();
+
+    bool connected() const { return _state == State::Connected; }
+
+    void onConnected(Callback cb) { _onConnected.push_back(cb); }
+    void onDisconnected(Callback cb) { _onDisconnected.push_back(cb); }
+
+private:
+    enum class State { Idle, Connecting, Connected, Backoff };
+
+    void startAttempt();
+    void scheduleRetry();
+    void handleEvent(arduino_event_id_t event, arduino_event_info_t info);
+    bool loadCachedNetwork();
+    void saveCachedNetwork();
+
+    const char* _ssid = nullptr;
+    const char* _password = nullptr;
+    State _state = State::Idle;
+
+    // Set from the WiFi event task, consumed in loop()
+    volatile bool _gotIp = false;
+    volatile bool _lostLink = false;
+
+    unsigned long _attemptStart = 0;
+    unsigned long _retryAt = 0;
+    unsigned long _backoff = 0;
+
+    bool _haveCache = false;
+    bool _lastAttemptFast = false;
+    uint8_t _cachedBssid[6] = {0};
+    int32_t _cachedChannel = 0;
+
+    std::vector<Callback> _onConnected;
+    std::vector<Callback> _onDisconnected;
+};
+
+extern WiFiConnectionManager Connectivity;